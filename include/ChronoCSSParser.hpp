@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ChronoExport.hpp"
+
+namespace ChronoUI {
+	namespace CSS {
+
+		// Token kinds from CSS Syntax Level 3 (section 4). Comments never become tokens.
+		enum class TokenType : uint8_t {
+			Ident, Function, AtKeyword, Hash, String, BadString, Url, BadUrl,
+			Delim, Number, Percentage, Dimension, Whitespace, CDO, CDC,
+			Colon, Semicolon, Comma, LeftSquare, RightSquare, LeftParen, RightParen,
+			LeftCurly, RightCurly, EndOfFile
+		};
+
+		// 'text' is the raw source span of the token, escapes included. It points into the
+		// buffer handed to the Tokenizer, nothing is copied.
+		struct Token {
+			TokenType type;
+			std::string_view text;
+			size_t offset;
+
+			bool IsDelim(char c) const { return type == TokenType::Delim && text.size() == 1 && text[0] == c; }
+		};
+
+		class CHRONO_API Tokenizer {
+		public:
+			explicit Tokenizer(std::string_view source) : m_src(source) {}
+
+			Token Next();
+			size_t Offset() const { return m_pos; }
+			std::string_view Source() const { return m_src; }
+
+		private:
+			void SkipComments();
+			bool StartsIdent(size_t at) const;
+			bool StartsNumber(size_t at) const;
+			bool ValidEscape(size_t at) const;
+			void ConsumeEscape();
+			void ConsumeName();
+			void ConsumeNumber();
+			TokenType ConsumeString(char quote);
+			TokenType ConsumeUrl();
+			TokenType ConsumeIdentLike();
+
+			std::string_view m_src;
+			size_t m_pos = 0;
+		};
+
+		// A declaration inside a rule block. 'value' has surrounding whitespace and
+		// "!important" removed; comments between value tokens are kept as written.
+		struct Declaration {
+			std::string_view name;
+			std::string_view value;
+			bool important;
+		};
+
+		// A qualified rule (atKeyword empty) or an at-rule. Rules nested in an at-rule block
+		// (@media, @supports, @layer, ...) point at it through 'parent'.
+		struct Rule {
+			std::string_view atKeyword;		// Without the '@'
+			std::string_view prelude;		// Selector list or at-rule prelude, trimmed
+			int32_t parent;					// Index into StyleSheet::rules, -1 at top level
+			uint32_t firstDeclaration;		// Range in StyleSheet::declarations
+			uint32_t declarationCount;
+			bool hasBlock;
+		};
+
+		struct ParseError {
+			size_t offset;
+			const char* message;
+		};
+
+		// Views into the source text; the source must outlive the StyleSheet
+		struct StyleSheet {
+			std::vector<Rule> rules;
+			std::vector<Declaration> declarations;
+			std::vector<ParseError> errors;
+		};
+
+		class CHRONO_API Parser {
+		public:
+			// Single pass over 'source'. Malformed constructs are skipped the way CSS Syntax
+			// Level 3 recovers from them and reported in 'errors'; parsing always completes.
+			static void Parse(std::string_view source, StyleSheet* out);
+
+			// Splits a selector list (or any prelude) on top-level commas, trimming each part.
+			// Commas inside (), [] and strings do not split.
+			static void SplitList(std::string_view prelude, std::vector<std::string_view>* out);
+
+			// 1-based line of 'offset', for error reports
+			static size_t LineOf(std::string_view source, size_t offset);
+		};
+	}
+}
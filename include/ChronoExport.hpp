@@ -0,0 +1,11 @@
+#pragma once
+
+// CHRONO_API marks what ChronoUI.dll exports. Sources compiled straight into another target
+// (CHRONOUI_STATIC, e.g. the headless parser tests) and non-Windows builds export nothing.
+#if defined(CHRONOUI_STATIC) || !defined(_WIN32)
+#define CHRONO_API
+#elif defined(CHRONOUI_EXPORTS)
+#define CHRONO_API __declspec(dllexport)
+#else
+#define CHRONO_API __declspec(dllimport)
+#endif
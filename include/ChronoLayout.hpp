@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Platform-independent layout math. Nothing here knows about windows: solvers take sizes
+// in device pixels and hand back rectangles, and the Win32 side (LayoutImpl) applies only
+// the ones that changed. Builds on its own (the ChronoLayout static library) so it can be
+// benchmarked headless.
+
+namespace ChronoUI {
+	namespace Layout {
+
+		// Mirrors ChronoUI::SizeUnit
+		enum class Unit : uint8_t { Pixels, Percent, Fill, System, Auto };
+
+		// Pixels are layout pixels (96 DPI), Percent of the axis, Fill a weight (fr), Auto the
+		// content of the cells in the track
+		struct Length {
+			Unit unit;
+			float value;
+		};
+
+		// One row or column of a Grid
+		struct Track {
+			Length size = { Unit::Fill, 1.0f };
+			Length min = { Unit::Pixels, 0.0f };	// Pixels, Percent or Auto: minmax(min, size)
+			int system = 0;				// Device pixels of a System size, resolved by the caller
+			bool splitter = false;		// A splitter bar follows the track
+			bool collapsed = false;		// Sized to 'min' until restored
+		};
+
+		struct Rect {
+			int x, y, w, h;
+			bool operator==(const Rect& o) const { return x == o.x && y == o.y && w == o.w && h == o.h; }
+			bool operator!=(const Rect& o) const { return !(*this == o); }
+		};
+
+		// Where a track ended up on its axis, device pixels
+		struct Span {
+			int pos, size;
+		};
+
+		// A cell covering rowSpan x colSpan tracks from (row, col). contentW / contentH (device
+		// pixels) size the Auto tracks it covers.
+		struct Area {
+			int row = 0, col = 0;
+			int rowSpan = 1, colSpan = 1;
+			int contentW = 0, contentH = 0;
+		};
+
+		// The last few results of a solver, keyed on the box it solved for and a generation its
+		// owner bumps whenever the solver's inputs change (Yoga's per-node measure cache): a node
+		// laid out again in a box it already had, at the same generation, replays the stored
+		// result. Once full, the oldest entry makes room.
+		template <typename Result, size_t Capacity = 8>
+		class SolveCache {
+		public:
+			// The result stored for the box at 'generation', or null; counts a hit or a miss
+			const Result* Find(int x, int y, int w, int h, uint64_t generation) {
+				for (const Entry& e : m_entries) {
+					if (e.generation == generation && e.x == x && e.y == y && e.w == w && e.h == h) {
+						++m_hits;
+						return &e.result;
+					}
+				}
+				++m_misses;
+				return nullptr;
+			}
+
+			// The slot to keep a fresh result in (its storage is reused)
+			Result& Store(int x, int y, int w, int h, uint64_t generation) {
+				Entry* e;
+				if (m_entries.size() < Capacity) {
+					m_entries.emplace_back();
+					e = &m_entries.back();
+				}
+				else {
+					e = &m_entries[m_next];
+					m_next = (m_next + 1) % Capacity;
+				}
+				e->x = x;
+				e->y = y;
+				e->w = w;
+				e->h = h;
+				e->generation = generation;
+				return e->result;
+			}
+
+			void Clear() {
+				m_entries.clear();
+				m_next = 0;
+			}
+
+			uint64_t Hits() const { return m_hits; }
+			uint64_t Misses() const { return m_misses; }
+
+		private:
+			struct Entry {
+				int x = 0, y = 0, w = 0, h = 0;
+				uint64_t generation = 0;
+				Result result;
+			};
+			std::vector<Entry> m_entries;
+			size_t m_next = 0;			// Oldest entry once full
+			uint64_t m_hits = 0, m_misses = 0;
+		};
+
+		// Rows x columns of cells with Pixels / Percent / Fill / System / Auto tracks, minimums,
+		// splitter bars and collapsed tracks. Fixed, auto and percent tracks are sized first,
+		// fill tracks share what is left by weight, and no track goes below its minimum. An
+		// auto track is as large as the cells only in it; a cell spanning several tracks
+		// spreads what they lack evenly over the auto ones among them, unless it also spans a
+		// fill track.
+		class Grid {
+		public:
+			std::vector<Track> rows, cols;
+			std::vector<Area> areas;	// Cells; empty for one per row and column (row-major)
+			int dpi = 96;				// Device pixels = layout pixels * dpi / 96, rounded
+			int splitterSize = 6;		// Layout pixels
+
+			// Sizes every track for the box (x, y, w, h) and rebuilds Rects(), recording which
+			// rectangles differ from the previous Solve in Changed()
+			void Solve(int x, int y, int w, int h);
+			// The same, replaying an earlier result for this box when one was kept at
+			// 'generation': a counter the caller bumps whenever rows, cols or areas change, or
+			// Signature(). dpi and splitterSize are checked here.
+			void Solve(int x, int y, int w, int h, uint64_t generation);
+			uint64_t CacheHits() const { return m_cache.Hits(); }
+			uint64_t CacheMisses() const { return m_cache.Misses(); }
+
+			// Hash of everything Solve reads besides the box. As a generation it also replays
+			// inputs that come back (a splitter dragged back, a column collapsed and restored).
+			uint64_t Signature() const;
+
+			const std::vector<Span>& RowSpans() const { return m_rowSpans; }
+			const std::vector<Span>& ColSpans() const { return m_colSpans; }
+
+			// One per area (or the cells row-major), then one bar per column, then one per row
+			// (empty for tracks without a splitter); see the index helpers below
+			const std::vector<Rect>& Rects() const { return m_rects; }
+			// Indices into Rects() that changed in the last Solve; all of them after a track
+			// was added or removed
+			const std::vector<uint32_t>& Changed() const { return m_changed; }
+
+			size_t ItemCount() const { return areas.empty() ? rows.size() * cols.size() : areas.size(); }
+			size_t CellIndex(size_t row, size_t col) const { return row * cols.size() + col; }	// Without areas
+			size_t ColSplitterIndex(size_t col) const { return ItemCount() + col; }
+			size_t RowSplitterIndex(size_t row) const { return ItemCount() + cols.size() + row; }
+
+			// Smallest box that fits every fixed, system and auto track, the minimums of the
+			// others and the splitters
+			void MinimumSize(int* w, int* h) const;
+
+			// Size (layout pixels, for a Pixels track) of the row / column a splitter drag to
+			// 'pointer' (device pixels, the space Solve placed the tracks in) leaves, kept
+			// within its own minimum and the minimums of the tracks after it
+			float DragRow(size_t row, int pointer) const;
+			float DragCol(size_t col, int pointer) const;
+
+			// Layout pixels to device pixels, rounded like MulDiv
+			int Scale(float px) const;
+
+		private:
+			void SolveAxis(const std::vector<Track>& tracks, const std::vector<int>& content, int total, int offset, std::vector<Span>* spans) const;
+			void AutoSizes(bool vertical, std::vector<int>* content) const;
+			int MinPixels(const Track& t, int total, int content) const;
+			float Drag(const std::vector<Track>& tracks, const std::vector<int>& content, const std::vector<Span>& spans, int origin, int total, size_t index, int pointer) const;
+
+			std::vector<Span> m_rowSpans, m_colSpans;
+			std::vector<int> m_rowContent, m_colContent;	// Content size of each auto track
+			std::vector<Rect> m_rects;
+			std::vector<uint32_t> m_changed;
+			int m_x = 0, m_y = 0, m_w = 0, m_h = 0;	// Last box
+
+			// What Solve produced, for replaying
+			struct Solved {
+				std::vector<Span> rowSpans, colSpans;
+				std::vector<int> rowContent, colContent;
+				std::vector<Rect> rects;
+			};
+			SolveCache<Solved> m_cache;
+			int m_cacheDpi = 0, m_cacheSplitterSize = 0;
+		};
+
+		// align-items / align-self / align-content; Auto (align-self only) defers to align-items
+		enum class Align : uint8_t { Auto, Start, Center, End, Stretch };
+		// justify-content
+		enum class Justify : uint8_t { Start, Center, End, SpaceBetween, SpaceAround, SpaceEvenly };
+
+		// One child of a Flex box. Sizes are device pixels; "main" is the flex direction.
+		struct FlexItem {
+			int basis = -1;				// flex-basis, else width / height; -1 for content
+			int content = 0;			// Size the content asks for (what a -1 basis uses)
+			float grow = 0.0f;
+			float shrink = 1.0f;
+			int minMain = -1;			// -1: automatic, the smaller of content and basis
+			int maxMain = -1;			// -1: none
+			int cross = -1;				// -1: stretched, or crossContent when not stretched
+			int crossContent = 0;
+			int minCross = 0;
+			int maxCross = -1;			// -1: none
+			Align alignSelf = Align::Auto;
+			int order = 0;
+			bool hidden = false;		// Takes no space (display: none, command bar overflow)
+		};
+
+		// CSS flexbox for a row or a column of items: basis, grow and shrink with min / max
+		// clamping (the freeze loop of the spec), gaps, wrapping into lines, justify-content,
+		// align-items / align-self / align-content and order. Solve allocates nothing once the
+		// item count is stable.
+		class Flex {
+		public:
+			std::vector<FlexItem> items;
+			bool row = true;			// Main axis horizontal
+			bool wrap = false;
+			int gap = 0;				// Between items on a line, device pixels
+			int crossGap = 0;			// Between lines
+			Justify justify = Justify::Start;
+			Align alignItems = Align::Stretch;
+			Align alignContent = Align::Stretch;
+
+			// Lays the items out in the box (x, y, w, h). 'unbounded': the main axis scrolls, so
+			// items keep their hypothetical size and Extent() reports how far they reach.
+			void Solve(int x, int y, int w, int h, bool unbounded = false);
+
+			// One per item, in items order; hidden items get an empty rectangle
+			const std::vector<Rect>& Rects() const { return m_rects; }
+			// Indices into Rects() that changed in the last Solve; all after the count changed
+			const std::vector<uint32_t>& Changed() const { return m_changed; }
+			// Main-axis length the lines used in the last Solve
+			int Extent() const { return m_extent; }
+
+			// When the items do not all fit in 'main' at their hypothetical size, hides them in
+			// order from the first one that does not fit next to 'reserve' (an overflow button
+			// and its gap). Returns how many it hid.
+			size_t Overflow(int main, int reserve);
+
+		private:
+			struct Work {
+				float base;				// Flex base size
+				float target;			// Hypothetical, then resolved main size
+				float minMain, maxMain;
+				float clamped;			// Min / max correction of the last share
+				float cross;
+				bool frozen;
+			};
+			struct Line {
+				size_t first, count;	// Range of m_order
+				float cross;
+				float pos;
+			};
+
+			void SortOrder();
+			void Hypothetical(size_t i);
+			void ResolveLine(const Line& line, float mainSize);
+
+			std::vector<uint32_t> m_order;	// Items in 'order' order (stable)
+			std::vector<Work> m_work;
+			std::vector<Line> m_lines;
+			std::vector<Rect> m_rects;
+			std::vector<uint32_t> m_changed;
+			int m_extent = 0;
+		};
+	}
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+namespace ChronoUI {
+	namespace CSS {
+
+		enum class Combinator : uint8_t { None, Descendant, Child };
+
+		// One compound selector, e.g. "Button#ok.primary". Names are atom ids, 0 = unconstrained.
+		struct Compound {
+			uint32_t type = 0;
+			uint32_t id = 0;
+			std::vector<uint32_t> classes;
+			Combinator combinator = Combinator::None;	// Relation to the compound on its left
+		};
+
+		struct Selector {
+			std::vector<Compound> compounds;	// Left to right; the last one is the subject
+			uint32_t specificity = 0;			// (ids << 20) | (classes + pseudo-classes << 10) | types
+			std::string state;					// State pseudo-class of the subject ("hover", ...), empty for none
+
+			// Type, '*', #id, .class, one state pseudo-class (:hover, :active, :selected, :disabled)
+			// on the subject, descendant and '>' combinators. Widgets resolve :selected while
+			// focused and :active while checked; :focus and :checked have no state of their own.
+			// Anything else (attributes, siblings, pseudo-elements, ...) returns false.
+			static bool Compile(std::string_view text, Selector* out);
+		};
+
+		// An @media prelude: a comma list of queries, any of which may match. A query is a media
+		// type ("all", "screen"; any other type never matches) and / or "and"-ed features:
+		// width, height (px) and resolution (dppx, x, dpi), each plain or with min- / max-.
+		// An empty prelude matches everything, like "all".
+		struct MediaQuery {
+			struct Range {
+				float minWidth, maxWidth;
+				float minHeight, maxHeight;
+				float minDppx, maxDppx;
+				bool never;
+			};
+			std::vector<Range> ranges;
+
+			// False for anything else ("not", unknown features, range syntax, ...)
+			static bool Compile(std::string_view prelude, MediaQuery* out);
+			bool Evaluate(const MediaFeatures& features) const;
+		};
+
+		// Compiled style rules with browser-style buckets: each rule is filed under the id, first
+		// class or type of its subject, so matching a node only tests the rules that can apply.
+		class CHRONO_API RuleSet {
+		public:
+			struct Declaration {
+				std::string name;
+				std::string value;
+				bool important;
+
+				// Filled by AddRule: the lookup key ("name" or "name:state") and the parsed value
+				uint32_t key = 0;
+				PropertyValue parsed = {};
+			};
+
+			// One selector (not a list) and its declarations, in source order. False if the selector is unsupported.
+			// 'media' is an AddMedia result: the rule only applies while that query matches.
+			// 'layer' is an AddLayer result, 0 = unlayered.
+			bool AddRule(std::string_view selector, const std::vector<Declaration>& declarations, uint32_t media = 0, uint32_t layer = 0);
+			// Registers an @media prelude for AddRule; 0 if it cannot be compiled
+			uint32_t AddMedia(std::string_view prelude);
+			void Clear();
+			// Rules added and not removed
+			size_t RuleCount() const { return m_rules.size() - m_dead; }
+
+			// --- Cascade layers ---
+			// The layer 'name' (dotted for nested layers, "a.b") inside 'parent', declared on first
+			// use: layers rank in the order they are first named, each after its own sublayers,
+			// and unlayered rules above all of them. An empty name is a new anonymous layer.
+			uint32_t AddLayer(std::string_view name, uint32_t parent = 0);
+			// Layers declared so far; RollbackLayers(mark) forgets the ones declared after LayerMark
+			// returned 'mark', for a load that declared them and then failed. No rule may use them.
+			uint32_t LayerMark() const { return (uint32_t)m_layers.size(); }
+			void RollbackLayers(uint32_t mark);
+
+			// --- Sheets ---
+			// Starts a new sheet: the rules, queries and images added from here on belong to it
+			// until the next AddSheet. Ids are never reused. Rules added before any AddSheet
+			// belong to sheet 0, which cannot be removed.
+			uint32_t AddSheet();
+			// Drops the rules of 'sheet' in O(its rules). Match no longer returns them; tables
+			// matched before say which nodes held them (InheritedTable::sheets).
+			bool RemoveSheet(uint32_t sheet);
+
+			// Full test of one rule against 'node' and its ancestors (no bucket filtering)
+			bool Matches(size_t rule, IContextNode* node);
+
+			// The declarations of every rule matching 'node', cascaded: by layer, then specificity,
+			// then source order, and !important ones last with the layer order reversed. A state
+			// pseudo-class becomes the key suffix the style lookup uses ("background-color:hover").
+			// Nodes matching the same rules share the table. Null when nothing matches.
+			ContextNodeImpl::ThemeTable Match(IContextNode* node);
+
+			// Distinct cascaded tables currently shared out
+			size_t TableCount() const { return m_tables.size(); }
+
+			// --- @media ---
+			// Queries (AddMedia results) that evaluate differently for 'before' and 'after'
+			void MediaChanges(const MediaFeatures& before, const MediaFeatures& after, std::vector<uint32_t>* flipped) const;
+			// True if a rule under one of 'queries' selects 'node', i.e. its restyle may change
+			bool MediaAffects(const std::vector<uint32_t>& queries, IContextNode* node);
+
+			// --- Compiled images ---
+			// The rules as one relocatable binary block (see ChronoStyleImage.hpp): string pool,
+			// atom table, compiled selectors, pre-parsed values, layers and the id / class / type buckets.
+			void SaveImage(std::string* out) const;
+			// Appends the rules of an image without tokenizing or parsing anything: atoms are
+			// interned once and indices rebased. 'data' must stay valid only for the call and may
+			// point into a mapped file or a pak buffer. False (and nothing added) if it is invalid.
+			// The image's layers are declared inside 'layer', and its unlayered rules go there.
+			bool LoadImage(const void* data, size_t size, std::string* error = nullptr, uint32_t layer = 0);
+			static bool IsImage(const void* data, size_t size);
+
+			// Where the selectors test a class or id name: on the node being styled (Subject),
+			// on one of its ancestors (Ancestor), both, or nowhere. A class change restyles
+			// only what these bits say can match differently.
+			enum Dependency : uint32_t { None = 0, Subject = 1, Ancestor = 2 };
+			uint32_t ClassDependency(PropertyHandle name) const;
+			uint32_t IdDependency(PropertyHandle name) const;
+
+		private:
+			struct Rule {
+				Selector selector;
+				std::vector<Declaration> declarations;
+				uint32_t media = 0;			// AddMedia result, 0 = unconditional
+				uint32_t layer = 0;			// AddLayer result, 0 = unlayered
+				uint32_t sheet = 0;
+				bool dead = false;			// Its sheet was removed; skipped until Compact
+			};
+			struct Media {
+				std::string prelude;
+				MediaQuery query;
+				std::vector<uint32_t> rules;	// Rules under this query
+			};
+			struct Layer {
+				std::string name;				// Last name part, empty when anonymous
+				uint32_t parent = 0;
+				std::vector<uint32_t> children;	// In declaration order
+				uint32_t rank = 0;				// Cascade position, see RankLayers
+			};
+			struct Sheet {
+				std::vector<uint32_t> rules, media;
+				bool removed = false;
+			};
+			struct Element {
+				IContextNode* node;
+				bool described;
+				uint32_t type, id;
+				std::vector<uint32_t> classes;
+			};
+
+			const Element& Describe(size_t depth);
+			bool CompoundMatches(const Compound& c, const Element& e) const;
+			bool MatchFrom(const Selector& s, size_t index, size_t depth);
+			const MediaFeatures* FindMediaFeatures();
+			void BuildChain(IContextNode* node);
+			void AddDependencies(uint32_t index);
+			void File(uint32_t index);
+			void RankLayers();
+			void Compact();
+
+			std::vector<Rule> m_rules;
+			std::unordered_map<uint32_t, std::vector<uint32_t>> m_byId, m_byClass, m_byType;
+			std::vector<uint32_t> m_universal;
+			std::unordered_map<uint32_t, uint32_t> m_classDeps, m_idDeps;	// Atom -> Dependency bits
+			std::vector<Media> m_media;
+			std::vector<Layer> m_layers = std::vector<Layer>(1);	// [0] is the unlayered root
+			std::vector<Sheet> m_sheets;		// Sheet id - 1
+			uint32_t m_sheet = 0;				// Current sheet
+			size_t m_dead = 0;
+
+			// Per-match scratch: the node and its ancestors, described on demand
+			std::vector<Element> m_chain;
+			size_t m_chainLength = 0;
+			std::vector<uint32_t> m_seen;
+			uint32_t m_stamp = 0;
+
+			std::map<std::vector<uint32_t>, ContextNodeImpl::ThemeTable> m_tables;
+		};
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+// Compiled style sheet image (".ccss"), written by RuleSet::SaveImage / ChronoCSSC and read
+// in place by RuleSet::LoadImage. Little-endian, every section 4-byte aligned, all offsets
+// relative to the start of the image so it can sit anywhere: a mapped file, a pak entry,
+// a std::string handed to StyleManager::LoadCSS.
+//
+//   Header
+//   strings     NUL-terminated UTF-8, referenced by byte offset
+//   atoms       uint32 string offsets; selectors and declarations refer to atom indices
+//   rules       Rule[], in source order
+//   compounds   Compound[], left to right per rule
+//   decls       Declaration[], values pre-parsed
+//   lists       uint32 pool: compound class lists and bucket rule lists
+//   buckets     Bucket[]: the RuleSet id / class / type / universal indexes
+//   media       uint32 string offsets of @media preludes, compiled again on load
+//   layers      Layer[]: the @layer tree in declaration order, parents first
+//
+// Atom indices are stored plus one so that 0 means "none", like the atom ids of a live RuleSet.
+
+namespace ChronoUI {
+	namespace CSS {
+		namespace Image {
+
+			const char kMagic[4] = { 'C', 'C', 'S', 'S' };
+			const uint16_t kVersion = 4;	// 2: em / rem / vw / ... units and calc(); 3: @media; 4: @layer
+			const uint32_t kNone = 0xFFFFFFFFu;
+
+			struct Section {
+				uint32_t offset;
+				uint32_t count;		// Elements, or bytes for the string pool
+			};
+
+			struct Header {
+				char magic[4];
+				uint16_t version;
+				uint16_t flags;			// Reserved, 0
+				uint32_t size;			// Whole image in bytes
+				Section strings, atoms, rules, compounds, decls, lists, buckets, media, layers;
+			};
+
+			struct Rule {
+				uint32_t firstCompound, compoundCount;
+				uint32_t firstDecl, declCount;
+				uint32_t specificity;
+				uint32_t state;			// String offset of the state pseudo-class, kNone for none
+				uint32_t media;			// Index into 'media' + 1, 0 = unconditional
+				uint32_t layer;			// Index into 'layers' + 1, 0 = unlayered
+			};
+
+			struct Compound {
+				uint32_t type, id;		// Atom index + 1, 0 = unconstrained
+				uint32_t firstClass, classCount;	// Range in 'lists', atom index + 1 each
+				uint32_t combinator;	// CSS::Combinator
+			};
+
+			// PropertyValue without its text pointer
+			struct Value {
+				uint8_t type, unit, boolean, hasNumber;
+				uint8_t hasInteger, reserved[3];
+				float number;
+				int32_t integer;
+				uint32_t rgba;
+			};
+
+			struct Declaration {
+				uint32_t name, value;	// String offsets
+				uint32_t key;			// Atom index + 1 of "name" or "name:state"
+				uint32_t important;
+				Value parsed;
+			};
+
+			// Declared again on load: a name the loading set already knows keeps its place in the cascade
+			struct Layer {
+				uint32_t name;			// String offset of the last name part, kNone when anonymous
+				uint32_t parent;		// Index into 'layers' + 1, 0 = top level
+			};
+
+			enum BucketKind : uint32_t { ById, ByClass, ByType, Universal };
+
+			struct Bucket {
+				uint32_t kind;
+				uint32_t atom;			// Atom index + 1, 0 for Universal
+				uint32_t first, count;	// Rule indices in 'lists'
+			};
+		}
+	}
+}
@@ -7,16 +7,29 @@
 
 
 #include "WidgetImpl.hpp"
+#include "ChronoSelectors.hpp"
 
 namespace ChronoUI {
 
 	typedef std::map<std::string, std::string> StyleProperties;
 
+	// A loaded style sheet, for StyleManager::UnloadSheet. Invalid when the load failed.
+	struct StyleSheetHandle {
+		uint32_t id = 0;
+		bool IsValid() const { return id != 0; }
+		explicit operator bool() const { return id != 0; }
+	};
+
 	// Apply the API Macro to the class
 	class CHRONO_API StyleManager {
 	private:
-		// Stores ".btn" -> { "background-color": "#333", ... }
-		std::map<std::string, StyleProperties> _registry;
+		// Compiled rules of every loaded sheet, bucketed by id / class / type and tagged with
+		// their sheet and cascade layer
+		CSS::RuleSet _rules;
+
+		// Compiled themes by name, and the one the controller currently references
+		std::map<std::string, ContextNodeImpl::ThemeTable> _themes;
+		std::string _theme;
 
 		// Private Constructor (Enforce Singleton)
 		StyleManager();
@@ -24,8 +37,9 @@ namespace ChronoUI {
 		// The Singleton Accessor (Declaration Only)
 		static StyleManager& Instance();
 
-		// Private helper to apply styles
-		void ApplyClassesImpl(IContextNode* node, const std::set<std::string>& classes);
+		static void CommitClasses(IContextNode* node, const std::string& classes, const std::vector<std::string_view>& changed);
+		static void CommitId(IContextNode* node, const char* before, const char* after);
+		friend class StyleCache;
 
 	public:
 		// Delete copy and move constructors
@@ -34,13 +48,52 @@ namespace ChronoUI {
 
 		// --- Public Static API ---
 
-		static void LoadCSS(const std::string& cssContent);
-		static void LoadCSSFile(const std::string& filePath);
+		// Text CSS or a compiled image; the two are told apart by the image header. Every load is
+		// a new sheet: within a cascade layer later sheets win, and @layer blocks order the layers
+		// across sheets. A non-empty 'layer' puts the whole sheet in that layer, as
+		// "@import url(...) layer(name)" does, e.g. to keep a plugin's rules under the app's.
+		// Nodes already styled keep their tables until restyled: pass 'root' to restyle the tree
+		// under it once the rules are in, as UnloadSheet does when they go.
+		static StyleSheetHandle LoadCSS(const std::string& cssContent, const std::string& layer = "", IContextNode* root = nullptr);
+		static StyleSheetHandle LoadCSSFile(const std::string& filePath, const std::string& layer = "", IContextNode* root = nullptr);
+		// Removes the rules of a loaded sheet in O(its rules) and restyles the nodes under 'root'
+		// that matched one of them; nodes that never saw the sheet are not re-matched. Pass each
+		// root the sheet may have styled, or restyle them yourself. False if it is not loaded.
+		static bool UnloadSheet(StyleSheetHandle sheet, IContextNode* root = nullptr);
+
+		// --- Compiled style sheets ---
+		// Compiles CSS into the binary image LoadCSS / LoadCompiled accept (see ChronoStyleImage.hpp).
+		// This is what the ChronoCSSC tool runs at build time.
+		static void CompileCSS(const std::string& cssContent, std::string* image);
+		// Adds the rules of a compiled image with no parsing, as a sheet like LoadCSS. 'data' can be
+		// a mapped file or a buffer read from a pak (VirtualDrive::ReadFile); it is not referenced
+		// after the call. 'root' as for LoadCSS.
+		static StyleSheetHandle LoadCompiled(const void* data, size_t size, const std::string& layer = "", IContextNode* root = nullptr);
 
 		static void AddClass(IContextNode* node, const std::string& classNames);
 		static void RemoveClass(IContextNode* node, const std::string& classNames);
 		static bool HasClass(IContextNode* node, const std::string& className);
 		static void ToggleClass(IContextNode* node, const std::string& className);
+
+		// Re-matches 'node' against the loaded rules and swaps its rule layer. Nodes matching
+		// the same rules share one table; properties set directly on the node still win.
+		static void Restyle(IContextNode* node);
+		// Restyle of 'node' and everything below it, for changes descendant selectors can see
+		static void RestyleTree(IContextNode* node);
+		// The media features of 'root' (a container) changed from 'before' to 'after'; call it once
+		// the node reports 'after'. Only @media queries whose result flips cause work, and only
+		// the nodes their rules select are restyled.
+		static void UpdateMedia(IContextNode* root, const MediaFeatures& before, const MediaFeatures& after);
+
+		// --- Themes ---
+		// A theme is compiled once into an immutable property table that sits under the
+		// controller's own properties. "light" (the default) and "dark" are built in.
+		// Registering an existing name replaces it; apply it again to pick up the new table.
+		static void RegisterTheme(const std::string& name, const StyleProperties& properties);
+		// Swaps the controller's theme table and repaints the visible windows of every
+		// container sharing it. Returns false for an unknown name.
+		static bool SetTheme(const std::string& name);
+		static std::string GetTheme();
 	};
 
 	// Internal helpers (kept in header as inline utilities, or move to .cpp if preferred)
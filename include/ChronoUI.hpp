@@ -6,6 +6,8 @@
 #include <sstream>
 #include <map>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 #include <d2d1.h>
 #include <d2d1_1.h>
@@ -22,14 +24,11 @@ using Microsoft::WRL::ComPtr;
 
 #pragma warning(disable:4100)
 
-#ifdef CHRONOUI_EXPORTS
-#define CHRONO_API __declspec(dllexport)
-#else
-#define CHRONO_API __declspec(dllimport)
-#endif
+#include "ChronoExport.hpp"
 
 namespace ChronoUI {
-	enum class SizeUnit { Pixels, Percent, Fill, System };
+	// Fill is a weight, like CSS fr; Auto sizes a grid track to the cells in it
+	enum class SizeUnit { Pixels, Percent, Fill, System, Auto };
 	// 1. Expanded Enum with Common Windows UI Definitions
 	enum class StandardMetric {
 		// Window Chrome
@@ -74,6 +73,7 @@ namespace ChronoUI {
 		static WidgetSize Fill(float weight = 1.0f) { return { SizeUnit::Fill, weight, {} }; }
 		static WidgetSize Percent(float p) { return { SizeUnit::Percent, p, {} }; }
 		static WidgetSize System(StandardMetric m) { return { SizeUnit::System, 0, m }; }
+		static WidgetSize Auto() { return { SizeUnit::Auto, 0, {} }; }
 	};
 
 	// Helper for DPI scaling if not available globally
@@ -375,7 +375,274 @@ namespace ChronoUI {
 		}
 	};
 
+	// Interned property key. Resolve a key once (IContextNode::ResolveKey or
+	// PropertyAtoms::Intern) and keep the handle: handle-based lookups compare
+	// integers and never hash the key text again.
+	struct PropertyHandle {
+		uint32_t id;
+
+		bool IsValid() const { return id != 0; }
+		bool operator==(const PropertyHandle& other) const { return id == other.id; }
+		bool operator!=(const PropertyHandle& other) const { return id != other.id; }
+	};
+
+	// Process-wide atom table living in ChronoUI.dll, so every widget DLL sees the same ids.
+	class PropertyAtoms {
+	public:
+		// Returns the handle for 'key', creating it on first use. Empty/null keys give an invalid handle.
+		CHRONO_API static PropertyHandle __stdcall Intern(const char* key);
+		// Returns the handle for 'key' or an invalid handle if it was never interned (no insertion).
+		CHRONO_API static PropertyHandle __stdcall Find(const char* key);
+		// Returns the key text of a handle. The pointer stays valid for the lifetime of the process.
+		CHRONO_API static const char* __stdcall Name(PropertyHandle handle);
+		// Number of interned keys (diagnostics)
+		CHRONO_API static size_t __stdcall Count();
+
+		// Style keys are the composed keys GetStyle has consulted ("button:hover:color", "color", ...).
+		// Writing one of them invalidates cached style resolutions; other keys never do.
+		CHRONO_API static PropertyHandle __stdcall InternStyleKey(const char* key);
+		CHRONO_API static void __stdcall MarkStyleKey(PropertyHandle handle);
+		CHRONO_API static bool __stdcall IsStyleKey(PropertyHandle handle);
+	};
+
+	// State bits of a style lookup (part of the style cache key)
+	namespace StyleState {
+		enum : uint32_t { Disabled = 1, Hover = 2, Selected = 4, Active = 8 };
+
+		inline uint32_t Mask(bool selected, bool enabled, bool hovered, bool active) {
+			return (enabled ? 0 : Disabled) | (hovered ? Hover : 0) | (selected ? Selected : 0) | (active ? Active : 0);
+		}
+	}
+
 	class IContextNode;
+
+	// Global epoch and statistics for the per-node style resolution caches.
+	class StyleCache {
+	public:
+		CHRONO_API static uint64_t __stdcall Epoch();
+		// Drops every cached resolution (CSS loaded, or a style key written on a shared ancestor)
+		CHRONO_API static void __stdcall Invalidate();
+
+		CHRONO_API static void __stdcall RecordLookup(bool hit);
+		CHRONO_API static void __stdcall GetStats(uint64_t* hits, uint64_t* misses);
+		CHRONO_API static void __stdcall ResetStats();
+
+		// The "id" of 'node' changed from 'before' to 'after': re-matches what #id selectors
+		// naming either can reach, as a class change does (see StyleManager::AddClass)
+		CHRONO_API static void __stdcall IdChanged(IContextNode* node, const char* before, const char* after);
+	};
+
+	// Opt-in flattened inheritance: each node keeps a shared, immutable table of everything
+	// its ancestors define, so an inherited key is one hash probe instead of a parent walk.
+	// The epoch moves when a node whose table was handed to children changes or moves;
+	// nodes revalidate lazily and only the changed subtree gets new tables.
+	class PropertyInheritance {
+	public:
+		CHRONO_API static void __stdcall EnableSnapshots(bool enable);
+		CHRONO_API static bool __stdcall SnapshotsEnabled();
+
+		CHRONO_API static uint64_t __stdcall Epoch();
+		CHRONO_API static void __stdcall Invalidate();
+	};
+
+	// CSS custom properties: "--name: value" declarations read through "var(--name, fallback)".
+	// A value using var() is computed lazily on the node that declares it and cached together
+	// with the generation of every custom property it read. Invalidation is scoped to a subtree:
+	// the node that (re)defines a custom property, or moves, takes a new stamp, and a computed
+	// value is only checked again when a node on its parent chain has a newer stamp than it saw.
+	// Even then only a change of one of the custom properties it read computes it again.
+	class CustomProperties {
+	public:
+		// True for "--" keys
+		CHRONO_API static bool __stdcall IsCustom(PropertyHandle key);
+		CHRONO_API static uint64_t __stdcall Generation(PropertyHandle key);
+		// 'key' was defined, changed or removed somewhere in the tree; returns the stamp it took
+		CHRONO_API static uint64_t __stdcall Touch(PropertyHandle key);
+		// Stamps come from one increasing counter: Stamp() is the latest handed out (by Touch or
+		// NewStamp), so a value checked at Stamp() is current while it does not move
+		CHRONO_API static uint64_t __stdcall Stamp();
+		CHRONO_API static uint64_t __stdcall NewStamp();
+
+		// Dependency recording (per thread). While a value is computed, every custom property
+		// it reads, directly or through another custom property, is appended to the active list.
+		struct Dependency {
+			uint32_t key;			// PropertyHandle::id
+			uint64_t generation;
+		};
+		typedef std::vector<Dependency> Dependencies;
+		// Makes 'deps' the active list (may be null) and returns the previous one
+		CHRONO_API static Dependencies* __stdcall Collect(Dependencies* deps);
+		CHRONO_API static void __stdcall Record(PropertyHandle key);
+		CHRONO_API static void __stdcall Record(const Dependencies& deps);
+		// True while every generation in 'deps' is still current
+		CHRONO_API static bool __stdcall IsCurrent(const Dependencies& deps);
+	};
+
+	// What changing a property affects. Keys without an entry are treated as Paint.
+	enum class PropertyImpact : uint8_t { None, Paint, Layout };
+
+	// Per-control property impact, used to skip redundant invalidation.
+	// Lookup order: the control's own entry, then the global default (classid = invalid handle), then Paint.
+	class PropertySchema {
+	public:
+		CHRONO_API static void __stdcall SetImpact(PropertyHandle classid, PropertyHandle key, PropertyImpact impact);
+		CHRONO_API static PropertyImpact __stdcall GetImpact(PropertyHandle classid, PropertyHandle key);
+		// Reads the optional "impact": "none" | "paint" | "layout" of each "properties" entry.
+		// Only the first call per control does any work.
+		CHRONO_API static void __stdcall RegisterManifest(PropertyHandle classid, const char* manifestJson);
+	};
+
+	// Posted to a container once per frame with dirty layout roots queued (see
+	// ContextNodeImpl::InvalidateLayout), or to the parent window of a widget that changed a
+	// Layout-impact property before joining the node tree
+	const UINT WM_CHRONO_LAYOUT_DIRTY = WM_USER + 102;
+
+	// Classification of a property's text, computed once when the property is written.
+	enum class PropertyType : uint8_t { Empty, String, Bool, Int, Float, Length, Color, FloatArray };
+	// Px (also "lu") and the physical units are logical and follow the DPI; Dpx is device pixels.
+	// Expression is a compiled min() / max() / clamp() / calc(), see LengthExpression.
+	enum class LengthUnit : uint8_t { None, Px, Percent, Em, Rem, Vw, Vh, Pt, Pc, In, Cm, Mm, Dpx, Expression };
+
+	// Compiled min() / max() / clamp() / calc(): a postfix program evaluated by Lengths::Resolve.
+	// Equal texts compile to the same expression, which is immutable and lives as long as the process;
+	// an owned one (PropertyValue::ParseOwned) belongs to its caller instead.
+	struct LengthExpression {
+		enum Op : uint8_t { Push, Add, Sub, Mul, Div, Min, Max, Clamp };
+		struct Step {
+			Op op;
+			LengthUnit unit;		// Push: unit of 'value' (None for a plain number)
+			uint16_t operands;		// Min / Max: how many values they take off the stack
+			float value;
+		};
+		const Step* steps;
+		uint32_t count;
+		uint32_t depth;				// Stack slots needed, at most kMaxDepth
+		bool usesFont;				// Reads em / rem
+		bool owned;					// Not interned: freed by Lengths::Release
+
+		static const uint32_t kMaxDepth = 16;
+	};
+
+	// Parsed view of a property value (plain data, safe to pass across the DLL boundary).
+	// The numeric fields follow std::stof/std::stoi rules, so "12px" still reads as 12.
+	struct PropertyValue {
+		PropertyType type;
+		LengthUnit unit;        // Length only: "px"/"lu" -> Px, "%" -> Percent, "12em" -> Em, ...
+		bool boolean;           // Bool only: true for "true"
+		bool hasNumber;         // 'number' is valid (text starts with a float)
+		bool hasInteger;        // 'integer' is valid (text starts with an integer)
+		float number;
+		int32_t integer;
+		uint32_t rgba;          // Color only, packed as 0xAARRGGBB
+		const char* text;       // Raw text, owned by the node (same lifetime as GetProperty)
+		const LengthExpression* expression;	// Length with unit Expression only
+
+		bool IsColor() const { return type == PropertyType::Color; }
+
+		// Parses 'text'. The result keeps pointing at 'text'.
+		CHRONO_API static PropertyValue __stdcall Parse(const char* text);
+		// As Parse, but an expression is the caller's own copy, freed with Lengths::Release once
+		// nothing reads the value. For texts that keep changing (node properties, var() results),
+		// which would otherwise stay in the interned table for good.
+		CHRONO_API static PropertyValue __stdcall ParseOwned(const char* text);
+	};
+
+	// What relative lengths resolve against. Sizes are device pixels, font sizes logical units.
+	struct LengthContext {
+		float percentBase;		// 100%
+		float dpiScale;			// Device pixels per logical unit (DPI / 96)
+		float viewportWidth;	// 100vw
+		float viewportHeight;	// 100vh
+		float fontSize;			// 1em
+		float rootFontSize;		// 1rem
+	};
+
+	// What @media queries are evaluated against, per container (see StyleManager::UpdateMedia)
+	struct MediaFeatures {
+		float width;			// Client area in logical pixels (CSS px)
+		float height;
+		float dppx;				// Device pixels per logical pixel (DPI / 96)
+	};
+
+	// Layout-time evaluation of the lengths PropertyValue::Parse compiled on write.
+	// No parsing and no allocation: a table lookup per unit and a small stack per expression.
+	class Lengths {
+	public:
+		// Device pixels for a Length, Int or Float value (plain numbers are logical pixels).
+		// False for anything else ("auto", keywords, empty): the caller applies its default.
+		CHRONO_API static bool __stdcall Resolve(const PropertyValue& value, const LengthContext& context, float* out);
+		// True when resolving 'value' reads the font sizes, so callers can skip looking them up
+		CHRONO_API static bool __stdcall UsesFont(const PropertyValue& value);
+		// Compiles an expression ("calc(100% - 2em)", "clamp(...)", ...); null if it is not one.
+		// Interned unless 'owned', see PropertyValue::ParseOwned.
+		CHRONO_API static const LengthExpression* __stdcall Compile(const char* text, bool owned = false);
+		// Frees an owned expression; interned ones and null are ignored
+		CHRONO_API static void __stdcall Release(const LengthExpression* expression);
+	};
+
+	// One entry of a "transition" value: "<property> <duration> [<easing>] [<delay>]"
+	struct TransitionTiming {
+		uint32_t property;		// PropertyHandle::id, 0 for "all"
+		float duration;			// Milliseconds
+		float delay;			// Milliseconds, may be negative
+		float x1, y1, x2, y2;	// cubic-bezier() control points; "linear" is (0, 0, 1, 1)
+		uint32_t steps;			// steps(n) / step-end: n jumps at the end of each interval, 0 = curve
+		bool jumpStart;			// steps(n, start) / step-start
+	};
+
+	// A compiled "transition" value. Equal texts compile to the same list, which is immutable
+	// and lives as long as the process (the same interning as LengthExpression).
+	struct TransitionList {
+		const TransitionTiming* items;
+		uint32_t count;
+	};
+
+	// Parsing and typed interpolation for CSS transitions (see WidgetImpl::GetAnimatedStyle)
+	class Transitions {
+	public:
+		// Comma list of entries; null for "none", empty or anything it cannot read
+		CHRONO_API static const TransitionList* __stdcall Compile(const char* text);
+		// The timing 'property' uses: the last entry naming it or "all", null if none does
+		CHRONO_API static const TransitionTiming* __stdcall Find(const TransitionList* list, PropertyHandle property);
+		// Eased progress in [0, 1] once 'elapsed' ms have passed since the change (delay included)
+		CHRONO_API static float __stdcall Progress(const TransitionTiming& timing, double elapsed);
+		// Interpolates two packed 0xAARRGGBB colors in linear light with premultiplied alpha
+		CHRONO_API static uint32_t __stdcall MixColor(uint32_t from, uint32_t to, float t);
+	};
+
+	// Something the animation clock drives, one call per frame
+	class IAnimated {
+	public:
+		// 'now' is AnimationClock::Now() for the frame. Return false once nothing is left to animate.
+		virtual bool __stdcall OnAnimationFrame(double now) = 0;
+	};
+
+	// One frame clock for the whole UI thread. A single timer runs while any target is
+	// animating and is killed when the last one finishes, so an idle UI gets no ticks at all.
+	class AnimationClock {
+	public:
+		// Monotonic milliseconds
+		CHRONO_API static double __stdcall Now();
+		// Drives 'target' until its OnAnimationFrame returns false. Adding it again is a no-op.
+		CHRONO_API static void __stdcall Add(IAnimated* target);
+		// Must be called before a target is destroyed; safe from inside OnAnimationFrame
+		CHRONO_API static void __stdcall Remove(IAnimated* target);
+		CHRONO_API static size_t __stdcall ActiveCount();
+		// Runs one frame and returns how many targets are still animating. The clock's timer
+		// calls this; tools and benchmarks may drive it directly.
+		CHRONO_API static size_t __stdcall Tick(double now);
+	};
+
+	// A splitter drag in progress. Layouts then arrange at most once per AnimationClock frame,
+	// and widgets that opt in (WidgetImpl::StretchesWhileResizing) stretch a snapshot of
+	// themselves instead of drawing; the layout repaints at full quality once on release.
+	class LiveResize {
+	public:
+		CHRONO_API static void __stdcall Begin();
+		CHRONO_API static void __stdcall End();
+		CHRONO_API static bool __stdcall IsActive();
+	};
+
 	class ChronoController {
 	public:
 		// Move CHRONO_API to the very front to satisfy MSVC parser
@@ -406,6 +673,42 @@ namespace ChronoUI {
 		virtual IContextNode* SetColor(const char* key, COLORREF color) = 0;
 		// Color Getter Helper
 		virtual COLORREF GetColor(const char* key, COLORREF defaultColor = RGB(0, 0, 0)) = 0;
+
+	public:
+		// Interned key access. Resolve once (e.g. in the widget constructor) and use the
+		// handle overloads on hot paths such as OnDrawWidget.
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) = 0;
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = 0) = 0;
+		virtual IContextNode* __stdcall SetProperty(PropertyHandle key, const char* value) = 0;
+		// Typed lookup through the same parent chain. Returns false if the key is not set anywhere.
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) = 0;
+		// Cached style resolution (see GetStyle). 'stateMask' is a StyleState::Mask(). Returns false if no level matched.
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) = 0;
+
+	public:
+		// Batched updates. Values set between BeginUpdate/EndUpdate are stored immediately,
+		// but change notifications, bindings and the repaint run once, at the outermost EndUpdate.
+		// Calls nest; see also PropertyUpdateScope.
+		virtual void __stdcall BeginUpdate() = 0;
+		virtual void __stdcall EndUpdate() = 0;
+	};
+
+	// RAII helper: BeginUpdate on construction, EndUpdate on destruction
+	class PropertyUpdateScope {
+	public:
+		explicit PropertyUpdateScope(IContextNode* node) : m_node(node) { if (m_node) m_node->BeginUpdate(); }
+		~PropertyUpdateScope() { if (m_node) m_node->EndUpdate(); }
+		PropertyUpdateScope(const PropertyUpdateScope&) = delete;
+		PropertyUpdateScope& operator=(const PropertyUpdateScope&) = delete;
+	private:
+		IContextNode* m_node;
+	};
+
+	// What the space a layout offers a widget means (see IWidget::Measure)
+	enum class MeasureMode {
+		Unbounded,		// Ignore the offer: natural size, text on one line
+		AtMost,			// No larger than the offer; text wraps at its width
+		Exactly			// The widget gets the offer; asks how tall that width makes it
 	};
 
 	// Widget event handler
@@ -439,6 +742,18 @@ namespace ChronoUI {
 		virtual IWidget*__stdcall AddOverlay(IWidget* overlay) = 0;
 		virtual void __stdcall RemoveOverlay(IWidget* overlay) = 0;
 
+		// Numeric fast path for high-rate values (telemetry, animation targets).
+		// No string is formatted or parsed; GetProperty() synthesizes the text on demand.
+		virtual IWidget* __stdcall SetFloat(PropertyHandle key, float value) = 0;
+		virtual IWidget* __stdcall SetInt(PropertyHandle key, int32_t value) = 0;
+		virtual IWidget* __stdcall SetDouble(PropertyHandle key, double value) = 0;
+		virtual IWidget* __stdcall SetFloatArray(PropertyHandle key, const float* values, size_t count) = 0;
+
+		// Intrinsic size in device pixels for availableW x availableH (a negative value leaves
+		// that axis open). False when the widget has no size of its own; layouts then fall back
+		// to their defaults. Answers are memoized per constraint until a property that affects
+		// layout changes.
+		virtual bool __stdcall Measure(int availableW, int availableH, MeasureMode mode, SIZE* desired) = 0;
 
 		// ---------------------------------------------------------
 		// NEW: Validation Logic
@@ -620,6 +935,8 @@ namespace ChronoUI {
 		// Returns a pointer owned by the widget. Valid until the next call or destruction.
 		// (GetProperty is already defined in IContextNode, but we can override if needed, though not strictly required if signature matches)
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override = 0;
+		virtual IWidget* __stdcall SetProperty(PropertyHandle key, const char* value) override = 0;
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override = 0;
 		virtual IWidget* SetColor(const char* key, COLORREF color) override = 0;
 
 		virtual void OnDrawWidget(ID2D1RenderTarget* pRT) = 0;
@@ -646,7 +963,12 @@ namespace ChronoUI {
 		virtual void __stdcall SetActiveTab(int index) = 0;
 		virtual void __stdcall EnableScroll(bool enable) = 0;
 
+		// Layout passes that replayed a cached result for a box the cell had before, and ones
+		// that solved; the nested layout's included
+		virtual void __stdcall GetLayoutCacheStats(uint64_t* hits, uint64_t* misses) = 0;
+
 		virtual ICell* __stdcall SetProperty(const char* key, const char* value) override = 0;
+		virtual ICell* __stdcall SetProperty(PropertyHandle key, const char* value) override = 0;
 	};
 
 	class ILayout : public IContextNode {
@@ -658,11 +980,21 @@ namespace ChronoUI {
 		virtual ICell* __stdcall GetCell(int row, int col) = 0;
 		virtual ICell* __stdcall GetCell(const char* name) = 0;
 		virtual void __stdcall SetCellName(int row, int col, const char* name) = 0;
-		
+
+		// The cell at (row, col) covers rowSpan x colSpan tracks; the slots it covers return it
+		// from GetCell. Null if the area leaves the grid or takes in another cell.
+		virtual ICell* __stdcall SetCellSpan(int row, int col, int rowSpan, int colSpan) = 0;
+		// CSS track lists, one entry per row / column from the first: "auto 1fr 120px 25%
+		// minmax(80px, 2fr) minmax(auto, 1fr)". Splitters stay as they are.
+		virtual void __stdcall SetRows(const char* tracks) = 0;
+		virtual void __stdcall SetCols(const char* tracks) = 0;
 
 		virtual void __stdcall Arrange(int x, int y, int w, int h) = 0;
+		// The same as ICell::GetLayoutCacheStats, summed over the grid and its cells
+		virtual void __stdcall GetLayoutCacheStats(uint64_t* hits, uint64_t* misses) = 0;
 
 		virtual ILayout* __stdcall SetProperty(const char* key, const char* value) override = 0;
+		virtual ILayout* __stdcall SetProperty(PropertyHandle key, const char* value) override = 0;
 
 		virtual void __stdcall CollapseColumn(int index) = 0;
 		virtual void __stdcall RestoreColumn(int index) = 0;
@@ -689,6 +1021,7 @@ namespace ChronoUI {
 		virtual void __stdcall UnregisterWidget(IWidget* w) = 0;
 
 		virtual IContainer* __stdcall SetProperty(const char* key, const char* value) override = 0;
+		virtual IContainer* __stdcall SetProperty(PropertyHandle key, const char* value) override = 0;
 
 		virtual IWidget* __stdcall SetOverlay(IWidget* w) = 0;
 		virtual IWidget* __stdcall GetOverlay() = 0;
@@ -1,49 +1,748 @@
+#pragma once
+
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ChronoUI {
 	class ContextNodeImpl : public virtual IContextNode {
 	protected:
 		IContextNode* m_parent = nullptr;
-		std::unordered_map<std::string, std::string> m_properties;
+		// Raw text plus its parsed form. Parsing happens once, on write.
+		struct PropertySlot {
+			std::string text;
+			PropertyValue value;
+			// Numeric fast path (StoreNumber / StoreFloatArray): 'text' is only
+			// produced when somebody reads it, see SlotText()
+			bool typed = false;		// Last written through the numeric path
+			bool textPending = false;
+			double number = 0.0;
+			std::vector<float> array;
+			bool hasVar = false;	// Text uses var(): read through Computed()
+			// Owns value.expression when the text is a calc() / min() / ..., see ParseSlot
+			std::shared_ptr<const LengthExpression> expression;
+		};
+		std::unordered_map<uint32_t, PropertySlot> m_properties; // Keyed by PropertyHandle::id
 		std::string m_lastQuery; // Buffer for returned C-strings
 
+		// Style resolution cache: (class, subclass, property, state bits) -> resolved value.
+		// Valid while StyleCache::Epoch() equals m_styleCacheEpoch.
+		struct StyleCacheKey {
+			uint32_t classid, subclass, prop, state;
+			bool operator==(const StyleCacheKey& o) const {
+				return classid == o.classid && subclass == o.subclass && prop == o.prop && state == o.state;
+			}
+		};
+		struct StyleCacheKeyHash {
+			size_t operator()(const StyleCacheKey& k) const {
+				uint64_t h = ((uint64_t)k.prop << 32) ^ ((uint64_t)k.classid << 20) ^ ((uint64_t)k.subclass << 4) ^ k.state;
+				return std::hash<uint64_t>()(h);
+			}
+		};
+		struct StyleCacheEntry {
+			bool found;
+			PropertyValue value;
+		};
+		std::unordered_map<StyleCacheKey, StyleCacheEntry, StyleCacheKeyHash> m_styleCache;
+		uint64_t m_styleCacheEpoch = 0;
+
+		// Flattened inheritance (opt-in, see PropertyInheritance): immutable tables shared
+		// down the tree. A node with no local properties hands its own table straight on.
+		struct InheritedTable {
+			std::unordered_map<uint32_t, PropertySlot> slots;
+			std::vector<uint32_t> customKeys;	// "--" keys defined by a compiled layer
+			std::vector<uint32_t> sheets;		// Style sheets a rule layer was cascaded from, sorted
+		};
+		typedef std::shared_ptr<const InheritedTable> InheritedTablePtr;
+
+		InheritedTablePtr m_inherited;			// Everything the ancestors define
+		uint64_t m_inheritedEpoch = 0;			// PropertyInheritance::Epoch() m_inherited was checked at
+		bool m_inheritedUsable = false;			// False when an ancestor cannot be flattened
+		InheritedTablePtr m_childTable;			// m_inherited plus the local properties
+		InheritedTablePtr m_childTableBase;		// The m_inherited m_childTable was built from
+		bool m_childTableDirty = true;
+		bool m_childTableIssued = false;		// Some child holds a table from this node
+
+		// Immutable layers consulted after the local properties: the declarations of the
+		// style rules matching this node (see SetRuleLayer), then the theme (SetThemeLayer)
+		InheritedTablePtr m_rules;
+		InheritedTablePtr m_theme;
+
+		// Computed values of the var() slots in effect on this node (local or layer), resolved
+		// on first read. Valid while the chain up to the root keeps its structure stamp and,
+		// when a custom property stamp on it moved, every property they read its generation.
+		struct ComputedSlot {
+			PropertySlot slot;
+			CustomProperties::Dependencies deps;
+			uint64_t custom = 0, structure = 0;	// ChainStamps() at compute time
+			uint64_t checked = 0;				// CustomProperties::Stamp() it was last found valid at
+			bool resolving = false;				// Cycle guard
+		};
+		std::unordered_map<uint32_t, ComputedSlot> m_computed;
+
+		// CustomProperties stamps: this node last (re)defined a custom property / moved
+		uint64_t m_customStamp = 0;
+		uint64_t m_structureStamp = 0;
+
+		int m_updateDepth = 0;					// BeginUpdate nesting
+
+		// Layout invalidation (see InvalidateLayout)
+		bool m_layoutDirty = false;
+		uint64_t m_layoutGeneration = 0;				// Times the node was marked dirty
+		ContextNodeImpl* m_layoutQueue = nullptr;		// Scheduler this node waits in as a dirty root
+		std::vector<ContextNodeImpl*> m_layoutRoots;	// Dirty roots waiting here (schedulers only)
+
+		// Local store write shared by every SetProperty flavour
+		void StoreProperty(PropertyHandle key, const char* value) {
+			if (!key.IsValid()) return;
+			PropertySlot& slot = m_properties[key.id];
+
+			// #id selectors test the id, so a new one is re-matched once stored. Only in the tree:
+			// a node without a parent may still be under construction (WidgetImpl assigns its
+			// automatic id there) and is matched anyway when it is added.
+			static const PropertyHandle kId = PropertyAtoms::Intern("id");
+			std::string previousId;
+			bool idChanged = (key == kId) && m_parent && slot.text != ((value) ? value : "");
+			if (idChanged) previousId = slot.text;
+
+			slot.text = (value) ? value : "";
+			ParseSlot(slot);
+			slot.typed = false;
+			slot.textPending = false;
+			slot.array.clear();
+			slot.hasVar = HasVarReference(slot.text);
+			OnPropertyStored(key);
+			if (idChanged) StyleCache::IdChanged(this, previousId.c_str(), slot.text.c_str());
+		}
+
+		// Numeric write: no formatting and no parsing. 'type' is Int or Float.
+		// The fields match what PropertyValue::Parse would give for the formatted text.
+		void StoreNumber(PropertyHandle key, PropertyType type, double number) {
+			if (!key.IsValid()) return;
+			PropertySlot& slot = m_properties[key.id];
+			slot.value = {};
+			slot.value.type = type;
+			slot.value.hasNumber = true;
+			slot.value.number = (float)number;
+			if (number >= (double)INT32_MIN && number <= (double)INT32_MAX) {
+				slot.value.hasInteger = true;
+				slot.value.integer = (int32_t)number;
+			}
+			slot.number = number;
+			slot.typed = true;
+			slot.textPending = true;
+			slot.array.clear();
+			slot.hasVar = false;
+			slot.expression.reset();
+			OnPropertyStored(key);
+		}
+
+		// Array write; the text form is the comma separated list
+		void StoreFloatArray(PropertyHandle key, const float* values, size_t count) {
+			if (!key.IsValid()) return;
+			PropertySlot& slot = m_properties[key.id];
+			slot.array.assign(values, values + ((values) ? count : 0));
+			slot.value = {};
+			slot.value.type = PropertyType::FloatArray;
+			if (!slot.array.empty()) {
+				slot.value.hasNumber = true;
+				slot.value.number = slot.array[0];
+			}
+			slot.typed = true;
+			slot.textPending = true;
+			slot.hasVar = false;
+			slot.expression.reset();
+			OnPropertyStored(key);
+		}
+
+		// Text of a slot, synthesized on the first read after a numeric write
+		static const std::string& SlotText(PropertySlot& slot) {
+			if (slot.textPending) {
+				slot.textPending = false;
+				if (slot.value.type == PropertyType::FloatArray) {
+					slot.text.clear();
+					for (size_t i = 0; i < slot.array.size(); ++i) {
+						if (i) slot.text += ',';
+						slot.text += std::to_string(slot.array[i]);
+					}
+				}
+				else if (slot.value.type == PropertyType::Int) {
+					slot.text = std::to_string(slot.value.integer);
+				}
+				else {
+					slot.text = std::to_string(slot.number);
+				}
+			}
+			return slot.text;
+		}
+
+		// Parses slot.text; an expression is compiled for the slot alone and freed with it
+		static void ParseSlot(PropertySlot& slot) {
+			slot.value = PropertyValue::ParseOwned(slot.text.c_str());
+			const LengthExpression* e = (slot.value.unit == LengthUnit::Expression) ? slot.value.expression : nullptr;
+			if (e) slot.expression.reset(e, [](const LengthExpression* owned) { Lengths::Release(owned); });
+			else slot.expression.reset();
+		}
+
+		void OnPropertyStored(PropertyHandle key) {
+			// Children holding a flattened table of this node must re-fetch it
+			m_childTableDirty = true;
+			ReleaseChildTables();
+
+			m_computed.erase(key.id);
+
+			// Keys that were never consulted by a style lookup cannot be in any cached result.
+			// A custom property can be behind any value through var().
+			bool custom = CustomProperties::IsCustom(key);
+			if (custom) {
+				m_customStamp = CustomProperties::Touch(key);
+			}
+			if (custom || PropertyAtoms::IsStyleKey(key)) {
+				OnStyleKeyChanged();
+			}
+		}
+
+		static bool HasVarReference(const std::string& text) {
+			return text.find("var(") != std::string::npos;
+		}
+
+		// Slot read for a lookup: 'slot' itself, or its computed form when it uses var().
+		// A value whose var() references cannot be resolved (no value, no fallback, or a
+		// cycle) is invalid and reads as empty.
+		const PropertySlot* Computed(PropertyHandle key, const PropertySlot* slot) {
+			if (!slot->hasVar) return slot;
+
+			static const PropertySlot kInvalid = {};
+			ComputedSlot& c = m_computed[key.id];
+			uint64_t now = CustomProperties::Stamp();
+			uint64_t custom = 0, structure = 0;
+			bool current = c.checked == now;
+			if (!current) {
+				// Only definitions and moves on the way up to the root can change what var() sees here
+				ChainStamps(&custom, &structure);
+				current = c.checked && structure == c.structure && (custom == c.custom || CustomProperties::IsCurrent(c.deps));
+			}
+			if (!current) {
+				if (c.resolving) return &kInvalid;
+				c.resolving = true;
+
+				// 1. Substitute, recording every custom property read on the way
+				CustomProperties::Dependencies deps;
+				CustomProperties::Dependencies* outer = CustomProperties::Collect(&deps);
+				std::string text;
+				bool valid = SubstituteVars(slot->text, &text, 0);
+				CustomProperties::Collect(outer);
+
+				// 2. Parse the result once, like a stored value
+				c.slot.text = (valid) ? text : std::string();
+				ParseSlot(c.slot);
+				c.deps.swap(deps);
+				c.resolving = false;
+			}
+			if (c.checked != now) {
+				c.custom = custom;
+				c.structure = structure;
+				c.checked = now;
+			}
+
+			// Whoever is computing a value from this one depends on the same properties
+			CustomProperties::Record(c.deps);
+			return &c.slot;
+		}
+
+		// Newest custom property and structure stamps of this node and its ancestors
+		void ChainStamps(uint64_t* custom, uint64_t* structure) {
+			*custom = *structure = 0;
+			for (IContextNode* node = this; node; node = node->GetParentNode()) {
+				ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(node);
+				if (!impl) continue;
+				*custom = (std::max)(*custom, impl->m_customStamp);
+				*structure = (std::max)(*structure, impl->m_structureStamp);
+			}
+		}
+
+		// Replaces every var(--name[, fallback]) in 'text' with the value of --name as seen
+		// from this node. False when a reference has neither a value nor a usable fallback.
+		bool SubstituteVars(const std::string& text, std::string* out, int depth) {
+			if (depth > 32) return false;
+			size_t pos = 0;
+			for (size_t at = text.find("var("); at != std::string::npos; at = text.find("var(", pos)) {
+				out->append(text, pos, at - pos);
+
+				// 1. Closing parenthesis and the comma before the fallback
+				size_t open = at + 4, end = open, comma = std::string::npos;
+				int nesting = 1;
+				for (; end < text.size(); ++end) {
+					char ch = text[end];
+					if (ch == '(') ++nesting;
+					else if (ch == ')' && --nesting == 0) break;
+					else if (ch == ',' && nesting == 1 && comma == std::string::npos) comma = end;
+				}
+				if (end >= text.size()) return false;
+
+				std::string name = TrimSpaces(text.substr(open, ((comma != std::string::npos) ? comma : end) - open));
+				if (name.size() < 3 || name[0] != '-' || name[1] != '-') return false;
+
+				// 2. Value of the custom property here, else the fallback
+				PropertyHandle handle = PropertyAtoms::Intern(name.c_str());
+				CustomProperties::Record(handle);
+				const char* value = GetProperty(handle, "");
+				if (*value) {
+					out->append(value);
+				}
+				else if (comma == std::string::npos || !SubstituteVars(TrimSpaces(text.substr(comma + 1, end - comma - 1)), out, depth + 1)) {
+					return false;
+				}
+				pos = end + 1;
+			}
+			out->append(text, pos, std::string::npos);
+			return true;
+		}
+
+		static std::string TrimSpaces(const std::string& s) {
+			size_t first = s.find_first_not_of(" \t\r\n");
+			if (first == std::string::npos) return std::string();
+			size_t last = s.find_last_not_of(" \t\r\n");
+			return s.substr(first, last - first + 1);
+		}
+
+		// A style key changed on this node (or the node moved in the tree).
+		// Any descendant may have cached the old value, so by default every cache goes.
+		// Leaf nodes override this to drop only their own cache.
+		virtual void OnStyleKeyChanged() {
+			StyleCache::Invalidate();
+		}
+
+		bool IsUpdating() const {
+			return m_updateDepth > 0;
+		}
+
+		// Runs once when the outermost EndUpdate closes a batch
+		virtual void OnEndUpdate() {
+		}
+
+		// Nodes that answer some keys from live state (widgets) cannot be flattened;
+		// their children walk the chain up to them and continue from their table.
+		virtual bool CanFlattenForChildren() {
+			return true;
+		}
+
+		void ReleaseChildTables() {
+			if (m_childTableIssued) {
+				m_childTableIssued = false;
+				PropertyInheritance::Invalidate();
+			}
+		}
+
+		// Re-fetches m_inherited from the parent once per inheritance epoch
+		bool RefreshInheritedTable() {
+			uint64_t epoch = PropertyInheritance::Epoch();
+			if (m_inheritedEpoch != epoch) {
+				m_inheritedEpoch = epoch;
+				m_inherited.reset();
+				m_inheritedUsable = true;
+				if (m_parent) {
+					ContextNodeImpl* parent = dynamic_cast<ContextNodeImpl*>(m_parent);
+					m_inheritedUsable = parent && parent->GetChildTable(&m_inherited);
+				}
+			}
+			return m_inheritedUsable;
+		}
+
+		// The table this node's children inherit. False when they must walk the chain instead.
+		bool GetChildTable(InheritedTablePtr* out) {
+			if (!CanFlattenForChildren() || !RefreshInheritedTable()) return false;
+			m_childTableIssued = true;
+
+			// 1. Nothing local: share the ancestors' table as is
+			if (m_properties.empty() && !m_theme && !m_rules) {
+				*out = m_inherited;
+				return true;
+			}
+
+			// 2. Rebuild when a local property, the theme or the ancestors' table changed
+			if (m_childTableDirty || m_childTableBase != m_inherited) {
+				std::shared_ptr<InheritedTable> table = m_inherited ? std::make_shared<InheritedTable>(*m_inherited) : std::make_shared<InheritedTable>();
+				for (const InheritedTablePtr& layer : { m_theme, m_rules }) {
+					if (!layer) continue;
+					for (const auto& kv : layer->slots) {
+						table->slots[kv.first] = kv.second;
+					}
+				}
+				for (auto& kv : m_properties) {
+					SlotText(kv.second);
+					table->slots[kv.first] = kv.second;
+				}
+				// Children inherit computed values: var() resolves where it is declared
+				for (auto& kv : table->slots) {
+					if (kv.second.hasVar) kv.second = *Computed(PropertyHandle{ kv.first }, &kv.second);
+				}
+				m_childTable = table;
+				m_childTableBase = m_inherited;
+				m_childTableDirty = false;
+			}
+			*out = m_childTable;
+			return true;
+		}
+
+		const PropertySlot* FindInLayers(PropertyHandle key) const {
+			for (const InheritedTable* layer : { m_rules.get(), m_theme.get() }) {
+				if (!layer) continue;
+				auto it = layer->slots.find(key.id);
+				if (it != layer->slots.end()) return &it->second;
+			}
+			return nullptr;
+		}
+
+		// The matched rules changed from 'before' to 'after' (either may be null)
+		virtual void OnRuleLayerChanged(const InheritedTable* before, const InheritedTable* after) {
+		}
+
+		// Layer swap: flattened tables below this node and cached style results both saw the old
+		// one, and so did every value computed from a custom property the layers define
+		void LayerChanged(const InheritedTable* before, const InheritedTable* after) {
+			for (const InheritedTable* layer : { before, after }) {
+				if (!layer) continue;
+				for (uint32_t key : layer->customKeys) m_customStamp = CustomProperties::Touch(PropertyHandle{ key });
+			}
+			m_computed.clear();
+			m_childTableDirty = true;
+			ReleaseChildTables();
+			OnStyleKeyChanged();
+		}
+
+		// Ancestor lookup through the flattened table. False when snapshots are off or unusable here.
+		bool FindInherited(PropertyHandle key, const PropertySlot** slot) {
+			if (!m_parent || !PropertyInheritance::SnapshotsEnabled() || !RefreshInheritedTable()) return false;
+
+			*slot = nullptr;
+			if (m_inherited) {
+				auto it = m_inherited->slots.find(key.id);
+				if (it != m_inherited->slots.end()) *slot = &it->second;
+			}
+			return true;
+		}
+
 	public:
+		typedef InheritedTablePtr ThemeTable;
+
+		// Compiles key/value pairs into an immutable table for SetThemeLayer/SetRuleLayer.
+		// Parsing happens here, once. A key given twice keeps its last value.
+		template <typename Pairs>
+		static ThemeTable CompileTheme(const Pairs& properties) {
+			std::shared_ptr<InheritedTable> table = std::make_shared<InheritedTable>();
+			for (const auto& kv : properties) {
+				PropertyHandle key = PropertyAtoms::Intern(std::string(kv.first).c_str());
+				PropertySlot& slot = table->slots[key.id];
+				slot.text = std::string(kv.second);
+				slot.value = PropertyValue::Parse(slot.text.c_str());
+				slot.hasVar = HasVarReference(slot.text);
+				if (CustomProperties::IsCustom(key)) table->customKeys.push_back(key.id);
+			}
+			return table;
+		}
+		static ThemeTable CompileTheme(const std::map<std::string, std::string>& properties) {
+			return CompileTheme<std::map<std::string, std::string>>(properties);
+		}
+
+		// Same for values parsed ahead of time (style rules, compiled style sheets): nothing
+		// is parsed here, 'value' is copied and re-pointed at the table's own text. 'sheets'
+		// names the style sheets the entries came from (see StyleManager::UnloadSheet).
+		struct ParsedEntry {
+			uint32_t key;						// PropertyHandle::id
+			const std::string* text;
+			const PropertyValue* value;
+		};
+		static ThemeTable CompileParsed(const std::vector<ParsedEntry>& entries, std::vector<uint32_t> sheets = {}) {
+			std::shared_ptr<InheritedTable> table = std::make_shared<InheritedTable>();
+			table->sheets = std::move(sheets);
+			for (const ParsedEntry& e : entries) {
+				PropertySlot& slot = table->slots[e.key];
+				slot.text = *e.text;
+				slot.value = *e.value;
+				slot.value.text = slot.text.c_str();
+				slot.hasVar = HasVarReference(slot.text);
+				if (CustomProperties::IsCustom(PropertyHandle{ e.key })) table->customKeys.push_back(e.key);
+			}
+			return table;
+		}
+
+		// Swaps the theme layer. The table is shared, never copied: switching themes is this
+		// pointer swap plus a style epoch bump, whatever the size of the tree below.
+		void SetThemeLayer(ThemeTable theme) {
+			if (theme == m_theme) return;
+			ThemeTable before = m_theme;
+			m_theme = theme;
+			LayerChanged(before.get(), m_theme.get());
+		}
+
+		ThemeTable GetThemeLayer() const {
+			return m_theme;
+		}
+
+		// Swaps the declarations of the style rules matching this node (see StyleManager).
+		// Nodes matching the same rules share one table instead of owning copies.
+		void SetRuleLayer(ThemeTable rules) {
+			if (rules == m_rules) return;
+			ThemeTable before = m_rules;
+			m_rules = rules;
+			LayerChanged(before.get(), m_rules.get());
+			OnRuleLayerChanged(before.get(), m_rules.get());
+		}
+
+		ThemeTable GetRuleLayer() const {
+			return m_rules;
+		}
+
+		// Own value of 'key', ignoring layers and ancestors; nullptr if not set here
+		const char* GetLocalProperty(PropertyHandle key) {
+			auto it = m_properties.find(key.id);
+			return (it != m_properties.end()) ? SlotText(it->second).c_str() : nullptr;
+		}
+
+		// Type name atom for type selectors ("Button", "Cell", ...); invalid for untyped nodes
+		virtual PropertyHandle StyleTypeKey() {
+			return PropertyHandle{};
+		}
+
+		// Child nodes that selectors see below this one (see StyleManager::RestyleTree)
+		virtual void GetStyleChildren(std::vector<IContextNode*>* out) {
+		}
+
+		// Features the @media rules of this subtree are evaluated against; null defers to the
+		// ancestors. Containers answer with their client size and DPI.
+		virtual const MediaFeatures* GetMediaFeatures() {
+			return nullptr;
+		}
+
+		// --- Layout invalidation ---
+		// A dirty node has to run its layout pass again. Marking one walks up only as far as
+		// the change can move things: while a node's own size follows its content, the parent
+		// that places it is dirty too. The topmost node marked is a dirty root; it waits with
+		// the nearest scheduler above it (the container runs one pass per frame over its roots)
+		// and is laid out at once when there is none.
+
+		~ContextNodeImpl() {
+			if (m_layoutQueue) {
+				std::vector<ContextNodeImpl*>& roots = m_layoutQueue->m_layoutRoots;
+				roots.erase(std::remove(roots.begin(), roots.end(), this), roots.end());
+			}
+			for (ContextNodeImpl* root : m_layoutRoots) root->m_layoutQueue = nullptr;
+		}
+
+		// 'sizeChanged': what this node asks of its parent changed as well (a width, a margin,
+		// the tracks of a nested layout), not just how it places its own children
+		void InvalidateLayout(bool sizeChanged = false) {
+			// 1. Mark up to the first node whose box does not depend on what changed
+			ContextNodeImpl* root = this;
+			m_layoutDirty = true;
+			++m_layoutGeneration;
+			while (sizeChanged) {
+				ContextNodeImpl* parent = dynamic_cast<ContextNodeImpl*>(root->m_parent);
+				if (!parent) break;
+				root = parent;
+				root->m_layoutDirty = true;
+				++root->m_layoutGeneration;
+				sizeChanged = root->SizesToContent();
+			}
+			if (root->m_layoutQueue) return;
+
+			// 2. Queue it with the nearest scheduler, or lay it out now
+			for (ContextNodeImpl* node = root; node; node = dynamic_cast<ContextNodeImpl*>(node->m_parent)) {
+				if (!node->SchedulesLayout()) continue;
+				root->m_layoutQueue = node;
+				node->m_layoutRoots.push_back(root);
+				if (node->m_layoutRoots.size() == 1) node->OnLayoutQueued();
+				return;
+			}
+			root->PerformLayout();
+		}
+
+		bool IsLayoutDirty() const {
+			return m_layoutDirty;
+		}
+
+		// Moves on every time the node is marked dirty: a layout result computed at one
+		// generation holds until the next (see Layout::SolveCache)
+		uint64_t LayoutGeneration() const {
+			return m_layoutGeneration;
+		}
+
+		// The node was laid out by its parent's pass
+		void ClearLayoutDirty() {
+			m_layoutDirty = false;
+		}
+
+		// Runs the pass of every dirty root queued here, shallowest first: a parent's pass
+		// places its children again, and a child it resized is clean by the time its turn
+		// comes. Roots dirtied meanwhile wait for the next pass.
+		void RunLayoutPass() {
+			std::vector<ContextNodeImpl*> roots;
+			roots.swap(m_layoutRoots);
+			std::vector<std::pair<int, ContextNodeImpl*>> ordered;
+			ordered.reserve(roots.size());
+			for (ContextNodeImpl* root : roots) {
+				root->m_layoutQueue = nullptr;
+				int depth = 0;
+				for (IContextNode* p = root->m_parent; p; p = p->GetParentNode()) ++depth;
+				ordered.push_back({ depth, root });
+			}
+			std::stable_sort(ordered.begin(), ordered.end(),
+				[](const std::pair<int, ContextNodeImpl*>& a, const std::pair<int, ContextNodeImpl*>& b) { return a.first < b.first; });
+			for (const auto& entry : ordered) {
+				if (entry.second->m_layoutDirty) entry.second->PerformLayout();
+			}
+		}
+
+	protected:
+		// True when this node's box follows its content, so its parent has to place it again
+		// when the content changes (see InvalidateLayout)
+		virtual bool SizesToContent() {
+			return false;
+		}
+
+		// Schedulers collect dirty roots and call RunLayoutPass later; OnLayoutQueued runs when
+		// the first root arrives (post a message, for example)
+		virtual bool SchedulesLayout() {
+			return false;
+		}
+		virtual void OnLayoutQueued() {
+		}
+
+		// This node's own layout pass; overrides clear the dirty flag as they run
+		virtual void PerformLayout() {
+			m_layoutDirty = false;
+		}
+
+	public:
+
 		virtual void __stdcall SetParentNode(IContextNode* parent) override {
-			m_parent = parent;
+			if (parent != m_parent) {
+				m_parent = parent;
+				// Inherited styles and custom properties now come from a different chain
+				OnStyleKeyChanged();
+				m_structureStamp = CustomProperties::NewStamp();
+				m_inheritedEpoch = 0;
+				ReleaseChildTables();
+			}
 		}
 
 		virtual IContextNode* __stdcall GetParentNode() override {
 			return m_parent;
 		}
+
+		virtual void __stdcall BeginUpdate() override {
+			++m_updateDepth;
+		}
+		virtual void __stdcall EndUpdate() override {
+			if (m_updateDepth > 0 && --m_updateDepth == 0) {
+				OnEndUpdate();
+			}
+		}
 		virtual IContextNode* __stdcall GetContextNode() override {
 			return this;
 		}
 		
 
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override {
+			return PropertyAtoms::Intern(key);
+		}
+
 		// THE MAGIC: Recursive Property Lookup
-		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override {
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override {
+			if (!key.IsValid()) return def;
+
 			// 1. Check Local Properties
-			auto it = m_properties.find(key);
+			auto it = m_properties.find(key.id);
 			if (it != m_properties.end()) {
-				return it->second.c_str();
+				if (it->second.hasVar) return Computed(key, &it->second)->text.c_str();
+				return SlotText(it->second).c_str();
+			}
+
+			// 2. Check the matched style rules, then the theme
+			const PropertySlot* slot = FindInLayers(key);
+			if (slot) {
+				return Computed(key, slot)->text.c_str();
 			}
 
-			// 2. Check Parent (The "Carry" mechanism)
+			// 3. Check the flattened ancestors, when enabled
+			if (FindInherited(key, &slot)) {
+				return (slot) ? slot->text.c_str() : def;
+			}
+
+			// 4. Check Parent (The "Carry" mechanism)
 			if (m_parent) {
 				return m_parent->GetProperty(key, def);
 			}
 
-			// 3. Not found anywhere in the chain
+			// 5. Not found anywhere in the chain
 			return def;
 		}
 
+		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override {
+			// A key that was never interned cannot be stored anywhere in the chain
+			return GetProperty(PropertyAtoms::Find(key), def);
+		}
+
+		// Typed lookup: same chain walk as GetProperty, returns the value parsed at write time
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override {
+			if (!key.IsValid()) return false;
+
+			auto it = m_properties.find(key.id);
+			if (it != m_properties.end() && !it->second.hasVar) {
+				if (out) {
+					*out = it->second.value;
+					out->text = SlotText(it->second).c_str();
+				}
+				return true;
+			}
+
+			const PropertySlot* slot = (it != m_properties.end()) ? &it->second : FindInLayers(key);
+			if (slot) {
+				slot = Computed(key, slot);
+				if (out) {
+					*out = slot->value;
+					out->text = slot->text.c_str();
+				}
+				return true;
+			}
+
+			if (FindInherited(key, &slot)) {
+				if (slot && out) {
+					*out = slot->value;
+					out->text = slot->text.c_str();
+				}
+				return slot != nullptr;
+			}
+
+			if (m_parent) {
+				return m_parent->GetPropertyValue(key, out);
+			}
+			return false;
+		}
+
+		// Local array written with the numeric fast path; false if 'key' holds no array here
+		bool GetFloatArray(PropertyHandle key, const float** data, size_t* count) {
+			auto it = m_properties.find(key.id);
+			if (it == m_properties.end() || it->second.value.type != PropertyType::FloatArray) return false;
+			*data = it->second.array.data();
+			*count = it->second.array.size();
+			return true;
+		}
+
 		// Helper to set local properties
-		virtual IContextNode* __stdcall SetProperty(const char* key, const char* value) {
-			m_properties[key] = (value) ? value : "";
+		virtual IContextNode* __stdcall SetProperty(PropertyHandle key, const char* value) override {
+			StoreProperty(key, value);
 			return this;
 		}
 
+		virtual IContextNode* __stdcall SetProperty(const char* key, const char* value) {
+			return SetProperty(PropertyAtoms::Intern(key), value);
+		}
+
 		IContextNode* SetColor(const char* key, COLORREF color) override {
 			char buf[16];
 			sprintf_s(buf, "#%02X%02X%02X", GetRValue(color), GetGValue(color), GetBValue(color));
@@ -52,20 +751,12 @@ namespace ChronoUI {
 
 		// Color Getter Helper
 		COLORREF GetColor(const char* key, COLORREF defaultColor = RGB(0, 0, 0)) override {
-			const char* val = GetProperty(key);
-
-			// Check if the property exists and looks like a hex color (#RRGGBB)
-			if (!val || val[0] != '#' || strlen(val) < 7) {
+			PropertyValue v;
+			if (!GetPropertyValue(PropertyAtoms::Find(key), &v) || !v.IsColor()) {
 				return defaultColor;
 			}
 
-			unsigned int r, g, b;
-			// sscanf_s reads the hex values. val + 1 skips the '#' character.
-			if (sscanf_s(val + 1, "%02x%02x%02x", &r, &g, &b) == 3) {
-				return RGB(r, g, b);
-			}
-
-			return defaultColor;
+			return RGB((v.rgba >> 16) & 0xFF, (v.rgba >> 8) & 0xFF, v.rgba & 0xFF);
 		}
 
 		bool HasProperty(const std::string& key)
@@ -74,72 +765,104 @@ namespace ChronoUI {
 			return k != "";
 		}
 
-		std::string TryResolveState(const std::string& baseKey, bool selected, bool enabled, bool hovered, bool active)
+		// Looks up 'key' and succeeds only for a non-empty value (same rule as HasProperty).
+		// The key is registered as a style key, so writing it later invalidates cached results.
+		bool FindStyleValue(const std::string& key, PropertyValue* out)
+		{
+			PropertyValue v;
+			if (!GetPropertyValue(PropertyAtoms::InternStyleKey(key.c_str()), &v) || v.type == PropertyType::Empty) return false;
+			*out = v;
+			return true;
+		}
+
+		bool TryResolveState(const std::string& baseKey, uint32_t state, PropertyValue* out)
 		{
 			// 1. Check Disabled
-			if (!enabled) {
-				std::string k = baseKey + ":disabled";
-				if (HasProperty(k.c_str())) 
-					return GetProperty(k.c_str());
+			if ((state & StyleState::Disabled) && FindStyleValue(baseKey + ":disabled", out)) {
+				return true;
 			}
 			// 3. Check Hovered
-			if (hovered) {
-				std::string k = baseKey + ":hover";
-				if (HasProperty(k.c_str()))
-					return GetProperty(k.c_str());
+			if ((state & StyleState::Hover) && FindStyleValue(baseKey + ":hover", out)) {
+				return true;
 			}
 
 			// 2. Check Selected
-			if (selected) {
-				std::string k = baseKey + ":selected";
-				if (HasProperty(k.c_str()))
-					return GetProperty(k.c_str());
+			if ((state & StyleState::Selected) && FindStyleValue(baseKey + ":selected", out)) {
+				return true;
 			}
-			if (active) {
-				std::string k = baseKey + ":active";
-				if (HasProperty(k.c_str()))
-					return GetProperty(k.c_str());
+			if ((state & StyleState::Active) && FindStyleValue(baseKey + ":active", out)) {
+				return true;
 			}
 
 			// 4. Return Base value (if it exists)
-			if (HasProperty(baseKey)) {
-				std::string k = baseKey;
-				return GetProperty(k.c_str());
-			}
-			// Return empty string to signal "Not Found"
-			return "";
+			return FindStyleValue(baseKey, out);
 		}
-		std::string result;
-		const char* GetStyle(const char* _prop, const char* _def, const char* _classid,const char* _variant, bool selected, bool enabled, bool hovered, bool active)
+
+		// Uncached resolution: walks the three key levels and the parent chain
+		bool ResolveStyleValue(PropertyHandle _prop, PropertyHandle _classid, PropertyHandle _variant, uint32_t state, PropertyValue* out)
 		{
-			std::string prop = _prop;
-			std::string classid = _classid;
-			std::string variant = _variant;
+			std::string prop = PropertyAtoms::Name(_prop);
+			std::string classid = PropertyAtoms::Name(_classid);
+			std::string variant = PropertyAtoms::Name(_variant);
 
 			// --- LEVEL 1: VARIANT SPECIFIC (e.g., button:danger:color) ---
 			if (!variant.empty()) {
-				std::string variantKey = classid + ":" + variant + ":" + prop;
-				result = TryResolveState(variantKey, selected, enabled, hovered, active);
-				if (!result.empty()) 
-					return result.c_str();
+				if (TryResolveState(classid + ":" + variant + ":" + prop, state, out))
+					return true;
 			}
 
 			// --- LEVEL 2: CLASS SPECIFIC (e.g., button:color) ---
 			if (!classid.empty()) {
-				std::string classKey = classid + ":" + prop;
-				result = TryResolveState(classKey, selected, enabled, hovered, active);
-				if (!result.empty()) 
-					return result.c_str();
+				if (TryResolveState(classid + ":" + prop, state, out))
+					return true;
 			}
 
 			// --- LEVEL 3: GLOBAL FALLBACK (e.g., color) ---
-			result = TryResolveState(prop, selected, enabled, hovered, active);
+			return TryResolveState(prop, state, out);
+		}
+
+		// Cached resolution: one hash probe while the style epoch is unchanged
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override
+		{
+			if (!prop.IsValid()) return false;
+
+			uint64_t epoch = StyleCache::Epoch();
+			if (epoch != m_styleCacheEpoch) {
+				m_styleCache.clear();
+				m_styleCacheEpoch = epoch;
+			}
 
-			if (result.empty()) {
-				result = _def;
+			StyleCacheKey key = { prop.id, classid.id, subclass.id, stateMask };
+			auto it = m_styleCache.find(key);
+			if (it != m_styleCache.end()) {
+				StyleCache::RecordLookup(true);
+				if (it->second.found && out) *out = it->second.value;
+				return it->second.found;
 			}
 
-			return result.c_str(); // Returns value or "" if nothing found
+			StyleCache::RecordLookup(false);
+			StyleCacheEntry entry = {};
+			entry.found = ResolveStyleValue(prop, classid, subclass, stateMask, &entry.value);
+			m_styleCache.emplace(key, entry);
+
+			if (entry.found && out) *out = entry.value;
+			return entry.found;
+		}
+
+		// String convenience over the cached handle path
+		bool GetStyleValue(const char* _prop, const char* _classid, const char* _variant, bool selected, bool enabled, bool hovered, bool active, PropertyValue* out)
+		{
+			return GetStyleValue(PropertyAtoms::Intern(_prop), PropertyAtoms::Intern(_classid), PropertyAtoms::Intern(_variant),
+				StyleState::Mask(selected, enabled, hovered, active), out);
+		}
+
+		const char* GetStyle(const char* _prop, const char* _def, const char* _classid,const char* _variant, bool selected, bool enabled, bool hovered, bool active)
+		{
+			PropertyValue v;
+			if (GetStyleValue(_prop, _classid, _variant, selected, enabled, hovered, active, &v)) {
+				return v.text;
+			}
+			return _def; // Returns value or the default if nothing found
 		}
 	};
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <dwmapi.h>
 #include <map>
+#include <unordered_map>
+#include <cmath>
 #include <atomic>
 #include <mutex>
 #include <d2d1.h>
@@ -52,6 +54,35 @@ namespace ChronoUI {
 		return D2D1::ColorF(D2D1::ColorF::Black);
 	}
 
+	// Packed 0xAARRGGBB (PropertyValue::rgba) to a D2D color
+	inline D2D1_COLOR_F RGBAToD2D(uint32_t rgba) {
+		return D2D1::ColorF(((rgba >> 16) & 0xFF) / 255.0f, ((rgba >> 8) & 0xFF) / 255.0f, (rgba & 0xFF) / 255.0f, ((rgba >> 24) & 0xFF) / 255.0f);
+	}
+
+	// And back, rounding each channel to 8 bits
+	inline uint32_t D2DToRGBA(const D2D1_COLOR_F& c) {
+		auto channel = [](float v) { return (uint32_t)((std::max)(0.0f, (std::min)(1.0f, v)) * 255.0f + 0.5f); };
+		return (channel(c.a) << 24) | (channel(c.r) << 16) | (channel(c.g) << 8) | channel(c.b);
+	}
+
+	// The styles read by the drawing helpers, resolved and parsed for one state combination.
+	// Margins are in logical units; callers apply ScaleF() so DPI changes need no recompute.
+	struct ComputedStyle {
+		float marginTop = 1.0f, marginLeft = 1.0f, marginRight = 1.0f, marginBottom = 1.0f;
+		float borderWidth = 0.0f;
+		float borderRadius = 2.0f;
+		D2D1_COLOR_F backgroundColor = D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f);
+		D2D1_COLOR_F borderColor = D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f);
+		D2D1_COLOR_F color = D2D1::ColorF(D2D1::ColorF::Black);
+		std::wstring fontFamily = L"Segoe UI";
+		float fontSize = 12.0f;
+		DWRITE_FONT_WEIGHT fontWeight = DWRITE_FONT_WEIGHT_NORMAL;
+		DWRITE_FONT_STYLE fontStyle = DWRITE_FONT_STYLE_NORMAL;
+		DWRITE_TEXT_ALIGNMENT textAlign = DWRITE_TEXT_ALIGNMENT_CENTER;
+		float opacity = 1.0f;							// Multiplies the alpha of the colors above
+		const TransitionList* transition = nullptr;		// "transition", compiled
+	};
+
 	struct EventHandlerEntry {
 		std::string eventName;
 		ChronoEventCallback callback;
@@ -128,45 +159,97 @@ namespace ChronoUI {
 			}
 		}
 
+		// The default styles live in an immutable theme layer under the root's own properties,
+		// so SetProperty on the controller still overrides them and StyleManager::SetTheme
+		// can swap them without touching the tree.
 		void SetDefaultStyles() {
-			// --- Main Window (Light Base) ---
-			SetProperty("background-color", "#ffffff");
-			SetProperty("background-color:hover", "#f9f9f9");
-			SetProperty("foreground-color", "#333333");
-			SetProperty("foreground-color:hover", "#333333");
-			SetProperty("border-color", "#e0e0e0");
-			SetProperty("border-color:hover", "#b3e5fc");
-
-			SetProperty("color", "#ffffff"); // For buttons
-			SetProperty("color:hover", "#fefefe"); // For buttons
-			SetProperty("image-align", "right");
-			SetProperty("border-radius", "2");
-
-			//description-color
-			//dimmed-color
-
-			// --- Color Widget (Pastel Blue Theme) ---
-			SetProperty("StaticText:background-color", "#ffffff");
-			SetProperty("StaticText:background-color:hover", "#e3f2fd");
-			SetProperty("StaticText:foreground-color:hover", "#333333");
-			SetProperty("StaticText:border-color:hover", "#90caf9");
-			SetProperty("StaticText:border-width:hover", "1");
-			SetProperty("StaticText:danger:background-color", "#ffcdd2");
-
-			// --- DateTime Widget (Pastel Mint Theme) ---
-			SetProperty("ViewDateTimeWidget:background-color", "#fcfcfc");
-			SetProperty("ViewDateTimeWidget:background-color:hover", "#e8f5e9");
-			SetProperty("ViewDateTimeWidget:foreground-color:hover", "#333333");
-			SetProperty("ViewDateTimeWidget:border-color:hover", "#a5d6a7");
-			SetProperty("ViewDateTimeWidget:border-width:hover", "1");
-			SetProperty("ViewDateTimeWidget:danger:background-color", "#ffcdd2");
-
-			// --- Global Typography ---
-			SetProperty("font-family", "Segoe UI");
-			SetProperty("font-size", "10");
-			SetProperty("font-size:hover", "12");
-			SetProperty("font-style", "normal");
-			SetProperty("text-align", "center");
+			SetThemeLayer(LightTheme());
+		}
+
+		static ThemeTable LightTheme() {
+			static const ThemeTable theme = CompileTheme({
+				// --- Main Window (Light Base) ---
+				{ "background-color", "#ffffff" },
+				{ "background-color:hover", "#f9f9f9" },
+				{ "foreground-color", "#333333" },
+				{ "foreground-color:hover", "#333333" },
+				{ "border-color", "#e0e0e0" },
+				{ "border-color:hover", "#b3e5fc" },
+
+				{ "color", "#ffffff" }, // For buttons
+				{ "color:hover", "#fefefe" }, // For buttons
+				{ "image-align", "right" },
+				{ "border-radius", "2" },
+
+				//description-color
+				//dimmed-color
+
+				// --- Color Widget (Pastel Blue Theme) ---
+				{ "StaticText:background-color", "#ffffff" },
+				{ "StaticText:background-color:hover", "#e3f2fd" },
+				{ "StaticText:foreground-color:hover", "#333333" },
+				{ "StaticText:border-color:hover", "#90caf9" },
+				{ "StaticText:border-width:hover", "1" },
+				{ "StaticText:danger:background-color", "#ffcdd2" },
+
+				// --- DateTime Widget (Pastel Mint Theme) ---
+				{ "ViewDateTimeWidget:background-color", "#fcfcfc" },
+				{ "ViewDateTimeWidget:background-color:hover", "#e8f5e9" },
+				{ "ViewDateTimeWidget:foreground-color:hover", "#333333" },
+				{ "ViewDateTimeWidget:border-color:hover", "#a5d6a7" },
+				{ "ViewDateTimeWidget:border-width:hover", "1" },
+				{ "ViewDateTimeWidget:danger:background-color", "#ffcdd2" },
+
+				// --- Global Typography ---
+				{ "font-family", "Segoe UI" },
+				{ "font-size", "10" },
+				{ "font-size:hover", "12" },
+				{ "font-style", "normal" },
+				{ "text-align", "center" },
+			});
+			return theme;
+		}
+
+		// Same keys as LightTheme, dark palette
+		static ThemeTable DarkTheme() {
+			static const ThemeTable theme = CompileTheme({
+				// --- Main Window (Dark Base) ---
+				{ "background-color", "#1e1e1e" },
+				{ "background-color:hover", "#2a2a2a" },
+				{ "foreground-color", "#e0e0e0" },
+				{ "foreground-color:hover", "#ffffff" },
+				{ "border-color", "#3c3c3c" },
+				{ "border-color:hover", "#0288d1" },
+
+				{ "color", "#ffffff" }, // For buttons
+				{ "color:hover", "#fefefe" }, // For buttons
+				{ "image-align", "right" },
+				{ "border-radius", "2" },
+
+				// --- Color Widget ---
+				{ "StaticText:background-color", "#1e1e1e" },
+				{ "StaticText:background-color:hover", "#263238" },
+				{ "StaticText:foreground-color:hover", "#ffffff" },
+				{ "StaticText:border-color:hover", "#4fc3f7" },
+				{ "StaticText:border-width:hover", "1" },
+				{ "StaticText:danger:background-color", "#5d1f1f" },
+
+				// --- DateTime Widget ---
+				{ "ViewDateTimeWidget:background-color", "#232323" },
+				{ "ViewDateTimeWidget:background-color:hover", "#1b2e1f" },
+				{ "ViewDateTimeWidget:foreground-color:hover", "#ffffff" },
+				{ "ViewDateTimeWidget:border-color:hover", "#66bb6a" },
+				{ "ViewDateTimeWidget:border-width:hover", "1" },
+				{ "ViewDateTimeWidget:danger:background-color", "#5d1f1f" },
+
+				// --- Global Typography ---
+				{ "font-family", "Segoe UI" },
+				{ "font-size", "10" },
+				{ "font-size:hover", "12" },
+				{ "font-style", "normal" },
+				{ "text-align", "center" },
+			});
+			return theme;
 		}
 
 		// Implement IContextNode overrides to expose this class as the root
@@ -174,6 +257,11 @@ namespace ChronoUI {
 		virtual IContextNode* __stdcall GetParentNode() override { return nullptr; }
 		virtual IContextNode* __stdcall GetContextNode() override { return nullptr; }
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override { return ContextNodeImpl::GetPropertyValue(key, out); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override {
+			return ContextNodeImpl::GetStyleValue(prop, classid, subclass, stateMask, out);
+		}
 		virtual IContextNode* SetColor(const char* key, COLORREF color) override { return ContextNodeImpl::SetColor(key, color); };
 		virtual COLORREF GetColor(const char* key, COLORREF defaultColor) override { return ContextNodeImpl::GetColor(key, defaultColor); }
 		virtual const char* GetStyle(const char* _prop, const char* _def, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active) override {
@@ -192,6 +280,97 @@ namespace ChronoUI {
 		return ChronoControllerImpl::Instance().m_pD2DFactory;
 	}
 
+	// Text extents, shared by the widgets of a module. Layouts measure the same few strings on
+	// every pass and resize step; after the first DirectWrite layout of a string in a font the
+	// answer is a hash lookup. UI thread only, like the drawing code.
+	class TextMetrics {
+	public:
+		// Width x height (DIPs, rounded up) of 'text' in the font, wrapped at 'maxWidth', or
+		// on one line when it is negative
+		static D2D1_SIZE_F Measure(const std::wstring& text, const wchar_t* family, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STYLE style, float size, float maxWidth = -1.0f) {
+			TextMetrics& cache = Instance();
+			Key key = { family, text, weight, style, size, (maxWidth < 0.0f) ? -1.0f : maxWidth };
+			auto it = cache.m_extents.find(key);
+			if (it != cache.m_extents.end()) {
+				++cache.m_hits;
+				return it->second;
+			}
+
+			// 1. Lay the text out once
+			D2D1_SIZE_F extent = D2D1::SizeF(0.0f, 0.0f);
+			IDWriteTextFormat* format = cache.Format(family, weight, style, size);
+			ComPtr<IDWriteTextLayout> layout;
+			bool oneLine = (key.maxWidth < 0.0f);
+			if (format && !text.empty() && SUCCEEDED(GetDWriteFactory()->CreateTextLayout(text.c_str(), (UINT32)text.length(), format, oneLine ? kUnbounded : key.maxWidth, kUnbounded, &layout))) {
+				layout->SetWordWrapping(oneLine ? DWRITE_WORD_WRAPPING_NO_WRAP : DWRITE_WORD_WRAPPING_WRAP);
+				DWRITE_TEXT_METRICS m;
+				if (SUCCEEDED(layout->GetMetrics(&m))) extent = D2D1::SizeF(std::ceil(m.widthIncludingTrailingWhitespace), std::ceil(m.height));
+			}
+
+			// 2. Keep it; a UI only shows so many strings, so a full table means churn
+			if (cache.m_extents.size() >= kMaxEntries) cache.m_extents.clear();
+			cache.m_extents.emplace(std::move(key), extent);
+			++cache.m_misses;
+			return extent;
+		}
+
+		static void GetStats(uint64_t* hits, uint64_t* misses) {
+			if (hits) *hits = Instance().m_hits;
+			if (misses) *misses = Instance().m_misses;
+		}
+
+	private:
+		static constexpr float kUnbounded = 1.0e6f;
+		static const size_t kMaxEntries = 4096;
+
+		struct Key {
+			std::wstring family, text;
+			DWRITE_FONT_WEIGHT weight;
+			DWRITE_FONT_STYLE style;
+			float size, maxWidth;
+			bool operator==(const Key& o) const {
+				return weight == o.weight && style == o.style && size == o.size && maxWidth == o.maxWidth && text == o.text && family == o.family;
+			}
+		};
+		struct KeyHash {
+			size_t operator()(const Key& k) const {
+				size_t h = std::hash<std::wstring>()(k.text);
+				h = h * 31 + std::hash<std::wstring>()(k.family);
+				h = h * 31 + ((size_t)k.weight << 4 | (size_t)k.style);
+				h = h * 31 + std::hash<float>()(k.size);
+				return h * 31 + std::hash<float>()(k.maxWidth);
+			}
+		};
+		struct FormatEntry {
+			std::wstring family;
+			DWRITE_FONT_WEIGHT weight;
+			DWRITE_FONT_STYLE style;
+			float size;
+			ComPtr<IDWriteTextFormat> format;
+		};
+
+		static TextMetrics& Instance() {
+			static TextMetrics instance;
+			return instance;
+		}
+
+		// Text formats are few (a handful of fonts per UI); a linear scan finds them
+		IDWriteTextFormat* Format(const wchar_t* family, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STYLE style, float size) {
+			for (const FormatEntry& f : m_formats) {
+				if (f.weight == weight && f.style == style && f.size == size && f.family == family) return f.format.Get();
+			}
+			ComPtr<IDWriteFactory> factory = GetDWriteFactory();
+			FormatEntry entry = { family, weight, style, size, nullptr };
+			if (!factory || FAILED(factory->CreateTextFormat(family, NULL, weight, style, DWRITE_FONT_STRETCH_NORMAL, size, L"en-us", &entry.format))) return nullptr;
+			m_formats.push_back(entry);
+			return entry.format.Get();
+		}
+
+		std::unordered_map<Key, D2D1_SIZE_F, KeyHash> m_extents;
+		std::vector<FormatEntry> m_formats;
+		uint64_t m_hits = 0, m_misses = 0;
+	};
+
 
 	inline void ImageFromBase64(ID2D1RenderTarget* pRT, const char* b64, ID2D1Bitmap** ppBitmap) {
 		// 0. Input Validation
@@ -274,7 +453,7 @@ namespace ChronoUI {
 		// pStream, decoder, source, and converter will auto-release here via ComPtr.
 	}
 
-	class WidgetImpl : public IWidget, public ContextNodeImpl {
+	class WidgetImpl : public IWidget, public ContextNodeImpl, public IAnimated {
 	protected:
 		HWND m_hwnd = nullptr;
 		std::vector<EventHandlerEntry> m_handlers;
@@ -284,6 +463,9 @@ namespace ChronoUI {
 		
 		// D2D Resources
 		ComPtr<ID2D1HwndRenderTarget> m_pRenderTarget;
+		// Live resize (see StretchesWhileResizing): resized during the drag, and what is stretched
+		bool m_stretching = false;
+		ComPtr<ID2D1Bitmap> m_resizeSnapshot;
 		// Brushes cache (Optional: usually recreated in Draw, 
 		// but for performance, keep commonly used brushes here)
 		ComPtr<ID2D1SolidColorBrush> m_pSolidBrush;
@@ -308,6 +490,52 @@ namespace ChronoUI {
 		int m_width = 0;
 		int m_height = 0;
 
+		PropertyHandle m_styleClassKey = {};	// Atom of GetControlName(), see StyleClassKey()
+
+		// Computed styles, one slot per StyleState mask (see GetComputedStyle)
+		std::vector<ComputedStyle> m_computedStyles;
+		uint16_t m_computedValid = 0;			// Bit per materialized slot
+		uint64_t m_computedEpoch = 0;
+		PropertyHandle m_computedClass = {};
+		PropertyHandle m_computedSubclass = {};
+
+		// Measure() answers for the last few constraints; dropped by RequestLayout and the style epoch
+		struct MeasureEntry {
+			int availableW, availableH;
+			MeasureMode mode;
+			SIZE size;
+			bool known;
+		};
+		std::vector<MeasureEntry> m_measures;
+		uint64_t m_measureEpoch = 0;
+
+		// Running CSS transitions (see GetAnimatedStyle, TransitionFloat), driven by AnimationClock
+		static const size_t kAnimatedStyleFields = 11;
+		struct StyleTrack {
+			uint32_t honoured;				// State bits the drawing call distinguishes
+			bool animating;
+			double start, end;
+			ComputedStyle from, to, shown;
+			const TransitionTiming* timings[kAnimatedStyleFields];	// Per AnimatedStyleFields() entry, null = switch at once
+		};
+		struct ValueTrack {
+			PropertyHandle key;
+			float from, to, shown;
+			double start;
+			const TransitionTiming* timing;
+		};
+		std::vector<StyleTrack> m_styleTracks;
+		std::vector<ValueTrack> m_valueTracks;
+		double m_animationEnd = 0.0;
+
+		// Pending work of an open BeginUpdate batch (see OnEndUpdate)
+		std::vector<PropertyHandle> m_batchedKeys;	// Distinct keys, first-write order
+		bool m_batchedOnChanged = false;
+		bool m_batchedRepaint = false;
+		bool m_batchedLayout = false;
+
+		bool m_schemaRegistered = false;		// GetControlManifest() fed to PropertySchema
+
 		// Store the validator
 		struct ValidatorData {
 			ChronoValidationCallback callback = nullptr;
@@ -329,6 +557,7 @@ namespace ChronoUI {
 			SetProperty("id", autoId.c_str());
 		}
 		virtual ~WidgetImpl() {
+			AnimationClock::Remove(this);
 			DiscardDeviceResources();
 			// Cleanup Overlays
 			for (auto* ov : m_overlays) {
@@ -375,6 +604,7 @@ namespace ChronoUI {
 		void DiscardDeviceResources() {
 			m_pRenderTarget.Reset();
 			m_pSolidBrush.Reset();
+			m_resizeSnapshot.Reset();
 		}
 
 		// Implement the virtual method
@@ -423,7 +653,7 @@ namespace ChronoUI {
 			// 1. Update the generic property store.
 			// This ensures that when the binding callback executes and calls 
 			// GetProperty(key), it retrieves the new value we just set.
-			m_properties[key] = value;
+			StoreProperty(PropertyAtoms::Intern(key), value.c_str());
 
 			// 2. Trigger the bindings associated with this widget
 			TriggerOnChanged();
@@ -482,6 +712,16 @@ namespace ChronoUI {
 		}
 		// -------------------------------------
 		virtual void OnDrawWidget(ID2D1RenderTarget* pRT) = 0;
+
+		// Content size for Measure() in device pixels; the caller clamps it to the constraint.
+		// The default has no opinion.
+		virtual bool OnMeasure(int availableW, int availableH, MeasureMode mode, SIZE* desired) {
+			return false;
+		}
+		// Widgets that are expensive to draw return true: while a splitter is dragged
+		// (LiveResize) they are drawn once and that picture is stretched to each new size, until
+		// the repaint on release
+		virtual bool StretchesWhileResizing() { return false; }
 		virtual bool OnMessage(UINT msg, WPARAM wp, LPARAM lp) { return false; }
 		virtual bool OnUpdateAnimation(float deltaTime) { return false;  }
 
@@ -516,9 +756,99 @@ namespace ChronoUI {
 		}
 
 		void TriggerOnChanged() {
+			// Inside a batch the bindings run once, at EndUpdate
+			if (IsUpdating()) {
+				m_batchedOnChanged = true;
+				return;
+			}
 			for (const auto& entry : m_onChangedCallbacks) if (entry.func) entry.func(this, entry.ctx);
 		}
 
+		// InvalidateRect, coalesced to a single call while a batch is open
+		void RequestRepaint() {
+			if (IsUpdating()) {
+				m_batchedRepaint = true;
+				return;
+			}
+			if (IsWindow(m_hwnd)) InvalidateRect(m_hwnd, NULL, FALSE);
+		}
+
+		// Marks this widget's size stale; the owning cell is laid out again in the container's
+		// next pass (see ContextNodeImpl::InvalidateLayout). Other cells are not touched.
+		void RequestLayout() {
+			m_measures.clear();
+			if (IsUpdating()) {
+				m_batchedLayout = true;
+				return;
+			}
+			if (m_parent) {
+				InvalidateLayout(true);
+				return;
+			}
+			// Not in the node tree yet: ask the parent window (coalesced by the cell)
+			HWND parent = IsWindow(m_hwnd) ? ::GetParent(m_hwnd) : NULL;
+			if (parent) PostMessage(parent, WM_CHRONO_LAYOUT_DIRTY, 0, (LPARAM)m_hwnd);
+		}
+
+		// What a change of 'key' affects for this control (see PropertySchema)
+		PropertyImpact GetPropertyImpact(PropertyHandle key) {
+			if (!m_schemaRegistered) {
+				PropertySchema::RegisterManifest(StyleClassKey(), GetControlManifest());
+				m_schemaRegistered = true;
+			}
+			return PropertySchema::GetImpact(StyleClassKey(), key);
+		}
+
+		// Repaint and/or relayout as declared for 'key'; non-visual keys cost nothing
+		void InvalidateForProperty(PropertyHandle key) {
+			switch (GetPropertyImpact(key)) {
+			case PropertyImpact::None:
+				break;
+			case PropertyImpact::Layout:
+				RequestLayout();
+				RequestRepaint();
+				break;
+			default:
+				RequestRepaint();
+				break;
+			}
+		}
+
+		// IWidget::Measure: OnMeasure, memoized per constraint. Unbounded ignores the numbers, so
+		// those calls share one entry; AtMost and Exactly are applied here so widgets only
+		// report their content.
+		virtual bool __stdcall Measure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+			if (!desired) return false;
+
+			// 1. Answers computed under other style rules are stale
+			uint64_t epoch = StyleCache::Epoch();
+			if (epoch != m_measureEpoch) {
+				m_measures.clear();
+				m_measureEpoch = epoch;
+			}
+			if (mode == MeasureMode::Unbounded) availableW = availableH = -1;
+
+			// 2. Asked before
+			for (const MeasureEntry& e : m_measures) {
+				if (e.availableW == availableW && e.availableH == availableH && e.mode == mode) {
+					*desired = e.size;
+					return e.known;
+				}
+			}
+
+			// 3. Ask the widget; a layout pass asks for one or two constraints per widget
+			MeasureEntry e = { availableW, availableH, mode, { 0, 0 }, false };
+			e.known = OnMeasure(availableW, availableH, mode, &e.size);
+			if (e.known && mode != MeasureMode::Unbounded) {
+				if (availableW >= 0) e.size.cx = (mode == MeasureMode::Exactly) ? availableW : (std::min)(e.size.cx, (LONG)availableW);
+				if (availableH >= 0) e.size.cy = (mode == MeasureMode::Exactly) ? availableH : (std::min)(e.size.cy, (LONG)availableH);
+			}
+			if (m_measures.size() >= 4) m_measures.erase(m_measures.begin());
+			m_measures.push_back(e);
+			*desired = e.size;
+			return e.known;
+		}
+
 		static void CALLBACK StaticTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
 			WidgetImpl* pThis = reinterpret_cast<WidgetImpl*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
 			if (pThis) pThis->ProcessTimer(idEvent);
@@ -605,15 +935,177 @@ namespace ChronoUI {
 			ContextNodeImpl::SetColor(key, color); return this; 
 		};
 		virtual const char* GetStyle(const char* _prop, const char* _def, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active=false) override { return ContextNodeImpl::GetStyle(_prop, _def, _classid, _subclass, selected, enabled, hovered, active); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override {
+			return ContextNodeImpl::GetStyleValue(prop, classid, subclass, stateMask, out);
+		}
+		bool GetStyleValue(const char* _prop, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active, PropertyValue* out) {
+			return ContextNodeImpl::GetStyleValue(_prop, _classid, _subclass, selected, enabled, hovered, active, out);
+		}
+
+		// Keys used by the built-in drawing helpers, resolved once per DLL
+		struct StyleKeys {
+			PropertyHandle subclass = PropertyAtoms::Intern("subclass");
+			PropertyHandle backgroundColor = PropertyAtoms::Intern("background-color");
+			PropertyHandle borderColor = PropertyAtoms::Intern("border-color");
+			PropertyHandle borderWidth = PropertyAtoms::Intern("border-width");
+			PropertyHandle borderRadius = PropertyAtoms::Intern("border-radius");
+			PropertyHandle marginTop = PropertyAtoms::Intern("margin-top");
+			PropertyHandle marginLeft = PropertyAtoms::Intern("margin-left");
+			PropertyHandle marginRight = PropertyAtoms::Intern("margin-right");
+			PropertyHandle marginBottom = PropertyAtoms::Intern("margin-bottom");
+			PropertyHandle color = PropertyAtoms::Intern("color");
+			PropertyHandle fontFamily = PropertyAtoms::Intern("font-family");
+			PropertyHandle fontStyle = PropertyAtoms::Intern("font-style");
+			PropertyHandle fontSize = PropertyAtoms::Intern("font-size");
+			PropertyHandle textAlign = PropertyAtoms::Intern("text-align");
+			PropertyHandle fontWeight = PropertyAtoms::Intern("font-weight");
+			PropertyHandle opacity = PropertyAtoms::Intern("opacity");
+			PropertyHandle transition = PropertyAtoms::Intern("transition");
+		};
+		static const StyleKeys& GetStyleKeys() {
+			static StyleKeys keys;
+			return keys;
+		}
+
+		// Style lookup context: the control name and the (inherited) subclass as atoms
+		PropertyHandle StyleClassKey() {
+			if (!m_styleClassKey.IsValid()) m_styleClassKey = PropertyAtoms::Intern(GetControlName());
+			return m_styleClassKey;
+		}
+		PropertyHandle StyleSubclassKey() {
+			return PropertyAtoms::Intern(GetProperty(GetStyleKeys().subclass));
+		}
+
+		// Returns the computed style for a StyleState mask. Each of the 16 combinations is
+		// materialized on first use and kept until the style epoch, the control class or the
+		// subclass changes, so a hover or focus flip is only an index change.
+		const ComputedStyle& GetComputedStyle(uint32_t state) {
+			// 1. Drop every variant if the rules they were computed from may have changed
+			PropertyHandle cls = StyleClassKey();
+			PropertyHandle sub = StyleSubclassKey();
+			uint64_t epoch = StyleCache::Epoch();
+			if (epoch != m_computedEpoch || cls != m_computedClass || sub != m_computedSubclass) {
+				m_computedValid = 0;
+				m_computedEpoch = epoch;
+				m_computedClass = cls;
+				m_computedSubclass = sub;
+			}
+
+			// 2. Materialize this combination on first use
+			state &= 0xF;
+			if (m_computedStyles.empty()) m_computedStyles.resize(16);
+			ComputedStyle& cs = m_computedStyles[state];
+			if (!(m_computedValid & (1u << state))) {
+				ComputeStyle(cs, cls, sub, state);
+				m_computedValid |= (uint16_t)(1u << state);
+			}
+			return cs;
+		}
+
+		void InvalidateComputedStyle() {
+			m_computedValid = 0;
+		}
+
+		// The style to draw for 'state': GetComputedStyle, or while a transition runs, the way
+		// from what was on screen towards it. A new target starts the transitions its
+		// "transition" names; everything else switches at once. 'honoured' are the StyleState
+		// bits the caller can pass (a helper that never shows hover leaves Hover out), so
+		// callers that draw different states of one widget do not restart each other.
+		const ComputedStyle& GetAnimatedStyle(uint32_t state, uint32_t honoured = 0xF) {
+			const ComputedStyle& target = GetComputedStyle(state);
+
+			// 1. The track of this caller; its first style is drawn as is
+			StyleTrack* track = nullptr;
+			for (StyleTrack& t : m_styleTracks) {
+				if (t.honoured == honoured) track = &t;
+			}
+			if (!track) {
+				m_styleTracks.push_back({ honoured, false, 0.0, 0.0, target, target, target, {} });
+				return target;
+			}
+
+			// 2. A new target: start from what is on screen now
+			double now = AnimationClock::Now();
+			if (!SameStyle(target, track->to)) {
+				track->from = track->animating ? track->shown : track->to;
+				track->to = target;
+				track->shown = target;
+				track->start = now;
+				track->end = now;
+
+				const AnimatedField* fields = AnimatedStyleFields();
+				for (size_t i = 0; i < kAnimatedStyleFields; ++i) {
+					const TransitionTiming* timing = SameField(fields[i], track->from, target) ? nullptr : Transitions::Find(target.transition, fields[i].key);
+					track->timings[i] = timing;
+					if (timing) track->end = (std::max)(track->end, now + timing->delay + timing->duration);
+				}
+				track->animating = track->end > now;
+				if (track->animating) StartAnimation(track->end);
+			}
+			if (!track->animating) return target;
+
+			// 3. Interpolate the fields in transition
+			const AnimatedField* fields = AnimatedStyleFields();
+			for (size_t i = 0; i < kAnimatedStyleFields; ++i) {
+				if (!track->timings[i]) continue;
+				float t = Transitions::Progress(*track->timings[i], now - track->start);
+				const AnimatedField& f = fields[i];
+				if (f.color) {
+					uint32_t mixed = Transitions::MixColor(D2DToRGBA(track->from.*f.color), D2DToRGBA(target.*f.color), t);
+					track->shown.*f.color = RGBAToD2D(mixed);
+				}
+				else {
+					track->shown.*f.number = track->from.*f.number + (target.*f.number - track->from.*f.number) * t;
+				}
+			}
+			if (now >= track->end) {
+				track->animating = false;
+				return target;
+			}
+			return track->shown;
+		}
 
+		// 'target' as shown: a change of it moves there along the transition the widget's
+		// "transition" (or else 'fallback', e.g. "value 400ms ease-out") gives 'key', and is
+		// immediate without one. For values a widget animates itself (a gauge needle, a switch thumb).
+		float TransitionFloat(PropertyHandle key, float target, const char* fallback = nullptr) {
+			double now = AnimationClock::Now();
+			auto it = std::find_if(m_valueTracks.begin(), m_valueTracks.end(), [key](const ValueTrack& v) { return v.key == key; });
+			if (it == m_valueTracks.end()) {
+				m_valueTracks.push_back({ key, target, target, target, now, nullptr });
+				return target;
+			}
+
+			ValueTrack& v = *it;
+			if (target != v.to) {
+				uint32_t state = StyleState::Mask(m_focused, m_isEnabled, m_hoverActive && m_isHovered, m_checked);
+				const TransitionTiming* timing = Transitions::Find(GetComputedStyle(state).transition, key);
+				if (!timing && fallback) timing = Transitions::Find(Transitions::Compile(fallback), key);
+				v.from = v.shown;
+				v.to = target;
+				v.start = now;
+				v.timing = timing;
+				if (timing) StartAnimation(now + timing->delay + timing->duration);
+			}
+			float t = v.timing ? Transitions::Progress(*v.timing, now - v.start) : 1.0f;
+			v.shown = v.from + (v.to - v.from) * t;
+			return v.shown;
+		}
+
+		// One frame of the shared clock: repaint this widget only, until its last transition ends
+		virtual bool __stdcall OnAnimationFrame(double now) override {
+			HWND hwnd = m_overlayHost ? m_overlayHost->GetHWND() : m_hwnd;
+			if (IsWindow(hwnd)) InvalidateRect(hwnd, NULL, FALSE);
+			return now < m_animationEnd;
+		}
 		 
 		D2D1_COLOR_F GetCSSColorStyle(const char* key) {
-			const char* controlName = GetControlName();
-			std::string subclass = GetProperty("subclass");
-			const char* subCStr = subclass.c_str();
-			return CSSToD2DColor(
-				GetStyle(key, "#00ff00", controlName, subCStr, m_focused, m_isEnabled, m_hoverActive&m_isHovered, m_checked)
-				);
+			PropertyValue v;
+			uint32_t state = StyleState::Mask(m_focused, m_isEnabled, m_hoverActive&m_isHovered, m_checked);
+			if (!GetStyleValue(PropertyAtoms::Intern(key), StyleClassKey(), StyleSubclassKey(), state, &v)) {
+				return CSSToD2DColor("#00ff00");
+			}
+			return v.IsColor() ? RGBAToD2D(v.rgba) : CSSToD2DColor(v.text);
 		}
 		COLORREF GetCSSColorRefStyle(const char* key) {
 			// 1. Get the D2D color
@@ -631,27 +1123,143 @@ namespace ChronoUI {
 		}
 
 		int GetCSSIntStyle(const char* key, int def = 0) {
-			const char* controlName = GetControlName();
-			std::string subclass = GetProperty("subclass");
-			const char* subCStr = subclass.c_str();
-
-			const char* r = GetStyle(key, std::to_string(def).c_str(), controlName, subCStr, m_focused, m_isEnabled, m_hoverActive&m_isHovered, m_checked);
+			PropertyValue v;
+			uint32_t state = StyleState::Mask(m_focused, m_isEnabled, m_hoverActive&m_isHovered, m_checked);
+			if (!GetStyleValue(PropertyAtoms::Intern(key), StyleClassKey(), StyleSubclassKey(), state, &v) || !v.hasInteger) {
+				return def;
+			}
+			return v.integer;
+		}
 
-			if (!r) return def;
-			try {
-				return (std::stoi(std::string(r)));
+		// Color style parsed at write time. Missing or non-color values give 'def'.
+		D2D1_COLOR_F GetCSSColorStyle(PropertyHandle key, D2D1_COLOR_F def, PropertyHandle classid, PropertyHandle subclass, uint32_t state) {
+			PropertyValue v;
+			if (!GetStyleValue(key, classid, subclass, state, &v) || !v.IsColor()) {
+				return def;
 			}
-			catch (...) {
+			return RGBAToD2D(v.rgba);
+		}
+		D2D1_COLOR_F GetCSSColorStyle(const char* key, D2D1_COLOR_F def, const char* controlName, const char* subclass, bool selected, bool enabled, bool hovered, bool active = false) {
+			return GetCSSColorStyle(PropertyAtoms::Intern(key), def, PropertyAtoms::Intern(controlName), PropertyAtoms::Intern(subclass), StyleState::Mask(selected, enabled, hovered, active));
+		}
+
+		// Float style with std::stof semantics ("2px" -> 2), parsed when the style was set
+		float GetCSSFloatStyle(PropertyHandle key, float def, PropertyHandle classid, PropertyHandle subclass, uint32_t state) {
+			PropertyValue v;
+			if (!GetStyleValue(key, classid, subclass, state, &v) || !v.hasNumber) {
 				return def;
 			}
+			return v.number;
+		}
+		float GetCSSFloatStyle(const char* key, float def, const char* controlName, const char* subclass, bool selected, bool enabled, bool hovered, bool active = false) {
+			return GetCSSFloatStyle(PropertyAtoms::Intern(key), def, PropertyAtoms::Intern(controlName), PropertyAtoms::Intern(subclass), StyleState::Mask(selected, enabled, hovered, active));
+		}
+
+		// Raw style text, or 'def' when nothing matched
+		const char* GetCSSStringStyle(PropertyHandle key, const char* def, PropertyHandle classid, PropertyHandle subclass, uint32_t state) {
+			PropertyValue v;
+			return GetStyleValue(key, classid, subclass, state, &v) ? v.text : def;
 		}
 		
 
+		// Widgets are leaves: a style key written here only affects this node's own cache
+		virtual void OnStyleKeyChanged() override {
+			m_styleCache.clear();
+			InvalidateComputedStyle();
+		}
+
+		// "checked", "enabled", ... are answered from live widget state (see GetProperty)
+		virtual bool CanFlattenForChildren() override {
+			return false;
+		}
+
+		virtual PropertyHandle StyleTypeKey() override {
+			return StyleClassKey();
+		}
+
+		// Matched style rules changed: notify the keys whose effective value moved, as one batch
+		virtual void OnRuleLayerChanged(const InheritedTable* before, const InheritedTable* after) override {
+			auto textIn = [](const InheritedTable* layer, uint32_t id) -> const std::string* {
+				if (!layer) return nullptr;
+				auto it = layer->slots.find(id);
+				return (it != layer->slots.end()) ? &it->second.text : nullptr;
+			};
+
+			// Keys set locally still win over any rule
+			std::vector<PropertyHandle> keys;
+			for (const InheritedTable* layer : { before, after }) {
+				if (!layer) continue;
+				for (const auto& kv : layer->slots) {
+					PropertyHandle key = { kv.first };
+					if (m_properties.count(kv.first) || std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+					const std::string* b = textIn(before, kv.first);
+					const std::string* a = textIn(after, kv.first);
+					if (b && a && *b == *a) continue;
+					keys.push_back(key);
+				}
+			}
+			if (keys.empty()) return;
+
+			BeginUpdate();
+			for (PropertyHandle key : keys) {
+				std::string value = GetProperty(key, "");
+				OnPropertyChanged(PropertyAtoms::Name(key), value.c_str());
+			}
+			EndUpdate();
+		}
+
+		virtual IWidget* __stdcall SetProperty(PropertyHandle key, const char* value) override {
+			if (!key.IsValid()) return this;
+			StoreProperty(key, value);
+
+			// Batched: notify once per key, with the final value, at EndUpdate
+			if (IsUpdating()) {
+				if (std::find(m_batchedKeys.begin(), m_batchedKeys.end(), key) == m_batchedKeys.end()) {
+					m_batchedKeys.push_back(key);
+				}
+				return this;
+			}
+			OnPropertyChanged(PropertyAtoms::Name(key), value);
+			return this;
+		}
+
+		// Numeric fast path: stored without formatting, dispatched to OnValueChanged
+		virtual IWidget* __stdcall SetFloat(PropertyHandle key, float value) override {
+			return SetDouble(key, value);
+		}
+		virtual IWidget* __stdcall SetInt(PropertyHandle key, int32_t value) override {
+			if (!key.IsValid()) return this;
+			StoreNumber(key, PropertyType::Int, value);
+			return NotifyValueChanged(key);
+		}
+		virtual IWidget* __stdcall SetDouble(PropertyHandle key, double value) override {
+			if (!key.IsValid()) return this;
+			StoreNumber(key, PropertyType::Float, value);
+			return NotifyValueChanged(key);
+		}
+		virtual IWidget* __stdcall SetFloatArray(PropertyHandle key, const float* values, size_t count) override {
+			if (!key.IsValid()) return this;
+			StoreFloatArray(key, values, count);
+			return NotifyValueChanged(key);
+		}
+
+		IWidget* NotifyValueChanged(PropertyHandle key) {
+			if (IsUpdating()) {
+				if (std::find(m_batchedKeys.begin(), m_batchedKeys.end(), key) == m_batchedKeys.end()) {
+					m_batchedKeys.push_back(key);
+				}
+				return this;
+			}
+			auto it = m_properties.find(key.id);
+			if (it != m_properties.end()) OnValueChanged(key, it->second.value);
+			return this;
+		}
+		virtual void __stdcall BeginUpdate() override { ContextNodeImpl::BeginUpdate(); }
+		virtual void __stdcall EndUpdate() override { ContextNodeImpl::EndUpdate(); }
 		virtual IWidget* __stdcall SetProperty(const char* key, const char* value) override { 
-			m_properties[key] = (value) ? value : ""; 
-			OnPropertyChanged(key, value); 
-			return this; 
+			return SetProperty(PropertyAtoms::Intern(key), value);
 		}
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override { return ContextNodeImpl::ResolveKey(key); }
 		IWidget* SetBoolProperty(const char* key, bool value) {
 			return SetProperty(key, value ? "true" : "false");
 		}
@@ -669,63 +1277,101 @@ namespace ChronoUI {
 			}
 			return D2D1::ColorF(r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
 		}
+		// Typed getters: values are parsed once in SetProperty, these only read the cached result.
+		// The handle overloads skip the key lookup too.
+		D2D1_COLOR_F GetColorProperty(PropertyHandle key, D2D1_COLOR_F def = D2D1::ColorF(0.0f, 1.0f, 0.0f)) {
+			PropertyValue v;
+			if (!GetPropertyValue(key, &v)) return def;
+			return v.IsColor() ? RGBAToD2D(v.rgba) : CSSToD2DColor(v.text);
+		}
 		D2D1_COLOR_F GetColorProperty(const char* key, D2D1_COLOR_F def = D2D1::ColorF(0.0f, 1.0f, 0.0f)) {
-			const char* r = GetProperty(key);
-			if (!r) return def;
-
-			return CSSToD2DColor(std::string(r));
+			return GetColorProperty(FindKey(key), def);
 		}
 
+		bool GetBoolProperty(PropertyHandle key, bool def = true) {
+			PropertyValue v;
+			if (!GetPropertyValue(key, &v)) return def;
+			return (v.type == PropertyType::Bool) && v.boolean;
+		}
 		bool GetBoolProperty(const char* key, bool def = true) {
-			const char* r = GetProperty(key, def ? "true" : "false");
-			if (!r) return def;
-			return (std::string(r) == "true");
+			return GetBoolProperty(FindKey(key), def);
+		}
+
+		float GetFloatProperty(PropertyHandle key, float def = 0) {
+			PropertyValue v;
+			if (!GetPropertyValue(key, &v) || !v.hasNumber) return def;
+			return v.number;
 		}
 		float GetFloatProperty(const char* key, float def = 0) {
-			const char* r = GetProperty(key, def ? "true" : "false");
-			if (!r) return def;
-			try {
-				return (std::stof(std::string(r)));
-			}
-			catch (...) {
-				return def;
-			}
+			return GetFloatProperty(FindKey(key), def);
+		}
+
+		int GetIntProperty(PropertyHandle key, int def = 0) {
+			PropertyValue v;
+			if (!GetPropertyValue(key, &v) || !v.hasInteger) return def;
+			return v.integer;
 		}
 		int GetIntProperty(const char* key, int def = 0) {
-			const char* r = GetProperty(key, def ? "true" : "false");
-			if (!r) return def;
-			try {
-				return (std::stoi(std::string(r)));
-			} catch(...){
-				return def;
-			}
+			return GetIntProperty(FindKey(key), def);
 		}
+
 		std::string GetStringProperty(std::string key, std::string def = "") {
 			const char* r = GetProperty(key.c_str(), def.c_str());
 			if (!r) return def;
 			return std::string(r);
 		}
-		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { 
-			std::string k = key;
-			std::string d = def ? def : "";
+		// Keys answered from widget state instead of the property store
+		struct StateKeys {
+			PropertyHandle checked = PropertyAtoms::Intern("checked");
+			PropertyHandle validated = PropertyAtoms::Intern("validated");
+			PropertyHandle enabled = PropertyAtoms::Intern("enabled");
+			PropertyHandle disabled = PropertyAtoms::Intern("disabled");
+		};
+		static const StateKeys& GetStateKeys() {
+			static StateKeys keys;
+			return keys;
+		}
 
-			if (k == "checked") {
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override {
+			const StateKeys& sk = GetStateKeys();
+
+			if (key == sk.checked) {
 				return m_checked?"true":"false";
 			}
-			else if (k == "validated") {
+			else if (key == sk.validated) {
 				return m_validated ? "true" : "false";
 			}
 			if (m_hwnd) {
-				if (k == "enabled") {
+				if (key == sk.enabled) {
 					return (::IsWindow(m_hwnd) && ::IsWindowEnabled(m_hwnd)) ? "true" : "false";
 				}
-				else if (k == "disabled") {
+				else if (key == sk.disabled) {
 					return (::IsWindow(m_hwnd) && ::IsWindowEnabled(m_hwnd)) ? "false" : "true";
 				}
 			}
 
 			return ContextNodeImpl::GetProperty(key, def); 
 		}
+		// Non-inserting key lookup. The state keys are interned first, so an unknown key really is absent.
+		static PropertyHandle FindKey(const char* key) {
+			GetStateKeys();
+			return PropertyAtoms::Find(key);
+		}
+
+		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { 
+			return GetProperty(FindKey(key), def);
+		}
+
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override {
+			const StateKeys& sk = GetStateKeys();
+
+			// State keys are not stored; parse the literal GetProperty answers with
+			if (key == sk.checked || key == sk.validated || (m_hwnd && (key == sk.enabled || key == sk.disabled))) {
+				if (out) *out = PropertyValue::Parse(GetProperty(key));
+				return true;
+			}
+			return ContextNodeImpl::GetPropertyValue(key, out);
+		}
 
 		virtual void OnPropertyChanged(const char* key, const char* value) {
 			std::string k = key;
@@ -756,45 +1402,202 @@ namespace ChronoUI {
 						EnableWindow(m_hwnd, TRUE);
 					}
 				}
-				InvalidateRect(m_hwnd, NULL, FALSE);
+				InvalidateForProperty(PropertyAtoms::Find(key));
+			}
+		}
+
+		// Typed change notification for SetFloat/SetInt/SetDouble/SetFloatArray.
+		// 'value.text' is not set; arrays are read with GetFloatArray(key, ...).
+		// The default formats the value and falls back to OnPropertyChanged, so widgets
+		// only override this for the keys they want to take without a string round trip.
+		virtual void OnValueChanged(PropertyHandle key, const PropertyValue& value) {
+			auto it = m_properties.find(key.id);
+			std::string text = (it != m_properties.end()) ? SlotText(it->second) : "";
+			OnPropertyChanged(PropertyAtoms::Name(key), text.c_str());
+		}
+
+		// Batched change notification: the distinct keys written since BeginUpdate.
+		// The default replays OnPropertyChanged once per key with the key's final value.
+		virtual void OnPropertiesChanged(const std::vector<PropertyHandle>& keys) {
+			for (PropertyHandle key : keys) {
+				auto it = m_properties.find(key.id);
+				if (it != m_properties.end() && it->second.typed) {
+					OnValueChanged(key, it->second.value);
+					continue;
+				}
+				std::string value = (it != m_properties.end()) ? it->second.text : "";
+				OnPropertyChanged(PropertyAtoms::Name(key), value.c_str());
+			}
+		}
+
+		virtual void OnEndUpdate() override {
+			// 1. Notify with the batch still open, so repaints and bindings requested
+			//    by the handlers coalesce as well
+			++m_updateDepth;
+			while (!m_batchedKeys.empty()) {
+				std::vector<PropertyHandle> keys;
+				keys.swap(m_batchedKeys);
+				OnPropertiesChanged(keys);
+			}
+			--m_updateDepth;
+
+			// 2. Bindings, once
+			if (m_batchedOnChanged) {
+				m_batchedOnChanged = false;
+				TriggerOnChanged();
+			}
+
+			// 3. Relayout and repaint, once
+			if (m_batchedLayout) {
+				m_batchedLayout = false;
+				RequestLayout();
+			}
+			if (m_batchedRepaint) {
+				m_batchedRepaint = false;
+				RequestRepaint();
 			}
 		}
 
 	protected:
+		// -----------------------------------------------------------------------------
+		// --- Computed Style ---
+
+		// The ComputedStyle fields a transition interpolates: colors (in linear light) and lengths
+		struct AnimatedField {
+			PropertyHandle key;
+			D2D1_COLOR_F ComputedStyle::* color;
+			float ComputedStyle::* number;
+		};
+		static const AnimatedField* AnimatedStyleFields() {
+			static const StyleKeys& k = GetStyleKeys();
+			static const AnimatedField fields[kAnimatedStyleFields] = {
+				{ k.backgroundColor, &ComputedStyle::backgroundColor, nullptr },
+				{ k.borderColor, &ComputedStyle::borderColor, nullptr },
+				{ k.color, &ComputedStyle::color, nullptr },
+				{ k.borderWidth, nullptr, &ComputedStyle::borderWidth },
+				{ k.borderRadius, nullptr, &ComputedStyle::borderRadius },
+				{ k.marginTop, nullptr, &ComputedStyle::marginTop },
+				{ k.marginLeft, nullptr, &ComputedStyle::marginLeft },
+				{ k.marginRight, nullptr, &ComputedStyle::marginRight },
+				{ k.marginBottom, nullptr, &ComputedStyle::marginBottom },
+				{ k.fontSize, nullptr, &ComputedStyle::fontSize },
+				{ k.opacity, nullptr, &ComputedStyle::opacity },
+			};
+			return fields;
+		}
+
+		static bool SameField(const AnimatedField& f, const ComputedStyle& a, const ComputedStyle& b) {
+			if (!f.color) return a.*f.number == b.*f.number;
+			const D2D1_COLOR_F& x = a.*f.color;
+			const D2D1_COLOR_F& y = b.*f.color;
+			return x.r == y.r && x.g == y.g && x.b == y.b && x.a == y.a;
+		}
+
+		static bool SameStyle(const ComputedStyle& a, const ComputedStyle& b) {
+			const AnimatedField* fields = AnimatedStyleFields();
+			for (size_t i = 0; i < kAnimatedStyleFields; ++i) {
+				if (!SameField(fields[i], a, b)) return false;
+			}
+			return a.fontFamily == b.fontFamily && a.fontWeight == b.fontWeight && a.fontStyle == b.fontStyle &&
+				a.textAlign == b.textAlign && a.transition == b.transition;
+		}
+
+		// Keeps this widget on the shared clock until at least 'end'
+		void StartAnimation(double end) {
+			m_animationEnd = (std::max)(m_animationEnd, end);
+			AnimationClock::Add(this);
+		}
+
+		void ComputeStyle(ComputedStyle& cs, PropertyHandle cls, PropertyHandle sub, uint32_t state) {
+			const StyleKeys& keys = GetStyleKeys();
+			cs = ComputedStyle();
+
+			// 1. Box model
+			cs.marginTop = GetCSSFloatStyle(keys.marginTop, cs.marginTop, cls, sub, state);
+			cs.marginLeft = GetCSSFloatStyle(keys.marginLeft, cs.marginLeft, cls, sub, state);
+			cs.marginRight = GetCSSFloatStyle(keys.marginRight, cs.marginRight, cls, sub, state);
+			cs.marginBottom = GetCSSFloatStyle(keys.marginBottom, cs.marginBottom, cls, sub, state);
+			cs.borderWidth = GetCSSFloatStyle(keys.borderWidth, cs.borderWidth, cls, sub, state);
+			cs.borderRadius = GetCSSFloatStyle(keys.borderRadius, cs.borderRadius, cls, sub, state);
+
+			// 2. Colors
+			cs.backgroundColor = GetCSSColorStyle(keys.backgroundColor, cs.backgroundColor, cls, sub, state);
+			cs.borderColor = GetCSSColorStyle(keys.borderColor, cs.borderColor, cls, sub, state);
+			cs.color = GetCSSColorStyle(keys.color, cs.color, cls, sub, state);
+
+			// 3. Font. "font-style: bold" is kept for existing themes, "font-weight" wins when set.
+			std::string fontName = GetCSSStringStyle(keys.fontFamily, "Segoe UI", cls, sub, state);
+			cs.fontFamily.assign(fontName.begin(), fontName.end());
+			cs.fontSize = GetCSSFloatStyle(keys.fontSize, cs.fontSize, cls, sub, state);
+
+			std::string style = GetCSSStringStyle(keys.fontStyle, "normal", cls, sub, state);
+			if (style == "bold") {
+				cs.fontWeight = DWRITE_FONT_WEIGHT_BOLD;
+			}
+			else if (style == "italic") {
+				cs.fontStyle = DWRITE_FONT_STYLE_ITALIC;
+			}
+
+			PropertyValue weight;
+			if (GetStyleValue(keys.fontWeight, cls, sub, state, &weight)) {
+				if (weight.hasInteger) {
+					cs.fontWeight = (DWRITE_FONT_WEIGHT)(std::max)(1, (std::min)(999, (int)weight.integer));
+				}
+				else if (strcmp(weight.text, "bold") == 0) {
+					cs.fontWeight = DWRITE_FONT_WEIGHT_BOLD;
+				}
+				else if (strcmp(weight.text, "normal") == 0) {
+					cs.fontWeight = DWRITE_FONT_WEIGHT_NORMAL;
+				}
+			}
+
+			// 4. Text alignment
+			std::string align = GetCSSStringStyle(keys.textAlign, "center", cls, sub, state);
+			if (align == "left") {
+				cs.textAlign = DWRITE_TEXT_ALIGNMENT_LEADING;
+			}
+			else if (align == "right") {
+				cs.textAlign = DWRITE_TEXT_ALIGNMENT_TRAILING;
+			}
+
+			// 5. Opacity and transitions
+			cs.opacity = (std::max)(0.0f, (std::min)(1.0f, GetCSSFloatStyle(keys.opacity, cs.opacity, cls, sub, state)));
+			cs.transition = Transitions::Compile(GetCSSStringStyle(keys.transition, "", cls, sub, state));
+		}
+
 		// -----------------------------------------------------------------------------
 		// --- Drawing Helpers ---
 
 		void DrawFlatBackground(ID2D1RenderTarget* pRT) {
-			// 1. Get Context
-			const char* controlName = GetControlName();
-			std::string subclass = GetProperty("subclass");
+			// 1. Fetch Style (using false/0 for state args as per original code)
+			const ComputedStyle& cs = GetAnimatedStyle(StyleState::Mask(false, false, false, false), 0);
 
-			// 2. Fetch Style (using false/0 for state args as per original code)
-			std::string bgStr = GetStyle("background-color", "", controlName, subclass.c_str(), false, false, false);
-
-			// 3. Clear the Render Target
+			// 2. Clear the Render Target
 			// Note: pRT->Clear ignores the current transform but respects the clip. 
 			// It fills the entire render target with the specified color.
-			pRT->Clear(CSSColorToD2D(bgStr));
+			D2D1_COLOR_F bgColor = cs.backgroundColor;
+			bgColor.a *= cs.opacity;
+			pRT->Clear(bgColor);
 		}
 
 		void DrawWidgetBackground(ID2D1RenderTarget* pRT, const D2D1_RECT_F& r, bool hovereffect = true) {
-			const char* controlName = GetControlName();
-			std::string subclass = GetProperty("subclass");
 			bool isEnabled = ::IsWindowEnabled(m_hwnd);
 			bool hover = m_isHovered && hovereffect;
 
-			// Fetch Styles
-			std::string bgStr = GetStyle("background-color", "", controlName, subclass.c_str(), m_focused, isEnabled, hover);
-			std::string borderStr = GetStyle("border-color", "", controlName, subclass.c_str(), m_focused, isEnabled, hover);
-			float borderWidth = std::stof(GetStyle("border-width", "0", controlName, subclass.c_str(), m_focused, isEnabled, hover));
-			float radius = std::stof(GetStyle("border-radius", "2", controlName, subclass.c_str(), m_focused, isEnabled, hover));
+			// Fetch Styles (computed once per state combination, in transition after a change)
+			const ComputedStyle& cs = GetAnimatedStyle(StyleState::Mask(m_focused, isEnabled, hover, false), hovereffect ? 0xF : (0xF & ~StyleState::Hover));
+			D2D1_COLOR_F bgColor = cs.backgroundColor;
+			D2D1_COLOR_F borderColor = cs.borderColor;
+			bgColor.a *= cs.opacity;
+			borderColor.a *= cs.opacity;
+			float borderWidth = cs.borderWidth;
+			float radius = cs.borderRadius;
 
 			// Scale margins (Keep existing ScaleF logic)
-			float mt = ScaleF(std::stof(GetStyle("margin-top", "1", controlName, subclass.c_str(), m_focused, isEnabled, hover)));
-			float ml = ScaleF(std::stof(GetStyle("margin-left", "1", controlName, subclass.c_str(), m_focused, isEnabled, hover)));
-			float w = r.right - r.left - ml - ScaleF(std::stof(GetStyle("margin-right", "1", controlName, subclass.c_str(), m_focused, isEnabled, hover)));
-			float h = r.bottom - r.top - mt - ScaleF(std::stof(GetStyle("margin-bottom", "1", controlName, subclass.c_str(), m_focused, isEnabled, hover)));
+			float mt = ScaleF(cs.marginTop);
+			float ml = ScaleF(cs.marginLeft);
+			float w = r.right - r.left - ml - ScaleF(cs.marginRight);
+			float h = r.bottom - r.top - mt - ScaleF(cs.marginBottom);
 
 			D2D1_RECT_F drawRect = D2D1::RectF(ml, mt, ml + w, mt + h);
 
@@ -802,7 +1605,6 @@ namespace ChronoUI {
 			ComPtr<ID2D1SolidColorBrush> pBrush;
 
 			// Fill
-			D2D1_COLOR_F bgColor = CSSColorToD2D(bgStr);
 			if (bgColor.a > 0) {
 				//pRT->CreateSolidColorBrush(bgColor, &pBrush);
 				//pRT->FillRectangle(drawRect, pBrush.Get());
@@ -811,7 +1613,6 @@ namespace ChronoUI {
 
 			// Border
 			if (borderWidth > 0) {
-				D2D1_COLOR_F borderColor = CSSColorToD2D(borderStr);
 				pRT->CreateSolidColorBrush(borderColor, &pBrush);
 				if (radius > 0) {
 					D2D1_ROUNDED_RECT roundedRect = D2D1::RoundedRect(drawRect, radius, radius);
@@ -822,65 +1623,43 @@ namespace ChronoUI {
 			}
 		}
 
+		// Extent of 'text' through the shared TextMetrics cache; maxWidth < 0 keeps it on one line
+		D2D1_SIZE_F MeasureText(const std::string& text, const wchar_t* family, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STYLE style, float size, float maxWidth = -1.0f) {
+			if (text.empty()) return D2D1::SizeF(0.0f, 0.0f);
+			return TextMetrics::Measure(NarrowToWide(text), family, weight, style, size, maxWidth);
+		}
+		// ... in the font of a computed style, as DrawTextStyled sets it
+		D2D1_SIZE_F MeasureText(const std::string& text, const ComputedStyle& cs, float maxWidth = -1.0f) {
+			return MeasureText(text, cs.fontFamily.c_str(), cs.fontWeight, cs.fontStyle, cs.fontSize, maxWidth);
+		}
+
 		void DrawTextStyled(ID2D1RenderTarget* pRT, const std::string& text, const D2D1_RECT_F& r, bool allowHover = true) {
 			if (text.empty()) return;
 
 			// 1. Retrieve State and Context
 			auto& controller = ChronoControllerImpl::Instance();
-			std::string subclass = GetProperty("subclass");
 			bool isEnabled = ::IsWindowEnabled(m_hwnd);
-			const char* cname = GetControlName();
 			bool hover = allowHover && m_isHovered;
 
-			// 2. Fetch Styles
-			// Foreground Color
-			std::string fgStr = GetStyle("color", "#000000", cname, subclass.c_str(), m_focused, isEnabled, hover);
-
-			// Font Family
-			std::string fontName = GetStyle("font-family", "Segoe UI", cname, subclass.c_str(), m_focused, isEnabled, hover);
-			std::wstring wFontName(fontName.begin(), fontName.end());
-
-			// Font Style (Bold/Italic/Normal)
-			std::string style = GetStyle("font-style", "normal", cname, subclass.c_str(), m_focused, isEnabled, hover);
-			DWRITE_FONT_WEIGHT fontWeight = DWRITE_FONT_WEIGHT_NORMAL;
-			DWRITE_FONT_STYLE fontStyle = DWRITE_FONT_STYLE_NORMAL;
-
-			if (style == "bold") {
-				fontWeight = DWRITE_FONT_WEIGHT_BOLD;
-			}
-			else if (style == "italic") {
-				fontStyle = DWRITE_FONT_STYLE_ITALIC;
-			}
-
-			// Font Size
-			float fontSize = std::stof(GetStyle("font-size", "12", cname, subclass.c_str(), m_focused, isEnabled, hover));
+			// 2. Fetch Styles (computed once per state combination, in transition after a change)
+			const ComputedStyle& cs = GetAnimatedStyle(StyleState::Mask(m_focused, isEnabled, hover, false), allowHover ? 0xF : (0xF & ~StyleState::Hover));
 
 			// 3. Create Text Format
 			ComPtr<IDWriteTextFormat> pTextFormat;
 			HRESULT hr = controller.m_pDWriteFactory->CreateTextFormat(
-				wFontName.c_str(),
+				cs.fontFamily.c_str(),
 				NULL,
-				fontWeight,
-				fontStyle,
+				cs.fontWeight,
+				cs.fontStyle,
 				DWRITE_FONT_STRETCH_NORMAL,
-				fontSize,
+				cs.fontSize,
 				L"en-us", // Locale
 				&pTextFormat
 			);
 
 			if (SUCCEEDED(hr)) {
 				// 4. Alignment
-				// Horizontal Alignment
-				std::string align = GetStyle("text-align", "center", cname, subclass.c_str(), m_focused, isEnabled, hover);
-				if (align == "left") {
-					pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-				}
-				else if (align == "right") {
-					pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
-				}
-				else {
-					pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-				}
+				pTextFormat->SetTextAlignment(cs.textAlign);
 
 				// Vertical Alignment (Matches GDI+ SetLineAlignment(StringAlignmentCenter))
 				pTextFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
@@ -889,8 +1668,9 @@ namespace ChronoUI {
 				std::wstring wText(text.begin(), text.end());
 				ComPtr<ID2D1SolidColorBrush> pBrush;
 
-				// CSSColorToD2D is assumed to be available based on context
-				pRT->CreateSolidColorBrush(CSSColorToD2D(fgStr), &pBrush);
+				D2D1_COLOR_F textColor = cs.color;
+				textColor.a *= cs.opacity;
+				pRT->CreateSolidColorBrush(textColor, &pBrush);
 
 				if (pBrush) {
 					pRT->DrawText(
@@ -947,6 +1727,7 @@ namespace ChronoUI {
 				// Update internal state
 				m_width = (int)width;
 				m_height = (int)height;
+				if (LiveResize::IsActive() && StretchesWhileResizing()) m_stretching = true;
 
 				if (m_pRenderTarget) {
 					m_pRenderTarget->Resize(D2D1::SizeU(width, height));
@@ -1023,12 +1804,17 @@ namespace ChronoUI {
 					m_isEnabled = ::IsWindowEnabled(m_hwnd);
 					m_focused = (GetFocus() == m_hwnd);
 
-					// Draw Self
-					OnDrawWidget(m_pRenderTarget.Get());
+					if (!(m_stretching && LiveResize::IsActive() && DrawResizeSnapshot())) {
+						m_stretching = false;
+						m_resizeSnapshot.Reset();
+
+						// Draw Self
+						OnDrawWidget(m_pRenderTarget.Get());
 
-					// Draw Overlays
-					for (auto* ov : m_overlays) {
-						((WidgetImpl*)ov)->OnDrawWidget(m_pRenderTarget.Get());
+						// Draw Overlays
+						for (auto* ov : m_overlays) {
+							((WidgetImpl*)ov)->OnDrawWidget(m_pRenderTarget.Get());
+						}
 					}
 				}
 				hr = m_pRenderTarget->EndDraw();
@@ -1041,6 +1827,24 @@ namespace ChronoUI {
 			EndPaint(m_hwnd, &ps);
 		}
 
+		// Live resize: the widget and its overlays drawn once, at the first size of the drag,
+		// then stretched over the render target. False if the snapshot could not be taken.
+		bool DrawResizeSnapshot() {
+			if (!m_resizeSnapshot) {
+				ComPtr<ID2D1BitmapRenderTarget> snapshot;
+				if (FAILED(m_pRenderTarget->CreateCompatibleRenderTarget(&snapshot))) return false;
+				snapshot->BeginDraw();
+				OnDrawWidget(snapshot.Get());
+				for (auto* ov : m_overlays) {
+					((WidgetImpl*)ov)->OnDrawWidget(snapshot.Get());
+				}
+				if (FAILED(snapshot->EndDraw()) || FAILED(snapshot->GetBitmap(&m_resizeSnapshot))) return false;
+			}
+			D2D1_SIZE_F size = m_pRenderTarget->GetSize();
+			m_pRenderTarget->DrawBitmap(m_resizeSnapshot.Get(), D2D1::RectF(0, 0, size.width, size.height), 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_LINEAR);
+			return true;
+		}
+
 		void __stdcall FireEvent(const char* eventName, const char* jsonPayload) override {
 			for (const auto& h : m_handlers) {
 				if (h.eventName == eventName)
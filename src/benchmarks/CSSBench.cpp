@@ -0,0 +1,205 @@
+// CSSBench: the old LoadCSS parsing loop vs the single-pass tokenizer/parser.
+//
+// The sheet is assets/bootstrap_lite.css repeated until it is over 1 MB, with every class
+// renamed per copy (".btn" -> ".btn-17") so the registry grows like a large themed app's.
+// Both sides fill the same std::map registry StyleManager keeps.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ChronoCSSParser.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	typedef std::map<std::string, std::string> StyleProperties;
+	typedef std::map<std::string, StyleProperties> Registry;
+
+	std::string Trim(const std::string& str) {
+		size_t first = str.find_first_not_of(" \t\n\r");
+		if (std::string::npos == first) return str;
+		size_t last = str.find_last_not_of(" \t\n\r");
+		return str.substr(first, (last - first + 1));
+	}
+
+	std::vector<std::string> Split(const std::string& str, char delimiter) {
+		std::vector<std::string> tokens;
+		std::string token;
+		std::istringstream tokenStream(str);
+		while (std::getline(tokenStream, token, delimiter)) {
+			std::string trimmed = Trim(token);
+			if (!trimmed.empty()) tokens.push_back(trimmed);
+		}
+		return tokens;
+	}
+
+	// The pre-tokenizer StyleManager::LoadCSS, verbatim apart from the registry argument
+	void LegacyLoad(const std::string& cssContent, Registry& registry) {
+		std::string cleanContent;
+		cleanContent.reserve(cssContent.length());
+		for (size_t i = 0; i < cssContent.length(); ++i) {
+			if (i + 1 < cssContent.length() && cssContent[i] == '/' && cssContent[i + 1] == '*') {
+				size_t closeComment = cssContent.find("*/", i + 2);
+				if (closeComment != std::string::npos) {
+					i = closeComment + 1;
+					cleanContent += ' ';
+				}
+				else {
+					break;
+				}
+			}
+			else {
+				cleanContent += cssContent[i];
+			}
+		}
+
+		size_t pos = 0;
+		while (pos < cleanContent.length()) {
+			size_t openBrace = cleanContent.find('{', pos);
+			if (openBrace == std::string::npos) break;
+			size_t closeBrace = cleanContent.find('}', openBrace);
+			if (closeBrace == std::string::npos) break;
+
+			std::string selectorStr = cleanContent.substr(pos, openBrace - pos);
+			std::string bodyStr = cleanContent.substr(openBrace + 1, closeBrace - openBrace - 1);
+
+			StyleProperties props;
+			auto rawProps = Split(bodyStr, ';');
+			for (const auto& rawProp : rawProps) {
+				auto kv = Split(rawProp, ':');
+				if (kv.size() == 2) props[kv[0]] = kv[1];
+			}
+
+			auto selectors = Split(selectorStr, ',');
+			for (auto& sel : selectors) {
+				if (sel.size() > 0 && sel[0] == '.') sel = sel.substr(1);
+				if (sel.empty()) continue;
+				for (const auto& kv : props) registry[sel][kv.first] = kv.second;
+			}
+			pos = closeBrace + 1;
+		}
+	}
+
+	// Same registry fill as StyleManager::LoadCSS
+	void ParserLoad(const std::string& cssContent, Registry& registry, size_t* errors) {
+		CSS::StyleSheet sheet;
+		CSS::Parser::Parse(cssContent, &sheet);
+		*errors = sheet.errors.size();
+
+		std::vector<std::string_view> selectors;
+		for (const auto& rule : sheet.rules) {
+			if (!rule.atKeyword.empty() || rule.parent >= 0 || rule.declarationCount == 0) continue;
+			selectors.clear();
+			CSS::Parser::SplitList(rule.prelude, &selectors);
+			for (std::string_view sel : selectors) {
+				if (sel.size() > 0 && sel[0] == '.') sel.remove_prefix(1);
+				if (sel.empty()) continue;
+				StyleProperties& props = registry[std::string(sel)];
+				for (uint32_t i = 0; i < rule.declarationCount; ++i) {
+					const CSS::Declaration& decl = sheet.declarations[rule.firstDeclaration + i];
+					props[std::string(decl.name)] = std::string(decl.value);
+				}
+			}
+		}
+	}
+
+	bool ReadFile(const std::string& path, std::string* out) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) return false;
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		*out = buffer.str();
+		return true;
+	}
+
+	// Copy 'n' of the sheet with every ".name" selector suffixed by "-n"
+	std::string Rename(const std::string& css, int n) {
+		std::string out;
+		out.reserve(css.size() + 256);
+		std::string suffix = "-" + std::to_string(n);
+		int depth = 0;
+		for (size_t i = 0; i < css.size(); ++i) {
+			char c = css[i];
+			out += c;
+			if (c == '{') ++depth;
+			else if (c == '}' && depth > 0) --depth;
+			else if (c == '.' && depth == 0 && i + 1 < css.size() && isalpha((unsigned char)css[i + 1])) {
+				size_t end = i + 1;
+				while (end < css.size() && (isalnum((unsigned char)css[end]) || css[end] == '-' || css[end] == '_')) ++end;
+				out.append(css, i + 1, end - i - 1);
+				out += suffix;
+				i = end - 1;
+			}
+		}
+		return out;
+	}
+
+	template <typename F>
+	double Measure(int runs, F&& run) {
+		double best = 1e30;
+		for (int i = 0; i < runs; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			run();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (ms < best) best = ms;
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string base;
+	const char* paths[] = { (argc > 1) ? argv[1] : "assets/bootstrap_lite.css", "../assets/bootstrap_lite.css", "../../assets/bootstrap_lite.css" };
+	bool found = false;
+	for (const char* p : paths) {
+		if (ReadFile(p, &base)) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		printf("CSSBench: could not open assets/bootstrap_lite.css (pass its path as the first argument)\n");
+		return 1;
+	}
+
+	// 1. Build the synthetic sheet
+	std::string sheet;
+	for (int n = 0; sheet.size() < 1024 * 1024; ++n) sheet += Rename(base, n);
+
+	const int runs = 5;
+	printf("CSSBench: %.2f MB sheet from %zu byte base, best of %d runs\n", sheet.size() / (1024.0 * 1024.0), base.size(), runs);
+
+	// 2. Parse only
+	size_t rules = 0, declarations = 0;
+	double tParse = Measure(runs, [&]() {
+		CSS::StyleSheet parsed;
+		CSS::Parser::Parse(sheet, &parsed);
+		rules = parsed.rules.size();
+		declarations = parsed.declarations.size();
+	});
+	printf("  %-32s %9.2f ms  (%zu rules, %zu declarations, %.0f MB/s)\n", "tokenize + parse (views)", tParse, rules, declarations,
+		(sheet.size() / (1024.0 * 1024.0)) / (tParse / 1000.0));
+
+	// 3. Full load into the registry
+	size_t legacyClasses = 0, parserClasses = 0, errors = 0;
+	double tLegacy = Measure(runs, [&]() {
+		Registry registry;
+		LegacyLoad(sheet, registry);
+		legacyClasses = registry.size();
+	});
+	double tParser = Measure(runs, [&]() {
+		Registry registry;
+		ParserLoad(sheet, registry, &errors);
+		parserClasses = registry.size();
+	});
+	printf("  %-32s %9.2f ms  (%zu classes)\n", "legacy LoadCSS", tLegacy, legacyClasses);
+	printf("  %-32s %9.2f ms  (%zu classes, %zu parse errors)\n", "parser LoadCSS", tParser, parserClasses, errors);
+	printf("  speedup: %.2fx\n", tLegacy / tParser);
+	return 0;
+}
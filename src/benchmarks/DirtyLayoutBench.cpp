@@ -0,0 +1,203 @@
+// DirtyLayoutBench: layout passes after small changes in a 40-cell dashboard, headless.
+//
+// container -> layout -> 40 cells -> 6 labels stacked vertically; the nodes run the same
+// passes CellImpl / LayoutImpl do (resolve each label's width and height, place the labels,
+// move the ones whose rectangle changed) without windows.
+//   - one label: a label's width changes. InvalidateLayout(true) stops at the label's cell
+//     and the container's next pass runs that cell only; shown against re-running the
+//     layout's whole subtree, as a layout-level relayout does.
+//   - burst: 200 layout writes to the cells of one row within a frame. Before, every cell
+//     write re-ran the cell at once; now the writes mark the cells and one pass covers them.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kCells = 40;
+	const int kLabels = 6;
+
+	struct Counters {
+		size_t passes = 0;		// Cell passes run
+		size_t moves = 0;		// Labels whose rectangle changed
+		size_t posts = 0;		// Messages a container would post
+	};
+	Counters g_count;
+
+	PropertyHandle WidthKey() {
+		static const PropertyHandle key = PropertyAtoms::Intern("width");
+		return key;
+	}
+	PropertyHandle HeightKey() {
+		static const PropertyHandle key = PropertyAtoms::Intern("height");
+		return key;
+	}
+
+	class Label : public ContextNodeImpl {
+	public:
+		void SetWidth(const char* value) {
+			StoreProperty(WidthKey(), value);
+			InvalidateLayout(true);
+		}
+		void SetBox(int w, int h) {
+			StoreProperty(WidthKey(), std::to_string(w).c_str());
+			StoreProperty(HeightKey(), std::to_string(h).c_str());
+		}
+	};
+
+	class Cell : public ContextNodeImpl {
+	public:
+		std::vector<std::unique_ptr<Label>> labels;
+		int width = 200, height = 150;
+
+		// Like ICell::SetProperty for a layout property: synchronous before, deferred now
+		void SetLayoutProperty(const char* key, const char* value, bool deferred) {
+			StoreProperty(PropertyAtoms::Intern(key), value);
+			if (deferred) InvalidateLayout();
+			else PerformLayout();
+		}
+
+		// CellImpl::UpdateWidgets, vertical stack
+		void Pass() {
+			++g_count.passes;
+			ClearLayoutDirty();
+			int y = 0;
+			for (size_t i = 0; i < labels.size(); ++i) {
+				Label* label = labels[i].get();
+				label->ClearLayoutDirty();
+				PropertyValue v;
+				int w = (label->GetPropertyValue(WidthKey(), &v) && v.hasNumber) ? (int)v.number : width;
+				int h = (label->GetPropertyValue(HeightKey(), &v) && v.hasNumber) ? (int)v.number : 45;
+				int rect[4] = { 0, y, (std::min)(w, width), h };
+				if (placed.size() <= i) placed.resize(i + 1, { -1, -1, -1, -1 });
+				if (!std::equal(rect, rect + 4, placed[i].begin())) {
+					std::copy(rect, rect + 4, placed[i].begin());
+					++g_count.moves;
+				}
+				y += h;
+			}
+		}
+
+	protected:
+		virtual void PerformLayout() override { Pass(); }
+
+	private:
+		std::vector<std::array<int, 4>> placed;
+	};
+
+	// LayoutImpl: its cells are sized by the tracks, never by their content
+	class Grid : public ContextNodeImpl {
+	public:
+		std::vector<std::unique_ptr<Cell>> cells;
+
+		// What a resize or RefreshLayout ran: every cell again
+		void Pass() {
+			ClearLayoutDirty();
+			for (auto& cell : cells) cell->Pass();
+		}
+
+	protected:
+		virtual bool SizesToContent() override { return true; }
+		virtual void PerformLayout() override { Pass(); }
+	};
+
+	class Container : public ContextNodeImpl {
+	public:
+		Grid grid;
+
+	protected:
+		virtual bool SchedulesLayout() override { return true; }
+		virtual void OnLayoutQueued() override { ++g_count.posts; }
+		virtual void PerformLayout() override {
+			ClearLayoutDirty();
+			grid.Pass();
+		}
+	};
+
+	void Build(Container& c) {
+		c.grid.SetParentNode(&c);
+		for (int i = 0; i < kCells; ++i) {
+			c.grid.cells.emplace_back(new Cell());
+			Cell* cell = c.grid.cells.back().get();
+			cell->SetParentNode(&c.grid);
+			for (int l = 0; l < kLabels; ++l) {
+				cell->labels.emplace_back(new Label());
+				cell->labels.back()->SetBox(180, 24);
+				cell->labels.back()->SetParentNode(cell);
+			}
+		}
+		c.grid.Pass();
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 200;
+	if (runs <= 0) runs = 200;
+
+	Container container;
+	Build(container);
+	Label* label = container.grid.cells[17]->labels[2].get();
+
+	// 1. One label's width, back and forth so every change moves it
+	double tFull = 1e30, tDirty = 1e30;
+	Counters full, dirty;
+	for (int r = 0; r < runs; ++r) {
+		g_count = Counters();
+		auto start = std::chrono::steady_clock::now();
+		label->SetBox(120, 24);
+		container.grid.Pass();
+		tFull = (std::min)(tFull, Elapsed(start));
+		full = g_count;
+
+		g_count = Counters();
+		start = std::chrono::steady_clock::now();
+		label->SetWidth("180");
+		container.RunLayoutPass();
+		tDirty = (std::min)(tDirty, Elapsed(start));
+		dirty = g_count;
+	}
+
+	printf("DirtyLayoutBench: %d cells x %d labels, best of %d runs\n", kCells, kLabels, runs);
+	printf("  one label resized\n");
+	printf("    %-24s %9.4f ms  (%zu cell passes, %zu label moves)\n", "whole subtree", tFull, full.passes, full.moves);
+	printf("    %-24s %9.4f ms  (%zu cell passes, %zu label moves)\n", "dirty roots", tDirty, dirty.passes, dirty.moves);
+
+	// 2. A burst of cell writes within one frame: 200 writes over the 8 cells of a row
+	const int kWrites = 200;
+	double tSync = 1e30, tDeferred = 1e30;
+	Counters sync, deferred;
+	for (int r = 0; r < runs; ++r) {
+		g_count = Counters();
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kWrites; ++i) container.grid.cells[i % 8]->SetLayoutProperty("padding", (i & 1) ? "4" : "2", false);
+		tSync = (std::min)(tSync, Elapsed(start));
+		sync = g_count;
+
+		g_count = Counters();
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kWrites; ++i) container.grid.cells[i % 8]->SetLayoutProperty("padding", (i & 1) ? "4" : "2", true);
+		container.RunLayoutPass();
+		tDeferred = (std::min)(tDeferred, Elapsed(start));
+		deferred = g_count;
+	}
+
+	printf("  %d cell writes in a frame\n", kWrites);
+	printf("    %-24s %9.4f ms  (%zu cell passes)\n", "pass per write", tSync, sync.passes);
+	printf("    %-24s %9.4f ms  (%zu cell passes, %zu posted message)\n", "one pass per frame", tDeferred, deferred.passes, deferred.posts);
+	printf("  speedup: %.1fx (one label), %.1fx (burst)\n", tFull / tDirty, tSync / tDeferred);
+	return 0;
+}
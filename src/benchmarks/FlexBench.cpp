@@ -0,0 +1,164 @@
+// FlexBench: a 60-button command bar resized from 300 to 1600 px and back, solved headless.
+//
+// Buttons are 32-96 px wide, every fifth one "auto" (a share of the free space, 40 px at
+// least), with a 1 px gap; the bar hides what does not fit behind a 20 px overflow button.
+//   - per-resize: what CellImpl::UpdateWidgets did before, per resize: re-read every
+//     button's width text, measure the overflow in one pass, allocate the visible / overflow
+//     lists and lay the visible buttons out in a second pass
+//   - flex: Layout::Flex::Overflow + Solve over the cached items (what LayoutFlex runs);
+//     no allocation once the item count is stable
+// Also shown: a 60-item wrapping row, and how many rectangles a 1 px resize changes.
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kButtons = 60;
+	const int kHeight = 32;
+	const int kReserve = 20;
+
+	// The width property of each button, as text
+	std::vector<std::string> Widths() {
+		std::vector<std::string> widths;
+		for (int i = 0; i < kButtons; ++i) widths.push_back((i % 5 == 4) ? "auto" : std::to_string(32 + (i * 17) % 65));
+		return widths;
+	}
+
+	// Old behaviour: measure, then place, re-reading the texts each time
+	size_t Reparse(const std::vector<std::string>& widths, int width, std::vector<int>* xs) {
+		std::vector<std::string> texts = widths;		// GetProperty copies
+		std::vector<int> visible, overflow;
+		int used = 0;
+		for (int i = 0; i < kButtons; ++i) {
+			int w = (texts[i] == "auto") ? 40 : atoi(texts[i].c_str());
+			int limit = (!overflow.empty() || used + w + 4 + 40 > width) ? width - 44 : width;
+			if (overflow.empty() && used + w <= limit) {
+				visible.push_back(i);
+				used += w + 4;
+			}
+			else overflow.push_back(i);
+		}
+
+		std::vector<int> sizes;
+		std::vector<bool> autos;
+		int total = 0, autoCount = 0;
+		for (int i : visible) {
+			bool isAuto = (texts[i] == "auto");
+			sizes.push_back(isAuto ? 0 : atoi(texts[i].c_str()));
+			autos.push_back(isAuto);
+			total += sizes.back() + 1;
+			autoCount += isAuto;
+		}
+		int share = (autoCount && width > total) ? (width - total) / autoCount : 0;
+		xs->clear();
+		int x = 0;
+		for (size_t k = 0; k < sizes.size(); ++k) {
+			xs->push_back(x);
+			x += (autos[k] ? share : sizes[k]) + 1;
+		}
+		return overflow.size();
+	}
+
+	void Build(Layout::Flex& flex, const std::vector<std::string>& widths) {
+		flex.items.assign(kButtons + 1, Layout::FlexItem());
+		for (int i = 0; i < kButtons; ++i) {
+			Layout::FlexItem& item = flex.items[i];
+			item.crossContent = kHeight;
+			if (widths[i] == "auto") {
+				item.basis = 0;
+				item.minMain = 40;
+				item.grow = 1.0f;
+			}
+			else item.content = atoi(widths[i].c_str());
+		}
+		flex.gap = 1;
+	}
+
+	// LayoutFlex, command bar branch
+	size_t SolveBar(Layout::Flex& flex, int width) {
+		for (int i = 0; i < kButtons; ++i) flex.items[i].hidden = false;
+		Layout::FlexItem& button = flex.items[kButtons];
+		button.basis = button.content = kReserve;
+		button.shrink = 0.0f;
+		button.order = INT_MAX;
+		button.hidden = true;
+		size_t hidden = flex.Overflow(width, kReserve + flex.gap);
+		button.hidden = (hidden == 0);
+		flex.Solve(0, 0, width, kHeight);
+		return hidden;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	volatile size_t g_sink = 0;
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+
+	std::vector<std::string> widths = Widths();
+	std::vector<int> steps;
+	for (int w = 300; w <= 1600; ++w) steps.push_back(w);
+	for (int w = 1600; w >= 300; --w) steps.push_back(w);
+
+	Layout::Flex bar;
+	Build(bar, widths);
+	SolveBar(bar, 800);
+
+	// 1. Command bar resize
+	double tReparse = 1e30, tFlex = 1e30;
+	size_t moves = 0;
+	std::vector<int> xs;
+	for (int r = 0; r < runs; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int w : steps) g_sink = g_sink + Reparse(widths, w, &xs);
+		tReparse = (std::min)(tReparse, Elapsed(start));
+
+		moves = 0;
+		start = std::chrono::steady_clock::now();
+		for (int w : steps) {
+			g_sink = g_sink + SolveBar(bar, w);
+			moves += bar.Changed().size();
+		}
+		tFlex = (std::min)(tFlex, Elapsed(start));
+	}
+
+	size_t n = steps.size();
+	printf("FlexBench: %d-button command bar, %zu resize steps, best of %d runs\n", kButtons, n, runs);
+	printf("  %-30s %9.3f ms  (%.2f us per resize)\n", "per-resize re-read", tReparse, tReparse * 1000.0 / n);
+	printf("  %-30s %9.3f ms  (%.2f us per resize)\n", "Flex::Overflow + Solve", tFlex, tFlex * 1000.0 / n);
+	printf("  %-30s %9.1f  (of %d rects)\n", "rects changed per resize", (double)moves / n, kButtons + 1);
+
+	// 2. The same buttons as a wrapping row, same resize
+	Layout::Flex wrapped;
+	Build(wrapped, widths);
+	wrapped.items.pop_back();
+	wrapped.wrap = true;
+	wrapped.crossGap = 4;
+	wrapped.alignContent = Layout::Align::Start;
+	double tWrap = 1e30;
+	for (int r = 0; r < runs; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int w : steps) wrapped.Solve(0, 0, w, 2000);
+		tWrap = (std::min)(tWrap, Elapsed(start));
+	}
+	printf("  %-30s %9.3f ms  (%.2f us per resize)\n", "wrapping row, Solve", tWrap, tWrap * 1000.0 / n);
+
+	// 3. A 1 px resize of a bar that fits: only the auto buttons and what follows them move
+	SolveBar(bar, 3999);
+	SolveBar(bar, 4000);
+	printf("  1 px resize of a fitting bar: %zu of %d rects changed\n", bar.Changed().size(), kButtons + 1);
+	return 0;
+}
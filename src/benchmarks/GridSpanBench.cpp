@@ -0,0 +1,170 @@
+// GridSpanBench: one settings form laid out as a single grid with spans and auto tracks,
+// against the nested layouts the same form needed without them. Headless.
+//
+// The form: a title across the top, eight rows of two label / field pairs, a notes field
+// three columns wide and three rows tall, and a button strip across the bottom.
+//   - nested: root (title / body / buttons) -> body (fields / notes) -> fields 8 x 4 and
+//     notes 1 x 2 -> the notes column split again (3 x 1) for its height; every slot a
+//     window, fixed-pixel tracks where a content size was wanted
+//   - flat: one 12 x 4 grid, label columns and title / button rows "auto", field columns
+//     "1fr", the title, notes and buttons spanning; a window per cell, none for empty slots
+// Shown per resize step (width 600 -> 1400 px): solver time and windows moved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kFieldRows = 8;
+
+	Layout::Track Fixed(float px) {
+		Layout::Track t;
+		t.size = { Layout::Unit::Pixels, px };
+		return t;
+	}
+	Layout::Track Auto() {
+		Layout::Track t;
+		t.size = { Layout::Unit::Auto, 0.0f };
+		return t;
+	}
+	Layout::Track Fill(float weight = 1.0f) {
+		Layout::Track t;
+		t.size = { Layout::Unit::Fill, weight };
+		return t;
+	}
+
+	// A grid placed inside one cell of its parent
+	struct Nested {
+		Layout::Grid grid;
+		int parent;		// Index into the parent's Rects(), -1 for the root
+		int parentGrid;
+	};
+
+	void BuildNested(std::vector<Nested>& levels) {
+		levels.resize(5);
+		Layout::Grid& root = levels[0].grid;
+		root.rows = { Fixed(40), Fill(), Fixed(44) };
+		root.cols = { Fill() };
+		levels[0].parent = -1;
+		levels[0].parentGrid = -1;
+
+		Layout::Grid& body = levels[1].grid;
+		body.rows = { Fixed(kFieldRows * 28.0f), Fill() };
+		body.cols = { Fill() };
+		levels[1].parent = (int)root.CellIndex(1, 0);
+		levels[1].parentGrid = 0;
+
+		Layout::Grid& fields = levels[2].grid;
+		fields.rows.assign(kFieldRows, Fixed(28));
+		fields.cols = { Fixed(120), Fill(), Fixed(120), Fill() };
+		levels[2].parent = (int)body.CellIndex(0, 0);
+		levels[2].parentGrid = 1;
+
+		Layout::Grid& notes = levels[3].grid;
+		notes.rows = { Fill() };
+		notes.cols = { Fixed(120), Fill() };
+		levels[3].parent = (int)body.CellIndex(1, 0);
+		levels[3].parentGrid = 1;
+
+		Layout::Grid& notesField = levels[4].grid;
+		notesField.rows = { Fill(), Fill(), Fill() };
+		notesField.cols = { Fill() };
+		levels[4].parent = (int)notes.CellIndex(0, 1);
+		levels[4].parentGrid = 3;
+	}
+
+	size_t SolveNested(std::vector<Nested>& levels, int w, int h) {
+		size_t moves = 0;
+		for (Nested& level : levels) {
+			if (level.parent < 0) level.grid.Solve(0, 0, w, h);
+			else {
+				const Layout::Rect& r = levels[level.parentGrid].grid.Rects()[level.parent];
+				level.grid.Solve(r.x, r.y, r.w, r.h);
+			}
+			moves += level.grid.Changed().size();
+		}
+		return moves;
+	}
+
+	size_t NestedWindows(const std::vector<Nested>& levels) {
+		size_t windows = 0;
+		for (const Nested& level : levels) windows += level.grid.rows.size() * level.grid.cols.size();
+		return windows;
+	}
+
+	void BuildFlat(Layout::Grid& g) {
+		// Title, field rows, three notes rows, buttons
+		g.rows.push_back(Auto());
+		for (int r = 0; r < kFieldRows; ++r) g.rows.push_back(Auto());
+		for (int r = 0; r < 3; ++r) g.rows.push_back(Fill());
+		g.rows.push_back(Auto());
+		g.cols = { Auto(), Fill(), Auto(), Fill() };
+
+		g.areas.push_back({ 0, 0, 1, 4, 300, 40 });
+		for (int r = 1; r <= kFieldRows; ++r) {
+			for (int c = 0; c < 4; ++c) {
+				bool label = (c % 2 == 0);
+				g.areas.push_back({ r, c, 1, 1, label ? 90 + (r * 7) % 30 : 160, 28 });
+			}
+		}
+		int notes = kFieldRows + 1;
+		g.areas.push_back({ notes, 0, 1, 1, 80, 28 });
+		g.areas.push_back({ notes, 1, 3, 3, 200, 90 });
+		g.areas.push_back({ notes + 3, 0, 1, 4, 240, 44 });
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+	const int height = 700;
+
+	std::vector<Nested> nested;
+	BuildNested(nested);
+	Layout::Grid flat;
+	BuildFlat(flat);
+
+	double tNested = 1e30, tFlat = 1e30;
+	size_t movesNested = 0, movesFlat = 0;
+	int steps = 0;
+	for (int r = 0; r < runs; ++r) {
+		movesNested = movesFlat = 0;
+		steps = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int w = 600; w <= 1400; ++w) movesNested += SolveNested(nested, w, height);
+		tNested = (std::min)(tNested, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int w = 600; w <= 1400; ++w, ++steps) {
+			flat.Solve(0, 0, w, height);
+			movesFlat += flat.Changed().size();
+		}
+		tFlat = (std::min)(tFlat, Elapsed(start));
+	}
+
+	printf("GridSpanBench: settings form, %d resize steps, best of %d runs\n", steps, runs);
+	printf("  %-26s %3zu windows, %zu grids\n", "nested layouts", NestedWindows(nested), nested.size());
+	printf("  %-26s %3zu windows, 1 grid\n", "spans + auto tracks", flat.areas.size());
+	printf("  %-26s %9.3f ms  (%.2f us per step, %.1f moves per step)\n", "nested, solve", tNested, tNested * 1000.0 / steps, (double)movesNested / steps);
+	printf("  %-26s %9.3f ms  (%.2f us per step, %.1f moves per step)\n", "flat, solve", tFlat, tFlat * 1000.0 / steps, (double)movesFlat / steps);
+
+	// Empty slots: a 6 x 4 dashboard with 9 tiles used to create all 24 cell windows
+	Layout::Grid dash;
+	dash.rows.assign(6, Fill());
+	dash.cols.assign(4, Fill());
+	for (int i = 0; i < 9; ++i) dash.areas.push_back({ (i * 5) % 6, (i * 3) % 4, 1, 1, 0, 0 });
+	dash.Solve(0, 0, 1200, 800);
+	printf("  6 x 4 dashboard, 9 tiles: %zu windows (was %zu)\n", dash.areas.size(), dash.rows.size() * dash.cols.size());
+	printf("  label column width: %d px (widest label)\n", flat.ColSpans()[0].size);
+	return 0;
+}
@@ -0,0 +1,121 @@
+// InheritBench: parent-chain walk vs flattened inheritance snapshots.
+//
+// The chain copies the LayoutTester example: controller -> container -> root layout ->
+// workspace cell -> workspace layout -> canvas cell -> (split layout -> cell) x N ->
+// wrapper layout -> content cell -> widget. Each canvas split adds two levels.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kThemeKeys[] = {
+		"background-color", "foreground-color", "border-color", "border-radius",
+		"font-family", "font-size", "font-style", "text-align", "color", "image-align",
+	};
+	const char* kMissingKeys[] = { "margin-left", "letter-spacing" };
+
+	volatile size_t g_sink = 0; // Keeps the lookups from being optimized away
+
+	struct Tree {
+		std::vector<std::unique_ptr<ContextNodeImpl>> nodes;
+		ContextNodeImpl* canvas = nullptr;
+
+		ContextNodeImpl* Add(ContextNodeImpl* parent) {
+			nodes.emplace_back(new ContextNodeImpl());
+			if (parent) nodes.back()->SetParentNode(parent);
+			return nodes.back().get();
+		}
+		ContextNodeImpl* Leaf() { return nodes.back().get(); }
+		size_t Depth() const { return nodes.size(); }
+	};
+
+	void BuildLayoutTester(Tree& t, int splits) {
+		// 1. Controller theme (ChronoControllerImpl::SetDefaultStyles subset)
+		ContextNodeImpl* n = t.Add(nullptr);
+		for (const char* k : kThemeKeys) n->SetProperty(k, "#333333");
+
+		// 2. Container, root layout, workspace cell, workspace layout, canvas cell
+		n = t.Add(n);
+		n = t.Add(n);
+		n = t.Add(n);
+		n = t.Add(n);
+		t.canvas = n = t.Add(n);
+		n->SetProperty("background-color", "#808080");
+		n->SetProperty("padding", "20");
+
+		// 3. Nested splits
+		for (int i = 0; i < splits; ++i) {
+			n = t.Add(n);
+			n = t.Add(n);
+		}
+
+		// 4. Wrapper layout, content cell, widget
+		n = t.Add(n);
+		n = t.Add(n);
+		n = t.Add(n);
+		n->SetProperty("title", "Layout Cell");
+		n->SetProperty("width", "100%");
+		n->SetProperty("height", "100%");
+	}
+
+	template <typename F>
+	double Measure(int frames, F&& frame) {
+		size_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; ++i) checksum += frame(i);
+		auto end = std::chrono::steady_clock::now();
+		g_sink = checksum;
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int frames = (argc > 1) ? atoi(argv[1]) : 200000;
+	if (frames <= 0) frames = 200000;
+
+	std::vector<PropertyHandle> handles;
+	for (const char* k : kThemeKeys) handles.push_back(PropertyAtoms::Intern(k));
+	for (const char* k : kMissingKeys) handles.push_back(PropertyAtoms::Intern(k));
+
+	printf("InheritBench: %d frames x %zu inherited lookups (LayoutTester tree)\n", frames, handles.size());
+	printf("  %6s %6s %12s %12s %9s %16s\n", "splits", "depth", "walk ms", "snapshot ms", "speedup", "w/ change ms");
+
+	for (int splits = 0; splits <= 4; ++splits) {
+		Tree tree;
+		BuildLayoutTester(tree, splits);
+		ContextNodeImpl* leaf = tree.Leaf();
+
+		auto lookups = [&](int) {
+			size_t n = 0;
+			for (PropertyHandle h : handles) n += leaf->GetProperty(h)[0];
+			return n;
+		};
+
+		// 1. Plain chain walk
+		PropertyInheritance::EnableSnapshots(false);
+		double tWalk = Measure(frames, lookups);
+
+		// 2. Snapshots, tree unchanged
+		PropertyInheritance::EnableSnapshots(true);
+		double tSnap = Measure(frames, lookups);
+
+		// 3. Snapshots, canvas background edited every 100 frames (subtree rebuild)
+		double tChange = Measure(frames, [&](int i) {
+			if (i % 100 == 0) tree.canvas->SetProperty("background-color", ((i / 100) & 1) ? "#808080" : "#7f7f7f");
+			return lookups(i);
+		});
+
+		printf("  %6d %6zu %12.2f %12.2f %8.2fx %16.2f\n", splits, tree.Depth(), tWalk, tSnap, tWalk / tSnap, tChange);
+	}
+
+	PropertyInheritance::EnableSnapshots(false);
+	return 0;
+}
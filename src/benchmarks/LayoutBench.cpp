@@ -0,0 +1,90 @@
+// LayoutBench: a splitter drag across a 6 x 8 dashboard grid, solved headless.
+//
+// Columns: a 240 px sidebar with a splitter, then fill columns; rows: a caption row, a
+// toolbar row with a splitter, then fill rows. The sidebar splitter is dragged from 120 to
+// 620 px and back, one step per pixel.
+//   - solve: Layout::Grid::Solve per step (the track math LayoutImpl::Arrange runs)
+//   - moves: the windows the Win32 side repositions per step. Before the solver reported
+//     changed rectangles every cell and splitter bar was moved (and the whole window
+//     repainted synchronously) each time; now only Changed() is applied.
+// Also shown: how much of the grid a height-only resize moves.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kRows = 6;
+	const int kCols = 8;
+
+	void Build(Layout::Grid& g) {
+		g.rows.assign(kRows, Layout::Track());
+		g.cols.assign(kCols, Layout::Track());
+		g.rows[0].size = { Layout::Unit::System, 0.0f };
+		g.rows[0].system = 31;
+		g.rows[1].size = { Layout::Unit::Pixels, 48.0f };
+		g.rows[1].splitter = true;
+		g.cols[0].size = { Layout::Unit::Pixels, 240.0f };
+		g.cols[0].min = { Layout::Unit::Pixels, 120.0f };
+		g.cols[0].splitter = true;
+		for (int c = 1; c < kCols; ++c) g.cols[c].min = { Layout::Unit::Percent, 5.0f };
+		g.cols[kCols - 1].size = { Layout::Unit::Fill, 2.0f };
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	volatile int g_sink = 0;
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+
+	const int width = 1600, height = 900;
+	Layout::Grid grid;
+	Build(grid);
+	grid.dpi = 144;
+	grid.Solve(0, 0, width, height);
+
+	// One drag: out to 620 px and back, the splitter following the pointer
+	std::vector<int> pointer;
+	for (int x = 120; x <= 620; ++x) pointer.push_back(x * grid.dpi / 96);
+	for (int x = 620; x >= 120; --x) pointer.push_back(x * grid.dpi / 96);
+
+	double tSolve = 1e30;
+	size_t moves = 0;
+	for (int r = 0; r < runs; ++r) {
+		moves = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int p : pointer) {
+			grid.cols[0].size = { Layout::Unit::Pixels, grid.DragCol(0, p) };
+			grid.Solve(0, 0, width, height);
+			moves += grid.Changed().size();
+		}
+		tSolve = (std::min)(tSolve, Elapsed(start));
+		g_sink = grid.ColSpans()[0].size;
+	}
+
+	size_t rects = grid.Rects().size();
+	size_t windows = kRows * kCols;
+	for (const Layout::Track& t : grid.rows) windows += t.splitter;
+	for (const Layout::Track& t : grid.cols) windows += t.splitter;
+	size_t steps = pointer.size();
+	printf("LayoutBench: %dx%d grid, %zu drag steps, best of %d runs\n", kRows, kCols, steps, runs);
+	printf("  %-30s %9.3f ms  (%.2f us per step)\n", "Grid::Solve + DragCol", tSolve, tSolve * 1000.0 / steps);
+	printf("  %-30s %9zu  (every cell and bar, each step)\n", "window moves, all windows", windows * steps);
+	printf("  %-30s %9zu  (%.1f per step)\n", "window moves, changed only", moves, (double)moves / steps);
+
+	// A height-only resize: the rows below the fixed ones and the full-height bars move
+	grid.Solve(0, 0, width, height + 40);
+	printf("  height-only resize: %zu of %zu rects changed\n", grid.Changed().size(), rects);
+	return 0;
+}
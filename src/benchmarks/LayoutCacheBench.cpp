@@ -0,0 +1,161 @@
+// LayoutCacheBench: layout passes that come back to a box they had before, headless.
+//
+// An editor shell (toolbar / sidebar, editor, inspector / status bar) as a 3 x 3 grid with
+// auto, fixed and fill tracks, splitters and spanning cells:
+//   - maximize / restore: the window toggles between 1920 x 1040 and 1200 x 800
+//   - splitter: the sidebar splitter goes back and forth between three positions
+// each solved every time (Grid::Solve) and through the solve cache keyed on the box and
+// Grid::Signature() (what LayoutImpl::Arrange runs). Also shown: a 60-button command bar
+// (CellImpl::LayoutFlex) toggled between two widths, with and without a SolveCache.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kToggles = 20000;
+
+	Layout::Track Track(Layout::Unit unit, float value, bool splitter = false) {
+		Layout::Track t;
+		t.size = { unit, value };
+		t.splitter = splitter;
+		return t;
+	}
+
+	void BuildShell(Layout::Grid& g) {
+		g.rows = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1, true), Track(Layout::Unit::Pixels, 24) };
+		g.cols = { Track(Layout::Unit::Pixels, 260, true), Track(Layout::Unit::Fill, 1, true), Track(Layout::Unit::Percent, 22) };
+		g.cols[0].min = { Layout::Unit::Pixels, 120 };
+		g.cols[2].min = { Layout::Unit::Auto, 0 };
+		g.areas.push_back({ 0, 0, 1, 3, 900, 36 });		// Toolbar
+		g.areas.push_back({ 1, 0, 1, 1, 0, 0 });		// Sidebar
+		g.areas.push_back({ 1, 1, 1, 1, 0, 0 });		// Editor
+		g.areas.push_back({ 1, 2, 1, 1, 180, 0 });		// Inspector
+		g.areas.push_back({ 2, 0, 1, 3, 0, 20 });		// Status bar
+	}
+
+	struct Box {
+		int w, h;
+	};
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	volatile size_t g_sink = 0;
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 10;
+	if (runs <= 0) runs = 10;
+
+	const Box boxes[2] = { { 1920, 1040 }, { 1200, 800 } };
+	const float sidebar[3] = { 260.0f, 420.0f, 180.0f };
+
+	// 1. Maximize / restore
+	Layout::Grid solved, cached;
+	BuildShell(solved);
+	BuildShell(cached);
+	double tSolve = 1e30, tCached = 1e30;
+	size_t movesSolve = 0, movesCached = 0;
+	for (int r = 0; r < runs; ++r) {
+		movesSolve = movesCached = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			const Box& b = boxes[i & 1];
+			solved.Solve(0, 0, b.w, b.h);
+			movesSolve += solved.Changed().size();
+		}
+		tSolve = (std::min)(tSolve, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			const Box& b = boxes[i & 1];
+			cached.Solve(0, 0, b.w, b.h, cached.Signature());
+			movesCached += cached.Changed().size();
+		}
+		tCached = (std::min)(tCached, Elapsed(start));
+	}
+
+	printf("LayoutCacheBench: editor shell, 3 x 3 grid, %d passes, best of %d runs\n", kToggles, runs);
+	printf("  maximize / restore\n");
+	printf("    %-22s %9.3f ms  (%.3f us per pass, %.1f moves per pass)\n", "solve", tSolve, tSolve * 1000.0 / kToggles, (double)movesSolve / kToggles);
+	printf("    %-22s %9.3f ms  (%.3f us per pass, %.1f moves per pass)\n", "solve cache", tCached, tCached * 1000.0 / kToggles, (double)movesCached / kToggles);
+
+	// 2. The sidebar splitter back and forth between three positions
+	uint64_t hits = cached.CacheHits(), misses = cached.CacheMisses();
+	tSolve = tCached = 1e30;
+	for (int r = 0; r < runs; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			solved.cols[0].size.value = sidebar[i % 3];
+			solved.Solve(0, 0, 1920, 1040);
+			g_sink = g_sink + solved.Changed().size();
+		}
+		tSolve = (std::min)(tSolve, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			cached.cols[0].size.value = sidebar[i % 3];
+			cached.Solve(0, 0, 1920, 1040, cached.Signature());
+			g_sink = g_sink + cached.Changed().size();
+		}
+		tCached = (std::min)(tCached, Elapsed(start));
+	}
+	printf("  splitter, three positions\n");
+	printf("    %-22s %9.3f ms  (%.3f us per pass)\n", "solve", tSolve, tSolve * 1000.0 / kToggles);
+	printf("    %-22s %9.3f ms  (%.3f us per pass)\n", "solve cache", tCached, tCached * 1000.0 / kToggles);
+	printf("    cache: %llu hits, %llu misses\n", (unsigned long long)(cached.CacheHits() - hits), (unsigned long long)(cached.CacheMisses() - misses));
+
+	// Replays match a fresh solve
+	bool same = true;
+	for (int i = 0; i < 6; ++i) {
+		solved.cols[0].size.value = cached.cols[0].size.value = sidebar[i % 3];
+		solved.Solve(0, 0, boxes[i & 1].w, boxes[i & 1].h);
+		cached.Solve(0, 0, boxes[i & 1].w, boxes[i & 1].h, cached.Signature());
+		same = same && (solved.Rects() == cached.Rects());
+	}
+	printf("  replayed rectangles match a solve: %s\n", same ? "yes" : "NO");
+
+	// 3. A command bar toggled between two widths
+	Layout::Flex bar;
+	bar.items.assign(60, Layout::FlexItem());
+	for (int i = 0; i < 60; ++i) {
+		bar.items[i].content = 32 + (i * 17) % 65;
+		bar.items[i].crossContent = 32;
+		if (i % 5 == 4) bar.items[i].grow = 1.0f;
+	}
+	bar.gap = 1;
+	Layout::SolveCache<std::vector<Layout::Rect>> barCache;
+	const int barWidths[2] = { 4800, 3600 };
+	double tFlex = 1e30, tFlexCached = 1e30;
+	for (int r = 0; r < runs; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			bar.Solve(0, 0, barWidths[i & 1], 32);
+			g_sink = g_sink + bar.Rects().size();
+		}
+		tFlex = (std::min)(tFlex, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kToggles; ++i) {
+			const std::vector<Layout::Rect>* rects = barCache.Find(0, 0, barWidths[i & 1], 32, 0);
+			if (!rects) {
+				bar.Solve(0, 0, barWidths[i & 1], 32);
+				rects = &(barCache.Store(0, 0, barWidths[i & 1], 32, 0) = bar.Rects());
+			}
+			g_sink = g_sink + rects->size();
+		}
+		tFlexCached = (std::min)(tFlexCached, Elapsed(start));
+	}
+	printf("  60-button command bar, two widths\n");
+	printf("    %-22s %9.3f ms  (%.3f us per pass)\n", "Flex::Solve", tFlex, tFlex * 1000.0 / kToggles);
+	printf("    %-22s %9.3f ms  (%.3f us per pass, %llu hits, %llu misses)\n", "solve cache", tFlexCached, tFlexCached * 1000.0 / kToggles, (unsigned long long)barCache.Hits(), (unsigned long long)barCache.Misses());
+	return same ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// LengthBench: resolving widths and heights of 5,000 widgets, as one layout pass does.
+//
+//   - legacy: the CellImpl::ParseCssDimension way, GetProperty then substr / std::stof on
+//     every pass ("200px", "25%", "120")
+//   - compiled: GetPropertyValue returns the length compiled on write and Lengths::Resolve
+//     evaluates it (same values)
+//   - calc(): the same pass when every width is an expression such as
+//     "clamp(80px, calc(50% - 2em), 20vw)", which the legacy parser cannot read at all
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kWidths[] = { "200px", "25%", "120", "48lu" };
+	const char* kHeights[] = { "32px", "10%", "45", "auto" };
+	const char* kExpressions[] = { "calc(100% - 20px)", "clamp(80px, calc(50% - 2em), 20vw)", "min(25%, 300px)", "max(10vh, 3rem)" };
+
+	class Node : public ContextNodeImpl {};
+
+	// The pre-compiled-length parser, kept here for comparison (DPI scaling as a plain multiply)
+	int ParseCssDimension(const std::string& input, int refTotalSize, float dpiScale) {
+		if (input.empty()) return -1;
+
+		std::string val = input;
+		bool isPercent = false;
+
+		if (val == "auto")
+			return refTotalSize;
+
+		if (val.back() == '%') {
+			isPercent = true;
+			val.pop_back();
+		}
+		else if (val.length() > 2) {
+			std::string suffix = val.substr(val.length() - 2);
+			if (suffix == "px" || suffix == "lu") {
+				val = val.substr(0, val.length() - 2);
+			}
+		}
+
+		try {
+			float fVal = std::stof(val);
+			if (isPercent) return (int)(refTotalSize * (fVal / 100.0f));
+			return (int)((int)fVal * dpiScale);
+		}
+		catch (...) {
+			return -1;
+		}
+	}
+
+	int Resolve(IContextNode* node, PropertyHandle key, const LengthContext& base, int ref) {
+		PropertyValue v;
+		if (!node->GetPropertyValue(key, &v)) return -1;
+		if (v.type == PropertyType::String && strcmp(v.text, "auto") == 0) return ref;
+		LengthContext context = base;
+		context.percentBase = (float)ref;
+		float px;
+		return Lengths::Resolve(v, context, &px) ? (int)std::floor(px + 0.5f) : -1;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	template <typename F>
+	double Best(int runs, F&& run) {
+		double best = 1e30;
+		for (int i = 0; i < runs; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			run();
+			best = (std::min)(best, Elapsed(start));
+		}
+		return best;
+	}
+
+	volatile long long g_sink = 0;
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+
+	const int count = 5000;
+	const int parentW = 1280, parentH = 720;
+	const PropertyHandle kWidth = PropertyAtoms::Intern("width");
+	const PropertyHandle kHeight = PropertyAtoms::Intern("height");
+	LengthContext context = { 0.0f, 1.0f, 1920.0f, 1080.0f, 12.0f, 12.0f };
+
+	Node cell;
+	cell.SetProperty("font-size", "12");
+	std::vector<std::unique_ptr<Node>> widgets, calcWidgets;
+	for (int i = 0; i < count; ++i) {
+		widgets.emplace_back(new Node());
+		widgets.back()->SetParentNode(&cell);
+		widgets.back()->SetProperty(kWidth, kWidths[i % 4]);
+		widgets.back()->SetProperty(kHeight, kHeights[i % 4]);
+
+		calcWidgets.emplace_back(new Node());
+		calcWidgets.back()->SetParentNode(&cell);
+		calcWidgets.back()->SetProperty(kWidth, kExpressions[i % 4]);
+		calcWidgets.back()->SetProperty(kHeight, kHeights[i % 4]);
+	}
+
+	// 1. Both paths agree on everything the legacy parser understands
+	size_t mismatches = 0;
+	for (auto& w : widgets) {
+		mismatches += ParseCssDimension(w->GetProperty("width", ""), parentW, 1.0f) != Resolve(w.get(), kWidth, context, parentW);
+		mismatches += ParseCssDimension(w->GetProperty("height", ""), parentH, 1.0f) != Resolve(w.get(), kHeight, context, parentH);
+	}
+
+	double tLegacy = Best(runs, [&]() {
+		long long sum = 0;
+		for (auto& w : widgets) {
+			sum += ParseCssDimension(w->GetProperty("width", ""), parentW, 1.0f);
+			sum += ParseCssDimension(w->GetProperty("height", ""), parentH, 1.0f);
+		}
+		g_sink = sum;
+	});
+	double tCompiled = Best(runs, [&]() {
+		long long sum = 0;
+		for (auto& w : widgets) {
+			sum += Resolve(w.get(), kWidth, context, parentW);
+			sum += Resolve(w.get(), kHeight, context, parentH);
+		}
+		g_sink = sum;
+	});
+	double tCalc = Best(runs, [&]() {
+		long long sum = 0;
+		for (auto& w : calcWidgets) {
+			sum += Resolve(w.get(), kWidth, context, parentW);
+			sum += Resolve(w.get(), kHeight, context, parentH);
+		}
+		g_sink = sum;
+	});
+
+	printf("LengthBench: %d widgets, width + height per widget, best of %d runs\n", count, runs);
+	printf("  %-30s %9.3f ms\n", "legacy substr + stof", tLegacy);
+	printf("  %-30s %9.3f ms  (%zu mismatches)\n", "compiled on write", tCompiled, mismatches);
+	printf("  speedup: %.2fx\n", tLegacy / tCompiled);
+	printf("  %-30s %9.3f ms  (calc / min / max / clamp widths)\n", "compiled expressions", tCalc);
+	return 0;
+}
@@ -0,0 +1,118 @@
+// LiveResizeBench: one second of a splitter drag over a dashboard of 30 gauges, headless.
+//
+// root 1 x 2 (sidebar | dashboard, a splitter between) -> dashboard 6 x 5 gauges. The mouse
+// reports 1000 moves a second while the sidebar grows from 200 to 500 px; frames are 60 Hz.
+//   - per move: what LayoutImpl::OnSplitter did before, a pass per mouse move, and every
+//     gauge whose rectangle changed drawn again
+//   - live resize: the moves only mark the drag pending and each frame lays out once
+//     (LayoutImpl::OnAnimationFrame); gauges opted into StretchesWhileResizing draw once
+//     and stretch that snapshot, then the release draws everything once at full quality
+// Shown: passes, full draws and stretched draws, and the time the passes took.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kRows = 6, kCols = 5;
+	const int kMoves = 1000;			// One second of mouse input
+	const double kFrameMs = 1000.0 / 60.0;
+
+	Layout::Track Track(Layout::Unit unit, float value, bool splitter = false) {
+		Layout::Track t;
+		t.size = { unit, value };
+		t.splitter = splitter;
+		return t;
+	}
+
+	struct Dashboard {
+		Layout::Grid root, gauges;
+		std::vector<bool> snapshot;		// Per gauge: drawn once this drag, stretched since
+
+		Dashboard() {
+			root.rows = { Track(Layout::Unit::Fill, 1) };
+			root.cols = { Track(Layout::Unit::Pixels, 200, true), Track(Layout::Unit::Fill, 1) };
+			gauges.rows.assign(kRows, Track(Layout::Unit::Fill, 1));
+			gauges.cols.assign(kCols, Track(Layout::Unit::Fill, 1));
+			snapshot.assign(kRows * kCols, false);
+			Pass(nullptr);
+		}
+
+		// One layout pass; returns the gauges it resized
+		size_t Pass(size_t* passes) {
+			if (passes) ++*passes;
+			root.Solve(0, 0, 1920, 1080);
+			const Layout::Rect& r = root.Rects()[root.CellIndex(0, 1)];
+			gauges.Solve(r.x, r.y, r.w, r.h);
+			return gauges.Changed().size();
+		}
+	};
+
+	struct Counts {
+		size_t passes = 0, draws = 0, stretched = 0;
+	};
+
+	float SidebarAt(int move) {
+		return 200.0f + 300.0f * move / (kMoves - 1);
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+
+	double tMoves = 1e30, tLive = 1e30;
+	Counts moves, live;
+	for (int r = 0; r < runs; ++r) {
+		// 1. A pass per mouse move, every resized gauge drawn
+		Dashboard a;
+		moves = Counts();
+		auto start = std::chrono::steady_clock::now();
+		for (int m = 0; m < kMoves; ++m) {
+			a.root.cols[0].size.value = SidebarAt(m);
+			moves.draws += a.Pass(&moves.passes);
+		}
+		tMoves = (std::min)(tMoves, Elapsed(start));
+
+		// 2. Live resize: a pass per frame with a pending move, snapshots stretched
+		Dashboard b;
+		live = Counts();
+		start = std::chrono::steady_clock::now();
+		bool pending = false;
+		double nextFrame = kFrameMs;
+		for (int m = 0; m < kMoves; ++m) {
+			b.root.cols[0].size.value = SidebarAt(m);
+			pending = true;
+			if (m + 1 < nextFrame) continue;
+			nextFrame += kFrameMs;
+			pending = false;
+			b.Pass(&live.passes);
+			for (uint32_t i : b.gauges.Changed()) {
+				if (b.snapshot[i]) ++live.stretched;
+				else {
+					b.snapshot[i] = true;
+					++live.draws;
+				}
+			}
+		}
+		// Release: the last position, then one full-quality draw of every gauge
+		if (pending) b.Pass(&live.passes);
+		live.draws += b.snapshot.size();
+		tLive = (std::min)(tLive, Elapsed(start));
+	}
+
+	printf("LiveResizeBench: %d x %d gauges, %d mouse moves in 1 s, 60 Hz frames, best of %d runs\n", kRows, kCols, kMoves, runs);
+	printf("  %-14s %9.3f ms  %5zu passes  %6zu full draws  %6zu stretched\n", "per move", tMoves, moves.passes, moves.draws, moves.stretched);
+	printf("  %-14s %9.3f ms  %5zu passes  %6zu full draws  %6zu stretched\n", "live resize", tLive, live.passes, live.draws, live.stretched);
+	return 0;
+}
@@ -0,0 +1,133 @@
+// MeasureBench: what measuring the widgets of a 60-button command bar costs per layout pass.
+//
+// Every button has an "auto" width, which CellImpl::LayoutFlex now sizes from the widget's
+// Measure() instead of a 40 px guess. Each resize step runs one pass, so each pass measures
+// all 60 titles:
+//   - DirectWrite per call: a text format and a text layout per title and pass, what the
+//     drawing code does for its own text
+//   - TextMetrics: the shared extent cache WidgetImpl::MeasureText goes through
+//   - Measure(): the widget's per-constraint memo in front of it (what a pass after a resize
+//     costs; the cell's copy of the answer is not even that)
+// Also shown: a title change, which drops only that widget's answers.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "WidgetImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const int kButtons = 60;
+	const int kPasses = 1300;
+
+	// A button that measures its title like Button::OnMeasure, without the image
+	class Label : public WidgetImpl {
+	public:
+		const char* __stdcall GetControlName() override { return "Label"; }
+		const char* __stdcall GetControlManifest() override {
+			return R"json({ "properties": [ { "name": "title", "type": "string", "impact": "layout" } ] })json";
+		}
+		void OnDrawWidget(ID2D1RenderTarget* pRT) override {}
+
+	protected:
+		bool OnMeasure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+			D2D1_SIZE_F text = MeasureText(GetProperty("title"), L"Segoe UI", DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, 10.0f);
+			desired->cx = (LONG)text.width + 16;
+			desired->cy = (LONG)text.height + 16;
+			return true;
+		}
+	};
+
+	std::string Title(int i) {
+		static const char* words[] = { "Open", "Save", "Save As", "Print", "Undo", "Redo", "Cut", "Copy", "Paste", "Find" };
+		return std::string(words[i % 10]) + " " + std::to_string(i);
+	}
+
+	// The drawing code's way: everything from scratch
+	LONG MeasureDirect(IDWriteFactory* factory, const std::string& title) {
+		ComPtr<IDWriteTextFormat> format;
+		factory->CreateTextFormat(L"Segoe UI", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 10.0f, L"en-us", &format);
+		std::wstring text = NarrowToWide(title);
+		ComPtr<IDWriteTextLayout> layout;
+		factory->CreateTextLayout(text.c_str(), (UINT32)text.length(), format.Get(), 1.0e6f, 1.0e6f, &layout);
+		layout->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
+		DWRITE_TEXT_METRICS m;
+		layout->GetMetrics(&m);
+		return (LONG)m.widthIncludingTrailingWhitespace + 16;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	volatile LONG g_sink = 0;
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 5;
+	if (runs <= 0) runs = 5;
+
+	std::vector<std::unique_ptr<Label>> labels;
+	std::vector<std::string> titles;
+	for (int i = 0; i < kButtons; ++i) {
+		titles.push_back(Title(i));
+		labels.emplace_back(new Label());
+		labels.back()->SetProperty("title", titles.back().c_str());
+	}
+	ComPtr<IDWriteFactory> factory = GetDWriteFactory();
+	if (!factory) {
+		printf("MeasureBench: no DirectWrite factory\n");
+		return 1;
+	}
+
+	double tDirect = 1e30, tCache = 1e30, tMemo = 1e30;
+	for (int r = 0; r < runs; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int p = 0; p < kPasses; ++p) {
+			for (const std::string& title : titles) g_sink = g_sink + MeasureDirect(factory.Get(), title);
+		}
+		tDirect = (std::min)(tDirect, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int p = 0; p < kPasses; ++p) {
+			for (const std::string& title : titles) {
+				D2D1_SIZE_F size = TextMetrics::Measure(NarrowToWide(title), L"Segoe UI", DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, 10.0f);
+				g_sink = g_sink + (LONG)size.width;
+			}
+		}
+		tCache = (std::min)(tCache, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		for (int p = 0; p < kPasses; ++p) {
+			for (auto& label : labels) {
+				SIZE size;
+				label->Measure(-1, -1, MeasureMode::Unbounded, &size);
+				g_sink = g_sink + size.cx;
+			}
+		}
+		tMemo = (std::min)(tMemo, Elapsed(start));
+	}
+
+	printf("MeasureBench: %d auto-width buttons, %d layout passes, best of %d runs\n", kButtons, kPasses, runs);
+	printf("  %-24s %9.3f ms  (%.2f us per pass)\n", "DirectWrite per call", tDirect, tDirect * 1000.0 / kPasses);
+	printf("  %-24s %9.3f ms  (%.2f us per pass)\n", "TextMetrics cache", tCache, tCache * 1000.0 / kPasses);
+	printf("  %-24s %9.3f ms  (%.2f us per pass)\n", "Measure() memo", tMemo, tMemo * 1000.0 / kPasses);
+
+	// A title change: the layout-impact key drops that widget's answers, nobody else's
+	uint64_t hits = 0, misses = 0, hitsAfter = 0, missesAfter = 0;
+	TextMetrics::GetStats(&hits, &misses);
+	labels[7]->SetProperty("title", "Save All");
+	for (auto& label : labels) {
+		SIZE size;
+		label->Measure(-1, -1, MeasureMode::Unbounded, &size);
+	}
+	TextMetrics::GetStats(&hitsAfter, &missesAfter);
+	printf("  title change, next pass: %llu text measured, %llu cache lookups\n", (unsigned long long)(missesAfter - misses), (unsigned long long)((hitsAfter - hits) + (missesAfter - misses)));
+	return 0;
+}
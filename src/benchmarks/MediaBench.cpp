@@ -0,0 +1,157 @@
+// MediaBench: dragging a window edge over a 5,000-widget container with responsive rules.
+//
+// container -> 200 cells -> 25 buttons; the sheet has three width breakpoints, and the
+// drag sends one WM_SIZE per pixel from 600 to 1800 wide.
+//   - restyle: what a resize must do when @media is not evaluated incrementally, i.e.
+//     re-match the whole tree on every WM_SIZE
+//   - UpdateMedia: evaluate the queries for the old and new size and re-match only the
+//     nodes a rule under a flipped query selects (ContainerImpl::RefreshMedia)
+// Both end with the same rule tables on every widget.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoSelectors.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kSheet =
+		"Cell { padding: 4 }"
+		".btn { width: 100%; background-color: #0d6efd; color: #ffffff }"
+		".btn:hover { background-color: #0b5ed7 }"
+		".label { color: #212529 }"
+		"@media (min-width: 768px) { .btn { width: 50% } }"
+		"@media (min-width: 1200px) { .btn { width: 33% } Cell { padding: 8 } }"
+		"@media (min-width: 1400px) { .sidebar { width: 280px } }";
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+		const MediaFeatures* GetMediaFeatures() override { return features; }
+		void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			for (Node* child : children) out->push_back(child);
+		}
+
+		MediaFeatures* features = nullptr;
+		std::vector<Node*> children;
+	private:
+		PropertyHandle m_type;
+	};
+
+	struct Tree {
+		MediaFeatures media = { 600.0f, 800.0f, 1.0f };
+		Node root{ "Container" };
+		std::vector<std::unique_ptr<Node>> nodes;
+
+		Node* Add(Node* parent, const char* type) {
+			nodes.emplace_back(new Node(type));
+			nodes.back()->SetParentNode(parent);
+			parent->children.push_back(nodes.back().get());
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		t.root.features = &t.media;
+		for (int c = 0; c < 200; ++c) {
+			Node* cell = t.Add(&t.root, "Cell");
+			for (int b = 0; b < 25; ++b) {
+				Node* button = t.Add(cell, "Button");
+				button->SetProperty("class", (b % 5 == 0) ? "label" : "btn");
+			}
+		}
+		StyleManager::RestyleTree(&t.root);
+	}
+
+	// Same rule tables on every node
+	bool Same(const Tree& a, const Tree& b) {
+		for (size_t i = 0; i < a.nodes.size(); ++i)
+			if (a.nodes[i]->GetRuleLayer() != b.nodes[i]->GetRuleLayer()) return false;
+		return true;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 3;
+	if (runs <= 0) runs = 3;
+
+	StyleManager::LoadCSS(kSheet);
+	std::string image;
+	StyleManager::CompileCSS(kSheet, &image);
+	CSS::RuleSet rules;
+	rules.LoadImage(image.data(), image.size());
+
+	Tree full, incremental;
+	Build(full);
+	Build(incremental);
+
+	const int first = 600, last = 1800;
+	double tFull = 1e30, tIncremental = 1e30;
+	size_t flips = 0, restyled = 0;
+	for (int r = 0; r < runs; ++r) {
+		// 1. Re-match everything on each WM_SIZE
+		auto start = std::chrono::steady_clock::now();
+		for (int w = first; w <= last; ++w) {
+			full.media.width = (float)w;
+			StyleManager::RestyleTree(&full.root);
+		}
+		tFull = (std::min)(tFull, Elapsed(start));
+
+		// 2. Evaluate the queries, restyle on flips
+		start = std::chrono::steady_clock::now();
+		for (int w = first; w <= last; ++w) {
+			MediaFeatures before = incremental.media;
+			incremental.media.width = (float)w;
+			StyleManager::UpdateMedia(&incremental.root, before, incremental.media);
+		}
+		tIncremental = (std::min)(tIncremental, Elapsed(start));
+
+		// Back to the start width for the next run (not timed)
+		full.media.width = incremental.media.width = (float)first;
+		StyleManager::RestyleTree(&full.root);
+		StyleManager::RestyleTree(&incremental.root);
+	}
+
+	// What the drag touched: queries that flipped, and the nodes they select
+	std::vector<uint32_t> flipped;
+	MediaFeatures before = incremental.media;
+	for (int w = first + 1; w <= last; ++w) {
+		MediaFeatures after = before;
+		after.width = (float)w;
+		flipped.clear();
+		rules.MediaChanges(before, after, &flipped);
+		if (!flipped.empty()) {
+			++flips;
+			restyled += rules.MediaAffects(flipped, &incremental.root);
+			for (auto& node : incremental.nodes) restyled += rules.MediaAffects(flipped, node.get());
+		}
+		before = after;
+	}
+	full.media.width = incremental.media.width = (float)last;
+	StyleManager::RestyleTree(&full.root);
+	before = incremental.media;
+	before.width = (float)first;
+	StyleManager::UpdateMedia(&incremental.root, before, incremental.media);
+
+	size_t steps = last - first + 1;
+	size_t nodes = full.nodes.size() + 1;
+	printf("MediaBench: %zu nodes, %zu WM_SIZE steps (%d..%d px), best of %d runs\n", nodes, steps, first, last, runs);
+	printf("  %-30s %9.2f ms  (%zu nodes re-matched)\n", "restyle tree per WM_SIZE", tFull, nodes * steps);
+	printf("  %-30s %9.2f ms  (%zu flips, %zu nodes re-matched)\n", "UpdateMedia per WM_SIZE", tIncremental, flips, restyled);
+	printf("  speedup: %.1fx, same styles: %s\n", tFull / tIncremental, Same(full, incremental) ? "yes" : "NO");
+	return 0;
+}
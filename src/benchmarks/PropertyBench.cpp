@@ -0,0 +1,104 @@
+// PropertyBench: string-keyed vs handle-keyed property lookups through a context chain.
+//
+// The chain mirrors a real widget: root theme -> container -> layout -> cell -> widget.
+// Each "frame" reads the keys a typical OnDrawWidget reads; some are local, most are
+// inherited from the root, a couple are missing everywhere.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	// The pre-atom store: std::string keys, hashed on every call at every level.
+	struct LegacyNode {
+		LegacyNode* parent = nullptr;
+		std::unordered_map<std::string, std::string> props;
+
+		const char* GetProperty(const char* key, const char* def = "") {
+			auto it = props.find(key);
+			if (it != props.end()) return it->second.c_str();
+			if (parent) return parent->GetProperty(key, def);
+			return def;
+		}
+	};
+
+	const char* kThemeKeys[] = {
+		"background-color", "foreground-color", "border-color", "border-width",
+		"border-radius", "font-family", "font-size", "font-weight", "text-align", "padding",
+	};
+	const char* kLocalKeys[] = { "title", "subclass", "value" };
+	const char* kMissingKeys[] = { "margin-left", "letter-spacing" };
+
+	template <typename F>
+	double Measure(const char* label, int frames, F&& frame) {
+		size_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; ++i) checksum += frame();
+		auto end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		printf("  %-28s %9.2f ms  (checksum %zu)\n", label, ms, checksum);
+		return ms;
+	}
+}
+
+int main(int argc, char** argv) {
+	int frames = (argc > 1) ? atoi(argv[1]) : 200000;
+	if (frames <= 0) frames = 200000;
+
+	// 1. Build both chains with identical content
+	std::vector<LegacyNode> legacy(5);
+	ContextNodeImpl atoms[5];
+	for (int i = 1; i < 5; ++i) {
+		legacy[i].parent = &legacy[i - 1];
+		atoms[i].SetParentNode(&atoms[i - 1]);
+	}
+	for (const char* k : kThemeKeys) {
+		legacy[0].props[k] = "1";
+		atoms[0].SetProperty(k, "1");
+	}
+	for (const char* k : kLocalKeys) {
+		legacy[4].props[k] = "local";
+		atoms[4].SetProperty(k, "local");
+	}
+	LegacyNode& legacyLeaf = legacy[4];
+	ContextNodeImpl& leaf = atoms[4];
+
+	// 2. Handles resolved once, as a widget constructor would
+	std::vector<PropertyHandle> handles;
+	std::vector<const char*> keys;
+	for (const char* k : kThemeKeys) keys.push_back(k);
+	for (const char* k : kLocalKeys) keys.push_back(k);
+	for (const char* k : kMissingKeys) keys.push_back(k);
+	for (const char* k : keys) handles.push_back(leaf.ResolveKey(k));
+
+	printf("PropertyBench: %d frames x %zu lookups, chain depth 5\n", frames, keys.size());
+
+	double tLegacy = Measure("legacy std::string map", frames, [&]() {
+		size_t n = 0;
+		for (const char* k : keys) n += legacyLeaf.GetProperty(k)[0];
+		return n;
+	});
+	double tString = Measure("atom table, string keys", frames, [&]() {
+		size_t n = 0;
+		for (const char* k : keys) n += leaf.GetProperty(k)[0];
+		return n;
+	});
+	double tHandle = Measure("atom table, handles", frames, [&]() {
+		size_t n = 0;
+		for (PropertyHandle h : handles) n += leaf.GetProperty(h)[0];
+		return n;
+	});
+
+	printf("  speedup handles vs legacy:  %.2fx\n", tLegacy / tHandle);
+	printf("  speedup strings vs legacy:  %.2fx\n", tLegacy / tString);
+	printf("  interned keys: %zu\n", PropertyAtoms::Count());
+	return 0;
+}
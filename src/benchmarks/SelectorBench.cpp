@@ -0,0 +1,155 @@
+// SelectorBench: matching 5,000 widgets against a 2,000-rule sheet.
+//
+// controller -> 4 containers -> 50 cells -> 25 widgets, the same tree ThemeBench uses.
+// Each widget has a type and one or two classes; the sheet is mostly class rules (like a
+// renamed bootstrap_lite.css) plus type, id, descendant and child rules.
+//   - naive: every rule is tested against every widget, each widget gets its own table
+//   - bucketed: RuleSet::Match, which only tests the id / class / type buckets of the
+//     widget and hands out one shared table per distinct set of matched rules
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+#include "ChronoSelectors.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kTypes[] = { "Button", "StaticText", "EditBox", "GaugeSpeedOmeter" };
+	const int kClassNames = 400;
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+	private:
+		PropertyHandle m_type;
+	};
+
+	struct Tree {
+		Node root{ "Controller" };
+		std::vector<std::unique_ptr<Node>> nodes;
+		std::vector<Node*> widgets;
+
+		Node* Add(Node* parent, const char* type) {
+			nodes.emplace_back(new Node(type));
+			nodes.back()->SetParentNode(parent);
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		for (int c = 0; c < 4; ++c) {
+			Node* container = t.Add(&t.root, "Container");
+			if (c == 0) container->SetProperty("id", "sidebar");
+			for (int cell = 0; cell < 50; ++cell) {
+				Node* cellNode = t.Add(container, "Cell");
+				for (int w = 0; w < 25; ++w) {
+					Node* widget = t.Add(cellNode, kTypes[w % 4]);
+					std::string cls = "c" + std::to_string((cell * 25 + w) % kClassNames);
+					if (w % 5 == 0) cls += " c" + std::to_string((cell + w) % kClassNames);
+					widget->SetProperty("class", cls.c_str());
+					t.widgets.push_back(widget);
+				}
+			}
+		}
+	}
+
+	void AddSheet(CSS::RuleSet& rules) {
+		std::vector<CSS::RuleSet::Declaration> decls = {
+			{ "background-color", "#0d6efd", false }, { "color", "#ffffff", false }, { "border-radius", "4", false },
+		};
+		std::vector<CSS::RuleSet::Declaration> hover = { { "background-color", "#0b5ed7", false } };
+
+		// 1. Class rules with their :hover variant, as in the bundled sheet
+		for (int i = 0; i < kClassNames; ++i) {
+			std::string c = ".c" + std::to_string(i);
+			rules.AddRule(c, decls);
+			rules.AddRule(c + ":hover", hover);
+			rules.AddRule("Cell > " + c, decls);
+			rules.AddRule("#sidebar " + c, decls);
+			rules.AddRule("Button" + c, decls);
+		}
+
+		// 2. Type rules
+		for (const char* type : kTypes) rules.AddRule(type, decls);
+		rules.AddRule("*", { { "font-family", "Segoe UI", false } });
+	}
+
+	volatile size_t g_sink = 0;
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 5;
+	if (runs <= 0) runs = 5;
+
+	Tree t;
+	Build(t);
+	CSS::RuleSet rules;
+	AddSheet(rules);
+
+	printf("SelectorBench: %zu widgets, %zu rules, best of %d runs\n", t.widgets.size(), rules.RuleCount(), runs);
+
+	// 1. Naive: every rule against every widget, one private table per widget
+	double tNaive = 1e30;
+	size_t naiveTables = 0, naiveMatches = 0;
+	for (int r = 0; r < runs; ++r) {
+		std::vector<ContextNodeImpl::ThemeTable> tables;
+		naiveMatches = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (Node* w : t.widgets) {
+			std::vector<std::pair<std::string, std::string>> pairs;
+			for (size_t i = 0; i < rules.RuleCount(); ++i) {
+				if (rules.Matches(i, w)) {
+					++naiveMatches;
+					pairs.emplace_back("background-color", "#0d6efd");
+				}
+			}
+			tables.push_back(ContextNodeImpl::CompileTheme(pairs));
+		}
+		tNaive = (std::min)(tNaive, Elapsed(start));
+		naiveTables = tables.size();
+	}
+
+	// 2. Bucketed, shared tables. A fresh RuleSet per run so the table cache starts cold.
+	double tBucket = 1e30, tWarm = 1e30;
+	size_t bucketTables = 0, shared = 0;
+	for (int r = 0; r < runs; ++r) {
+		CSS::RuleSet fresh;
+		AddSheet(fresh);
+		auto start = std::chrono::steady_clock::now();
+		for (Node* w : t.widgets) w->SetRuleLayer(fresh.Match(w));
+		tBucket = (std::min)(tBucket, Elapsed(start));
+
+		// Restyle again with every table cached (AddClass / re-parenting)
+		start = std::chrono::steady_clock::now();
+		for (Node* w : t.widgets) w->SetRuleLayer(fresh.Match(w));
+		tWarm = (std::min)(tWarm, Elapsed(start));
+
+		bucketTables = fresh.TableCount();
+		shared = 0;
+		for (Node* w : t.widgets) shared += (w->GetRuleLayer() != nullptr);
+	}
+
+	// 3. Sanity: resolved values come from the rule layer
+	static const PropertyHandle kBg = PropertyAtoms::Intern("background-color");
+	size_t n = 0;
+	for (Node* w : t.widgets) n += w->GetProperty(kBg, "")[0];
+	g_sink = n;
+
+	printf("  %-30s %9.2f ms  (%zu matches, %zu tables)\n", "naive (all rules, copies)", tNaive, naiveMatches, naiveTables);
+	printf("  %-30s %9.2f ms  (%zu tables shared by %zu widgets)\n", "bucketed (cold cache)", tBucket, bucketTables, shared);
+	printf("  %-30s %9.2f ms\n", "bucketed (warm cache)", tWarm);
+	printf("  speedup: %.2fx cold, %.2fx warm\n", tNaive / tBucket, tNaive / tWarm);
+	return 0;
+}
@@ -0,0 +1,153 @@
+// SheetBench: loading and unloading a plugin's style sheet over a 5,000-widget container.
+//
+// container -> 200 cells -> 25 buttons; the app sheet styles every button, the plugin sheet
+// (in its own cascade layer) only the 200 ".plugin" badges and their hover state.
+//   - reload: what unloading takes with one global rule set, i.e. clear it, load the app
+//     sheet again (from its compiled image, the cheap way) and re-match the whole tree
+//   - UnloadSheet: drop the plugin's rules and re-match only the nodes that had matched one
+// Both end with the same declarations on every widget.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoSelectors.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kAppSheet =
+		"@layer plugins;"
+		"Cell { padding: 4 }"
+		".btn { width: 100%; background-color: #0d6efd; color: #ffffff }"
+		".btn:hover { background-color: #0b5ed7 }"
+		".label { color: #212529 }";
+
+	const char* kPluginSheet =
+		".plugin { border-color: #ffc107; border-width: 2; color: #000000 }"
+		".plugin:hover { border-color: #ffca2c }"
+		"Cell > .plugin { margin: 2 }";
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+		void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			for (Node* child : children) out->push_back(child);
+		}
+
+		std::vector<Node*> children;
+	private:
+		PropertyHandle m_type;
+	};
+
+	struct Tree {
+		Node root{ "Container" };
+		std::vector<std::unique_ptr<Node>> nodes;
+
+		Node* Add(Node* parent, const char* type) {
+			nodes.emplace_back(new Node(type));
+			nodes.back()->SetParentNode(parent);
+			parent->children.push_back(nodes.back().get());
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		for (int c = 0; c < 200; ++c) {
+			Node* cell = t.Add(&t.root, "Cell");
+			for (int b = 0; b < 25; ++b) {
+				Node* button = t.Add(cell, "Button");
+				button->SetProperty("class", (b == 0) ? "btn plugin" : (b % 5 == 0) ? "label" : "btn");
+			}
+		}
+	}
+
+	void Restyle(CSS::RuleSet& rules, IContextNode* root) {
+		std::vector<IContextNode*> pending(1, root);
+		while (!pending.empty()) {
+			ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(pending.back());
+			pending.pop_back();
+			impl->SetRuleLayer(rules.Match(impl));
+			impl->GetStyleChildren(&pending);
+		}
+	}
+
+	// Same cascaded declarations, whichever rule set the tables came from
+	bool SameTable(const ContextNodeImpl::ThemeTable& a, const ContextNodeImpl::ThemeTable& b) {
+		if (!a || !b) return !a && !b;
+		if (a->slots.size() != b->slots.size()) return false;
+		for (const auto& kv : a->slots) {
+			auto it = b->slots.find(kv.first);
+			if (it == b->slots.end() || it->second.text != kv.second.text) return false;
+		}
+		return true;
+	}
+
+	bool Same(const Tree& a, const Tree& b) {
+		for (size_t i = 0; i < a.nodes.size(); ++i)
+			if (!SameTable(a.nodes[i]->GetRuleLayer(), b.nodes[i]->GetRuleLayer())) return false;
+		return true;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 20;
+	if (runs <= 0) runs = 20;
+
+	std::string appImage, pluginImage;
+	StyleManager::CompileCSS(kAppSheet, &appImage);
+	StyleManager::CompileCSS(kPluginSheet, &pluginImage);
+
+	Tree reloaded, unloaded;
+	Build(reloaded);
+	Build(unloaded);
+
+	CSS::RuleSet rules;
+	StyleManager::LoadCSS(kAppSheet);
+
+	double tReload = 1e30, tUnload = 1e30;
+	size_t restyled = 0;
+	for (int r = 0; r < runs; ++r) {
+		// Plugin loaded and applied on both trees (not timed)
+		rules.Clear();
+		rules.LoadImage(appImage.data(), appImage.size());
+		rules.LoadImage(pluginImage.data(), pluginImage.size());
+		Restyle(rules, &reloaded.root);
+		StyleSheetHandle plugin = StyleManager::LoadCompiled(pluginImage.data(), pluginImage.size(), "plugins", &unloaded.root);
+
+		// 1. One global rule set: start over without the plugin
+		auto start = std::chrono::steady_clock::now();
+		rules.Clear();
+		rules.LoadImage(appImage.data(), appImage.size());
+		Restyle(rules, &reloaded.root);
+		tReload = (std::min)(tReload, Elapsed(start));
+
+		// 2. Drop the plugin's sheet
+		restyled = 0;
+		for (auto& node : unloaded.nodes) {
+			ContextNodeImpl::ThemeTable table = node->GetRuleLayer();
+			if (table && std::binary_search(table->sheets.begin(), table->sheets.end(), plugin.id)) ++restyled;
+		}
+		start = std::chrono::steady_clock::now();
+		StyleManager::UnloadSheet(plugin, &unloaded.root);
+		tUnload = (std::min)(tUnload, Elapsed(start));
+	}
+
+	size_t nodes = reloaded.nodes.size() + 1;
+	printf("SheetBench: %zu nodes, plugin sheet unloaded %d times, best run\n", nodes, runs);
+	printf("  %-26s %9.3f ms  (%zu nodes re-matched)\n", "clear, reload, restyle", tReload, nodes);
+	printf("  %-26s %9.3f ms  (%zu nodes re-matched)\n", "UnloadSheet", tUnload, restyled);
+	printf("  speedup: %.1fx, same styles: %s\n", tReload / tUnload, Same(reloaded, unloaded) ? "yes" : "NO");
+	return 0;
+}
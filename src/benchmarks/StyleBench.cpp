@@ -0,0 +1,117 @@
+// StyleBench: uncached vs cached style resolution for a dashboard-sized tree.
+//
+// root theme -> container -> 40 cells -> 50 widgets each (2,000 widgets).
+// Every "frame" each widget resolves the styles DrawWidgetBackground and
+// DrawTextStyled read. Halfway through, the theme changes once.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kProps[] = {
+		"background-color", "border-color", "border-width", "border-radius",
+		"margin-top", "margin-left", "margin-right", "margin-bottom",
+		"color", "font-family", "font-style", "font-size", "text-align",
+	};
+	const char* kClasses[] = { "Button", "StaticText", "EditBox", "GaugeSpeedOmeter" };
+
+	struct Widget {
+		std::unique_ptr<ContextNodeImpl> node;
+		PropertyHandle cls;
+		PropertyHandle sub;
+	};
+
+	void PrintStats(const char* label) {
+		uint64_t hits = 0, misses = 0;
+		StyleCache::GetStats(&hits, &misses);
+		double rate = (hits + misses) ? (100.0 * hits / (hits + misses)) : 0.0;
+		printf("  %-28s hits %llu, misses %llu (%.2f%% hit rate)\n", label,
+			(unsigned long long)hits, (unsigned long long)misses, rate);
+	}
+}
+
+int main(int argc, char** argv) {
+	int frames = (argc > 1) ? atoi(argv[1]) : 60;
+	if (frames <= 0) frames = 60;
+
+	// 1. Theme on the root, a few overrides on the way down
+	ContextNodeImpl root, container;
+	container.SetParentNode(&root);
+	root.SetProperty("background-color", "#ffffff");
+	root.SetProperty("border-width", "1");
+	root.SetProperty("font-family", "Segoe UI");
+	root.SetProperty("font-size", "10");
+	root.SetProperty("font-size:hover", "12");
+	root.SetProperty("Button:background-color", "#f0f0f0");
+	root.SetProperty("Button:background-color:hover", "#e3f2fd");
+	root.SetProperty("Button:danger:background-color", "#ffcdd2");
+	root.SetProperty("StaticText:border-color:hover", "#90caf9");
+
+	std::vector<std::unique_ptr<ContextNodeImpl>> cells;
+	std::vector<Widget> widgets;
+	for (int c = 0; c < 40; ++c) {
+		cells.emplace_back(new ContextNodeImpl());
+		cells.back()->SetParentNode(&container);
+		cells.back()->SetProperty("background-color", "#fafafa");
+
+		for (int w = 0; w < 50; ++w) {
+			Widget wd;
+			wd.node.reset(new ContextNodeImpl());
+			wd.node->SetParentNode(cells.back().get());
+			wd.node->SetProperty("title", "label");
+			wd.cls = PropertyAtoms::Intern(kClasses[w % 4]);
+			wd.sub = PropertyAtoms::Intern((w % 7 == 0) ? "danger" : "");
+			widgets.push_back(std::move(wd));
+		}
+	}
+
+	std::vector<PropertyHandle> props;
+	for (const char* p : kProps) props.push_back(PropertyAtoms::Intern(p));
+
+	printf("StyleBench: %zu widgets x %zu styles x %d frames\n", widgets.size(), props.size(), frames);
+
+	auto frame = [&](bool cached, int f) {
+		size_t n = 0;
+		for (size_t i = 0; i < widgets.size(); ++i) {
+			Widget& wd = widgets[i];
+			// A handful of widgets are hovered each frame
+			uint32_t state = StyleState::Mask(false, true, ((i + f) % 97) == 0, false);
+			for (PropertyHandle p : props) {
+				PropertyValue v;
+				bool found = cached ? wd.node->GetStyleValue(p, wd.cls, wd.sub, state, &v)
+					: wd.node->ResolveStyleValue(p, wd.cls, wd.sub, state, &v);
+				if (found) n += v.text[0];
+			}
+		}
+		return n;
+	};
+
+	auto run = [&](const char* label, bool cached) {
+		StyleCache::ResetStats();
+		size_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int f = 0; f < frames; ++f) {
+			// 2. One theme change halfway through
+			if (f == frames / 2) root.SetProperty("Button:background-color", (f & 1) ? "#eeeeee" : "#f0f0f0");
+			checksum += frame(cached, f);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		printf("  %-28s %9.2f ms  (%.3f ms/frame, checksum %zu)\n", label, ms, ms / frames, checksum);
+		if (cached) PrintStats("style cache");
+		return ms;
+	};
+
+	double tUncached = run("uncached resolution", false);
+	double tCached = run("cached resolution", true);
+	printf("  speedup: %.2fx\n", tUncached / tCached);
+	return 0;
+}
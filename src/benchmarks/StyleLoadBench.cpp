@@ -0,0 +1,150 @@
+// StyleLoadBench: startup cost of the style sheet, CSS text vs compiled image.
+//
+// Loads assets/bootstrap_lite.css into a fresh RuleSet the way StyleManager::LoadCSS does
+// (tokenize, parse, compile selectors, parse values), and the same rules from the image
+// StyleManager::CompileCSS / ChronoCSSC produce (RuleSet::LoadImage). The image is loaded
+// first, in a process that has interned nothing yet, so "first" is a true cold start.
+// The 1 MB sheet is the base sheet repeated with renamed classes, as in CSSBench.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoCSSParser.hpp"
+#include "ChronoSelectors.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	// Text path of StyleManager::LoadCSS
+	void LoadText(const std::string& css, CSS::RuleSet& rules) {
+		CSS::StyleSheet sheet;
+		CSS::Parser::Parse(css, &sheet);
+		std::vector<std::string_view> selectors;
+		std::vector<CSS::RuleSet::Declaration> declarations;
+		for (const auto& rule : sheet.rules) {
+			if (!rule.atKeyword.empty() || rule.parent >= 0 || rule.declarationCount == 0) continue;
+			declarations.clear();
+			for (uint32_t i = 0; i < rule.declarationCount; ++i) {
+				const CSS::Declaration& decl = sheet.declarations[rule.firstDeclaration + i];
+				declarations.push_back({ std::string(decl.name), std::string(decl.value), decl.important });
+			}
+			selectors.clear();
+			CSS::Parser::SplitList(rule.prelude, &selectors);
+			for (std::string_view sel : selectors) rules.AddRule(sel, declarations);
+		}
+	}
+
+	bool ReadFile(const std::string& path, std::string* out) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) return false;
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		*out = buffer.str();
+		return true;
+	}
+
+	std::string Rename(const std::string& css, int n) {
+		std::string out;
+		std::string suffix = "-" + std::to_string(n);
+		int depth = 0;
+		for (size_t i = 0; i < css.size(); ++i) {
+			char c = css[i];
+			out += c;
+			if (c == '{') ++depth;
+			else if (c == '}' && depth > 0) --depth;
+			else if (c == '.' && depth == 0 && i + 1 < css.size() && isalpha((unsigned char)css[i + 1])) {
+				size_t end = i + 1;
+				while (end < css.size() && (isalnum((unsigned char)css[end]) || css[end] == '-' || css[end] == '_')) ++end;
+				out.append(css, i + 1, end - i - 1);
+				out += suffix;
+				i = end - 1;
+			}
+		}
+		return out;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// First run and best of 'runs', in microseconds
+	template <typename F>
+	void Measure(int runs, F&& run, double* first, double* best) {
+		*best = 1e30;
+		for (int i = 0; i < runs; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			run();
+			double us = Elapsed(start);
+			if (i == 0) *first = us;
+			*best = (std::min)(*best, us);
+		}
+	}
+
+	// Same rules, same order, same resolved values
+	bool SameRules(CSS::RuleSet& a, CSS::RuleSet& b) {
+		std::string ia, ib;
+		a.SaveImage(&ia);
+		b.SaveImage(&ib);
+		return ia == ib;
+	}
+
+	void Report(const char* label, const std::string& css, int runs) {
+		std::string image;
+		StyleManager::CompileCSS(css, &image);
+
+		double imageFirst, imageBest, textFirst, textBest;
+		size_t rules = 0;
+		Measure(runs, [&]() {
+			CSS::RuleSet set;
+			set.LoadImage(image.data(), image.size());
+			rules = set.RuleCount();
+		}, &imageFirst, &imageBest);
+		Measure(runs, [&]() {
+			CSS::RuleSet set;
+			LoadText(css, set);
+		}, &textFirst, &textBest);
+
+		CSS::RuleSet fromText, fromImage;
+		LoadText(css, fromText);
+		fromImage.LoadImage(image.data(), image.size());
+
+		printf("  %s: %zu bytes of CSS, %zu byte image, %zu rules, identical: %s\n", label, css.size(), image.size(), rules,
+			SameRules(fromText, fromImage) ? "yes" : "NO");
+		printf("    %-22s first %10.1f us   best %10.1f us\n", "CSS text", textFirst, textBest);
+		printf("    %-22s first %10.1f us   best %10.1f us\n", "compiled image", imageFirst, imageBest);
+		printf("    speedup (best): %.1fx\n", textBest / imageBest);
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string base;
+	const char* paths[] = { (argc > 1) ? argv[1] : "assets/bootstrap_lite.css", "../assets/bootstrap_lite.css", "../../assets/bootstrap_lite.css" };
+	bool found = false;
+	for (const char* p : paths) {
+		if (ReadFile(p, &base)) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		printf("StyleLoadBench: could not open assets/bootstrap_lite.css (pass its path as the first argument)\n");
+		return 1;
+	}
+
+	const int runs = 20;
+	printf("StyleLoadBench: first and best of %d loads into a fresh RuleSet\n", runs);
+	Report("bootstrap_lite.css", base, runs);
+
+	std::string large;
+	for (int n = 0; large.size() < 1024 * 1024; ++n) large += Rename(base, n);
+	Report("1 MB sheet", large, 5);
+	return 0;
+}
@@ -0,0 +1,178 @@
+// ThemeBench: light <-> dark switch latency on a 5,000-widget tree.
+//
+// controller -> 4 containers -> 50 cells each -> 25 widgets each. Three ways to switch:
+//   - rewrite every widget (what re-running StyleManager::AddClass over the tree does)
+//   - rewrite the controller's property map (what SetDefaultStyles used to write into)
+//   - swap the controller's immutable theme layer
+// "switch" is the call itself, "first frame" is every widget resolving the styles
+// DrawWidgetBackground and DrawTextStyled read right after it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kLight[][2] = {
+		{ "background-color", "#ffffff" }, { "background-color:hover", "#f9f9f9" },
+		{ "foreground-color", "#333333" }, { "border-color", "#e0e0e0" }, { "border-color:hover", "#b3e5fc" },
+		{ "color", "#ffffff" }, { "border-radius", "2" },
+		{ "StaticText:background-color", "#ffffff" }, { "StaticText:background-color:hover", "#e3f2fd" },
+		{ "StaticText:border-color:hover", "#90caf9" }, { "StaticText:danger:background-color", "#ffcdd2" },
+		{ "font-family", "Segoe UI" }, { "font-size", "10" }, { "font-size:hover", "12" },
+		{ "font-style", "normal" }, { "text-align", "center" },
+	};
+	const char* kDark[][2] = {
+		{ "background-color", "#1e1e1e" }, { "background-color:hover", "#2a2a2a" },
+		{ "foreground-color", "#e0e0e0" }, { "border-color", "#3c3c3c" }, { "border-color:hover", "#0288d1" },
+		{ "color", "#ffffff" }, { "border-radius", "2" },
+		{ "StaticText:background-color", "#1e1e1e" }, { "StaticText:background-color:hover", "#263238" },
+		{ "StaticText:border-color:hover", "#4fc3f7" }, { "StaticText:danger:background-color", "#5d1f1f" },
+		{ "font-family", "Segoe UI" }, { "font-size", "10" }, { "font-size:hover", "12" },
+		{ "font-style", "normal" }, { "text-align", "center" },
+	};
+	const size_t kThemeSize = sizeof(kLight) / sizeof(kLight[0]);
+
+	const char* kProps[] = {
+		"background-color", "border-color", "border-width", "border-radius",
+		"margin-top", "margin-left", "margin-right", "margin-bottom",
+		"color", "font-family", "font-style", "font-size", "text-align",
+	};
+	const char* kClasses[] = { "Button", "StaticText", "EditBox", "GaugeSpeedOmeter" };
+
+	struct Widget {
+		ContextNodeImpl* node;
+		PropertyHandle cls;
+		PropertyHandle sub;
+	};
+
+	struct Tree {
+		ContextNodeImpl root;
+		std::vector<std::unique_ptr<ContextNodeImpl>> nodes;
+		std::vector<Widget> widgets;
+
+		ContextNodeImpl* Add(ContextNodeImpl* parent) {
+			nodes.emplace_back(new ContextNodeImpl());
+			nodes.back()->SetParentNode(parent);
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		for (int c = 0; c < 4; ++c) {
+			ContextNodeImpl* container = t.Add(&t.root);
+			for (int cell = 0; cell < 50; ++cell) {
+				ContextNodeImpl* cellNode = t.Add(container);
+				for (int w = 0; w < 25; ++w) {
+					Widget wd;
+					wd.node = t.Add(cellNode);
+					wd.node->SetProperty("title", "label");
+					wd.cls = PropertyAtoms::Intern(kClasses[w % 4]);
+					wd.sub = PropertyAtoms::Intern((w % 7 == 0) ? "danger" : "");
+					t.widgets.push_back(wd);
+				}
+			}
+		}
+	}
+
+	ContextNodeImpl::ThemeTable Compile(const char* pairs[][2]) {
+		std::map<std::string, std::string> props;
+		for (size_t i = 0; i < kThemeSize; ++i) props[pairs[i][0]] = pairs[i][1];
+		return ContextNodeImpl::CompileTheme(props);
+	}
+
+	volatile size_t g_sink = 0; // Keeps the lookups from being optimized away
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	double Median(std::vector<double> v) {
+		std::sort(v.begin(), v.end());
+		return v[v.size() / 2];
+	}
+}
+
+int main(int argc, char** argv) {
+	int switches = (argc > 1) ? atoi(argv[1]) : 21;
+	if (switches <= 0) switches = 21;
+
+	std::vector<PropertyHandle> props;
+	for (const char* p : kProps) props.push_back(PropertyAtoms::Intern(p));
+
+	ContextNodeImpl::ThemeTable light = Compile(kLight);
+	ContextNodeImpl::ThemeTable dark = Compile(kDark);
+
+	auto frame = [&](Tree& t) {
+		size_t n = 0;
+		for (const Widget& wd : t.widgets) {
+			uint32_t state = StyleState::Mask(false, true, false, false);
+			for (PropertyHandle p : props) {
+				PropertyValue v;
+				if (wd.node->GetStyleValue(p, wd.cls, wd.sub, state, &v)) n += v.text[0];
+			}
+		}
+		g_sink = n;
+	};
+
+	auto run = [&](const char* label, auto&& apply) {
+		Tree t;
+		Build(t);
+		apply(t, 0);
+		frame(t);
+
+		std::vector<double> tSwitch, tFrame;
+		for (int i = 1; i <= switches; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			apply(t, i & 1);
+			tSwitch.push_back(Elapsed(start));
+
+			start = std::chrono::steady_clock::now();
+			frame(t);
+			tFrame.push_back(Elapsed(start));
+		}
+		double s = Median(tSwitch), f = Median(tFrame);
+		printf("  %-26s %10.3f %12.3f %10.3f\n", label, s, f, s + f);
+		return s + f;
+	};
+
+	printf("ThemeBench: %zu widgets, %zu theme keys, median of %d switches (ms)\n", (size_t)4 * 50 * 25, kThemeSize, switches);
+
+	for (int snapshots = 0; snapshots <= 1; ++snapshots) {
+		PropertyInheritance::EnableSnapshots(snapshots != 0);
+		printf("  %-26s %10s %12s %10s\n", snapshots ? "(inheritance snapshots)" : "(chain walk)", "switch", "first frame", "total");
+
+		// 1. Rewrite every widget, batched per node like AddClass
+		double tNodes = run("rewrite every widget", [&](Tree& t, int which) {
+			const char* (*pairs)[2] = which ? kDark : kLight;
+			for (const Widget& wd : t.widgets) {
+				PropertyUpdateScope batch(wd.node);
+				for (size_t k = 0; k < kThemeSize; ++k) wd.node->SetProperty(pairs[k][0], pairs[k][1]);
+			}
+		});
+
+		// 2. Rewrite the controller's map
+		double tRoot = run("rewrite controller map", [&](Tree& t, int which) {
+			const char* (*pairs)[2] = which ? kDark : kLight;
+			for (size_t k = 0; k < kThemeSize; ++k) t.root.SetProperty(pairs[k][0], pairs[k][1]);
+		});
+
+		// 3. Swap the theme layer
+		double tSwap = run("swap theme layer", [&](Tree& t, int which) {
+			t.root.SetThemeLayer(which ? dark : light);
+		});
+
+		printf("  speedup vs widget rewrite: %.2fx, vs controller map: %.2fx\n", tNodes / tSwap, tRoot / tSwap);
+	}
+
+	PropertyInheritance::EnableSnapshots(false);
+	return 0;
+}
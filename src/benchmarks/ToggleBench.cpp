@@ -0,0 +1,206 @@
+// ToggleBench: StyleManager::ToggleClass on 10,000 nodes.
+//
+// container -> 400 cells -> 25 buttons, every button with "btn btn-primary". Toggles
+// "active" on every button twice (on, then off) and compares against the class handling
+// StyleManager had before the selector engine: split the class list into a std::set, join
+// it back and write every property of every remaining class onto the node again.
+// Also reports what the old way leaves behind after the "off" toggle, and what a class
+// toggle on the cells costs when a descendant selector does / does not depend on it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoCSSParser.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kSheet =
+		".btn { border-radius: 4; border-width: 1; font-size: 10; }\n"
+		".btn:hover { border-color: #86b7fe; }\n"
+		".btn-primary { background-color: #0d6efd; border-color: #0d6efd; color: #ffffff; }\n"
+		".btn-primary:hover { background-color: #0b5ed7; }\n"
+		".active { background-color: #0a58ca; border-color: #0a53be; font-weight: bold; }\n"
+		".active:hover { background-color: #084298; }\n"
+		".compact Button { font-size: 8; margin-top: 1; margin-bottom: 1; }\n";
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+		void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			for (Node* c : children) out->push_back(c);
+		}
+		std::vector<Node*> children;
+	private:
+		PropertyHandle m_type;
+	};
+
+	struct Tree {
+		Node root{ "Container" };
+		std::vector<std::unique_ptr<Node>> nodes;
+		std::vector<Node*> cells, buttons;
+
+		Node* Add(Node* parent, const char* type) {
+			nodes.emplace_back(new Node(type));
+			nodes.back()->SetParentNode(parent);
+			parent->children.push_back(nodes.back().get());
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		for (int c = 0; c < 400; ++c) {
+			Node* cell = t.Add(&t.root, "Cell");
+			t.cells.push_back(cell);
+			for (int b = 0; b < 25; ++b) t.buttons.push_back(t.Add(cell, "Button"));
+		}
+	}
+
+	// --- The pre-selector-engine class handling, kept here for comparison ---
+
+	typedef std::map<std::string, StyleProperties> Registry;
+
+	std::vector<std::string> Split(const std::string& str, char delimiter) {
+		std::vector<std::string> tokens;
+		std::string token;
+		std::istringstream tokenStream(str);
+		while (std::getline(tokenStream, token, delimiter)) {
+			std::string trimmed = Internal::Trim(token);
+			if (!trimmed.empty()) tokens.push_back(trimmed);
+		}
+		return tokens;
+	}
+
+	void LegacyRegistry(const std::string& css, Registry& registry) {
+		CSS::StyleSheet sheet;
+		CSS::Parser::Parse(css, &sheet);
+		std::vector<std::string_view> selectors;
+		for (const auto& rule : sheet.rules) {
+			if (!rule.atKeyword.empty() || rule.parent >= 0) continue;
+			selectors.clear();
+			CSS::Parser::SplitList(rule.prelude, &selectors);
+			for (std::string_view sel : selectors) {
+				if (sel.size() > 0 && sel[0] == '.') sel.remove_prefix(1);
+				StyleProperties& props = registry[std::string(sel)];
+				for (uint32_t i = 0; i < rule.declarationCount; ++i) {
+					const CSS::Declaration& decl = sheet.declarations[rule.firstDeclaration + i];
+					props[std::string(decl.name)] = std::string(decl.value);
+				}
+			}
+		}
+	}
+
+	void LegacyApply(const Registry& registry, IContextNode* node, const std::set<std::string>& classes) {
+		static const std::vector<std::string> pseudoStates = { "hover", "active", "checked", "selected", "focus", "disabled" };
+		for (const auto& cls : classes) {
+			auto it = registry.find(cls);
+			if (it != registry.end()) {
+				for (const auto& kv : it->second) node->SetProperty(kv.first.c_str(), kv.second.c_str());
+			}
+			for (const auto& state : pseudoStates) {
+				auto pseudoIt = registry.find(cls + ":" + state);
+				if (pseudoIt != registry.end()) {
+					for (const auto& kv : pseudoIt->second) node->SetProperty((kv.first + ":" + state).c_str(), kv.second.c_str());
+				}
+			}
+		}
+	}
+
+	void LegacyToggle(const Registry& registry, IContextNode* node, const std::string& className) {
+		std::set<std::string> classes;
+		for (const auto& t : Split(node->GetProperty("class", ""), ' ')) classes.insert(t);
+		if (!classes.erase(className)) classes.insert(className);
+
+		std::string finalClassStr;
+		for (const auto& c : classes) {
+			if (!finalClassStr.empty()) finalClassStr += " ";
+			finalClassStr += c;
+		}
+		PropertyUpdateScope batch(node);
+		node->SetProperty("class", finalClassStr.c_str());
+		LegacyApply(registry, node, classes);
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	template <typename F>
+	double Best(int runs, F&& run) {
+		double best = 1e30;
+		for (int i = 0; i < runs; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			run();
+			best = (std::min)(best, Elapsed(start));
+		}
+		return best;
+	}
+
+	size_t CountValue(const std::vector<Node*>& nodes, const char* key, const char* value) {
+		size_t n = 0;
+		for (Node* node : nodes) n += (strcmp(node->GetProperty(key, ""), value) == 0);
+		return n;
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 5;
+	if (runs <= 0) runs = 5;
+
+	StyleManager::LoadCSS(kSheet);
+	Registry registry;
+	LegacyRegistry(kSheet, registry);
+
+	// 1. Old class handling
+	Tree legacy;
+	Build(legacy);
+	for (Node* b : legacy.buttons) {
+		std::set<std::string> classes = { "btn", "btn-primary" };
+		b->SetProperty("class", "btn btn-primary");
+		LegacyApply(registry, b, classes);
+	}
+	double tLegacy = Best(runs, [&]() {
+		for (Node* b : legacy.buttons) LegacyToggle(registry, b, "active");
+		for (Node* b : legacy.buttons) LegacyToggle(registry, b, "active");
+	});
+	size_t stale = CountValue(legacy.buttons, "font-weight", "bold");
+
+	// 2. Rule layers and invalidation sets
+	Tree tree;
+	Build(tree);
+	for (Node* b : tree.buttons) StyleManager::AddClass(b, "btn btn-primary");
+	double tToggle = Best(runs, [&]() {
+		for (Node* b : tree.buttons) StyleManager::ToggleClass(b, "active");
+		for (Node* b : tree.buttons) StyleManager::ToggleClass(b, "active");
+	});
+	size_t leftover = CountValue(tree.buttons, "font-weight", "bold");
+
+	// 3. Class toggles on the cells: one a descendant selector depends on, one nothing uses
+	double tCompact = Best(runs, [&]() {
+		for (Node* c : tree.cells) StyleManager::ToggleClass(c, "compact");
+		for (Node* c : tree.cells) StyleManager::ToggleClass(c, "compact");
+	});
+	double tUnused = Best(runs, [&]() {
+		for (Node* c : tree.cells) StyleManager::ToggleClass(c, "expanded");
+		for (Node* c : tree.cells) StyleManager::ToggleClass(c, "expanded");
+	});
+
+	printf("ToggleBench: %zu buttons in %zu cells, 2 toggles per node, best of %d runs\n", tree.buttons.size(), tree.cells.size(), runs);
+	printf("  %-34s %9.2f ms  (%zu of %zu keep .active's font-weight)\n", "legacy set + rewrite", tLegacy, stale, legacy.buttons.size());
+	printf("  %-34s %9.2f ms  (%zu of %zu keep .active's font-weight)\n", "rule layer diff", tToggle, leftover, tree.buttons.size());
+	printf("  speedup: %.2fx\n", tLegacy / tToggle);
+	printf("  %-34s %9.2f ms  (restyles %zu buttons each)\n", "cells: .compact (descendant rule)", tCompact, tree.buttons.size());
+	printf("  %-34s %9.2f ms  (no rule names it, no restyle)\n", "cells: .expanded (unused)", tUnused);
+	return 0;
+}
@@ -0,0 +1,147 @@
+// VarBench: changing an accent color on 5,000 styled widgets.
+//
+// controller -> 4 containers -> 50 cells -> 25 buttons, every button matching ".btn",
+// whose rule paints background and border from the accent (text from --on-accent).
+//   - literal: the accent is written into the rules, so a new accent means recompiling
+//     the rules and re-matching every widget (what a theme edit costs without var())
+//   - var(): the rules say var(--accent) and the controller defines --accent; a new accent
+//     is one SetProperty, and each widget recomputes its two accent values on the next read
+// Also reads the tree again with nothing changed and after redefining a custom property
+// nothing uses, both of which are served from the computed values.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ContextNodeImpl.hpp"
+#include "ChronoSelectors.hpp"
+
+using namespace ChronoUI;
+
+namespace {
+	const char* kAccents[] = { "#0d6efd", "#dc3545", "#198754", "#ffc107" };
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+	private:
+		PropertyHandle m_type;
+	};
+
+	struct Tree {
+		Node root{ "Controller" };
+		std::vector<std::unique_ptr<Node>> nodes;
+		std::vector<Node*> buttons;
+
+		Node* Add(Node* parent, const char* type) {
+			nodes.emplace_back(new Node(type));
+			nodes.back()->SetParentNode(parent);
+			return nodes.back().get();
+		}
+	};
+
+	void Build(Tree& t) {
+		for (int c = 0; c < 4; ++c) {
+			Node* container = t.Add(&t.root, "Container");
+			for (int cell = 0; cell < 50; ++cell) {
+				Node* cellNode = t.Add(container, "Cell");
+				for (int b = 0; b < 25; ++b) {
+					Node* button = t.Add(cellNode, "Button");
+					button->SetProperty("class", "btn");
+					t.buttons.push_back(button);
+				}
+			}
+		}
+	}
+
+	// The .btn rule with 'accent' in every accent-colored declaration
+	void AddSheet(CSS::RuleSet& rules, const std::string& accent) {
+		rules.AddRule(".btn", {
+			{ "background-color", accent, false }, { "border-color", accent, false },
+			{ "color", "var(--on-accent, #ffffff)", false }, { "border-radius", "4", false } });
+		rules.AddRule(".btn:hover", { { "background-color", accent, false } });
+		rules.AddRule("Cell", { { "padding", "2", false } });
+	}
+
+	const PropertyHandle kBg = PropertyAtoms::Intern("background-color");
+	const PropertyHandle kBorder = PropertyAtoms::Intern("border-color");
+	const PropertyHandle kColor = PropertyAtoms::Intern("color");
+
+	// Reads what a paint pass would; returns how many backgrounds equal 'expected'
+	size_t Read(const Tree& t, const char* expected) {
+		size_t n = 0;
+		for (Node* b : t.buttons) {
+			n += (strcmp(b->GetProperty(kBg, ""), expected) == 0);
+			n += (b->GetProperty(kBorder, "")[0] == '#') ? 0 : 1000000;
+			n += (b->GetProperty(kColor, "")[0] == '#') ? 0 : 1000000;
+		}
+		return n;
+	}
+
+	double Elapsed(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = (argc > 1) ? atoi(argv[1]) : 5;
+	if (runs <= 0) runs = 5;
+
+	// 1. Literal accent: recompile and re-match on every change
+	Tree literal;
+	Build(literal);
+	double tLiteral = 1e30;
+	size_t literalOk = 0;
+	for (int r = 0; r < runs; ++r) {
+		const char* accent = kAccents[r % 4];
+		auto start = std::chrono::steady_clock::now();
+		CSS::RuleSet rules;
+		AddSheet(rules, accent);
+		for (Node* b : literal.buttons) b->SetRuleLayer(rules.Match(b));
+		literalOk = Read(literal, accent);
+		tLiteral = (std::min)(tLiteral, Elapsed(start));
+	}
+
+	// 2. var(--accent): one definition on the controller
+	Tree tree;
+	Build(tree);
+	CSS::RuleSet rules;
+	AddSheet(rules, "var(--accent)");
+	for (Node* b : tree.buttons) b->SetRuleLayer(rules.Match(b));
+	tree.root.SetProperty("--accent", kAccents[0]);
+	Read(tree, kAccents[0]);
+
+	double tVar = 1e30, tWarm = 1e30, tUnrelated = 1e30;
+	size_t varOk = 0;
+	for (int r = 0; r < runs; ++r) {
+		const char* accent = kAccents[(r + 1) % 4];
+		auto start = std::chrono::steady_clock::now();
+		tree.root.SetProperty("--accent", accent);
+		varOk = Read(tree, accent);
+		tVar = (std::min)(tVar, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		Read(tree, accent);
+		tWarm = (std::min)(tWarm, Elapsed(start));
+
+		start = std::chrono::steady_clock::now();
+		tree.root.SetProperty("--sidebar-width", (r & 1) ? "200" : "240");
+		Read(tree, accent);
+		tUnrelated = (std::min)(tUnrelated, Elapsed(start));
+	}
+
+	size_t values = tree.buttons.size() * 2;
+	printf("VarBench: %zu buttons, 3 values read each, best of %d runs\n", tree.buttons.size(), runs);
+	printf("  %-36s %9.2f ms  (%zu of %zu correct)\n", "literal: recompile + re-match + read", tLiteral, literalOk, literal.buttons.size());
+	printf("  %-36s %9.2f ms  (%zu of %zu correct, %zu values recomputed)\n", "var(): redefine --accent + read", tVar, varOk, tree.buttons.size(), values);
+	printf("  speedup: %.2fx\n", tLiteral / tVar);
+	printf("  %-36s %9.2f ms\n", "var(): read, nothing changed", tWarm);
+	printf("  %-36s %9.2f ms  (no value depends on it)\n", "var(): redefine --sidebar-width", tUnrelated);
+	return 0;
+}
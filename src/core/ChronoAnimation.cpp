@@ -0,0 +1,423 @@
+#ifndef CHRONOUI_EXPORTS
+#define CHRONOUI_EXPORTS
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ChronoUI.hpp"
+
+namespace ChronoUI {
+
+	// --- Transition Lists ---
+	namespace {
+		std::string_view Trim(std::string_view s) {
+			while (!s.empty() && isspace((unsigned char)s.front())) s.remove_prefix(1);
+			while (!s.empty() && isspace((unsigned char)s.back())) s.remove_suffix(1);
+			return s;
+		}
+
+		// Splits on 'separator' (or any space for ' ') outside parentheses; empty parts are dropped for ' '
+		void Split(std::string_view text, char separator, std::vector<std::string_view>* out) {
+			int depth = 0;
+			size_t start = 0;
+			for (size_t i = 0; i <= text.size(); ++i) {
+				char c = (i < text.size()) ? text[i] : separator;
+				if (c == '(') ++depth;
+				else if (c == ')') --depth;
+				bool split = (i == text.size()) || (depth == 0 && (separator == ' ' ? isspace((unsigned char)c) != 0 : c == separator));
+				if (!split) continue;
+				std::string_view part = Trim(text.substr(start, i - start));
+				if (separator != ' ' || !part.empty()) out->push_back(part);
+				start = i + 1;
+			}
+		}
+
+		// "200ms", "0.2s", ".5s"; false for anything else (a bare "0" included, as in CSS)
+		bool ParseTime(std::string_view token, float* ms) {
+			std::string text(token);
+			char* end = nullptr;
+			float v = strtof(text.c_str(), &end);
+			if (end == text.c_str()) return false;
+			if (strcmp(end, "ms") == 0) *ms = v;
+			else if (strcmp(end, "s") == 0) *ms = v * 1000.0f;
+			else return false;
+			return std::isfinite(*ms);
+		}
+
+		// Comma separated numbers inside "name(...)"
+		bool ParseArguments(std::string_view token, size_t nameLength, std::vector<std::string_view>* args) {
+			if (token.size() < nameLength + 2 || token.back() != ')') return false;
+			Split(token.substr(nameLength + 1, token.size() - nameLength - 2), ',', args);
+			return true;
+		}
+
+		bool ParseNumber(std::string_view token, float* out) {
+			std::string text(token);
+			char* end = nullptr;
+			*out = strtof(text.c_str(), &end);
+			return end != text.c_str() && *end == '\0' && std::isfinite(*out);
+		}
+
+		bool SetCurve(TransitionTiming* t, float x1, float y1, float x2, float y2) {
+			t->x1 = x1; t->y1 = y1; t->x2 = x2; t->y2 = y2;
+			return true;
+		}
+
+		bool ParseEasing(std::string_view token, TransitionTiming* t) {
+			if (token == "linear") return SetCurve(t, 0.0f, 0.0f, 1.0f, 1.0f);
+			if (token == "ease") return SetCurve(t, 0.25f, 0.1f, 0.25f, 1.0f);
+			if (token == "ease-in") return SetCurve(t, 0.42f, 0.0f, 1.0f, 1.0f);
+			if (token == "ease-out") return SetCurve(t, 0.0f, 0.0f, 0.58f, 1.0f);
+			if (token == "ease-in-out") return SetCurve(t, 0.42f, 0.0f, 0.58f, 1.0f);
+			if (token == "step-start" || token == "step-end") {
+				t->steps = 1;
+				t->jumpStart = (token == "step-start");
+				return true;
+			}
+
+			std::vector<std::string_view> args;
+			if (token.compare(0, 13, "cubic-bezier(") == 0) {
+				float v[4];
+				if (!ParseArguments(token, 12, &args) || args.size() != 4) return false;
+				for (int i = 0; i < 4; ++i) if (!ParseNumber(args[i], &v[i])) return false;
+				// The x coordinates must stay in [0, 1] so the curve is a function of time
+				if (v[0] < 0.0f || v[0] > 1.0f || v[2] < 0.0f || v[2] > 1.0f) return false;
+				return SetCurve(t, v[0], v[1], v[2], v[3]);
+			}
+			if (token.compare(0, 6, "steps(") == 0) {
+				float n;
+				if (!ParseArguments(token, 5, &args) || args.empty() || args.size() > 2) return false;
+				if (!ParseNumber(args[0], &n) || n < 1.0f || n != std::floor(n)) return false;
+				t->steps = (uint32_t)n;
+				t->jumpStart = false;
+				if (args.size() == 2) {
+					if (args[1] == "start" || args[1] == "jump-start") t->jumpStart = true;
+					else if (args[1] != "end" && args[1] != "jump-end") return false;
+				}
+				return true;
+			}
+			return false;
+		}
+
+		// One comma entry. Missing parts take the CSS initial values: all, 0s, ease, 0s.
+		bool ParseEntry(std::string_view entry, TransitionTiming* t) {
+			*t = {};
+			SetCurve(t, 0.25f, 0.1f, 0.25f, 1.0f);
+
+			std::vector<std::string_view> tokens;
+			Split(entry, ' ', &tokens);
+			if (tokens.empty()) return false;
+
+			int times = 0;
+			bool hasProperty = false, hasEasing = false;
+			for (std::string_view token : tokens) {
+				float ms;
+				if (ParseTime(token, &ms)) {
+					if (times == 0) {
+						if (ms < 0.0f) return false;
+						t->duration = ms;
+					}
+					else if (times == 1) {
+						t->delay = ms;
+					}
+					else {
+						return false;
+					}
+					++times;
+				}
+				else if (!hasEasing && ParseEasing(token, t)) {
+					hasEasing = true;
+				}
+				else if (!hasProperty && token != "none") {
+					if (!isalpha((unsigned char)token[0]) && token[0] != '-' && token[0] != '_') return false;
+					if (token.find('(') != std::string_view::npos) return false;
+					std::string name(token);
+					t->property = (name == "all") ? 0 : PropertyAtoms::Intern(name.c_str()).id;
+					hasProperty = true;
+				}
+				else {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		class TransitionLists {
+		public:
+			static TransitionLists& Instance() {
+				static TransitionLists instance;
+				return instance;
+			}
+
+			const TransitionList* Get(const char* text) {
+				{
+					std::shared_lock<std::shared_mutex> lock(m_mutex);
+					auto it = m_byText.find(text);
+					if (it != m_byText.end()) return it->second;
+				}
+
+				// Compile outside the lock (it interns property names)
+				std::vector<TransitionTiming> items;
+				std::vector<std::string_view> entries;
+				std::string_view value = Trim(text);
+				bool valid = !value.empty() && value != "none";
+				if (valid) Split(value, ',', &entries);
+				for (std::string_view entry : entries) {
+					TransitionTiming t;
+					if (!ParseEntry(entry, &t)) {
+						valid = false;
+						break;
+					}
+					items.push_back(t);
+				}
+
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_byText.find(text);
+				if (it != m_byText.end()) return it->second;
+
+				const TransitionList* result = nullptr;
+				if (valid && !items.empty()) {
+					m_entries.emplace_back();
+					Entry& e = m_entries.back();
+					e.items.swap(items);
+					e.list = { e.items.data(), (uint32_t)e.items.size() };
+					result = &e.list;
+				}
+				m_byText.emplace(text, result);
+				return result;
+			}
+
+		private:
+			struct Entry {
+				std::vector<TransitionTiming> items;
+				TransitionList list;
+			};
+			std::shared_mutex m_mutex;
+			std::deque<Entry> m_entries;
+			std::unordered_map<std::string, const TransitionList*> m_byText;
+		};
+
+		// x or y of the curve through (0,0), (a,b), (c,d), (1,1) at parameter u
+		float Bezier(float a, float c, float u) {
+			float v = 1.0f - u;
+			return 3.0f * v * v * u * a + 3.0f * v * u * u * c + u * u * u;
+		}
+		float BezierSlope(float a, float c, float u) {
+			float v = 1.0f - u;
+			return 3.0f * v * v * a + 6.0f * v * u * (c - a) + 3.0f * u * u * (1.0f - c);
+		}
+
+		// y for time x: Newton's method from x itself, bisection when the slope is too flat
+		float SolveCurve(const TransitionTiming& t, float x) {
+			if (t.x1 == t.y1 && t.x2 == t.y2) return x;
+
+			float u = x;
+			for (int i = 0; i < 8; ++i) {
+				float error = Bezier(t.x1, t.x2, u) - x;
+				if (std::fabs(error) < 1e-5f) return Bezier(t.y1, t.y2, u);
+				float slope = BezierSlope(t.x1, t.x2, u);
+				if (std::fabs(slope) < 1e-6f) break;
+				u -= error / slope;
+			}
+
+			float lo = 0.0f, hi = 1.0f;
+			u = x;
+			for (int i = 0; i < 32; ++i) {
+				float value = Bezier(t.x1, t.x2, u);
+				if (std::fabs(value - x) < 1e-5f) break;
+				if (value < x) lo = u;
+				else hi = u;
+				u = (lo + hi) * 0.5f;
+			}
+			return Bezier(t.y1, t.y2, u);
+		}
+
+		// sRGB <-> linear light, by table in both directions
+		struct ColorTables {
+			float toLinear[256];
+			uint8_t toSrgb[4096];
+
+			ColorTables() {
+				for (int i = 0; i < 256; ++i) {
+					float c = i / 255.0f;
+					toLinear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+				for (int i = 0; i < 4096; ++i) {
+					float l = i / 4095.0f;
+					float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+					toSrgb[i] = (uint8_t)(std::min)(255.0f, std::floor(c * 255.0f + 0.5f));
+				}
+			}
+
+			uint8_t Encode(float l) const {
+				l = (std::max)(0.0f, (std::min)(1.0f, l));
+				return toSrgb[(int)(l * 4095.0f + 0.5f)];
+			}
+		};
+
+		const ColorTables& Colors() {
+			static const ColorTables tables;
+			return tables;
+		}
+	}
+
+	const TransitionList* __stdcall Transitions::Compile(const char* text) {
+		if (!text || !*text) return nullptr;
+		return TransitionLists::Instance().Get(text);
+	}
+
+	const TransitionTiming* __stdcall Transitions::Find(const TransitionList* list, PropertyHandle property) {
+		if (!list) return nullptr;
+		for (uint32_t i = list->count; i-- > 0;) {
+			const TransitionTiming& t = list->items[i];
+			if (t.property == 0 || t.property == property.id) return &t;
+		}
+		return nullptr;
+	}
+
+	float __stdcall Transitions::Progress(const TransitionTiming& timing, double elapsed) {
+		double active = elapsed - timing.delay;
+		if (active < 0.0) return 0.0f;
+		if (timing.duration <= 0.0f || active >= timing.duration) return 1.0f;
+
+		float x = (float)(active / timing.duration);
+		if (timing.steps > 0) {
+			float n = (float)timing.steps;
+			float step = timing.jumpStart ? std::ceil(x * n) : std::floor(x * n);
+			return (std::min)(1.0f, step / n);
+		}
+		return SolveCurve(timing, x);
+	}
+
+	uint32_t __stdcall Transitions::MixColor(uint32_t from, uint32_t to, float t) {
+		if (t <= 0.0f) return from;
+		if (t >= 1.0f) return to;
+
+		// 1. Premultiplied linear channels of both ends
+		const ColorTables& tables = Colors();
+		float a0 = ((from >> 24) & 0xFF) / 255.0f;
+		float a1 = ((to >> 24) & 0xFF) / 255.0f;
+		float alpha = a0 + (a1 - a0) * t;
+		if (alpha <= 0.0f) return 0;
+
+		// 2. Mix, un-premultiply and encode each of R, G, B
+		uint32_t out = (uint32_t)(alpha * 255.0f + 0.5f) << 24;
+		for (int shift = 16; shift >= 0; shift -= 8) {
+			float c0 = tables.toLinear[(from >> shift) & 0xFF] * a0;
+			float c1 = tables.toLinear[(to >> shift) & 0xFF] * a1;
+			out |= (uint32_t)tables.Encode((c0 + (c1 - c0) * t) / alpha) << shift;
+		}
+		return out;
+	}
+
+	// --- Animation Clock ---
+	// Driven by a thread timer of the UI thread (SetTimer without a window), which exists
+	// only while something is animating.
+	namespace {
+		const UINT kFrameInterval = 16;
+
+		struct ClockState {
+			std::vector<IAnimated*> targets;	// Null slots are removals made during a frame
+			UINT_PTR timer = 0;
+			bool ticking = false;
+		};
+
+		ClockState& Clock() {
+			static ClockState state;
+			return state;
+		}
+
+		void CALLBACK ClockTimerProc(HWND, UINT, UINT_PTR, DWORD) {
+			AnimationClock::Tick(AnimationClock::Now());
+		}
+
+		void UpdateTimer(ClockState& clock) {
+			bool running = !clock.targets.empty();
+			if (running && !clock.timer) {
+				clock.timer = ::SetTimer(NULL, 0, kFrameInterval, ClockTimerProc);
+			}
+			else if (!running && clock.timer) {
+				::KillTimer(NULL, clock.timer);
+				clock.timer = 0;
+			}
+		}
+	}
+
+	double __stdcall AnimationClock::Now() {
+		static const auto origin = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+	}
+
+	void __stdcall AnimationClock::Add(IAnimated* target) {
+		if (!target) return;
+		ClockState& clock = Clock();
+		if (std::find(clock.targets.begin(), clock.targets.end(), target) != clock.targets.end()) return;
+		clock.targets.push_back(target);
+		if (!clock.ticking) UpdateTimer(clock);
+	}
+
+	void __stdcall AnimationClock::Remove(IAnimated* target) {
+		ClockState& clock = Clock();
+		auto it = std::find(clock.targets.begin(), clock.targets.end(), target);
+		if (it == clock.targets.end()) return;
+		if (clock.ticking) {
+			*it = nullptr;
+			return;
+		}
+		clock.targets.erase(it);
+		UpdateTimer(clock);
+	}
+
+	size_t __stdcall AnimationClock::ActiveCount() {
+		const ClockState& clock = Clock();
+		return clock.targets.size() - std::count(clock.targets.begin(), clock.targets.end(), nullptr);
+	}
+
+	size_t __stdcall AnimationClock::Tick(double now) {
+		ClockState& clock = Clock();
+		if (clock.ticking) return clock.targets.size();
+
+		// 1. One frame for everything registered before it started; targets added by a
+		//    frame callback run from the next frame on
+		clock.ticking = true;
+		size_t count = clock.targets.size();
+		for (size_t i = 0; i < count; ++i) {
+			IAnimated* target = clock.targets[i];
+			if (target && !target->OnAnimationFrame(now) && clock.targets[i] == target) clock.targets[i] = nullptr;
+		}
+		clock.ticking = false;
+
+		// 2. Drop finished and removed targets; stop the timer when none is left
+		clock.targets.erase(std::remove(clock.targets.begin(), clock.targets.end(), nullptr), clock.targets.end());
+		UpdateTimer(clock);
+		return clock.targets.size();
+	}
+
+	// --- Live Resize ---
+	namespace {
+		int g_liveResizes = 0;		// Drags in progress (UI thread only)
+	}
+
+	void __stdcall LiveResize::Begin() {
+		++g_liveResizes;
+	}
+
+	void __stdcall LiveResize::End() {
+		if (g_liveResizes > 0) --g_liveResizes;
+	}
+
+	bool __stdcall LiveResize::IsActive() {
+		return g_liveResizes > 0;
+	}
+}
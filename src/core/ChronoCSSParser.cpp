@@ -0,0 +1,551 @@
+#include "ChronoCSSParser.hpp"
+
+namespace ChronoUI {
+	namespace CSS {
+
+		namespace {
+			const size_t npos = std::string_view::npos;
+			const int kMaxNesting = 32; // Deeper at-rule blocks are skipped, not recursed into
+
+			bool IsWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; }
+			bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+			bool IsHex(char c) { return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+			bool IsNameStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (unsigned char)c >= 0x80; }
+			bool IsNameChar(char c) { return IsNameStart(c) || IsDigit(c) || c == '-'; }
+
+			bool EqualsNoCase(std::string_view a, const char* b) {
+				size_t i = 0;
+				for (; i < a.size() && b[i]; ++i) {
+					char c = a[i];
+					if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+					if (c != b[i]) return false;
+				}
+				return i == a.size() && !b[i];
+			}
+
+			// At-rules whose block holds rules, and those whose block holds declarations.
+			// Any other block is skipped.
+			bool IsRuleListAtRule(std::string_view name) {
+				static const char* names[] = { "media", "supports", "layer", "container", "document", "scope", "starting-style" };
+				for (const char* n : names) if (EqualsNoCase(name, n)) return true;
+				return false;
+			}
+			bool IsDeclarationAtRule(std::string_view name) {
+				static const char* names[] = { "font-face", "page", "property", "counter-style", "viewport" };
+				for (const char* n : names) if (EqualsNoCase(name, n)) return true;
+				return false;
+			}
+
+			TokenType ClosingFor(TokenType open) {
+				switch (open) {
+				case TokenType::LeftCurly: return TokenType::RightCurly;
+				case TokenType::LeftSquare: return TokenType::RightSquare;
+				case TokenType::LeftParen:
+				case TokenType::Function: return TokenType::RightParen;
+				default: return TokenType::EndOfFile;
+				}
+			}
+		}
+
+		// =========================================================
+		// --- Tokenizer ---
+		// =========================================================
+
+		void Tokenizer::SkipComments() {
+			while (m_pos + 1 < m_src.size() && m_src[m_pos] == '/' && m_src[m_pos + 1] == '*') {
+				size_t end = m_src.find("*/", m_pos + 2);
+				m_pos = (end == npos) ? m_src.size() : end + 2;
+			}
+		}
+
+		bool Tokenizer::ValidEscape(size_t at) const {
+			return at < m_src.size() && m_src[at] == '\\' && (at + 1 >= m_src.size() || m_src[at + 1] != '\n');
+		}
+
+		bool Tokenizer::StartsIdent(size_t at) const {
+			if (at >= m_src.size()) return false;
+			char c = m_src[at];
+			if (c == '-') {
+				if (at + 1 >= m_src.size()) return false;
+				char n = m_src[at + 1];
+				return IsNameStart(n) || n == '-' || ValidEscape(at + 1);
+			}
+			return IsNameStart(c) || ValidEscape(at);
+		}
+
+		bool Tokenizer::StartsNumber(size_t at) const {
+			if (at >= m_src.size()) return false;
+			char c = m_src[at];
+			if (c == '+' || c == '-') {
+				++at;
+				if (at >= m_src.size()) return false;
+				c = m_src[at];
+			}
+			if (IsDigit(c)) return true;
+			return c == '.' && at + 1 < m_src.size() && IsDigit(m_src[at + 1]);
+		}
+
+		void Tokenizer::ConsumeEscape() {
+			++m_pos; // '\'
+			if (m_pos >= m_src.size()) return;
+			if (IsHex(m_src[m_pos])) {
+				size_t end = m_pos + 6;
+				while (m_pos < m_src.size() && m_pos < end && IsHex(m_src[m_pos])) ++m_pos;
+				if (m_pos < m_src.size() && IsWhitespace(m_src[m_pos])) ++m_pos;
+			}
+			else {
+				++m_pos;
+			}
+		}
+
+		void Tokenizer::ConsumeName() {
+			while (m_pos < m_src.size()) {
+				if (IsNameChar(m_src[m_pos])) ++m_pos;
+				else if (ValidEscape(m_pos)) ConsumeEscape();
+				else break;
+			}
+		}
+
+		void Tokenizer::ConsumeNumber() {
+			if (m_src[m_pos] == '+' || m_src[m_pos] == '-') ++m_pos;
+			while (m_pos < m_src.size() && IsDigit(m_src[m_pos])) ++m_pos;
+			if (m_pos + 1 < m_src.size() && m_src[m_pos] == '.' && IsDigit(m_src[m_pos + 1])) {
+				m_pos += 2;
+				while (m_pos < m_src.size() && IsDigit(m_src[m_pos])) ++m_pos;
+			}
+			if (m_pos + 1 < m_src.size() && (m_src[m_pos] == 'e' || m_src[m_pos] == 'E')) {
+				size_t at = m_pos + 1;
+				if (m_src[at] == '+' || m_src[at] == '-') ++at;
+				if (at < m_src.size() && IsDigit(m_src[at])) {
+					m_pos = at;
+					while (m_pos < m_src.size() && IsDigit(m_src[m_pos])) ++m_pos;
+				}
+			}
+		}
+
+		TokenType Tokenizer::ConsumeString(char quote) {
+			while (m_pos < m_src.size()) {
+				char c = m_src[m_pos];
+				if (c == quote) {
+					++m_pos;
+					return TokenType::String;
+				}
+				if (c == '\n') {
+					// Unterminated on this line; the newline is left for the next token
+					return TokenType::BadString;
+				}
+				if (c == '\\') {
+					if (m_pos + 1 < m_src.size() && m_src[m_pos + 1] == '\n') m_pos += 2;
+					else ConsumeEscape();
+					continue;
+				}
+				++m_pos;
+			}
+			return TokenType::String; // EOF closes the string
+		}
+
+		TokenType Tokenizer::ConsumeUrl() {
+			while (m_pos < m_src.size() && IsWhitespace(m_src[m_pos])) ++m_pos;
+			while (m_pos < m_src.size()) {
+				char c = m_src[m_pos];
+				if (c == ')') {
+					++m_pos;
+					return TokenType::Url;
+				}
+				if (IsWhitespace(c)) {
+					while (m_pos < m_src.size() && IsWhitespace(m_src[m_pos])) ++m_pos;
+					if (m_pos >= m_src.size()) return TokenType::Url;
+					if (m_src[m_pos] == ')') {
+						++m_pos;
+						return TokenType::Url;
+					}
+					break;
+				}
+				if (c == '"' || c == '\'' || c == '(' || (unsigned char)c < 0x20 || c == 0x7f) break;
+				if (c == '\\') {
+					if (!ValidEscape(m_pos)) break;
+					ConsumeEscape();
+					continue;
+				}
+				++m_pos;
+			}
+			if (m_pos >= m_src.size()) return TokenType::Url;
+
+			// Bad url: skip to the closing ')' so the rest of the sheet stays aligned
+			while (m_pos < m_src.size()) {
+				if (m_src[m_pos] == ')') {
+					++m_pos;
+					break;
+				}
+				if (ValidEscape(m_pos)) ConsumeEscape();
+				else ++m_pos;
+			}
+			return TokenType::BadUrl;
+		}
+
+		TokenType Tokenizer::ConsumeIdentLike() {
+			size_t start = m_pos;
+			ConsumeName();
+			if (m_pos >= m_src.size() || m_src[m_pos] != '(') return TokenType::Ident;
+
+			std::string_view name = m_src.substr(start, m_pos - start);
+			++m_pos; // '('
+			if (EqualsNoCase(name, "url")) {
+				size_t at = m_pos;
+				while (at < m_src.size() && IsWhitespace(m_src[at])) ++at;
+				if (at >= m_src.size() || (m_src[at] != '"' && m_src[at] != '\'')) {
+					return ConsumeUrl();
+				}
+			}
+			return TokenType::Function;
+		}
+
+		Token Tokenizer::Next() {
+			SkipComments();
+			size_t start = m_pos;
+			if (m_pos >= m_src.size()) return { TokenType::EndOfFile, std::string_view(), start };
+
+			char c = m_src[m_pos];
+			TokenType type = TokenType::Delim;
+
+			if (IsWhitespace(c)) {
+				while (m_pos < m_src.size() && IsWhitespace(m_src[m_pos])) ++m_pos;
+				type = TokenType::Whitespace;
+			}
+			else if (c == '"' || c == '\'') {
+				++m_pos;
+				type = ConsumeString(c);
+			}
+			else if (IsDigit(c) || ((c == '+' || c == '-' || c == '.') && StartsNumber(m_pos))) {
+				ConsumeNumber();
+				if (StartsIdent(m_pos)) {
+					ConsumeName();
+					type = TokenType::Dimension;
+				}
+				else if (m_pos < m_src.size() && m_src[m_pos] == '%') {
+					++m_pos;
+					type = TokenType::Percentage;
+				}
+				else {
+					type = TokenType::Number;
+				}
+			}
+			else if (c == '-' && m_src.compare(m_pos, 3, "-->") == 0) {
+				m_pos += 3;
+				type = TokenType::CDC;
+			}
+			else if (c == '<' && m_src.compare(m_pos, 4, "<!--") == 0) {
+				m_pos += 4;
+				type = TokenType::CDO;
+			}
+			else if (StartsIdent(m_pos)) {
+				type = ConsumeIdentLike();
+			}
+			else if (c == '#' && m_pos + 1 < m_src.size() && (IsNameChar(m_src[m_pos + 1]) || ValidEscape(m_pos + 1))) {
+				++m_pos;
+				ConsumeName();
+				type = TokenType::Hash;
+			}
+			else if (c == '@' && StartsIdent(m_pos + 1)) {
+				++m_pos;
+				ConsumeName();
+				type = TokenType::AtKeyword;
+			}
+			else {
+				++m_pos;
+				switch (c) {
+				case ':': type = TokenType::Colon; break;
+				case ';': type = TokenType::Semicolon; break;
+				case ',': type = TokenType::Comma; break;
+				case '(': type = TokenType::LeftParen; break;
+				case ')': type = TokenType::RightParen; break;
+				case '[': type = TokenType::LeftSquare; break;
+				case ']': type = TokenType::RightSquare; break;
+				case '{': type = TokenType::LeftCurly; break;
+				case '}': type = TokenType::RightCurly; break;
+				default: type = TokenType::Delim; break;
+				}
+			}
+			return { type, m_src.substr(start, m_pos - start), start };
+		}
+
+		// =========================================================
+		// --- Parser ---
+		// =========================================================
+
+		namespace {
+			struct ParserState {
+				Tokenizer tok;
+				StyleSheet* sheet;
+				Token current = { TokenType::EndOfFile, std::string_view(), 0 };
+				bool reconsume = false;
+
+				ParserState(std::string_view source, StyleSheet* out) : tok(source), sheet(out) {}
+
+				Token Next() {
+					if (reconsume) reconsume = false;
+					else current = tok.Next();
+					return current;
+				}
+				void Reconsume() { reconsume = true; }
+				void Error(size_t offset, const char* message) { sheet->errors.push_back({ offset, message }); }
+
+				std::string_view Span(size_t begin, size_t end) const {
+					if (begin == npos || end <= begin) return std::string_view();
+					return tok.Source().substr(begin, end - begin);
+				}
+
+				// Skips to the token closing 'open' (just consumed), nested blocks included.
+				// Returns the offset just past the closer, or npos at EOF.
+				size_t SkipBlock(TokenType open) {
+					std::vector<TokenType> closers(1, ClosingFor(open));
+					while (!closers.empty()) {
+						Token t = Next();
+						if (t.type == TokenType::EndOfFile) return npos;
+						if (t.type == closers.back()) closers.pop_back();
+						else if (ClosingFor(t.type) != TokenType::EndOfFile) closers.push_back(ClosingFor(t.type));
+					}
+					return current.offset + current.text.size();
+				}
+
+				// Component values up to '{' (or ';' for at-rules). 'nested': a '}' closes the enclosing block.
+				// Returns the terminating token; [*begin, *end) spans the non-whitespace content.
+				Token ConsumePrelude(bool atRule, bool nested, size_t* begin, size_t* end) {
+					*begin = *end = npos;
+					for (;;) {
+						Token t = Next();
+						if (t.type == TokenType::EndOfFile || t.type == TokenType::LeftCurly) return t;
+						if (atRule && t.type == TokenType::Semicolon) return t;
+						if (nested && t.type == TokenType::RightCurly) {
+							Reconsume();
+							return t;
+						}
+						if (t.type == TokenType::Whitespace) continue;
+
+						if (*begin == npos) *begin = t.offset;
+						*end = t.offset + t.text.size();
+						if (ClosingFor(t.type) != TokenType::EndOfFile && t.type != TokenType::LeftCurly) {
+							size_t close = SkipBlock(t.type);
+							*end = (close == npos) ? tok.Offset() : close;
+							if (close == npos) return current;
+						}
+					}
+				}
+
+				// Error recovery inside a block: drop everything up to the next ';' or the block's '}'.
+				// A nested {} block (e.g. a nested rule) ends the skipped part as well.
+				void SkipDeclaration() {
+					for (;;) {
+						Token t = Next();
+						if (t.type == TokenType::Semicolon) return;
+						if (t.type == TokenType::RightCurly || t.type == TokenType::EndOfFile) {
+							Reconsume();
+							return;
+						}
+						if (ClosingFor(t.type) != TokenType::EndOfFile) {
+							if (SkipBlock(t.type) == npos) return;
+							if (t.type == TokenType::LeftCurly) return;
+						}
+					}
+				}
+
+				void ConsumeDeclaration(const Token& name) {
+					// 1. Name, ':'
+					Token t = Next();
+					while (t.type == TokenType::Whitespace) t = Next();
+					if (t.type != TokenType::Colon) {
+						Error(t.offset, "expected ':' after property name");
+						Reconsume();
+						SkipDeclaration();
+						return;
+					}
+
+					// 2. Value span, tracking a trailing "! important"
+					size_t begin = npos, end = npos;
+					size_t bangAt = npos, beforeBang = npos;
+					size_t badAt = npos;	// A string cut by a newline or a broken url() voids the declaration
+					bool important = false;
+					for (;;) {
+						t = Next();
+						if (t.type == TokenType::Semicolon) break;
+						if (t.type == TokenType::RightCurly || t.type == TokenType::EndOfFile) {
+							Reconsume();
+							break;
+						}
+						if (t.type == TokenType::Whitespace) continue;
+						if ((t.type == TokenType::BadString || t.type == TokenType::BadUrl) && badAt == npos) badAt = t.offset;
+
+						size_t tokenEnd = t.offset + t.text.size();
+						if (ClosingFor(t.type) != TokenType::EndOfFile) {
+							size_t close = SkipBlock(t.type);
+							tokenEnd = (close == npos) ? tok.Offset() : close;
+						}
+
+						if (t.IsDelim('!')) {
+							bangAt = t.offset;
+							beforeBang = end;
+							important = false;
+						}
+						else if (bangAt != npos && end == bangAt + 1 && t.type == TokenType::Ident && EqualsNoCase(t.text, "important")) {
+							important = true;
+						}
+						else {
+							bangAt = npos;
+							important = false;
+						}
+
+						if (begin == npos) begin = t.offset;
+						end = tokenEnd;
+						if (current.type == TokenType::EndOfFile) break;
+					}
+					if (important) end = beforeBang;
+					if (badAt != npos) {
+						Error(badAt, "bad string or url in a value");
+						return;
+					}
+
+					// 3. Only custom properties may be empty
+					std::string_view value = Span(begin, end);
+					if (value.empty() && name.text.compare(0, 2, "--") != 0) {
+						Error(name.offset, "declaration without a value");
+						return;
+					}
+					sheet->declarations.push_back({ name.text, value, important });
+				}
+
+				void ConsumeDeclarationList(size_t ruleIndex) {
+					for (;;) {
+						Token t = Next();
+						switch (t.type) {
+						case TokenType::Whitespace:
+						case TokenType::Semicolon:
+							continue;
+						case TokenType::RightCurly:
+							break;
+						case TokenType::EndOfFile:
+							Error(t.offset, "unterminated block");
+							break;
+						case TokenType::Ident:
+							ConsumeDeclaration(t);
+							continue;
+						case TokenType::AtKeyword:
+							Error(t.offset, "at-rule inside a declaration block is not supported");
+							SkipDeclaration();
+							continue;
+						default:
+							Error(t.offset, "expected a declaration");
+							Reconsume();
+							SkipDeclaration();
+							continue;
+						}
+						break;
+					}
+					Rule& rule = sheet->rules[ruleIndex];
+					rule.declarationCount = (uint32_t)(sheet->declarations.size() - rule.firstDeclaration);
+				}
+
+				size_t AddRule(std::string_view atKeyword, std::string_view prelude, int32_t parent, bool hasBlock) {
+					sheet->rules.push_back({ atKeyword, prelude, parent, (uint32_t)sheet->declarations.size(), 0, hasBlock });
+					return sheet->rules.size() - 1;
+				}
+
+				void ConsumeQualifiedRule(int32_t parent, bool nested) {
+					size_t begin, end;
+					Token t = ConsumePrelude(false, nested, &begin, &end);
+					if (t.type != TokenType::LeftCurly) {
+						Error((begin != npos) ? begin : t.offset, "selector without a block");
+						return;
+					}
+					ConsumeDeclarationList(AddRule(std::string_view(), Span(begin, end), parent, true));
+				}
+
+				void ConsumeAtRule(const Token& at, int32_t parent, int depth, bool nested) {
+					std::string_view name = at.text.substr(1);
+					size_t begin, end;
+					Token t = ConsumePrelude(true, nested, &begin, &end);
+					bool hasBlock = (t.type == TokenType::LeftCurly);
+					size_t index = AddRule(name, Span(begin, end), parent, hasBlock);
+
+					if (!hasBlock) {
+						if (t.type == TokenType::EndOfFile) Error(at.offset, "unterminated at-rule");
+						return;
+					}
+					if (IsRuleListAtRule(name) && depth < kMaxNesting) {
+						ConsumeRuleList(false, (int32_t)index, depth + 1);
+					}
+					else if (IsDeclarationAtRule(name)) {
+						ConsumeDeclarationList(index);
+					}
+					else {
+						if (depth >= kMaxNesting) Error(at.offset, "at-rule nested too deeply");
+						if (SkipBlock(TokenType::LeftCurly) == npos) Error(at.offset, "unterminated block");
+					}
+				}
+
+				void ConsumeRuleList(bool top, int32_t parent, int depth) {
+					for (;;) {
+						Token t = Next();
+						switch (t.type) {
+						case TokenType::Whitespace:
+							continue;
+						case TokenType::EndOfFile:
+							if (!top) Error(t.offset, "unterminated block");
+							return;
+						case TokenType::CDO:
+						case TokenType::CDC:
+							if (top) continue;
+							Reconsume();
+							ConsumeQualifiedRule(parent, !top);
+							continue;
+						case TokenType::AtKeyword:
+							ConsumeAtRule(t, parent, depth, !top);
+							continue;
+						case TokenType::RightCurly:
+							if (!top) return;
+							Error(t.offset, "unexpected '}'");
+							continue;
+						default:
+							Reconsume();
+							ConsumeQualifiedRule(parent, !top);
+							continue;
+						}
+					}
+				}
+			};
+		}
+
+		void Parser::Parse(std::string_view source, StyleSheet* out) {
+			if (!out) return;
+			ParserState state(source, out);
+			state.ConsumeRuleList(true, -1, 0);
+		}
+
+		void Parser::SplitList(std::string_view prelude, std::vector<std::string_view>* out) {
+			Tokenizer tok(prelude);
+			int depth = 0;
+			size_t begin = npos, end = npos;
+			for (;;) {
+				Token t = tok.Next();
+				if (t.type == TokenType::EndOfFile || (depth == 0 && t.type == TokenType::Comma)) {
+					if (begin != npos) out->push_back(prelude.substr(begin, end - begin));
+					if (t.type == TokenType::EndOfFile) return;
+					begin = end = npos;
+					continue;
+				}
+				if (t.type == TokenType::LeftParen || t.type == TokenType::Function || t.type == TokenType::LeftSquare) ++depth;
+				else if ((t.type == TokenType::RightParen || t.type == TokenType::RightSquare) && depth > 0) --depth;
+				if (t.type == TokenType::Whitespace) continue;
+				if (begin == npos) begin = t.offset;
+				end = t.offset + t.text.size();
+			}
+		}
+
+		size_t Parser::LineOf(std::string_view source, size_t offset) {
+			size_t line = 1;
+			for (size_t i = 0; i < offset && i < source.size(); ++i) {
+				if (source[i] == '\n') ++line;
+			}
+			return line;
+		}
+	}
+}
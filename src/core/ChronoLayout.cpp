@@ -0,0 +1,527 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ChronoLayout.hpp"
+
+namespace ChronoUI {
+	namespace Layout {
+
+		int Grid::Scale(float px) const {
+			// MulDiv((int)px, dpi, 96): truncate, scale, round half away from zero
+			int64_t n = (int64_t)(int)px * dpi;
+			return (int)((n >= 0) ? (n + 48) / 96 : (n - 48) / 96);
+		}
+
+		int Grid::MinPixels(const Track& t, int total, int content) const {
+			if (t.min.unit == Unit::Auto) return content;
+			return (t.min.unit == Unit::Percent) ? (int)(total * t.min.value / 100.0f) : Scale(t.min.value);
+		}
+
+		static bool IsAuto(const Track& t) {
+			return t.size.unit == Unit::Auto || t.min.unit == Unit::Auto;
+		}
+
+		void Grid::AutoSizes(bool vertical, std::vector<int>* content) const {
+			const std::vector<Track>& tracks = vertical ? rows : cols;
+			content->assign(tracks.size(), 0);
+			if (std::none_of(tracks.begin(), tracks.end(), IsAuto)) return;
+			int count = (int)tracks.size();
+			int bar = Scale((float)splitterSize);
+
+			// 1. Cells in a single track
+			for (const Area& a : areas) {
+				int first = vertical ? a.row : a.col;
+				int span = vertical ? a.rowSpan : a.colSpan;
+				if (span != 1 || first < 0 || first >= count || !IsAuto(tracks[first])) continue;
+				(*content)[first] = (std::max)((*content)[first], vertical ? a.contentH : a.contentW);
+			}
+
+			// 2. Spanning cells: what the fixed and auto tracks they cross do not give yet is
+			// spread evenly over the auto ones. A cell that also spans a fill track takes its
+			// room from that track instead, as in CSS.
+			for (const Area& a : areas) {
+				int first = (std::max)(vertical ? a.row : a.col, 0);
+				int last = (std::min)((vertical ? a.row + a.rowSpan : a.col + a.colSpan), count);
+				if (last - first < 2) continue;
+
+				int have = 0, autos = 0;
+				bool fills = false;
+				for (int k = first; k < last; ++k) {
+					const Track& t = tracks[k];
+					fills = fills || t.size.unit == Unit::Fill;
+					if (IsAuto(t)) {
+						have += (*content)[k];
+						++autos;
+					}
+					else if (t.size.unit == Unit::Pixels) have += Scale(t.size.value);
+					else if (t.size.unit == Unit::System) have += t.system;
+					if (t.splitter && k + 1 < last) have += bar;
+				}
+				int missing = (vertical ? a.contentH : a.contentW) - have;
+				if (missing <= 0 || autos == 0 || fills) continue;
+				int share = missing / autos, remainder = missing % autos;
+				for (int k = first; k < last; ++k) {
+					if (!IsAuto(tracks[k])) continue;
+					(*content)[k] += share + ((remainder-- > 0) ? 1 : 0);
+				}
+			}
+		}
+
+		void Grid::SolveAxis(const std::vector<Track>& tracks, const std::vector<int>& content, int total, int offset, std::vector<Span>* spans) const {
+			spans->resize(tracks.size());
+			int bar = Scale((float)splitterSize);
+
+			// 1. Fixed, system, auto and percent tracks; what remains goes to the fill tracks
+			int avail = total;
+			float fillWeights = 0.0f;
+			for (size_t i = 0; i < tracks.size(); ++i) {
+				const Track& t = tracks[i];
+				const Length& size = t.collapsed ? t.min : t.size;
+				int minPx = MinPixels(t, total, content[i]);
+				int& actual = (*spans)[i].size;
+				if (t.splitter) avail -= bar;
+
+				if (size.unit == Unit::Pixels) actual = (std::max)(Scale(size.value), minPx);
+				else if (size.unit == Unit::System) actual = t.system;
+				else if (size.unit == Unit::Auto) actual = (std::max)(content[i], minPx);
+				else if (size.unit == Unit::Percent) actual = (std::max)((int)(total * size.value / 100.0f), minPx);
+				else {
+					actual = 0;
+					fillWeights += size.value;
+					continue;
+				}
+				avail -= actual;
+			}
+
+			// 2. Fill tracks by weight. One held at its minimum takes that out of what the others
+			// share, and they share again (minmax(auto, 1fr) next to 1fr).
+			for (bool settled = false; fillWeights > 0.0f && !settled;) {
+				settled = true;
+				for (size_t i = 0; i < tracks.size(); ++i) {
+					const Track& t = tracks[i];
+					const Length& size = t.collapsed ? t.min : t.size;
+					if (size.unit != Unit::Fill || (*spans)[i].size < 0) continue;
+					int share = (avail > 0) ? (int)(avail * size.value / fillWeights) : 0;
+					int minPx = MinPixels(t, total, content[i]);
+					(*spans)[i].size = (std::max)(share, minPx);
+					if (share < minPx && avail > 0) {
+						// Held: marked negative until the others are done
+						(*spans)[i].size = -minPx - 1;
+						avail -= minPx;
+						fillWeights -= size.value;
+						settled = false;
+						break;
+					}
+				}
+			}
+			for (Span& span : *spans) {
+				if (span.size < 0) span.size = -span.size - 1;
+			}
+
+			// 3. Positions, each splitter bar right after its track
+			int cur = offset;
+			for (size_t i = 0; i < tracks.size(); ++i) {
+				(*spans)[i].pos = cur;
+				cur += (*spans)[i].size + (tracks[i].splitter ? bar : 0);
+			}
+		}
+
+		void Grid::Solve(int x, int y, int w, int h) {
+			m_x = x;
+			m_y = y;
+			m_w = w;
+			m_h = h;
+			AutoSizes(true, &m_rowContent);
+			AutoSizes(false, &m_colContent);
+			SolveAxis(rows, m_rowContent, h, y, &m_rowSpans);
+			SolveAxis(cols, m_colContent, w, x, &m_colSpans);
+
+			// Cells, then the column bars (full height), then the row bars (full width)
+			size_t count = ItemCount() + cols.size() + rows.size();
+			bool resized = (m_rects.size() != count);
+			m_rects.resize(count);
+			m_changed.clear();
+			auto place = [&](size_t index, const Rect& r) {
+				if (resized || m_rects[index] != r) {
+					m_rects[index] = r;
+					m_changed.push_back((uint32_t)index);
+				}
+			};
+
+			int bar = Scale((float)splitterSize);
+			if (areas.empty()) {
+				for (size_t r = 0; r < rows.size(); ++r) {
+					for (size_t c = 0; c < cols.size(); ++c) {
+						place(CellIndex(r, c), { m_colSpans[c].pos, m_rowSpans[r].pos, m_colSpans[c].size, m_rowSpans[r].size });
+					}
+				}
+			}
+			for (size_t i = 0; i < areas.size(); ++i) {
+				// From the first track's start to the last one's end, bars in between included
+				const Area& a = areas[i];
+				int r0 = (std::max)(a.row, 0), r1 = (std::min)(a.row + a.rowSpan, (int)rows.size()) - 1;
+				int c0 = (std::max)(a.col, 0), c1 = (std::min)(a.col + a.colSpan, (int)cols.size()) - 1;
+				Rect rect = { 0, 0, 0, 0 };
+				if (r0 <= r1 && c0 <= c1) {
+					rect.x = m_colSpans[c0].pos;
+					rect.y = m_rowSpans[r0].pos;
+					rect.w = m_colSpans[c1].pos + m_colSpans[c1].size - rect.x;
+					rect.h = m_rowSpans[r1].pos + m_rowSpans[r1].size - rect.y;
+				}
+				place(i, rect);
+			}
+			for (size_t c = 0; c < cols.size(); ++c) {
+				Rect r = { 0, 0, 0, 0 };
+				if (cols[c].splitter) r = { m_colSpans[c].pos + m_colSpans[c].size, y, bar, h };
+				place(ColSplitterIndex(c), r);
+			}
+			for (size_t r = 0; r < rows.size(); ++r) {
+				Rect rect = { 0, 0, 0, 0 };
+				if (rows[r].splitter) rect = { x, m_rowSpans[r].pos + m_rowSpans[r].size, w, bar };
+				place(RowSplitterIndex(r), rect);
+			}
+		}
+
+		void Grid::Solve(int x, int y, int w, int h, uint64_t generation) {
+			if (dpi != m_cacheDpi || splitterSize != m_cacheSplitterSize) {
+				m_cache.Clear();
+				m_cacheDpi = dpi;
+				m_cacheSplitterSize = splitterSize;
+			}
+
+			// 1. Solved before: the spans as they were, the rectangles compared like a solve does
+			if (const Solved* solved = m_cache.Find(x, y, w, h, generation)) {
+				m_x = x;
+				m_y = y;
+				m_w = w;
+				m_h = h;
+				m_rowSpans = solved->rowSpans;
+				m_colSpans = solved->colSpans;
+				m_rowContent = solved->rowContent;
+				m_colContent = solved->colContent;
+				bool resized = (m_rects.size() != solved->rects.size());
+				m_rects.resize(solved->rects.size());
+				m_changed.clear();
+				for (size_t i = 0; i < m_rects.size(); ++i) {
+					if (resized || m_rects[i] != solved->rects[i]) {
+						m_rects[i] = solved->rects[i];
+						m_changed.push_back((uint32_t)i);
+					}
+				}
+				return;
+			}
+
+			// 2. Solve and keep the result
+			Solve(x, y, w, h);
+			Solved& kept = m_cache.Store(x, y, w, h, generation);
+			kept.rowSpans = m_rowSpans;
+			kept.colSpans = m_colSpans;
+			kept.rowContent = m_rowContent;
+			kept.colContent = m_colContent;
+			kept.rects = m_rects;
+		}
+
+		uint64_t Grid::Signature() const {
+			// FNV-1a over the fields, a word at a time
+			uint64_t hash = 14695981039346656037ull;
+			auto mix = [&hash](uint64_t v) { hash = (hash ^ v) * 1099511628211ull; };
+			auto mixFloat = [&mix](float f) {
+				uint32_t bits;
+				memcpy(&bits, &f, sizeof(bits));
+				mix(bits);
+			};
+			auto mixTracks = [&](const std::vector<Track>& tracks) {
+				mix(tracks.size());
+				for (const Track& t : tracks) {
+					mix((uint64_t)t.size.unit << 16 | (uint64_t)t.min.unit << 8 | (t.splitter ? 1u : 0u) | (t.collapsed ? 2u : 0u));
+					mixFloat(t.size.value);
+					mixFloat(t.min.value);
+					mix((uint32_t)t.system);
+				}
+			};
+			mixTracks(rows);
+			mixTracks(cols);
+			mix(areas.size());
+			for (const Area& a : areas) {
+				mix((uint64_t)(uint32_t)a.row << 32 | (uint32_t)a.col);
+				mix((uint64_t)(uint32_t)a.rowSpan << 32 | (uint32_t)a.colSpan);
+				mix((uint64_t)(uint32_t)a.contentW << 32 | (uint32_t)a.contentH);
+			}
+			mix((uint32_t)dpi);
+			mix((uint32_t)splitterSize);
+			return hash;
+		}
+
+		void Grid::MinimumSize(int* w, int* h) const {
+			int bar = Scale((float)splitterSize);
+			std::vector<int> content;
+			auto axis = [&](bool vertical) {
+				const std::vector<Track>& tracks = vertical ? rows : cols;
+				AutoSizes(vertical, &content);
+				int total = 0;
+				for (size_t i = 0; i < tracks.size(); ++i) {
+					const Track& t = tracks[i];
+					if (t.splitter) total += bar;
+					const Length& size = t.collapsed ? t.min : t.size;
+					if (size.unit == Unit::Pixels) total += Scale(size.value);
+					else if (size.unit == Unit::System) total += t.system;
+					else if (size.unit == Unit::Auto || t.min.unit == Unit::Auto) total += content[i];
+					else if (t.min.unit == Unit::Pixels) total += Scale(t.min.value);	// A percent minimum needs the box
+				}
+				return total;
+			};
+			*w = axis(false);
+			*h = axis(true);
+		}
+
+		float Grid::Drag(const std::vector<Track>& tracks, const std::vector<int>& content, const std::vector<Span>& spans, int origin, int total, size_t index, int pointer) const {
+			if (index >= tracks.size() || index >= spans.size() || index >= content.size()) return 0.0f;
+
+			// Room the tracks after this one need at their minimum
+			int bar = Scale((float)splitterSize);
+			int after = 0;
+			for (size_t i = index + 1; i < tracks.size(); ++i) {
+				after += MinPixels(tracks[i], total, content[i]);
+				if (tracks[i].splitter) after += bar;
+			}
+
+			int size = pointer - spans[index].pos;
+			size = (std::max)(size, MinPixels(tracks[index], total, content[index]));
+			size = (std::min)(size, origin + total - after - spans[index].pos);
+			return size * 96.0f / dpi;
+		}
+
+		float Grid::DragRow(size_t row, int pointer) const {
+			return Drag(rows, m_rowContent, m_rowSpans, m_y, m_h, row, pointer);
+		}
+
+		float Grid::DragCol(size_t col, int pointer) const {
+			return Drag(cols, m_colContent, m_colSpans, m_x, m_w, col, pointer);
+		}
+
+		void Flex::SortOrder() {
+			// Visible items; stable insertion sort on 'order' (few items, and no allocation)
+			m_order.clear();
+			m_work.resize(items.size());
+			for (size_t i = 0; i < items.size(); ++i) {
+				if (items[i].hidden) continue;
+				uint32_t index = (uint32_t)i;
+				size_t k = m_order.size();
+				m_order.push_back(index);
+				while (k > 0 && items[m_order[k - 1]].order > items[index].order) {
+					m_order[k] = m_order[k - 1];
+					--k;
+				}
+				m_order[k] = index;
+			}
+		}
+
+		void Flex::Hypothetical(size_t i) {
+			const FlexItem& item = items[i];
+			Work& w = m_work[i];
+			w.base = (float)((item.basis >= 0) ? item.basis : item.content);
+
+			// Automatic minimum: no smaller than the content, unless the basis asks for less
+			w.minMain = (float)((item.minMain >= 0) ? item.minMain : (std::min)(item.content, (item.basis >= 0) ? item.basis : item.content));
+			w.maxMain = (item.maxMain >= 0) ? (std::max)((float)item.maxMain, w.minMain) : 1e9f;
+			w.target = (std::min)((std::max)(w.base, w.minMain), w.maxMain);
+			w.frozen = false;
+
+			float cross = (float)((item.cross >= 0) ? item.cross : item.crossContent);
+			if (item.maxCross >= 0) cross = (std::min)(cross, (float)item.maxCross);
+			w.cross = (std::max)(cross, (float)item.minCross);
+		}
+
+		void Flex::ResolveLine(const Line& line, float mainSize) {
+			// 1. Grow or shrink, from the hypothetical sizes; inflexible items freeze right away
+			float gaps = (float)gap * (float)(line.count - 1);
+			float hypothetical = gaps;
+			for (size_t k = line.first; k < line.first + line.count; ++k) hypothetical += m_work[m_order[k]].target;
+			bool growing = hypothetical < mainSize;
+			size_t unfrozen = 0;
+			for (size_t k = line.first; k < line.first + line.count; ++k) {
+				const FlexItem& item = items[m_order[k]];
+				Work& w = m_work[m_order[k]];
+				float factor = growing ? item.grow : item.shrink;
+				w.frozen = factor <= 0.0f || (growing && w.base > w.target) || (!growing && w.base < w.target);
+				if (!w.frozen) ++unfrozen;
+			}
+
+			// 2. Share the free space, clamp, freeze the violators and go again
+			for (size_t pass = 0; unfrozen > 0 && pass <= line.count; ++pass) {
+				float free = mainSize - gaps, factors = 0.0f;
+				for (size_t k = line.first; k < line.first + line.count; ++k) {
+					const FlexItem& item = items[m_order[k]];
+					const Work& w = m_work[m_order[k]];
+					if (w.frozen) {
+						free -= w.target;
+						continue;
+					}
+					free -= w.base;
+					factors += growing ? item.grow : item.shrink * w.base;
+				}
+				if (growing && factors < 1.0f) free *= factors;
+
+				float violation = 0.0f;
+				for (size_t k = line.first; k < line.first + line.count; ++k) {
+					const FlexItem& item = items[m_order[k]];
+					Work& w = m_work[m_order[k]];
+					if (w.frozen) continue;
+					float share = 0.0f;
+					if (factors > 0.0f) share = free * (growing ? item.grow : item.shrink * w.base) / factors;
+					float unclamped = w.base + share;
+					w.target = (std::min)((std::max)(unclamped, w.minMain), w.maxMain);
+					w.clamped = w.target - unclamped;
+					violation += w.clamped;
+				}
+
+				// Minimum violations freeze when the total is positive, maximum ones when negative
+				for (size_t k = line.first; k < line.first + line.count; ++k) {
+					Work& w = m_work[m_order[k]];
+					if (w.frozen) continue;
+					bool freeze = (violation == 0.0f) || (violation > 0.0f && w.clamped > 0.0f) || (violation < 0.0f && w.clamped < 0.0f);
+					if (freeze) {
+						w.frozen = true;
+						--unfrozen;
+					}
+				}
+			}
+		}
+
+		void Flex::Solve(int x, int y, int w, int h, bool unbounded) {
+			float mainSize = (float)(row ? w : h);
+			float crossSize = (float)(row ? h : w);
+			bool bounded = !unbounded;
+
+			// 1. Hypothetical sizes, in order
+			SortOrder();
+			for (uint32_t i : m_order) Hypothetical(i);
+
+			// 2. Lines
+			m_lines.clear();
+			Line current = { 0, 0, 0.0f, 0.0f };
+			float used = 0.0f;
+			for (size_t k = 0; k < m_order.size(); ++k) {
+				float outer = m_work[m_order[k]].target;
+				if (wrap && bounded && current.count > 0 && used + gap + outer > mainSize) {
+					m_lines.push_back(current);
+					current = { k, 0, 0.0f, 0.0f };
+					used = 0.0f;
+				}
+				used += (current.count ? gap : 0) + outer;
+				++current.count;
+			}
+			if (current.count > 0) m_lines.push_back(current);
+
+			// 3. Flexible lengths, and the cross size of each line
+			for (Line& line : m_lines) {
+				if (bounded) ResolveLine(line, mainSize);
+				line.cross = 0.0f;
+				for (size_t k = line.first; k < line.first + line.count; ++k) line.cross = (std::max)(line.cross, m_work[m_order[k]].cross);
+			}
+			if (m_lines.size() == 1 && !wrap) m_lines[0].cross = crossSize;
+
+			// 4. align-content: lines packed or stretched along the cross axis
+			float linesCross = (float)crossGap * (float)(m_lines.empty() ? 0 : m_lines.size() - 1);
+			for (const Line& line : m_lines) linesCross += line.cross;
+			float extra = crossSize - linesCross;
+			float crossPos = 0.0f;
+			if (extra > 0.0f && !m_lines.empty()) {
+				if (alignContent == Align::Stretch) {
+					for (Line& line : m_lines) line.cross += extra / (float)m_lines.size();
+				}
+				else if (alignContent == Align::Center) crossPos = extra / 2.0f;
+				else if (alignContent == Align::End) crossPos = extra;
+			}
+			for (Line& line : m_lines) {
+				line.pos = crossPos;
+				crossPos += line.cross + crossGap;
+			}
+
+			// 5. Rectangles: justify-content along each line, alignment across it
+			size_t count = items.size();
+			bool resized = (m_rects.size() != count);
+			m_rects.resize(count);
+			m_changed.clear();
+			auto place = [&](size_t index, const Rect& r) {
+				if (resized || m_rects[index] != r) {
+					m_rects[index] = r;
+					m_changed.push_back((uint32_t)index);
+				}
+			};
+			for (size_t i = 0; i < count; ++i) {
+				if (items[i].hidden) place(i, { 0, 0, 0, 0 });
+			}
+
+			m_extent = 0;
+			for (const Line& line : m_lines) {
+				float lineUsed = (float)gap * (float)(line.count - 1);
+				for (size_t k = line.first; k < line.first + line.count; ++k) lineUsed += m_work[m_order[k]].target;
+				float free = bounded ? mainSize - lineUsed : 0.0f;
+
+				float pos = 0.0f, between = (float)gap;
+				if (free > 0.0f) {
+					switch (justify) {
+					case Justify::Center: pos = free / 2.0f; break;
+					case Justify::End: pos = free; break;
+					case Justify::SpaceBetween: if (line.count > 1) between += free / (float)(line.count - 1); break;
+					case Justify::SpaceAround: pos = free / (float)line.count / 2.0f; between += free / (float)line.count; break;
+					case Justify::SpaceEvenly: pos = free / (float)(line.count + 1); between += free / (float)(line.count + 1); break;
+					default: break;
+					}
+				}
+
+				for (size_t k = line.first; k < line.first + line.count; ++k) {
+					uint32_t i = m_order[k];
+					const FlexItem& item = items[i];
+					const Work& work = m_work[i];
+
+					Align align = (item.alignSelf == Align::Auto) ? alignItems : item.alignSelf;
+					float cross = work.cross;
+					if (align == Align::Stretch && item.cross < 0) {
+						cross = line.cross;
+						if (item.maxCross >= 0) cross = (std::min)(cross, (float)item.maxCross);
+						cross = (std::max)(cross, (float)item.minCross);
+					}
+					float crossOffset = 0.0f;
+					if (align == Align::Center) crossOffset = (line.cross - cross) / 2.0f;
+					else if (align == Align::End) crossOffset = line.cross - cross;
+
+					// Edges rounded, not sizes, so neighbours never leave a pixel between them
+					int main0 = (int)std::lround(pos), main1 = (int)std::lround(pos + work.target);
+					int cross0 = (int)std::lround(line.pos + crossOffset), cross1 = (int)std::lround(line.pos + crossOffset + cross);
+					if (row) place(i, { x + main0, y + cross0, main1 - main0, cross1 - cross0 });
+					else place(i, { x + cross0, y + main0, cross1 - cross0, main1 - main0 });
+
+					m_extent = (std::max)(m_extent, main1);
+					pos += work.target + between;
+				}
+			}
+		}
+
+		size_t Flex::Overflow(int main, int reserve) {
+			SortOrder();
+			float total = 0.0f;
+			for (size_t k = 0; k < m_order.size(); ++k) {
+				Hypothetical(m_order[k]);
+				total += m_work[m_order[k]].target + (k ? gap : 0);
+			}
+			if (total <= (float)main) return 0;
+
+			// Everything up to the first item that does not fit next to the reserve stays
+			float limit = (float)(main - reserve), used = 0.0f;
+			size_t hidden = 0;
+			for (size_t k = 0; k < m_order.size(); ++k) {
+				float outer = m_work[m_order[k]].target + (k ? gap : 0);
+				if (hidden == 0 && used + outer <= limit) {
+					used += outer;
+					continue;
+				}
+				items[m_order[k]].hidden = true;
+				++hidden;
+			}
+			return hidden;
+		}
+	}
+}
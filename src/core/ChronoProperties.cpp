@@ -0,0 +1,847 @@
+#ifndef CHRONOUI_EXPORTS
+#define CHRONOUI_EXPORTS
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <shared_mutex>
+#include <mutex>
+#include <new>
+
+#include "ChronoUI.hpp"
+
+namespace ChronoUI {
+
+	// --- Property Atom Table ---
+	// Lives only in ChronoUI.dll so the ids are identical in every widget DLL.
+	namespace {
+		class AtomTable {
+		public:
+			static AtomTable& Instance() {
+				static AtomTable instance;
+				return instance;
+			}
+
+			uint32_t Find(std::string_view key) {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_ids.find(key);
+				return (it != m_ids.end()) ? it->second : 0;
+			}
+
+			uint32_t Intern(std::string_view key) {
+				// 1. Fast path: already interned (shared lock only)
+				uint32_t id = Find(key);
+				if (id) return id;
+
+				// 2. Slow path: insert. Re-check, another thread may have won the race.
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_ids.find(key);
+				if (it != m_ids.end()) return it->second;
+
+				// std::deque never moves its elements, so the views used as map keys stay valid
+				m_names.emplace_back(key);
+				m_styleKey.push_back(false);
+				id = (uint32_t)m_names.size() - 1;
+				m_ids.emplace(std::string_view(m_names.back()), id);
+				return id;
+			}
+
+			const char* Name(uint32_t id) {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				return (id < m_names.size()) ? m_names[id].c_str() : "";
+			}
+
+			void MarkStyleKey(uint32_t id) {
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				if (id < m_styleKey.size()) m_styleKey[id] = true;
+			}
+
+			bool IsStyleKey(uint32_t id) {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				return (id < m_styleKey.size()) && m_styleKey[id];
+			}
+
+			size_t Count() {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				return m_names.size() - 1;
+			}
+
+		private:
+			AtomTable() {
+				// Id 0 is reserved for the invalid handle
+				m_names.emplace_back("");
+				m_styleKey.push_back(false);
+			}
+
+			std::shared_mutex m_mutex;
+			std::deque<std::string> m_names;
+			std::vector<bool> m_styleKey; // Indexed by id
+			std::unordered_map<std::string_view, uint32_t> m_ids;
+		};
+	}
+
+	PropertyHandle __stdcall PropertyAtoms::Intern(const char* key) {
+		if (!key || !*key) return PropertyHandle{ 0 };
+		return PropertyHandle{ AtomTable::Instance().Intern(key) };
+	}
+
+	PropertyHandle __stdcall PropertyAtoms::Find(const char* key) {
+		if (!key || !*key) return PropertyHandle{ 0 };
+		return PropertyHandle{ AtomTable::Instance().Find(key) };
+	}
+
+	const char* __stdcall PropertyAtoms::Name(PropertyHandle handle) {
+		return AtomTable::Instance().Name(handle.id);
+	}
+
+	size_t __stdcall PropertyAtoms::Count() {
+		return AtomTable::Instance().Count();
+	}
+
+	PropertyHandle __stdcall PropertyAtoms::InternStyleKey(const char* key) {
+		PropertyHandle h = Intern(key);
+		if (h.IsValid() && !IsStyleKey(h)) MarkStyleKey(h);
+		return h;
+	}
+
+	void __stdcall PropertyAtoms::MarkStyleKey(PropertyHandle handle) {
+		AtomTable::Instance().MarkStyleKey(handle.id);
+	}
+
+	bool __stdcall PropertyAtoms::IsStyleKey(PropertyHandle handle) {
+		return handle.IsValid() && AtomTable::Instance().IsStyleKey(handle.id);
+	}
+
+	// --- Style Cache Epoch & Statistics ---
+	namespace {
+		std::atomic<uint64_t> g_styleEpoch{ 1 };
+		std::atomic<uint64_t> g_styleHits{ 0 };
+		std::atomic<uint64_t> g_styleMisses{ 0 };
+	}
+
+	uint64_t __stdcall StyleCache::Epoch() {
+		return g_styleEpoch.load(std::memory_order_acquire);
+	}
+
+	void __stdcall StyleCache::Invalidate() {
+		g_styleEpoch.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	void __stdcall StyleCache::RecordLookup(bool hit) {
+		(hit ? g_styleHits : g_styleMisses).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void __stdcall StyleCache::GetStats(uint64_t* hits, uint64_t* misses) {
+		if (hits) *hits = g_styleHits.load(std::memory_order_relaxed);
+		if (misses) *misses = g_styleMisses.load(std::memory_order_relaxed);
+	}
+
+	void __stdcall StyleCache::ResetStats() {
+		g_styleHits.store(0, std::memory_order_relaxed);
+		g_styleMisses.store(0, std::memory_order_relaxed);
+	}
+
+	// --- Inherited Property Snapshots ---
+	namespace {
+		std::atomic<bool> g_snapshotsEnabled{ false };
+		std::atomic<uint64_t> g_inheritEpoch{ 1 };
+	}
+
+	void __stdcall PropertyInheritance::EnableSnapshots(bool enable) {
+		if (g_snapshotsEnabled.exchange(enable) != enable) Invalidate();
+	}
+
+	bool __stdcall PropertyInheritance::SnapshotsEnabled() {
+		return g_snapshotsEnabled.load(std::memory_order_relaxed);
+	}
+
+	uint64_t __stdcall PropertyInheritance::Epoch() {
+		return g_inheritEpoch.load(std::memory_order_acquire);
+	}
+
+	void __stdcall PropertyInheritance::Invalidate() {
+		g_inheritEpoch.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	// --- Custom Properties ---
+	namespace {
+		std::atomic<uint64_t> g_customStamp{ 1 };		// 0 is never current (ComputedSlot::checked)
+
+		class CustomGenerations {
+		public:
+			static CustomGenerations& Instance() {
+				static CustomGenerations instance;
+				return instance;
+			}
+
+			uint64_t Get(uint32_t key) {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_generations.find(key);
+				return (it != m_generations.end()) ? it->second : 0;
+			}
+
+			uint64_t Touch(uint32_t key) {
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				uint64_t stamp = g_customStamp.fetch_add(1, std::memory_order_acq_rel) + 1;
+				m_generations[key] = stamp;
+				return stamp;
+			}
+
+		private:
+			std::shared_mutex m_mutex;
+			std::unordered_map<uint32_t, uint64_t> m_generations;
+		};
+
+		thread_local CustomProperties::Dependencies* t_customCollector = nullptr;
+	}
+
+	bool __stdcall CustomProperties::IsCustom(PropertyHandle key) {
+		if (!key.IsValid()) return false;
+		const char* name = PropertyAtoms::Name(key);
+		return name[0] == '-' && name[1] == '-';
+	}
+
+	uint64_t __stdcall CustomProperties::Generation(PropertyHandle key) {
+		return CustomGenerations::Instance().Get(key.id);
+	}
+
+	uint64_t __stdcall CustomProperties::Touch(PropertyHandle key) {
+		return (key.IsValid()) ? CustomGenerations::Instance().Touch(key.id) : NewStamp();
+	}
+
+	uint64_t __stdcall CustomProperties::Stamp() {
+		return g_customStamp.load(std::memory_order_acquire);
+	}
+
+	uint64_t __stdcall CustomProperties::NewStamp() {
+		return g_customStamp.fetch_add(1, std::memory_order_acq_rel) + 1;
+	}
+
+	CustomProperties::Dependencies* __stdcall CustomProperties::Collect(Dependencies* deps) {
+		Dependencies* previous = t_customCollector;
+		t_customCollector = deps;
+		return previous;
+	}
+
+	void __stdcall CustomProperties::Record(PropertyHandle key) {
+		if (t_customCollector && key.IsValid()) t_customCollector->push_back({ key.id, Generation(key) });
+	}
+
+	void __stdcall CustomProperties::Record(const Dependencies& deps) {
+		if (t_customCollector) t_customCollector->insert(t_customCollector->end(), deps.begin(), deps.end());
+	}
+
+	bool __stdcall CustomProperties::IsCurrent(const Dependencies& deps) {
+		CustomGenerations& generations = CustomGenerations::Instance();
+		for (const Dependency& d : deps) {
+			if (generations.Get(d.key) != d.generation) return false;
+		}
+		return true;
+	}
+
+	// --- Property Impact Schema ---
+	namespace {
+		class ImpactTable {
+		public:
+			static ImpactTable& Instance() {
+				static ImpactTable instance;
+				return instance;
+			}
+
+			void Set(uint32_t classid, uint32_t key, PropertyImpact impact) {
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				m_impacts[Key(classid, key)] = impact;
+			}
+
+			PropertyImpact Get(uint32_t classid, uint32_t key) {
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_impacts.find(Key(classid, key));
+				if (it == m_impacts.end() && classid) it = m_impacts.find(Key(0, key));
+				return (it != m_impacts.end()) ? it->second : PropertyImpact::Paint;
+			}
+
+			// True only for the first caller per control
+			bool MarkRegistered(uint32_t classid) {
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				return m_registered.insert(classid).second;
+			}
+
+		private:
+			ImpactTable() {
+				// 1. Bookkeeping keys: nothing to redraw (PerformValidation repaints on its own)
+				for (const char* k : { "id", "dll", "class", "validated" }) {
+					m_impacts[Key(0, PropertyAtoms::Intern(k).id)] = PropertyImpact::None;
+				}
+				// 2. Keys read by CellImpl::UpdateWidgets
+				for (const char* k : { "width", "height", "align-items", "justify-content", "overflow",
+					"min-width", "max-width", "min-height", "max-height", "flex", "flex-grow", "flex-shrink", "flex-basis",
+					"flex-wrap", "order", "align-self", "align-content", "gap", "row-gap", "column-gap" }) {
+					m_impacts[Key(0, PropertyAtoms::Intern(k).id)] = PropertyImpact::Layout;
+				}
+				// 3. Keys text is measured with (IWidget::Measure)
+				for (const char* k : { "font-size", "font-family", "font-weight", "font-style" }) {
+					m_impacts[Key(0, PropertyAtoms::Intern(k).id)] = PropertyImpact::Layout;
+				}
+			}
+
+			static uint64_t Key(uint32_t classid, uint32_t key) {
+				return ((uint64_t)classid << 32) | key;
+			}
+
+			std::shared_mutex m_mutex;
+			std::unordered_map<uint64_t, PropertyImpact> m_impacts;
+			std::unordered_set<uint32_t> m_registered;
+		};
+
+		// "field": "value" inside [begin, end). Manifests are literals written by widget
+		// authors, so a flat scan is enough; this is not a general JSON parser.
+		bool ReadStringField(const char* begin, const char* end, const char* field, std::string* out) {
+			std::string pattern = std::string("\"") + field + "\"";
+			const char* p = std::search(begin, end, pattern.begin(), pattern.end());
+			if (p == end) return false;
+
+			p += pattern.size();
+			while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == ':')) ++p;
+			if (p >= end || *p != '"') return false;
+
+			const char* q = std::find(p + 1, end, '"');
+			if (q == end) return false;
+			out->assign(p + 1, q);
+			return true;
+		}
+	}
+
+	void __stdcall PropertySchema::SetImpact(PropertyHandle classid, PropertyHandle key, PropertyImpact impact) {
+		if (!key.IsValid()) return;
+		ImpactTable::Instance().Set(classid.id, key.id, impact);
+	}
+
+	PropertyImpact __stdcall PropertySchema::GetImpact(PropertyHandle classid, PropertyHandle key) {
+		if (!key.IsValid()) return PropertyImpact::Paint;
+		return ImpactTable::Instance().Get(classid.id, key.id);
+	}
+
+	void __stdcall PropertySchema::RegisterManifest(PropertyHandle classid, const char* manifestJson) {
+		if (!classid.IsValid() || !manifestJson) return;
+		if (!ImpactTable::Instance().MarkRegistered(classid.id)) return;
+
+		// 1. Locate the "properties" array
+		const char* end = manifestJson + strlen(manifestJson);
+		const char* p = strstr(manifestJson, "\"properties\"");
+		if (!p) return;
+		p = std::find(p, end, '[');
+
+		// 2. Each { ... } entry up to the closing bracket
+		while (p < end && *p != ']') {
+			const char* objBegin = std::find(p, end, '{');
+			const char* closing = std::find(p, end, ']');
+			if (objBegin > closing) break;
+			const char* objEnd = std::find(objBegin, end, '}');
+			if (objEnd == end) break;
+
+			std::string name, impact;
+			if (ReadStringField(objBegin, objEnd, "name", &name) && ReadStringField(objBegin, objEnd, "impact", &impact)) {
+				PropertyImpact value = PropertyImpact::Paint;
+				if (impact == "none") value = PropertyImpact::None;
+				else if (impact == "layout") value = PropertyImpact::Layout;
+				SetImpact(classid, PropertyAtoms::Intern(name.c_str()), value);
+			}
+			p = objEnd + 1;
+		}
+	}
+
+	// --- Property Value Parsing ---
+	namespace {
+		int HexDigit(char c) {
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		uint8_t ClampByte(float v) {
+			if (v < 0.0f) return 0;
+			if (v > 255.0f) return 255;
+			return (uint8_t)v;
+		}
+
+		// Length unit from the text after the number; the suffix must be all of it
+		bool ParseUnit(const char* s, size_t length, LengthUnit* out) {
+			struct Suffix { const char* name; LengthUnit unit; };
+			static const Suffix kUnits[] = {
+				{ "px", LengthUnit::Px }, { "lu", LengthUnit::Px }, { "%", LengthUnit::Percent },
+				{ "em", LengthUnit::Em }, { "rem", LengthUnit::Rem }, { "vw", LengthUnit::Vw }, { "vh", LengthUnit::Vh },
+				{ "pt", LengthUnit::Pt }, { "pc", LengthUnit::Pc }, { "in", LengthUnit::In }, { "cm", LengthUnit::Cm },
+				{ "mm", LengthUnit::Mm }, { "dpx", LengthUnit::Dpx },
+			};
+			for (const Suffix& u : kUnits) {
+				if (strlen(u.name) == length && strncmp(s, u.name, length) == 0) {
+					*out = u.unit;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// #RGB, #RRGGBB, #AARRGGBB, rgb(r,g,b), rgba(r,g,b,a), transparent
+		bool ParseColor(const char* t, uint32_t* out) {
+			if (t[0] == '#') {
+				size_t len = strlen(t + 1);
+				if (len != 3 && len != 6 && len != 8) return false;
+
+				uint32_t hex = 0;
+				for (size_t i = 1; i <= len; ++i) {
+					int d = HexDigit(t[i]);
+					if (d < 0) return false;
+					hex = (hex << 4) | (uint32_t)d;
+				}
+
+				if (len == 3) {
+					// #RGB -> #RRGGBB
+					uint32_t r = ((hex >> 8) & 0xF) * 17, g = ((hex >> 4) & 0xF) * 17, b = (hex & 0xF) * 17;
+					*out = 0xFF000000u | (r << 16) | (g << 8) | b;
+				}
+				else if (len == 6) {
+					*out = 0xFF000000u | hex;
+				}
+				else {
+					*out = hex; // Already #AARRGGBB
+				}
+				return true;
+			}
+
+			if (strcmp(t, "transparent") == 0) {
+				*out = 0;
+				return true;
+			}
+
+			if (strncmp(t, "rgb", 3) == 0) {
+				const char* p = strchr(t, '(');
+				if (!p) return false;
+				++p;
+
+				float vals[4] = { 0, 0, 0, 255.0f };
+				int count = 0;
+				while (count < 4) {
+					char* end = nullptr;
+					float v = strtof(p, &end);
+					if (end == p) break;
+					vals[count++] = v;
+					p = end;
+					while (*p == ' ' || *p == ',' || *p == '\t') ++p;
+				}
+				if (count < 3 || *p != ')') return false;
+
+				// CSS alpha is usually 0.0 - 1.0; larger values are taken as 0 - 255
+				if (count == 4 && vals[3] >= 0.0f && vals[3] <= 1.0f) vals[3] *= 255.0f;
+
+				*out = ((uint32_t)ClampByte(vals[3]) << 24) | ((uint32_t)ClampByte(vals[0]) << 16) |
+					((uint32_t)ClampByte(vals[1]) << 8) | (uint32_t)ClampByte(vals[2]);
+				return true;
+			}
+			return false;
+		}
+	}
+
+	static PropertyValue ParseValue(const char* text, bool owned) {
+		PropertyValue v = {};
+		v.text = (text) ? text : "";
+		const char* t = v.text;
+
+		if (!*t) {
+			v.type = PropertyType::Empty;
+			return v;
+		}
+
+		// 1. Leading numbers (std::stof / std::stoi compatible)
+		char* floatEnd = nullptr;
+		errno = 0;
+		float f = strtof(t, &floatEnd);
+		if (floatEnd != t && errno != ERANGE) {
+			v.hasNumber = true;
+			v.number = f;
+		}
+
+		char* intEnd = nullptr;
+		errno = 0;
+		long l = strtol(t, &intEnd, 10);
+		if (intEnd != t && errno != ERANGE && l >= INT_MIN && l <= INT_MAX) {
+			v.hasInteger = true;
+			v.integer = (int32_t)l;
+		}
+
+		// 2. Classify
+		if (strcmp(t, "true") == 0 || strcmp(t, "false") == 0) {
+			v.type = PropertyType::Bool;
+			v.boolean = (t[0] == 't');
+		}
+		else if (ParseColor(t, &v.rgba)) {
+			v.type = PropertyType::Color;
+		}
+		else if (v.hasNumber && *floatEnd == '\0') {
+			v.type = (v.hasInteger && intEnd == floatEnd) ? PropertyType::Int : PropertyType::Float;
+		}
+		else if (v.hasNumber && ParseUnit(floatEnd, strlen(floatEnd), &v.unit)) {
+			v.type = PropertyType::Length;
+		}
+		else if ((v.expression = Lengths::Compile(t, owned)) != nullptr) {
+			v.type = PropertyType::Length;
+			v.unit = LengthUnit::Expression;
+		}
+		else {
+			v.type = PropertyType::String;
+		}
+		return v;
+	}
+
+	PropertyValue __stdcall PropertyValue::Parse(const char* text) {
+		return ParseValue(text, false);
+	}
+
+	PropertyValue __stdcall PropertyValue::ParseOwned(const char* text) {
+		return ParseValue(text, true);
+	}
+
+	// --- Lengths ---
+	namespace {
+		typedef LengthExpression::Step Step;
+
+		// Recursive descent over calc() syntax, emitting postfix steps. Every operand is typed
+		// as a plain number or a length; a number mixed with lengths (min(200, 50%)) is taken
+		// as logical pixels, like a bare "200" property.
+		class LengthCompiler {
+		public:
+			explicit LengthCompiler(const char* text) : m_p(text) {}
+
+			bool Compile(std::vector<Step>* steps, bool* usesFont) {
+				m_steps = steps;
+				m_usesFont = false;
+				bool length = false;
+				if (!Function(&length)) return false;
+				SkipSpaces();
+				if (*m_p) return false;
+				if (!length) AsLength(m_steps->size());
+				*usesFont = m_usesFont;
+				return true;
+			}
+
+		private:
+			void SkipSpaces() {
+				while (*m_p == ' ' || *m_p == '\t' || *m_p == '\r' || *m_p == '\n') ++m_p;
+			}
+
+			bool Accept(char c) {
+				SkipSpaces();
+				if (*m_p != c) return false;
+				++m_p;
+				return true;
+			}
+
+			void Emit(LengthExpression::Op op, uint16_t operands = 0) {
+				m_steps->push_back({ op, LengthUnit::None, operands, 0.0f });
+			}
+
+			// Turns the number ending at step 'end' into logical pixels
+			void AsLength(size_t end) {
+				m_steps->insert(m_steps->begin() + end, { Step{ LengthExpression::Push, LengthUnit::Px, 0, 1.0f }, Step{ LengthExpression::Mul, LengthUnit::None, 0, 0.0f } });
+			}
+
+			// Operands of an additive op or of min() / max() / clamp() must agree
+			void Unify(const std::vector<size_t>& ends, const std::vector<bool>& lengths, bool* length) {
+				*length = false;
+				for (bool l : lengths) *length = *length || l;
+				if (!*length) return;
+				for (size_t i = ends.size(); i-- > 0;) {
+					if (!lengths[i]) AsLength(ends[i]);
+				}
+			}
+
+			// calc(...), min(...), max(...), clamp(...)
+			bool Function(bool* length) {
+				SkipSpaces();
+				if (strncmp(m_p, "calc(", 5) == 0) {
+					m_p += 5;
+					return Sum(length) && Accept(')');
+				}
+
+				struct Name { const char* text; size_t size; LengthExpression::Op op; };
+				static const Name kNames[] = {
+					{ "min(", 4, LengthExpression::Min }, { "max(", 4, LengthExpression::Max }, { "clamp(", 6, LengthExpression::Clamp },
+				};
+				for (const Name& n : kNames) {
+					if (strncmp(m_p, n.text, n.size) != 0) continue;
+					m_p += n.size;
+
+					std::vector<size_t> ends;
+					std::vector<bool> lengths;
+					do {
+						bool l = false;
+						if (!Sum(&l)) return false;
+						ends.push_back(m_steps->size());
+						lengths.push_back(l);
+					} while (Accept(','));
+					if (!Accept(')')) return false;
+					if (n.op == LengthExpression::Clamp ? ends.size() != 3 : ends.size() > 0xFFFF) return false;
+
+					// Ends move as coercions are inserted before them, so unify from the back
+					Unify(ends, lengths, length);
+					Emit(n.op, (uint16_t)ends.size());
+					return true;
+				}
+				return false;
+			}
+
+			bool Sum(bool* length) {
+				if (!Product(length)) return false;
+				for (;;) {
+					SkipSpaces();
+					char c = *m_p;
+					if (c != '+' && c != '-') return true;
+					++m_p;
+					size_t leftEnd = m_steps->size();
+					bool right = false;
+					if (!Product(&right)) return false;
+					std::vector<size_t> ends = { leftEnd, m_steps->size() };
+					std::vector<bool> lengths = { *length, right };
+					Unify(ends, lengths, length);
+					Emit(c == '+' ? LengthExpression::Add : LengthExpression::Sub);
+				}
+			}
+
+			bool Product(bool* length) {
+				if (!Value(length)) return false;
+				for (;;) {
+					SkipSpaces();
+					char c = *m_p;
+					if (c != '*' && c != '/') return true;
+					++m_p;
+					bool right = false;
+					if (!Value(&right)) return false;
+					// A length times a length, or divided by one, has no meaning here
+					if (right && (*length || c == '/')) return false;
+					*length = *length || right;
+					Emit(c == '*' ? LengthExpression::Mul : LengthExpression::Div);
+				}
+			}
+
+			bool Value(bool* length) {
+				SkipSpaces();
+				if (*m_p == '(') {
+					++m_p;
+					return Sum(length) && Accept(')');
+				}
+				if (isalpha((unsigned char)*m_p)) return Function(length);
+
+				char* end = nullptr;
+				float number = strtof(m_p, &end);
+				if (end == m_p || !std::isfinite(number)) return false;
+				m_p = end;
+				const char* suffix = m_p;
+				while (isalpha((unsigned char)*m_p) || *m_p == '%') ++m_p;
+
+				LengthUnit unit = LengthUnit::None;
+				if (m_p != suffix && !ParseUnit(suffix, (size_t)(m_p - suffix), &unit)) return false;
+				m_usesFont = m_usesFont || unit == LengthUnit::Em || unit == LengthUnit::Rem;
+				*length = unit != LengthUnit::None;
+				m_steps->push_back({ LengthExpression::Push, unit, 0, number });
+				return true;
+			}
+
+			const char* m_p;
+			std::vector<Step>* m_steps = nullptr;
+			bool m_usesFont = false;
+		};
+
+		// Stack slots 'steps' needs; 0 if it is malformed
+		uint32_t StackDepth(const std::vector<Step>& steps) {
+			uint32_t depth = 0, max = 0;
+			for (const Step& s : steps) {
+				switch (s.op) {
+				case LengthExpression::Push: ++depth; break;
+				case LengthExpression::Min:
+				case LengthExpression::Max:
+				case LengthExpression::Clamp:
+					if (s.operands == 0 || depth < s.operands) return 0;
+					depth -= s.operands - 1;
+					break;
+				default:
+					if (depth < 2) return 0;
+					--depth;
+					break;
+				}
+				max = (std::max)(max, depth);
+			}
+			return (depth == 1) ? max : 0;
+		}
+
+		// Steps of 'text' and the stack they need; false if it is not a valid expression
+		bool CompileSteps(const char* text, std::vector<Step>* steps, uint32_t* depth, bool* usesFont) {
+			LengthCompiler compiler(text);
+			*depth = compiler.Compile(steps, usesFont) ? StackDepth(*steps) : 0;
+			return *depth > 0 && *depth <= LengthExpression::kMaxDepth;
+		}
+
+		// An expression and its steps in one block, for Lengths::Release to free
+		const LengthExpression* CompileOwned(const char* text) {
+			std::vector<Step> steps;
+			uint32_t depth = 0;
+			bool usesFont = false;
+			if (!CompileSteps(text, &steps, &depth, &usesFont)) return nullptr;
+
+			void* block = ::operator new(sizeof(LengthExpression) + steps.size() * sizeof(Step));
+			Step* copy = reinterpret_cast<Step*>(static_cast<char*>(block) + sizeof(LengthExpression));
+			std::copy(steps.begin(), steps.end(), copy);
+			return new (block) LengthExpression{ copy, (uint32_t)steps.size(), depth, usesFont, true };
+		}
+
+		// Interned, immortal expressions: layout code keeps raw pointers to them. Only the texts of
+		// style sheets, themes and plain Parse calls end up here; node properties own theirs
+		// (PropertyValue::ParseOwned), so values that keep changing do not pile up.
+		class LengthExpressions {
+		public:
+			static LengthExpressions& Instance() {
+				static LengthExpressions instance;
+				return instance;
+			}
+
+			const LengthExpression* Get(const char* text) {
+				{
+					std::shared_lock<std::shared_mutex> lock(m_mutex);
+					auto it = m_byText.find(text);
+					if (it != m_byText.end()) return it->second;
+				}
+
+				// Compile outside the lock; texts that are not expressions are remembered as null
+				std::vector<Step> steps;
+				bool usesFont = false;
+				uint32_t depth = 0;
+				bool valid = CompileSteps(text, &steps, &depth, &usesFont);
+
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				auto it = m_byText.find(text);
+				if (it != m_byText.end()) return it->second;
+
+				const LengthExpression* result = nullptr;
+				if (valid) {
+					m_entries.emplace_back();
+					Entry& e = m_entries.back();
+					e.steps.swap(steps);
+					e.expression = { e.steps.data(), (uint32_t)e.steps.size(), depth, usesFont, false };
+					result = &e.expression;
+				}
+				m_byText.emplace(text, result);
+				return result;
+			}
+
+		private:
+			struct Entry {
+				std::vector<Step> steps;
+				LengthExpression expression;
+			};
+			std::shared_mutex m_mutex;
+			std::deque<Entry> m_entries;
+			std::unordered_map<std::string, const LengthExpression*> m_byText;
+		};
+
+		// One unit in device pixels
+		float UnitScale(LengthUnit unit, const LengthContext& c) {
+			switch (unit) {
+			case LengthUnit::Px: return c.dpiScale;
+			case LengthUnit::Percent: return c.percentBase / 100.0f;
+			case LengthUnit::Em: return c.fontSize * c.dpiScale;
+			case LengthUnit::Rem: return c.rootFontSize * c.dpiScale;
+			case LengthUnit::Vw: return c.viewportWidth / 100.0f;
+			case LengthUnit::Vh: return c.viewportHeight / 100.0f;
+			case LengthUnit::Pt: return c.dpiScale * 96.0f / 72.0f;
+			case LengthUnit::Pc: return c.dpiScale * 16.0f;
+			case LengthUnit::In: return c.dpiScale * 96.0f;
+			case LengthUnit::Cm: return c.dpiScale * 96.0f / 2.54f;
+			case LengthUnit::Mm: return c.dpiScale * 96.0f / 25.4f;
+			default: return 1.0f;	// None (plain number inside an expression), Dpx
+			}
+		}
+
+		bool Evaluate(const LengthExpression& e, const LengthContext& c, float* out) {
+			float stack[LengthExpression::kMaxDepth];
+			uint32_t top = 0;
+			for (uint32_t i = 0; i < e.count; ++i) {
+				const Step& s = e.steps[i];
+				switch (s.op) {
+				case LengthExpression::Push:
+					stack[top++] = s.value * UnitScale(s.unit, c);
+					break;
+				case LengthExpression::Add: --top; stack[top - 1] += stack[top]; break;
+				case LengthExpression::Sub: --top; stack[top - 1] -= stack[top]; break;
+				case LengthExpression::Mul: --top; stack[top - 1] *= stack[top]; break;
+				case LengthExpression::Div: --top; stack[top - 1] /= stack[top]; break;
+				case LengthExpression::Min:
+				case LengthExpression::Max: {
+					uint32_t first = top - s.operands;
+					float v = stack[first];
+					for (uint32_t k = first + 1; k < top; ++k) {
+						v = (s.op == LengthExpression::Min) ? (std::min)(v, stack[k]) : (std::max)(v, stack[k]);
+					}
+					top = first;
+					stack[top++] = v;
+					break;
+				}
+				case LengthExpression::Clamp:
+					// clamp(min, value, max) = max(min, min(value, max))
+					top -= 2;
+					stack[top - 1] = (std::max)(stack[top - 1], (std::min)(stack[top], stack[top + 1]));
+					break;
+				}
+			}
+			*out = stack[0];
+			return std::isfinite(*out);
+		}
+	}
+
+	const LengthExpression* __stdcall Lengths::Compile(const char* text, bool owned) {
+		if (!text) return nullptr;
+		// Cheap rejection: every expression starts with one of the function names
+		char c = text[0];
+		if (c != 'c' && c != 'm') return nullptr;
+		if (strncmp(text, "calc(", 5) != 0 && strncmp(text, "min(", 4) != 0 && strncmp(text, "max(", 4) != 0 && strncmp(text, "clamp(", 6) != 0) return nullptr;
+		return (owned) ? CompileOwned(text) : LengthExpressions::Instance().Get(text);
+	}
+
+	void __stdcall Lengths::Release(const LengthExpression* expression) {
+		if (expression && expression->owned) ::operator delete(const_cast<LengthExpression*>(expression));
+	}
+
+	bool __stdcall Lengths::Resolve(const PropertyValue& value, const LengthContext& context, float* out) {
+		switch (value.type) {
+		case PropertyType::Int:
+		case PropertyType::Float:
+			*out = value.number * context.dpiScale;
+			return true;
+		case PropertyType::Length:
+			if (value.unit == LengthUnit::Expression) {
+				return value.expression && Evaluate(*value.expression, context, out);
+			}
+			*out = value.number * UnitScale(value.unit, context);
+			return std::isfinite(*out);
+		default:
+			return false;
+		}
+	}
+
+	bool __stdcall Lengths::UsesFont(const PropertyValue& value) {
+		if (value.type != PropertyType::Length) return false;
+		if (value.unit == LengthUnit::Expression) return value.expression && value.expression->usesFont;
+		return value.unit == LengthUnit::Em || value.unit == LengthUnit::Rem;
+	}
+}
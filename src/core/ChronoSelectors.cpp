@@ -0,0 +1,983 @@
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+
+#include "ChronoSelectors.hpp"
+#include "ChronoCSSParser.hpp"
+#include "ChronoStyleImage.hpp"
+
+namespace ChronoUI {
+	namespace CSS {
+
+		namespace {
+			// Pseudo-classes the style lookup resolves per state (see ContextNodeImpl::TryResolveState).
+			// There is no StyleState bit for :checked or :focus, so they are rejected rather than
+			// compiled into keys nothing reads.
+			bool IsStatePseudo(std::string_view name) {
+				static const char* states[] = { "hover", "active", "selected", "disabled" };
+				for (const char* s : states) if (name == s) return true;
+				return false;
+			}
+
+			uint32_t Atom(std::string_view name) {
+				return PropertyAtoms::Intern(std::string(name).c_str()).id;
+			}
+
+			std::string Lower(std::string_view s) {
+				std::string out(s);
+				for (char& c : out) c = (char)tolower((unsigned char)c);
+				return out;
+			}
+
+			Token NextSignificant(Tokenizer& tok) {
+				Token t = tok.Next();
+				while (t.type == TokenType::Whitespace) t = tok.Next();
+				return t;
+			}
+
+			// "800px" -> 800 and "px"; a plain number has no unit
+			bool SplitDimension(const Token& t, float* value, std::string* unit) {
+				if (t.type != TokenType::Number && t.type != TokenType::Dimension) return false;
+				std::string text(t.text);
+				char* end = nullptr;
+				*value = strtof(text.c_str(), &end);
+				if (end == text.c_str()) return false;
+				*unit = Lower(end);
+				return true;
+			}
+		}
+
+		// =========================================================
+		// --- Selector ---
+		// =========================================================
+
+		bool Selector::Compile(std::string_view text, Selector* out) {
+			*out = Selector();
+			Tokenizer tok(text);
+			Compound current;
+			bool started = false;		// 'current' has at least one part
+			bool whitespace = false;	// Whitespace since the last part
+			uint32_t ids = 0, classes = 0, types = 0;
+			size_t stateCompound = 0;
+
+			for (;;) {
+				Token t = tok.Next();
+				if (t.type == TokenType::EndOfFile) break;
+				if (t.type == TokenType::Whitespace) {
+					whitespace = true;
+					continue;
+				}
+
+				// 1. Child combinator
+				if (t.IsDelim('>')) {
+					if (!started) return false;
+					out->compounds.push_back(current);
+					current = Compound();
+					current.combinator = Combinator::Child;
+					started = whitespace = false;
+					continue;
+				}
+
+				// 2. A new part after whitespace starts a descendant compound
+				if (started && whitespace) {
+					out->compounds.push_back(current);
+					current = Compound();
+					current.combinator = Combinator::Descendant;
+					started = false;
+				}
+				whitespace = false;
+
+				// 3. The part itself
+				if (t.type == TokenType::Ident || t.IsDelim('*')) {
+					if (started) return false; // Type must come first
+					if (t.type == TokenType::Ident) {
+						current.type = Atom(t.text);
+						++types;
+					}
+				}
+				else if (t.type == TokenType::Hash) {
+					if (current.id) return false;
+					current.id = Atom(t.text.substr(1));
+					++ids;
+				}
+				else if (t.IsDelim('.')) {
+					Token name = tok.Next();
+					if (name.type != TokenType::Ident) return false;
+					current.classes.push_back(Atom(name.text));
+					++classes;
+				}
+				else if (t.type == TokenType::Colon) {
+					Token name = tok.Next();
+					if (name.type != TokenType::Ident || !IsStatePseudo(name.text) || !out->state.empty()) return false;
+					out->state = std::string(name.text);
+					stateCompound = out->compounds.size();
+					++classes;
+				}
+				else {
+					return false;
+				}
+				started = true;
+			}
+
+			if (!started) return false;
+			out->compounds.push_back(current);
+
+			// States are keyed on the node being styled, so only the subject may carry one
+			if (!out->state.empty() && stateCompound != out->compounds.size() - 1) return false;
+
+			out->specificity = ((std::min)(ids, 1023u) << 20) | ((std::min)(classes, 1023u) << 10) | (std::min)(types, 1023u);
+			return true;
+		}
+
+		// =========================================================
+		// --- MediaQuery ---
+		// =========================================================
+
+		bool MediaQuery::Compile(std::string_view prelude, MediaQuery* out) {
+			*out = MediaQuery();
+			std::vector<std::string_view> queries;
+			Parser::SplitList(prelude, &queries);
+
+			// "@media { ... }" is "@media all { ... }"
+			if (queries.empty()) {
+				out->ranges.push_back({ 0.0f, FLT_MAX, 0.0f, FLT_MAX, 0.0f, FLT_MAX, false });
+				return true;
+			}
+
+			for (std::string_view q : queries) {
+				Range r = { 0.0f, FLT_MAX, 0.0f, FLT_MAX, 0.0f, FLT_MAX, false };
+				Tokenizer tok(q);
+				bool term = false;		// A media type or feature was just read; "and" may follow
+				for (;;) {
+					Token t = NextSignificant(tok);
+					if (t.type == TokenType::EndOfFile) break;
+
+					// 1. Media types and "and"
+					if (t.type == TokenType::Ident) {
+						std::string word = Lower(t.text);
+						if (term) {
+							if (word != "and") return false;
+							term = false;
+						}
+						else if (word == "not") {
+							return false;
+						}
+						else if (word != "only") {
+							if (word != "all" && word != "screen") r.never = true;
+							term = true;
+						}
+						continue;
+					}
+
+					// 2. (feature: value)
+					if (t.type != TokenType::LeftParen || term) return false;
+					Token name = NextSignificant(tok);
+					Token colon = NextSignificant(tok);
+					Token value = NextSignificant(tok);
+					if (name.type != TokenType::Ident || colon.type != TokenType::Colon || NextSignificant(tok).type != TokenType::RightParen) return false;
+
+					float v = 0.0f;
+					std::string unit;
+					if (!SplitDimension(value, &v, &unit)) return false;
+
+					std::string feature = Lower(name.text);
+					int bound = 0;		// -1 min-, 1 max-, 0 exact
+					if (feature.compare(0, 4, "min-") == 0) { bound = -1; feature.erase(0, 4); }
+					else if (feature.compare(0, 4, "max-") == 0) { bound = 1; feature.erase(0, 4); }
+
+					float* lo = nullptr;
+					float* hi = nullptr;
+					if (feature == "width" || feature == "height") {
+						if (unit == "em" || unit == "rem") v *= 16.0f;
+						else if (!unit.empty() && unit != "px" && unit != "lu") return false;
+						lo = (feature == "width") ? &r.minWidth : &r.minHeight;
+						hi = (feature == "width") ? &r.maxWidth : &r.maxHeight;
+					}
+					else if (feature == "resolution") {
+						if (unit == "dpi") v /= 96.0f;
+						else if (unit == "dpcm") v *= 2.54f / 96.0f;
+						else if (unit != "dppx" && unit != "x") return false;
+						lo = &r.minDppx;
+						hi = &r.maxDppx;
+					}
+					else {
+						return false;
+					}
+					if (bound <= 0) *lo = (std::max)(*lo, v);
+					if (bound >= 0) *hi = (std::min)(*hi, v);
+					term = true;
+				}
+				if (!term) return false;		// Empty, or ends with "and"
+				out->ranges.push_back(r);
+			}
+			return true;
+		}
+
+		bool MediaQuery::Evaluate(const MediaFeatures& f) const {
+			for (const Range& r : ranges) {
+				if (r.never) continue;
+				if (f.width >= r.minWidth && f.width <= r.maxWidth && f.height >= r.minHeight && f.height <= r.maxHeight &&
+					f.dppx >= r.minDppx && f.dppx <= r.maxDppx) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// =========================================================
+		// --- RuleSet ---
+		// =========================================================
+
+		uint32_t RuleSet::AddMedia(std::string_view prelude) {
+			Media media;
+			if (!MediaQuery::Compile(prelude, &media.query)) return 0;
+			media.prelude = std::string(prelude);
+			m_media.push_back(std::move(media));
+			if (m_sheet) m_sheets[m_sheet - 1].media.push_back((uint32_t)m_media.size());
+			return (uint32_t)m_media.size();
+		}
+
+		bool RuleSet::AddRule(std::string_view selector, const std::vector<Declaration>& declarations, uint32_t media, uint32_t layer) {
+			Rule rule;
+			if (!Selector::Compile(selector, &rule.selector) || media > m_media.size() || layer >= m_layers.size()) return false;
+			rule.declarations = declarations;
+			rule.media = media;
+			rule.layer = layer;
+			rule.sheet = m_sheet;
+
+			// Keys and values are resolved here once, not per matched node
+			for (Declaration& d : rule.declarations) {
+				std::string key = rule.selector.state.empty() ? d.name : d.name + ":" + rule.selector.state;
+				d.key = PropertyAtoms::Intern(key.c_str()).id;
+				d.parsed = PropertyValue::Parse(d.value.c_str());
+				d.parsed.text = nullptr; // Re-pointed at the table's copy, see CompileParsed
+			}
+
+			uint32_t index = (uint32_t)m_rules.size();
+			m_rules.push_back(std::move(rule));
+			if (m_sheet) m_sheets[m_sheet - 1].rules.push_back(index);
+			File(index);
+			AddDependencies(index);
+			m_seen.resize(m_rules.size(), 0);
+			m_tables.clear();
+			return true;
+		}
+
+		// File the rule under the most selective part of its subject
+		void RuleSet::File(uint32_t index) {
+			const Compound& subject = m_rules[index].selector.compounds.back();
+			if (subject.id) m_byId[subject.id].push_back(index);
+			else if (!subject.classes.empty()) m_byClass[subject.classes[0]].push_back(index);
+			else if (subject.type) m_byType[subject.type].push_back(index);
+			else m_universal.push_back(index);
+		}
+
+		// Invalidation sets: which class / id changes can alter what rule 'index' matches
+		void RuleSet::AddDependencies(uint32_t index) {
+			const Selector& s = m_rules[index].selector;
+			for (size_t i = 0; i < s.compounds.size(); ++i) {
+				const Compound& c = s.compounds[i];
+				uint32_t bit = (i + 1 == s.compounds.size()) ? Subject : Ancestor;
+				for (uint32_t cls : c.classes) m_classDeps[cls] |= bit;
+				if (c.id) m_idDeps[c.id] |= bit;
+			}
+			if (m_rules[index].media) m_media[m_rules[index].media - 1].rules.push_back(index);
+		}
+
+		void RuleSet::Clear() {
+			m_rules.clear();
+			m_byId.clear();
+			m_byClass.clear();
+			m_byType.clear();
+			m_universal.clear();
+			m_classDeps.clear();
+			m_idDeps.clear();
+			m_media.clear();
+			m_seen.clear();
+			m_tables.clear();
+			m_layers.assign(1, Layer());
+			m_dead = 0;
+
+			// Sheet ids stay unique: handles to the cleared sheets just stop working
+			for (Sheet& s : m_sheets) s = Sheet{ {}, {}, true };
+			m_sheet = 0;
+		}
+
+		uint32_t RuleSet::AddLayer(std::string_view name, uint32_t parent) {
+			if (parent >= m_layers.size()) return 0;
+			auto create = [this](std::string_view part, uint32_t under) {
+				Layer layer;
+				layer.name = std::string(part);
+				layer.parent = under;
+				m_layers.push_back(std::move(layer));
+				uint32_t id = (uint32_t)m_layers.size() - 1;
+				m_layers[under].children.push_back(id);
+				return id;
+			};
+
+			// 1. Anonymous layers are never named again, so each one is new
+			if (name.empty()) {
+				uint32_t id = create(name, parent);
+				RankLayers();
+				return id;
+			}
+
+			// 2. "a.b": each part is a sublayer of the one before, declared if new
+			uint32_t layer = parent;
+			bool added = false;
+			for (size_t start = 0;;) {
+				size_t dot = name.find('.', start);
+				std::string_view part = name.substr(start, (dot == std::string_view::npos) ? dot : dot - start);
+				if (part.empty()) return 0;
+
+				uint32_t found = 0;
+				for (uint32_t child : m_layers[layer].children) {
+					if (m_layers[child].name == part) {
+						found = child;
+						break;
+					}
+				}
+				if (!found) {
+					found = create(part, layer);
+					added = true;
+				}
+				layer = found;
+				if (dot == std::string_view::npos) break;
+				start = dot + 1;
+			}
+			if (added) RankLayers();
+			return layer;
+		}
+
+		void RuleSet::RollbackLayers(uint32_t mark) {
+			if (mark == 0 || mark >= m_layers.size()) return;
+			// Newest first: each one is the last child of its parent
+			while (m_layers.size() > mark) {
+				m_layers[m_layers.back().parent].children.pop_back();
+				m_layers.pop_back();
+			}
+			RankLayers();
+		}
+
+		// Cascade ranks: a layer's sublayers in declaration order, then its own rules; the root,
+		// i.e. unlayered rules, ranks last. New layers only slot in, so existing ranks keep their
+		// relative order and tables cascaded before stay valid.
+		void RuleSet::RankLayers() {
+			uint32_t rank = 0;
+			std::vector<std::pair<uint32_t, size_t>> stack(1, { 0u, size_t(0) });
+			while (!stack.empty()) {
+				uint32_t layer = stack.back().first;
+				size_t next = stack.back().second;
+				if (next < m_layers[layer].children.size()) {
+					++stack.back().second;
+					stack.push_back({ m_layers[layer].children[next], size_t(0) });
+					continue;
+				}
+				m_layers[layer].rank = rank++;
+				stack.pop_back();
+			}
+		}
+
+		uint32_t RuleSet::AddSheet() {
+			m_sheets.push_back(Sheet());
+			m_sheet = (uint32_t)m_sheets.size();
+			return m_sheet;
+		}
+
+		bool RuleSet::RemoveSheet(uint32_t sheet) {
+			if (sheet == 0 || sheet > m_sheets.size() || m_sheets[sheet - 1].removed) return false;
+			Sheet& s = m_sheets[sheet - 1];
+
+			// 1. Tombstones: the bucket entries stay and Match skips them
+			for (uint32_t r : s.rules) {
+				m_rules[r].dead = true;
+				std::vector<Declaration>().swap(m_rules[r].declarations);
+			}
+			m_dead += s.rules.size();
+
+			// 2. Its queries select nothing and never match again, so they never flip
+			for (uint32_t m : s.media) {
+				m_media[m - 1].rules.clear();
+				m_media[m - 1].query.ranges.clear();
+			}
+
+			s = Sheet{ {}, {}, true };
+			if (m_sheet == sheet) m_sheet = 0;
+
+			// 3. Once most rules are dead, drop them for good; paid for by the removals
+			if (m_dead * 2 > m_rules.size()) Compact();
+			return true;
+		}
+
+		// Renumbers the live rules and rebuilds the buckets, invalidation sets and query lists
+		// without the dead ones. Cached tables are keyed by rule index and go too.
+		void RuleSet::Compact() {
+			std::vector<uint32_t> index(m_rules.size(), 0);
+			std::vector<Rule> live;
+			live.reserve(m_rules.size() - m_dead);
+			for (size_t r = 0; r < m_rules.size(); ++r) {
+				if (m_rules[r].dead) continue;
+				index[r] = (uint32_t)live.size();
+				live.push_back(std::move(m_rules[r]));
+			}
+			m_rules.swap(live);
+			for (Sheet& s : m_sheets) {
+				for (uint32_t& r : s.rules) r = index[r];
+			}
+
+			m_byId.clear();
+			m_byClass.clear();
+			m_byType.clear();
+			m_universal.clear();
+			m_classDeps.clear();
+			m_idDeps.clear();
+			for (Media& m : m_media) m.rules.clear();
+			for (uint32_t r = 0; r < m_rules.size(); ++r) {
+				File(r);
+				AddDependencies(r);
+			}
+
+			m_seen.assign(m_rules.size(), 0);
+			m_stamp = 0;
+			m_tables.clear();
+			m_dead = 0;
+		}
+
+		void RuleSet::BuildChain(IContextNode* node) {
+			m_chainLength = 0;
+			for (IContextNode* n = node; n; n = n->GetParentNode()) {
+				if (m_chainLength == m_chain.size()) m_chain.emplace_back();
+				Element& e = m_chain[m_chainLength++];
+				e.node = n;
+				e.described = false;
+			}
+		}
+
+		const RuleSet::Element& RuleSet::Describe(size_t depth) {
+			static const PropertyHandle kId = PropertyAtoms::Intern("id");
+			static const PropertyHandle kClass = PropertyAtoms::Intern("class");
+
+			Element& e = m_chain[depth];
+			if (e.described) return e;
+			e.described = true;
+			e.type = e.id = 0;
+			e.classes.clear();
+
+			// Only the node's own values count; "class" and "id" must not be inherited here
+			ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(e.node);
+			if (!impl) return e;
+
+			e.type = impl->StyleTypeKey().id;
+			const char* id = impl->GetLocalProperty(kId);
+			if (id && *id) e.id = PropertyAtoms::Find(id).id;
+
+			const char* cls = impl->GetLocalProperty(kClass);
+			std::string name;
+			for (const char* p = cls; p; ++p) {
+				if (*p && *p != ' ' && *p != '\t') {
+					name += *p;
+					continue;
+				}
+				if (!name.empty()) {
+					// A class no selector names was never interned and cannot match
+					PropertyHandle h = PropertyAtoms::Find(name.c_str());
+					if (h.IsValid()) e.classes.push_back(h.id);
+					name.clear();
+				}
+				if (!*p) break;
+			}
+			return e;
+		}
+
+		bool RuleSet::CompoundMatches(const Compound& c, const Element& e) const {
+			if (c.type && c.type != e.type) return false;
+			if (c.id && c.id != e.id) return false;
+			for (uint32_t cls : c.classes) {
+				if (std::find(e.classes.begin(), e.classes.end(), cls) == e.classes.end()) return false;
+			}
+			return true;
+		}
+
+		// Compounds [0, index] against the chain starting at 'depth', right to left
+		bool RuleSet::MatchFrom(const Selector& s, size_t index, size_t depth) {
+			const Compound& c = s.compounds[index];
+			if (!CompoundMatches(c, Describe(depth))) return false;
+			if (index == 0) return true;
+
+			if (c.combinator == Combinator::Child) {
+				return depth + 1 < m_chainLength && MatchFrom(s, index - 1, depth + 1);
+			}
+			for (size_t up = depth + 1; up < m_chainLength; ++up) {
+				if (MatchFrom(s, index - 1, up)) return true;
+			}
+			return false;
+		}
+
+		uint32_t RuleSet::ClassDependency(PropertyHandle name) const {
+			auto it = m_classDeps.find(name.id);
+			return (it != m_classDeps.end()) ? it->second : None;
+		}
+
+		uint32_t RuleSet::IdDependency(PropertyHandle name) const {
+			auto it = m_idDeps.find(name.id);
+			return (it != m_idDeps.end()) ? it->second : None;
+		}
+
+		// Features of the nearest node in the current chain that provides them
+		const MediaFeatures* RuleSet::FindMediaFeatures() {
+			for (size_t depth = 0; depth < m_chainLength; ++depth) {
+				ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(m_chain[depth].node);
+				const MediaFeatures* features = impl ? impl->GetMediaFeatures() : nullptr;
+				if (features) return features;
+			}
+			return nullptr;
+		}
+
+		void RuleSet::MediaChanges(const MediaFeatures& before, const MediaFeatures& after, std::vector<uint32_t>* flipped) const {
+			for (size_t i = 0; i < m_media.size(); ++i) {
+				if (m_media[i].query.Evaluate(before) != m_media[i].query.Evaluate(after)) flipped->push_back((uint32_t)i + 1);
+			}
+		}
+
+		bool RuleSet::MediaAffects(const std::vector<uint32_t>& queries, IContextNode* node) {
+			if (!node) return false;
+			BuildChain(node);
+			for (uint32_t q : queries) {
+				if (q == 0 || q > m_media.size()) continue;
+				for (uint32_t r : m_media[q - 1].rules) {
+					const Selector& s = m_rules[r].selector;
+					if (MatchFrom(s, s.compounds.size() - 1, 0)) return true;
+				}
+			}
+			return false;
+		}
+
+		bool RuleSet::Matches(size_t rule, IContextNode* node) {
+			if (rule >= m_rules.size() || m_rules[rule].dead || !node) return false;
+			BuildChain(node);
+			const Selector& s = m_rules[rule].selector;
+			return MatchFrom(s, s.compounds.size() - 1, 0);
+		}
+
+		ContextNodeImpl::ThemeTable RuleSet::Match(IContextNode* node) {
+			if (!node || m_rules.empty()) return nullptr;
+			BuildChain(node);
+
+			// 1. Candidate rules from the subject's buckets, each tested once. @media rules also
+			// need their query to match the features of the nearest container.
+			std::vector<uint32_t> matched;
+			const MediaFeatures* features = nullptr;
+			bool featuresFound = false;
+			if (++m_stamp == 0) {
+				std::fill(m_seen.begin(), m_seen.end(), 0);
+				m_stamp = 1;
+			}
+			auto test = [&](const std::vector<uint32_t>& bucket) {
+				for (uint32_t r : bucket) {
+					if (m_seen[r] == m_stamp) continue;
+					m_seen[r] = m_stamp;
+					const Rule& rule = m_rules[r];
+					if (rule.dead || !MatchFrom(rule.selector, rule.selector.compounds.size() - 1, 0)) continue;
+					if (rule.media) {
+						if (!featuresFound) {
+							features = FindMediaFeatures();
+							featuresFound = true;
+						}
+						if (!features || !m_media[rule.media - 1].query.Evaluate(*features)) continue;
+					}
+					matched.push_back(r);
+				}
+			};
+			auto testKey = [&](std::unordered_map<uint32_t, std::vector<uint32_t>>& buckets, uint32_t key) {
+				if (!key) return;
+				auto it = buckets.find(key);
+				if (it != buckets.end()) test(it->second);
+			};
+
+			const Element& e = Describe(0);
+			testKey(m_byId, e.id);
+			for (size_t i = 0; i < e.classes.size(); ++i) testKey(m_byClass, e.classes[i]);
+			testKey(m_byType, e.type);
+			test(m_universal);
+			if (matched.empty()) return nullptr;
+
+			// 2. Cascade order: layer, specificity, then source order
+			auto rank = [this](uint32_t r) { return m_layers[m_rules[r].layer].rank; };
+			std::sort(matched.begin(), matched.end(), [&](uint32_t a, uint32_t b) {
+				uint32_t la = rank(a), lb = rank(b);
+				if (la != lb) return la < lb;
+				uint32_t sa = m_rules[a].selector.specificity, sb = m_rules[b].selector.specificity;
+				return (sa != sb) ? sa < sb : a < b;
+			});
+
+			// 3. One shared table per distinct match set
+			auto cached = m_tables.find(matched);
+			if (cached != m_tables.end()) return cached->second;
+
+			// Normal declarations in that order. !important ones come after, the layers taken in
+			// reverse: an earlier layer's !important beats a later one's, and unlayered ones lose.
+			std::vector<ContextNodeImpl::ParsedEntry> cascade;
+			std::vector<uint32_t> sheets;
+			for (uint32_t r : matched) {
+				for (const Declaration& d : m_rules[r].declarations) {
+					if (!d.important) cascade.push_back({ d.key, &d.value, &d.parsed });
+				}
+				sheets.push_back(m_rules[r].sheet);
+			}
+			for (size_t end = matched.size(); end > 0;) {
+				size_t begin = end - 1;
+				while (begin > 0 && rank(matched[begin - 1]) == rank(matched[end - 1])) --begin;
+				for (size_t i = begin; i < end; ++i) {
+					for (const Declaration& d : m_rules[matched[i]].declarations) {
+						if (d.important) cascade.push_back({ d.key, &d.value, &d.parsed });
+					}
+				}
+				end = begin;
+			}
+			std::sort(sheets.begin(), sheets.end());
+			sheets.erase(std::unique(sheets.begin(), sheets.end()), sheets.end());
+
+			ContextNodeImpl::ThemeTable table = ContextNodeImpl::CompileParsed(cascade, std::move(sheets));
+			m_tables.emplace(std::move(matched), table);
+			return table;
+		}
+
+		// =========================================================
+		// --- Compiled images ---
+		// =========================================================
+
+		namespace {
+			template <typename T>
+			void AppendSection(std::string& out, Image::Section* section, const std::vector<T>& items) {
+				section->offset = (uint32_t)out.size();
+				section->count = (uint32_t)items.size();
+				if (!items.empty()) out.append((const char*)items.data(), items.size() * sizeof(T));
+				out.resize((out.size() + 3) & ~size_t(3), '\0');
+			}
+
+			bool SectionFits(const Image::Section& s, size_t elementSize, size_t imageSize) {
+				return (s.offset % 4) == 0 && s.offset <= imageSize && (imageSize - s.offset) / elementSize >= s.count;
+			}
+
+			bool RangeFits(uint32_t first, uint32_t count, uint32_t total) {
+				return (uint64_t)first + count <= total;
+			}
+		}
+
+		bool RuleSet::IsImage(const void* data, size_t size) {
+			return data && size >= sizeof(Image::kMagic) && memcmp(data, Image::kMagic, sizeof(Image::kMagic)) == 0;
+		}
+
+		void RuleSet::SaveImage(std::string* out) const {
+			// 1. String pool (each text once) and atom table (each atom once)
+			std::string strings;
+			std::unordered_map<std::string, uint32_t> stringOffsets;
+			auto addString = [&](const std::string& text) -> uint32_t {
+				auto it = stringOffsets.find(text);
+				if (it != stringOffsets.end()) return it->second;
+				uint32_t offset = (uint32_t)strings.size();
+				strings.append(text.c_str(), text.size() + 1);
+				stringOffsets.emplace(text, offset);
+				return offset;
+			};
+
+			std::vector<uint32_t> atoms;
+			std::unordered_map<uint32_t, uint32_t> atomIndex; // Live atom id -> index + 1
+			auto addAtom = [&](uint32_t id) -> uint32_t {
+				if (!id) return 0;
+				auto it = atomIndex.find(id);
+				if (it != atomIndex.end()) return it->second;
+				atoms.push_back(addString(PropertyAtoms::Name(PropertyHandle{ id })));
+				atomIndex.emplace(id, (uint32_t)atoms.size());
+				return (uint32_t)atoms.size();
+			};
+
+			// 2. Rules, their compounds and declarations; the rules of removed sheets are left out
+			std::vector<Image::Rule> rules;
+			std::vector<Image::Compound> compounds;
+			std::vector<Image::Declaration> decls;
+			std::vector<uint32_t> lists;
+			std::vector<uint32_t> index(m_rules.size(), Image::kNone);	// Rule -> image rule
+			for (size_t i = 0; i < m_rules.size(); ++i) {
+				const Rule& rule = m_rules[i];
+				if (rule.dead) continue;
+				index[i] = (uint32_t)rules.size();
+
+				Image::Rule r = {};
+				r.firstCompound = (uint32_t)compounds.size();
+				r.compoundCount = (uint32_t)rule.selector.compounds.size();
+				r.firstDecl = (uint32_t)decls.size();
+				r.declCount = (uint32_t)rule.declarations.size();
+				r.specificity = rule.selector.specificity;
+				r.state = rule.selector.state.empty() ? Image::kNone : addString(rule.selector.state);
+				r.media = rule.media;
+				r.layer = rule.layer;
+				rules.push_back(r);
+
+				for (const Compound& c : rule.selector.compounds) {
+					Image::Compound ic = {};
+					ic.type = addAtom(c.type);
+					ic.id = addAtom(c.id);
+					ic.firstClass = (uint32_t)lists.size();
+					ic.classCount = (uint32_t)c.classes.size();
+					ic.combinator = (uint32_t)c.combinator;
+					for (uint32_t cls : c.classes) lists.push_back(addAtom(cls));
+					compounds.push_back(ic);
+				}
+
+				for (const Declaration& d : rule.declarations) {
+					Image::Declaration idecl = {};
+					idecl.name = addString(d.name);
+					idecl.value = addString(d.value);
+					idecl.key = addAtom(d.key);
+					idecl.important = d.important ? 1 : 0;
+					idecl.parsed.type = (uint8_t)d.parsed.type;
+					idecl.parsed.unit = (uint8_t)d.parsed.unit;
+					idecl.parsed.boolean = d.parsed.boolean;
+					idecl.parsed.hasNumber = d.parsed.hasNumber;
+					idecl.parsed.hasInteger = d.parsed.hasInteger;
+					idecl.parsed.number = d.parsed.number;
+					idecl.parsed.integer = d.parsed.integer;
+					idecl.parsed.rgba = d.parsed.rgba;
+					decls.push_back(idecl);
+				}
+			}
+
+			// 3. The buckets, exactly as filed. Ordered by atom index so the same sheet always
+			// compiles to the same bytes, whatever the hash map order.
+			std::vector<Image::Bucket> buckets;
+			auto addBucket = [&](uint32_t kind, uint32_t atom, const std::vector<uint32_t>& bucket) {
+				uint32_t first = (uint32_t)lists.size();
+				for (uint32_t r : bucket) {
+					if (index[r] != Image::kNone) lists.push_back(index[r]);
+				}
+				if (lists.size() > first) buckets.push_back({ kind, atom, first, (uint32_t)lists.size() - first });
+			};
+			auto addBuckets = [&](uint32_t kind, const std::unordered_map<uint32_t, std::vector<uint32_t>>& map) {
+				std::vector<std::pair<uint32_t, const std::vector<uint32_t>*>> sorted;
+				for (const auto& kv : map) sorted.emplace_back(addAtom(kv.first), &kv.second);
+				std::sort(sorted.begin(), sorted.end());
+				for (const auto& entry : sorted) addBucket(kind, entry.first, *entry.second);
+			};
+			addBuckets(Image::ById, m_byId);
+			addBuckets(Image::ByClass, m_byClass);
+			addBuckets(Image::ByType, m_byType);
+			addBucket(Image::Universal, 0, m_universal);
+
+			std::vector<uint32_t> media;
+			for (const Media& m : m_media) media.push_back(addString(m.prelude));
+
+			// Layer ids are declaration order with the root at 0, i.e. already index + 1
+			std::vector<Image::Layer> layers;
+			for (size_t i = 1; i < m_layers.size(); ++i) {
+				const Layer& layer = m_layers[i];
+				layers.push_back({ layer.name.empty() ? Image::kNone : addString(layer.name), layer.parent });
+			}
+
+			// 4. Layout: header, then each section 4-byte aligned
+			Image::Header h = {};
+			memcpy(h.magic, Image::kMagic, sizeof(h.magic));
+			h.version = Image::kVersion;
+
+			out->assign(sizeof(h), '\0');
+			AppendSection(*out, &h.strings, std::vector<char>(strings.begin(), strings.end()));
+			AppendSection(*out, &h.atoms, atoms);
+			AppendSection(*out, &h.rules, rules);
+			AppendSection(*out, &h.compounds, compounds);
+			AppendSection(*out, &h.decls, decls);
+			AppendSection(*out, &h.lists, lists);
+			AppendSection(*out, &h.buckets, buckets);
+			AppendSection(*out, &h.media, media);
+			AppendSection(*out, &h.layers, layers);
+			h.size = (uint32_t)out->size();
+			memcpy(&(*out)[0], &h, sizeof(h));
+		}
+
+		bool RuleSet::LoadImage(const void* data, size_t size, std::string* error, uint32_t layer) {
+			auto fail = [&](const char* message) {
+				if (error) *error = message;
+				return false;
+			};
+			if (!IsImage(data, size)) return fail("not a compiled style sheet");
+			if (layer >= m_layers.size()) return fail("unknown layer");
+			if (size < sizeof(Image::Header)) return fail("truncated compiled style sheet");
+
+			// 1. Sections are read in place; only a misaligned buffer is copied first
+			std::vector<uint32_t> aligned;
+			const char* base = (const char*)data;
+			if ((uintptr_t)base % 4) {
+				aligned.resize((size + 3) / 4);
+				memcpy(aligned.data(), data, size);
+				base = (const char*)aligned.data();
+			}
+
+			const Image::Header* h = (const Image::Header*)base;
+			if (h->version != Image::kVersion) return fail("compiled style sheet version mismatch, recompile it");
+			if (h->size != size) return fail("truncated compiled style sheet");
+			if (!SectionFits(h->strings, 1, size) || !SectionFits(h->atoms, 4, size) ||
+				!SectionFits(h->rules, sizeof(Image::Rule), size) || !SectionFits(h->compounds, sizeof(Image::Compound), size) ||
+				!SectionFits(h->decls, sizeof(Image::Declaration), size) || !SectionFits(h->lists, 4, size) ||
+				!SectionFits(h->buckets, sizeof(Image::Bucket), size) || !SectionFits(h->media, 4, size) ||
+				!SectionFits(h->layers, sizeof(Image::Layer), size)) {
+				return fail("corrupt compiled style sheet (section bounds)");
+			}
+
+			const char* strings = base + h->strings.offset;
+			const uint32_t* atoms = (const uint32_t*)(base + h->atoms.offset);
+			const Image::Rule* rules = (const Image::Rule*)(base + h->rules.offset);
+			const Image::Compound* compounds = (const Image::Compound*)(base + h->compounds.offset);
+			const Image::Declaration* decls = (const Image::Declaration*)(base + h->decls.offset);
+			const uint32_t* lists = (const uint32_t*)(base + h->lists.offset);
+			const Image::Bucket* buckets = (const Image::Bucket*)(base + h->buckets.offset);
+			const uint32_t* media = (const uint32_t*)(base + h->media.offset);
+			const Image::Layer* layers = (const Image::Layer*)(base + h->layers.offset);
+
+			// The pool ends with a NUL, so every in-range offset is a terminated string
+			if (h->strings.count && strings[h->strings.count - 1] != '\0') return fail("corrupt compiled style sheet (strings)");
+			auto text = [&](uint32_t offset) -> const char* {
+				return (offset < h->strings.count) ? strings + offset : nullptr;
+			};
+
+			// 2. Atoms: the only hashing the load does
+			std::vector<uint32_t> atomIds(h->atoms.count + 1, 0);
+			for (uint32_t i = 0; i < h->atoms.count; ++i) {
+				const char* name = text(atoms[i]);
+				if (!name) return fail("corrupt compiled style sheet (atoms)");
+				atomIds[i + 1] = PropertyAtoms::Intern(name).id;
+			}
+			auto atom = [&](uint32_t index, uint32_t* id) {
+				if (index > h->atoms.count) return false;
+				*id = atomIds[index];
+				return true;
+			};
+
+			// 3. Rules, built aside so a bad image leaves the set untouched
+			std::vector<Rule> loaded(h->rules.count);
+			for (uint32_t r = 0; r < h->rules.count; ++r) {
+				const Image::Rule& ir = rules[r];
+				Rule& rule = loaded[r];
+				if (ir.compoundCount == 0 || !RangeFits(ir.firstCompound, ir.compoundCount, h->compounds.count) ||
+					!RangeFits(ir.firstDecl, ir.declCount, h->decls.count)) {
+					return fail("corrupt compiled style sheet (rules)");
+				}
+
+				if (ir.media > h->media.count || ir.layer > h->layers.count) return fail("corrupt compiled style sheet (rules)");
+				rule.media = ir.media;
+				rule.layer = ir.layer;
+				rule.selector.specificity = ir.specificity;
+				if (ir.state != Image::kNone) {
+					const char* state = text(ir.state);
+					if (!state) return fail("corrupt compiled style sheet (rules)");
+					rule.selector.state = state;
+				}
+
+				rule.selector.compounds.resize(ir.compoundCount);
+				for (uint32_t c = 0; c < ir.compoundCount; ++c) {
+					const Image::Compound& ic = compounds[ir.firstCompound + c];
+					Compound& compound = rule.selector.compounds[c];
+					if (!atom(ic.type, &compound.type) || !atom(ic.id, &compound.id) ||
+						ic.combinator > (uint32_t)Combinator::Child || !RangeFits(ic.firstClass, ic.classCount, h->lists.count)) {
+						return fail("corrupt compiled style sheet (selectors)");
+					}
+					compound.combinator = (Combinator)ic.combinator;
+					compound.classes.resize(ic.classCount);
+					for (uint32_t k = 0; k < ic.classCount; ++k) {
+						if (!atom(lists[ic.firstClass + k], &compound.classes[k]) || !compound.classes[k]) {
+							return fail("corrupt compiled style sheet (selectors)");
+						}
+					}
+				}
+
+				rule.declarations.resize(ir.declCount);
+				for (uint32_t d = 0; d < ir.declCount; ++d) {
+					const Image::Declaration& idecl = decls[ir.firstDecl + d];
+					Declaration& decl = rule.declarations[d];
+					const char* name = text(idecl.name);
+					const char* value = text(idecl.value);
+					if (!name || !value || !atom(idecl.key, &decl.key) || !decl.key) return fail("corrupt compiled style sheet (declarations)");
+					decl.name = name;
+					decl.value = value;
+					decl.important = idecl.important != 0;
+					decl.parsed.type = (PropertyType)idecl.parsed.type;
+					decl.parsed.unit = (LengthUnit)idecl.parsed.unit;
+					decl.parsed.boolean = idecl.parsed.boolean != 0;
+					decl.parsed.hasNumber = idecl.parsed.hasNumber != 0;
+					decl.parsed.hasInteger = idecl.parsed.hasInteger != 0;
+					decl.parsed.number = idecl.parsed.number;
+					decl.parsed.integer = idecl.parsed.integer;
+					decl.parsed.rgba = idecl.parsed.rgba;
+					decl.parsed.text = nullptr;
+					if (idecl.parsed.unit > (uint8_t)LengthUnit::Expression) return fail("corrupt compiled style sheet (declarations)");
+					// Expressions are process-local pointers: compile the text again (interned, cheap)
+					if (decl.parsed.unit == LengthUnit::Expression) {
+						decl.parsed.expression = Lengths::Compile(value);
+						if (!decl.parsed.expression) return fail("corrupt compiled style sheet (declarations)");
+					}
+				}
+			}
+
+			for (uint32_t b = 0; b < h->buckets.count; ++b) {
+				const Image::Bucket& ib = buckets[b];
+				uint32_t key = 0;
+				if (ib.kind > Image::Universal || !atom(ib.atom, &key) || (ib.kind != Image::Universal && !key) ||
+					!RangeFits(ib.first, ib.count, h->lists.count)) {
+					return fail("corrupt compiled style sheet (buckets)");
+				}
+				for (uint32_t i = 0; i < ib.count; ++i) {
+					if (lists[ib.first + i] >= h->rules.count) return fail("corrupt compiled style sheet (buckets)");
+				}
+			}
+
+			std::vector<Media> loadedMedia(h->media.count);
+			for (uint32_t m = 0; m < h->media.count; ++m) {
+				const char* prelude = text(media[m]);
+				if (!prelude || !MediaQuery::Compile(prelude, &loadedMedia[m].query)) return fail("corrupt compiled style sheet (media)");
+				loadedMedia[m].prelude = prelude;
+			}
+
+			for (uint32_t l = 0; l < h->layers.count; ++l) {
+				const char* name = (layers[l].name == Image::kNone) ? "" : text(layers[l].name);
+				if (!name || (layers[l].name != Image::kNone && !*name) || strchr(name, '.') || layers[l].parent > l) {
+					return fail("corrupt compiled style sheet (layers)");
+				}
+			}
+
+			// 4. Commit: declare the layers inside 'layer', append the rules and rebase the pre-built
+			// buckets and media onto them
+			std::vector<uint32_t> layerIds(h->layers.count + 1, layer);
+			for (uint32_t l = 0; l < h->layers.count; ++l) {
+				const char* name = (layers[l].name == Image::kNone) ? "" : text(layers[l].name);
+				layerIds[l + 1] = AddLayer(name, layerIds[layers[l].parent]);
+			}
+
+			uint32_t first = (uint32_t)m_rules.size();
+			uint32_t firstMedia = (uint32_t)m_media.size();
+			for (Media& m : loadedMedia) {
+				m_media.push_back(std::move(m));
+				if (m_sheet) m_sheets[m_sheet - 1].media.push_back((uint32_t)m_media.size());
+			}
+			for (Rule& rule : loaded) {
+				if (rule.media) rule.media += firstMedia;
+				rule.layer = layerIds[rule.layer];
+				rule.sheet = m_sheet;
+				if (m_sheet) m_sheets[m_sheet - 1].rules.push_back((uint32_t)m_rules.size());
+				m_rules.push_back(std::move(rule));
+			}
+			for (uint32_t b = 0; b < h->buckets.count; ++b) {
+				const Image::Bucket& ib = buckets[b];
+				std::vector<uint32_t>* bucket = &m_universal;
+				if (ib.kind == Image::ById) bucket = &m_byId[atomIds[ib.atom]];
+				else if (ib.kind == Image::ByClass) bucket = &m_byClass[atomIds[ib.atom]];
+				else if (ib.kind == Image::ByType) bucket = &m_byType[atomIds[ib.atom]];
+				for (uint32_t i = 0; i < ib.count; ++i) bucket->push_back(first + lists[ib.first + i]);
+			}
+			for (uint32_t r = first; r < m_rules.size(); ++r) AddDependencies(r);
+
+			m_seen.resize(m_rules.size(), 0);
+			m_tables.clear();
+			return true;
+		}
+	}
+}
@@ -1,27 +1,21 @@
-﻿#include <sstream>
+﻿#include <algorithm>
+#include <sstream>
 #include <fstream>
 #include <iostream>
 
 #include "ChronoStyles.hpp"
+#include "ChronoCSSParser.hpp"
 
 namespace ChronoUI {
 
-	// --- Helper for splitting strings (Local to this file) ---
-	static std::vector<std::string> Split(const std::string& str, char delimiter) {
-		std::vector<std::string> tokens;
-		std::string token;
-		std::istringstream tokenStream(str);
-		while (std::getline(tokenStream, token, delimiter)) {
-			std::string trimmed = Internal::Trim(token);
-			if (!trimmed.empty()) tokens.push_back(trimmed);
-		}
-		return tokens;
-	}
-
 	// --- Singleton Implementation ---
 
 	// Constructor
-	StyleManager::StyleManager() {}
+	StyleManager::StyleManager() {
+		_themes["light"] = ChronoControllerImpl::LightTheme();
+		_themes["dark"] = ChronoControllerImpl::DarkTheme();
+		_theme = "light";
+	}
 
 	// THE GLOBAL INSTANCE
 	// Because this is in the .cpp, the memory is allocated here ONCE.
@@ -32,185 +26,350 @@ namespace ChronoUI {
 
 	// --- CSS Loading Logic ---
 
-	void StyleManager::LoadCSS(const std::string& cssContent) {
-		// 1. Sanitize (Remove Comments)
-		std::string cleanContent;
-		cleanContent.reserve(cssContent.length());
-
-		for (size_t i = 0; i < cssContent.length(); ++i) {
-			if (i + 1 < cssContent.length() && cssContent[i] == '/' && cssContent[i + 1] == '*') {
-				size_t closeComment = cssContent.find("*/", i + 2);
-				if (closeComment != std::string::npos) {
-					i = closeComment + 1;
-					cleanContent += ' ';
+	// Parses CSS text and adds its style rules to 'rules', inside 'layer' (0 = unlayered)
+	static void CompileRules(const std::string& cssContent, CSS::RuleSet& rules, uint32_t layer = 0) {
+		// 1. Tokenize and parse in one pass; rules and declarations are views into cssContent
+		CSS::StyleSheet sheet;
+		CSS::Parser::Parse(cssContent, &sheet);
+		for (const auto& err : sheet.errors) {
+			std::cerr << "[ChronoUI] CSS line " << CSS::Parser::LineOf(cssContent, err.offset) << ": " << err.message << std::endl;
+		}
+
+		// 2. Compile style rules, one per selector of each list: top-level ones, and those inside
+		// @layer and @media blocks (one @media at most) under that layer and query. "@layer a, b;"
+		// only declares the order. Other at-rules are parsed but not applied.
+		struct Scope {
+			uint32_t layer, media;
+			bool applied;		// False: the block is not applied, nor anything inside it
+		};
+		std::vector<Scope> scopes(sheet.rules.size(), Scope{ 0, 0, false });
+		auto unsupported = [&](const CSS::Rule& rule, const char* what) {
+			std::cerr << "[ChronoUI] CSS line " << CSS::Parser::LineOf(cssContent, rule.prelude.data() - cssContent.data())
+				<< ": unsupported " << what << " '" << rule.prelude << "'" << std::endl;
+		};
+
+		std::vector<std::string_view> selectors;
+		std::vector<CSS::RuleSet::Declaration> declarations;
+		for (size_t index = 0; index < sheet.rules.size(); ++index) {
+			const auto& rule = sheet.rules[index];
+			Scope scope = (rule.parent >= 0) ? scopes[rule.parent] : Scope{ layer, 0, true };
+			if (!scope.applied) continue;
+
+			if (rule.atKeyword == "layer") {
+				selectors.clear();
+				CSS::Parser::SplitList(rule.prelude, &selectors);
+				if (!rule.hasBlock) {
+					for (std::string_view name : selectors) {
+						if (!rules.AddLayer(name, scope.layer)) unsupported(rule, "layer name");
+					}
+					continue;
 				}
-				else {
-					break;
+				scope.layer = (selectors.size() > 1) ? 0 : rules.AddLayer(selectors.empty() ? "" : selectors[0], scope.layer);
+				if (!scope.layer) {
+					unsupported(rule, "layer name");
+					continue;
 				}
+				scopes[index] = scope;
+				continue;
 			}
-			else {
-				cleanContent += cssContent[i];
-			}
-		}
-
-		// 2. Parse
-		size_t pos = 0;
-		while (pos < cleanContent.length()) {
-			size_t openBrace = cleanContent.find('{', pos);
-			if (openBrace == std::string::npos) break;
-
-			size_t closeBrace = cleanContent.find('}', openBrace);
-			if (closeBrace == std::string::npos) break;
-
-			std::string selectorStr = cleanContent.substr(pos, openBrace - pos);
-			std::string bodyStr = cleanContent.substr(openBrace + 1, closeBrace - openBrace - 1);
-
-			StyleProperties props;
-			auto rawProps = Split(bodyStr, ';');
-			for (const auto& rawProp : rawProps) {
-				auto kv = Split(rawProp, ':');
-				if (kv.size() == 2) {
-					props[kv[0]] = kv[1];
+			if (rule.atKeyword == "media") {
+				scope.media = scope.media ? 0 : rules.AddMedia(rule.prelude);
+				if (!scope.media) {
+					unsupported(rule, "media query");
+					continue;
 				}
+				scopes[index] = scope;
+				continue;
 			}
+			if (!rule.atKeyword.empty() || rule.declarationCount == 0) continue;
 
-			auto selectors = Split(selectorStr, ',');
-			for (auto& sel : selectors) {
-				if (sel.size() > 0 && sel[0] == '.') sel = sel.substr(1); // Remove dot
-				if (sel.empty()) continue;
+			declarations.clear();
+			for (uint32_t i = 0; i < rule.declarationCount; ++i) {
+				const CSS::Declaration& decl = sheet.declarations[rule.firstDeclaration + i];
+				declarations.push_back({ std::string(decl.name), std::string(decl.value), decl.important });
+			}
 
-				// ACCESS SINGLETON HERE
-				for (const auto& kv : props) {
-					Instance()._registry[sel][kv.first] = kv.second;
+			selectors.clear();
+			CSS::Parser::SplitList(rule.prelude, &selectors);
+			for (std::string_view sel : selectors) {
+				if (!rules.AddRule(sel, declarations, scope.media, scope.layer)) {
+					std::cerr << "[ChronoUI] CSS line " << CSS::Parser::LineOf(cssContent, rule.prelude.data() - cssContent.data())
+						<< ": unsupported selector '" << sel << "'" << std::endl;
 				}
 			}
-			pos = closeBrace + 1;
 		}
 	}
 
-	void StyleManager::LoadCSSFile(const std::string& filePath) {
-		std::ifstream file(filePath);
+	StyleSheetHandle StyleManager::LoadCSS(const std::string& cssContent, const std::string& layer, IContextNode* root) {
+		// Compiled images (ChronoCSSC output) are recognized by their header
+		if (CSS::RuleSet::IsImage(cssContent.data(), cssContent.size())) {
+			return LoadCompiled(cssContent.data(), cssContent.size(), layer, root);
+		}
+
+		CSS::RuleSet& rules = Instance()._rules;
+		StyleSheetHandle sheet = { rules.AddSheet() };
+		CompileRules(cssContent, rules, layer.empty() ? 0 : rules.AddLayer(layer));
+
+		// Cached style resolutions may predate the new rules
+		StyleCache::Invalidate();
+		if (root) RestyleTree(root);
+		return sheet;
+	}
+
+	StyleSheetHandle StyleManager::LoadCompiled(const void* data, size_t size, const std::string& layer, IContextNode* root) {
+		CSS::RuleSet& rules = Instance()._rules;
+		StyleSheetHandle sheet = { rules.AddSheet() };
+		uint32_t layers = rules.LayerMark();
+		std::string error;
+		if (!rules.LoadImage(data, size, &error, layer.empty() ? 0 : rules.AddLayer(layer))) {
+			// A layer named only by this load would still shift the ranks of later ones
+			std::cerr << "[ChronoUI] " << error << std::endl;
+			rules.RollbackLayers(layers);
+			rules.RemoveSheet(sheet.id);
+			return StyleSheetHandle();
+		}
+		StyleCache::Invalidate();
+		if (root) RestyleTree(root);
+		return sheet;
+	}
+
+	bool StyleManager::UnloadSheet(StyleSheetHandle sheet, IContextNode* root) {
+		// 1. Drop the rules; cached style resolutions may have come from them
+		CSS::RuleSet& rules = Instance()._rules;
+		if (!rules.RemoveSheet(sheet.id)) return false;
+		StyleCache::Invalidate();
+
+		// 2. Restyle only the nodes whose rule layer was cascaded with the sheet's declarations
+		std::vector<IContextNode*> pending;
+		if (root) pending.push_back(root);
+		while (!pending.empty()) {
+			IContextNode* current = pending.back();
+			pending.pop_back();
+
+			ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(current);
+			if (!impl) continue;
+			ContextNodeImpl::ThemeTable table = impl->GetRuleLayer();
+			if (table && std::binary_search(table->sheets.begin(), table->sheets.end(), sheet.id)) impl->SetRuleLayer(rules.Match(current));
+			impl->GetStyleChildren(&pending);
+		}
+		return true;
+	}
+
+	void StyleManager::CompileCSS(const std::string& cssContent, std::string* image) {
+		CSS::RuleSet rules;
+		CompileRules(cssContent, rules);
+		rules.SaveImage(image);
+	}
+
+	StyleSheetHandle StyleManager::LoadCSSFile(const std::string& filePath, const std::string& layer, IContextNode* root) {
+		// Binary: the file may be a compiled image
+		std::ifstream file(filePath, std::ios::binary);
 		if (file.is_open()) {
 			std::stringstream buffer;
 			buffer << file.rdbuf();
-			LoadCSS(buffer.str());
-		}
-		else {
-			std::cerr << "[ChronoUI] Could not open CSS file: " << filePath << std::endl;
+			return LoadCSS(buffer.str(), layer, root);
 		}
+		std::cerr << "[ChronoUI] Could not open CSS file: " << filePath << std::endl;
+		return StyleSheetHandle();
 	}
 
 	// --- Class Manipulation Logic ---
 
-	void StyleManager::AddClass(IContextNode* node, const std::string& classNames) {
-		if (!node) return;
+	static PropertyHandle ClassKey() {
+		static const PropertyHandle key = PropertyAtoms::Intern("class");
+		return key;
+	}
 
-		std::string currentClassStr = node->GetProperty("class", "");
-		std::set<std::string> classes;
+	// The node's own class list. An ancestor's "class" must not leak in through inheritance.
+	static const char* LocalClasses(IContextNode* node) {
+		ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(node);
+		const char* classes = impl ? impl->GetLocalProperty(ClassKey()) : node->GetProperty(ClassKey(), "");
+		return classes ? classes : "";
+	}
 
-		auto existingTokens = Split(currentClassStr, ' ');
-		for (const auto& t : existingTokens) classes.insert(t);
+	// Calls f(name) for every whitespace separated name of 'list'
+	template <typename F>
+	static void ForEachClass(std::string_view list, F&& f) {
+		size_t pos = 0;
+		while (pos < list.size()) {
+			size_t start = list.find_first_not_of(" \t\r\n", pos);
+			if (start == std::string_view::npos) break;
+			size_t end = list.find_first_of(" \t\r\n", start);
+			if (end == std::string_view::npos) end = list.size();
+			f(list.substr(start, end - start));
+			pos = end;
+		}
+	}
 
-		auto newTokens = Split(classNames, ' ');
-		bool changed = false;
-		for (const auto& t : newTokens) {
-			if (classes.find(t) == classes.end()) {
-				classes.insert(t);
-				changed = true;
-			}
+	static bool ContainsClass(std::string_view list, std::string_view name) {
+		bool found = false;
+		ForEachClass(list, [&](std::string_view c) { found = found || c == name; });
+		return found;
+	}
+
+	static void AppendClass(std::string& list, std::string_view name) {
+		if (!list.empty()) list += ' ';
+		list.append(name.data(), name.size());
+	}
+
+	// Writes the new class list and restyles only what the changed names can affect
+	void StyleManager::CommitClasses(IContextNode* node, const std::string& classes, const std::vector<std::string_view>& changed) {
+		// 1. Where do the selectors test these names? Names no selector uses were never interned.
+		const CSS::RuleSet& rules = Instance()._rules;
+		uint32_t deps = CSS::RuleSet::None;
+		for (std::string_view name : changed) {
+			PropertyHandle h = PropertyAtoms::Find(std::string(name).c_str());
+			if (h.IsValid()) deps |= rules.ClassDependency(h);
 		}
 
-		if (changed) {
-			std::string finalClassStr;
-			for (const auto& c : classes) {
-				if (!finalClassStr.empty()) finalClassStr += " ";
-				finalClassStr += c;
-			}
-			node->SetProperty("class", finalClassStr.c_str());
+		// 2. One notification and one repaint for the whole class change
+		PropertyUpdateScope batch(node);
+		node->SetProperty(ClassKey(), classes.c_str());
+
+		// 3. The node's rule layer is swapped and diffed; descendants only when an ancestor selector names the class
+		if (deps & CSS::RuleSet::Ancestor) RestyleTree(node);
+		else if (deps & CSS::RuleSet::Subject) Restyle(node);
+	}
 
-			// Delegate to instance
-			Instance().ApplyClassesImpl(node, classes);
+	// The id is already stored; restyles only what selectors naming the old or new id can reach
+	void StyleManager::CommitId(IContextNode* node, const char* before, const char* after) {
+		const CSS::RuleSet& rules = Instance()._rules;
+		uint32_t deps = CSS::RuleSet::None;
+		for (const char* name : { before, after }) {
+			PropertyHandle h = (name && *name) ? PropertyAtoms::Find(name) : PropertyHandle{};
+			if (h.IsValid()) deps |= rules.IdDependency(h);
 		}
+		if (deps & CSS::RuleSet::Ancestor) RestyleTree(node);
+		else if (deps & CSS::RuleSet::Subject) Restyle(node);
 	}
 
-	void StyleManager::RemoveClass(IContextNode* node, const std::string& classNames) {
-		if (!node) return;
+	void __stdcall StyleCache::IdChanged(IContextNode* node, const char* before, const char* after) {
+		StyleManager::CommitId(node, before, after);
+	}
 
-		std::string currentClassStr = node->GetProperty("class", "");
-		std::set<std::string> classes;
+	void StyleManager::AddClass(IContextNode* node, const std::string& classNames) {
+		if (!node) return;
 
-		auto existingTokens = Split(currentClassStr, ' ');
-		for (const auto& t : existingTokens) classes.insert(t);
+		std::string classes = LocalClasses(node);
+		std::vector<std::string_view> added;
+		ForEachClass(classNames, [&](std::string_view name) {
+			if (ContainsClass(classes, name)) return;
+			AppendClass(classes, name);
+			added.push_back(name);
+		});
+		if (!added.empty()) CommitClasses(node, classes, added);
+	}
 
-		auto removeTokens = Split(classNames, ' ');
-		bool changed = false;
-		for (const auto& t : removeTokens) {
-			if (classes.erase(t) > 0) changed = true;
-		}
+	void StyleManager::RemoveClass(IContextNode* node, const std::string& classNames) {
+		if (!node) return;
 
-		if (changed) {
-			std::string finalClassStr;
-			for (const auto& c : classes) {
-				if (!finalClassStr.empty()) finalClassStr += " ";
-				finalClassStr += c;
-			}
-			node->SetProperty("class", finalClassStr.c_str());
+		std::string current = LocalClasses(node), classes;
+		std::vector<std::string_view> removed;
+		ForEachClass(current, [&](std::string_view name) {
+			if (ContainsClass(classNames, name)) removed.push_back(name);
+			else AppendClass(classes, name);
+		});
 
-			// Re-apply remaining classes
-			Instance().ApplyClassesImpl(node, classes);
-		}
+		// The old rule layer goes away with the class, no stale properties stay behind
+		if (!removed.empty()) CommitClasses(node, classes, removed);
 	}
 
 	bool StyleManager::HasClass(IContextNode* node, const std::string& className) {
 		if (!node) return false;
-		std::string currentClassStr = node->GetProperty("class", "");
-		auto tokens = Split(currentClassStr, ' ');
-		for (const auto& t : tokens) {
-			if (t == className) return true;
-		}
-		return false;
+		return ContainsClass(LocalClasses(node), className);
 	}
 
 	void StyleManager::ToggleClass(IContextNode* node, const std::string& className) {
-		if (HasClass(node, className)) RemoveClass(node, className);
-		else AddClass(node, className);
+		if (!node || className.empty()) return;
+
+		// Single pass over the list: drop the name if present, otherwise append it
+		std::string current = LocalClasses(node), classes;
+		bool found = false;
+		ForEachClass(current, [&](std::string_view name) {
+			if (name == className) found = true;
+			else AppendClass(classes, name);
+		});
+		if (!found) AppendClass(classes, className);
+		CommitClasses(node, classes, { std::string_view(className) });
 	}
 
-	// Instance method implementation
-	void StyleManager::ApplyClassesImpl(IContextNode* node, const std::set<std::string>& classes) {
-		// 1. Define the pseudo-states you want to support
-		static const std::vector<std::string> pseudoStates = {
-			"hover", "active", "checked", "selected", "focus", "disabled"
-		};
+	// --- Themes ---
 
-		for (const auto& cls : classes) {
-			// --- 1. Apply the Main Class (Base State) ---
-			auto it = _registry.find(cls);
-			if (it != _registry.end()) {
-				const auto& props = it->second;
-				for (const auto& kv : props) {
-					node->SetProperty(kv.first.c_str(), kv.second.c_str());
-				}
-			}
+	void StyleManager::RegisterTheme(const std::string& name, const StyleProperties& properties) {
+		Instance()._themes[name] = ContextNodeImpl::CompileTheme(properties);
+	}
 
-			// --- 2. Apply Pseudo States (e.g., btn-primary:hover) ---
-			for (const auto& state : pseudoStates) {
-				// Construct the class name to look for (e.g., "btn-primary:hover")
-				std::string pseudoClassName = cls + ":" + state;
-
-				auto pseudoIt = _registry.find(pseudoClassName);
-				if (pseudoIt != _registry.end()) {
-					const auto& props = pseudoIt->second;
-					for (const auto& kv : props) {
-						// Construct the property key (e.g., "background-color:hover")
-						// Note: We use std::string to ensure correct concatenation, 
-						// as adding char* + char* in C++ is pointer arithmetic.
-						std::string propKey = kv.first + ":" + state;
-
-						node->SetProperty(propKey.c_str(), kv.second.c_str());
-					}
-				}
-			}
+	// Top-level container windows of this process that are on screen
+	static BOOL CALLBACK InvalidateContainerProc(HWND hwnd, LPARAM) {
+		DWORD pid = 0;
+		GetWindowThreadProcessId(hwnd, &pid);
+		if (pid != GetCurrentProcessId() || !IsWindowVisible(hwnd) || IsIconic(hwnd)) return TRUE;
+
+		wchar_t cls[32];
+		if (GetClassNameW(hwnd, cls, 32) && wcscmp(cls, L"ChronoMain") == 0) {
+			// Hidden children (inactive tabs, collapsed panels) get no WM_PAINT; they
+			// resolve the new theme whenever they are shown
+			RedrawWindow(hwnd, NULL, NULL, RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN);
+		}
+		return TRUE;
+	}
+
+	bool StyleManager::SetTheme(const std::string& name) {
+		StyleManager& self = Instance();
+		auto it = self._themes.find(name);
+		if (it == self._themes.end()) return false;
+
+		// 1. Pointer swap on the shared root, plus the style epoch bump
+		ChronoControllerImpl::Instance().SetThemeLayer(it->second);
+		self._theme = name;
+
+		// 2. Repaint what is on screen
+		EnumWindows(InvalidateContainerProc, 0);
+		return true;
+	}
+
+	std::string StyleManager::GetTheme() {
+		return Instance()._theme;
+	}
+
+	void StyleManager::Restyle(IContextNode* node) {
+		ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(node);
+		if (!impl) return;
+		impl->SetRuleLayer(Instance()._rules.Match(node));
+	}
+
+	void StyleManager::UpdateMedia(IContextNode* root, const MediaFeatures& before, const MediaFeatures& after) {
+		// 1. Which queries flip; most resize steps flip none and stop here
+		CSS::RuleSet& rules = Instance()._rules;
+		std::vector<uint32_t> flipped;
+		rules.MediaChanges(before, after, &flipped);
+		if (flipped.empty() || !root) return;
+
+		// 2. Restyle only the nodes a rule under a flipped query selects
+		std::vector<IContextNode*> pending(1, root);
+		while (!pending.empty()) {
+			IContextNode* current = pending.back();
+			pending.pop_back();
+
+			ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(current);
+			if (!impl) continue;
+			if (rules.MediaAffects(flipped, current)) impl->SetRuleLayer(rules.Match(current));
+			impl->GetStyleChildren(&pending);
+		}
+	}
+
+	void StyleManager::RestyleTree(IContextNode* node) {
+		if (!node) return;
+		CSS::RuleSet& rules = Instance()._rules;
+		std::vector<IContextNode*> pending(1, node);
+		while (!pending.empty()) {
+			IContextNode* current = pending.back();
+			pending.pop_back();
+
+			ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(current);
+			if (!impl) continue;
+			impl->SetRuleLayer(rules.Match(current));
+			impl->GetStyleChildren(&pending);
 		}
 	}
 }
\ No newline at end of file
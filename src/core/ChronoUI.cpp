@@ -8,6 +8,8 @@
 #include <map>
 #include <windowsx.h>
 #include <algorithm>
+#include <climits>
+#include <cmath>
 #include <dwmapi.h>
 #include <gdiplus.h>
 #include <mutex>
@@ -35,6 +37,7 @@ using namespace Gdiplus;
 
 #include "WidgetImpl.hpp"
 #include "ChronoStyles.hpp"
+#include "ChronoLayout.hpp"
 
 namespace ChronoUI {
 	const int SPLITTER_SIZE = 6;
@@ -43,6 +46,33 @@ namespace ChronoUI {
 	static int Scale(HWND hwnd, int px) { return MulDiv((int)px, (int)GetDpiForWindow(hwnd), 96); }
 	static int Scale(HWND hwnd, float px) { return MulDiv((int)px, (int)GetDpiForWindow(hwnd), 96); }
 
+	// Layout keys, interned once
+	static const PropertyHandle kWidthKey = PropertyAtoms::Intern("width");
+	static const PropertyHandle kHeightKey = PropertyAtoms::Intern("height");
+	static const PropertyHandle kFontSizeKey = PropertyAtoms::Intern("font-size");
+
+	// align-items / align-self / align-content keywords; anything else gives 'def'
+	static Layout::Align ParseAlign(const char* text, Layout::Align def) {
+		if (!text) return def;
+		if (!strcmp(text, "start") || !strcmp(text, "flex-start") || !strcmp(text, "left") || !strcmp(text, "top") || !strcmp(text, "baseline")) return Layout::Align::Start;
+		if (!strcmp(text, "center")) return Layout::Align::Center;
+		if (!strcmp(text, "end") || !strcmp(text, "flex-end") || !strcmp(text, "right") || !strcmp(text, "bottom")) return Layout::Align::End;
+		if (!strcmp(text, "stretch") || !strcmp(text, "normal")) return Layout::Align::Stretch;
+		if (!strcmp(text, "auto")) return Layout::Align::Auto;
+		return def;
+	}
+
+	// justify-content keywords; start when unknown
+	static Layout::Justify ParseJustify(const char* text) {
+		if (!text) return Layout::Justify::Start;
+		if (!strcmp(text, "center")) return Layout::Justify::Center;
+		if (!strcmp(text, "end") || !strcmp(text, "flex-end") || !strcmp(text, "right") || !strcmp(text, "bottom")) return Layout::Justify::End;
+		if (!strcmp(text, "space-between")) return Layout::Justify::SpaceBetween;
+		if (!strcmp(text, "space-around")) return Layout::Justify::SpaceAround;
+		if (!strcmp(text, "space-evenly")) return Layout::Justify::SpaceEvenly;
+		return Layout::Justify::Start;
+	}
+
 	
 	// Window properties used for cross-window hit-test behavior
 	static constexpr wchar_t kPropCustomTitleBar[] = L"Chrono.CustomTitleBar";
@@ -56,7 +86,14 @@ namespace ChronoUI {
 		switch (msg) {
 		case WM_SETCURSOR: SetCursor(LoadCursor(NULL, sd->isVert ? IDC_SIZEWE : IDC_SIZENS)); return TRUE;
 		case WM_LBUTTONDOWN: SetCapture(hwnd); sd->dragging = true; return 0;
-		case WM_LBUTTONUP: ReleaseCapture(); sd->dragging = false; return 0;
+		case WM_LBUTTONUP: ReleaseCapture(); return 0;
+		case WM_CAPTURECHANGED:
+			// Released or lost: the owner finishes the drag (a message with dragging == false)
+			if (sd->dragging) {
+				sd->dragging = false;
+				SendMessage(GetParent(hwnd), WM_CHRONO_SPLIT, (WPARAM)sd, 0);
+			}
+			return 0;
 		case WM_MOUSEMOVE:
 			if (sd->dragging && (wp & MK_LBUTTON))
 				SendMessage(GetParent(hwnd), WM_CHRONO_SPLIT, (WPARAM)sd, lp); return 0;
@@ -90,8 +127,98 @@ namespace ChronoUI {
 		std::vector<IWidget*> overflowItems;
 		IWidget* overflowButton = nullptr;
 		bool measurementsDirty = true;
+		bool batchedRepaint = false;			// Pending work of an open BeginUpdate batch
+		bool batchedLayout = false;
 		IContainer* parentContainer;
 
+		// Where the last pass put each widget, so a pass only moves the ones that changed.
+		// Cleared whenever the widget list changes.
+		std::vector<std::pair<IWidget*, Layout::Rect>> m_placed;
+
+		// Flex inputs of one widget. Read from its properties when the cell was marked
+		// (measurementsDirty) or the style epoch moved; a pass only resolves the lengths.
+		// The values stay valid until the property is written again, which marks the cell.
+		struct FlexChild {
+			PropertyValue width, height, basis;		// Empty when unset or "auto"
+			PropertyValue minWidth, maxWidth, minHeight, maxHeight;
+			float fontSize = 12.0f;					// 1em of the lengths above
+			float grow = 0.0f, shrink = 1.0f;
+			bool growSet = false;
+			bool autoWidth = false, autoHeight = false;	// "auto": a share of the free space
+			int order = 0;
+			Layout::Align alignSelf = Layout::Align::Auto;
+
+			// The last IWidget::Measure answer and the constraint it was asked for
+			int measureW = INT_MIN, measureH = INT_MIN;
+			MeasureMode measureMode = MeasureMode::Unbounded;
+			SIZE measured = { 0, 0 };
+			bool measuredKnown = false;
+		};
+		// The cell's own flex settings, read with the children
+		struct FlexBox {
+			PropertyValue rowGap, columnGap;
+			float fontSize = 12.0f;
+			bool wrap = false;
+			bool allowOverflow = true;				// Command bar: "overflow: false" clips instead
+			bool usesViewport = false;				// Some length above or of a child is in vw / vh
+			Layout::Justify justify = Layout::Justify::Start;
+			Layout::Align alignItems = Layout::Align::Stretch;
+			Layout::Align alignContent = Layout::Align::Stretch;
+		};
+		std::vector<FlexChild> m_flexChildren;
+		FlexBox m_flexBox;
+		Layout::Flex m_flex;
+		uint64_t m_flexEpoch = 0;				// StyleCache::Epoch() the children were read at
+
+		// What a flex pass placed, kept per box for replaying (see LayoutFlex). The generation
+		// moves whenever the children are read again or the mode changes.
+		struct FlexPass {
+			std::vector<Layout::Rect> rects;
+			std::vector<uint8_t> hidden;
+			int extent = 0;
+		};
+		Layout::SolveCache<FlexPass> m_flexCache;
+		FlexPass m_flexUncached;				// Passes the cache cannot keep (viewport lengths)
+		uint64_t m_flexGeneration = 0;
+		float m_flexCacheDpi = 0.0f;
+
+		void ReadFlex();
+		void LayoutFlex(const RECT& r);
+		void SolveFlex(const RECT& r, int x, int y, FlexPass* out);
+
+		// The i-th widget's intrinsic size for a constraint. Asked once per constraint until
+		// the children are read again, so a resize that keeps the constraint asks nothing.
+		bool MeasureChild(size_t i, int availableW, int availableH, MeasureMode mode, SIZE* out) {
+			FlexChild& c = m_flexChildren[i];
+			if (c.measureW != availableW || c.measureH != availableH || c.measureMode != mode) {
+				c.measureW = availableW;
+				c.measureH = availableH;
+				c.measureMode = mode;
+				c.measuredKnown = widgets[i]->Measure(availableW, availableH, mode, &c.measured);
+			}
+			*out = c.measured;
+			return c.measuredKnown;
+		}
+
+		// Item sizes where nothing is set and the widget does not measure itself
+		void FlexDefaults(int* defMain, int* defCross, int* autoMin) {
+			bool isRow = (m_mode != StackMode::Vertical);
+			bool commandBar = (m_mode == StackMode::CommandBar);
+			*defMain = Scale(m_hwnd, isRow ? 80 : 45);
+			*defCross = Scale(m_hwnd, commandBar ? 32 : (isRow ? 45 : 80));
+			*autoMin = commandBar ? Scale(m_hwnd, 40) : *defMain;
+		}
+
+		// In an auto grid track: what the widgets (or the nested layout) need, and a change in
+		// them lays the grid out again
+		bool m_autoSized = false;
+		void ContentSize(int* w, int* h);
+
+		// A dirty cell its layout did not resize still owes its pass
+		void LayoutIfDirty() {
+			if (IsLayoutDirty()) UpdateWidgets();
+		}
+
 		CellImpl(IContainer* _parentContainer) : parentContainer(_parentContainer) {
 		}
 		~CellImpl();
@@ -105,59 +232,114 @@ namespace ChronoUI {
 		
 		void __stdcall UpdateWidgets();
 
-		// Helper: Parses dimensions like "200", "200px", "25%"
-		// Returns -1 if the string is empty so the caller can apply defaults.
-		int ParseCssDimension(const std::string& input, int refTotalSize) {
-			if (input.empty()) return -1;
-
-			std::string val = input;
-			bool isPercent = false;
-
-			if (val == "auto")
+		// Records where the slot-th widget of this pass goes; false if the last pass already put it there
+		bool Place(size_t slot, IWidget* w, int x, int y, int cx, int cy) {
+			Layout::Rect r = { x, y, cx, cy };
+			if (slot < m_placed.size() && m_placed[slot].first == w && m_placed[slot].second == r) return false;
+			if (slot >= m_placed.size()) m_placed.resize(slot + 1, { nullptr, { 0, 0, 0, 0 } });
+			m_placed[slot] = { w, r };
+			return true;
+		}
+
+		// Resolution context of the current UpdateWidgets pass (DPI, viewport, root font size)
+		LengthContext m_lengths = {};
+
+		void PrepareLengths() {
+			m_lengths.dpiScale = (float)GetDpiForWindow(m_hwnd) / 96.0f;
+			RECT view = {};
+			GetClientRect(GetAncestor(m_hwnd, GA_ROOT), &view);
+			m_lengths.viewportWidth = (float)view.right;
+			m_lengths.viewportHeight = (float)view.bottom;
+			m_lengths.rootFontSize = 0.0f;	// Looked up on the first rem
+		}
+
+		// Device pixels for the width / height / margin ... of 'node': the value compiled when the
+		// property was written (px, %, em, rem, vw, vh, pt, calc(), min(), max(), clamp()),
+		// evaluated against 'refTotalSize' for percentages. "auto" gives 'refTotalSize' (and sets
+		// *isAuto). Returns -1 if the property is unset or not a length so the caller can apply defaults.
+		int ResolveDimension(IContextNode* node, PropertyHandle key, int refTotalSize, bool* isAuto = nullptr) {
+			if (isAuto) *isAuto = false;
+			PropertyValue v;
+			if (!node->GetPropertyValue(key, &v)) return -1;
+			if (v.type == PropertyType::String && strcmp(v.text, "auto") == 0) {
+				if (isAuto) *isAuto = true;
 				return refTotalSize;
-
-			// Check for percentage
-			if (val.back() == '%') {
-				isPercent = true;
-				val.pop_back();
-			}
-			// Check for units to strip (px, lu) - treat both as scalable units
-			else if (val.length() > 2) {
-				std::string suffix = val.substr(val.length() - 2);
-				if (suffix == "px" || suffix == "lu") {
-					val = val.substr(0, val.length() - 2);
-				}
 			}
+			return ResolveLength(v, Lengths::UsesFont(v) ? FontSizeOf(node, kFontSizeKey) : 12.0f, refTotalSize);
+		}
 
-			try {
-				float fVal = std::stof(val);
-				if (isPercent) {
-					return (int)(refTotalSize * (fVal / 100.0f));
-				}
-				else {
-					// We assume inputs are logical units (DPI independent) unless otherwise specified,
-					// so we scale them.
-					return Scale(m_hwnd, (int)(fVal));
-				}
-			}
-			catch (...) {
-				return -1;
+		// A compiled length in device pixels, 'fontSize' being its 1em; -1 if 'v' is not a length
+		int ResolveLength(const PropertyValue& v, float fontSize, int refTotalSize) {
+			LengthContext context = m_lengths;
+			context.percentBase = (float)refTotalSize;
+			context.fontSize = fontSize;
+			if (m_lengths.rootFontSize <= 0.0f && Lengths::UsesFont(v)) {
+				IContextNode* root = (ContextNodeImpl*)this;
+				while (root->GetParentNode()) root = root->GetParentNode();
+				m_lengths.rootFontSize = FontSizeOf(root, kFontSizeKey);
+				context.rootFontSize = m_lengths.rootFontSize;
 			}
+
+			float px;
+			if (!Lengths::Resolve(v, context, &px)) return -1;
+			return (int)std::floor(px + 0.5f);
+		}
+
+		// Logical font size for em / rem; 12 like the cell's own text when nothing sets it
+		static float FontSizeOf(IContextNode* node, PropertyHandle key) {
+			PropertyValue v;
+			if (node->GetPropertyValue(key, &v) && v.hasNumber && v.number > 0.0f) return v.number;
+			return 12.0f;
 		}
 
 		IContainer* SetParentContainer(IContainer* _parentContainer) { parentContainer = _parentContainer; };
 		IContainer* GetParentContainer() { return parentContainer; };
 
+		virtual PropertyHandle StyleTypeKey() override {
+			static const PropertyHandle type = PropertyAtoms::Intern("Cell");
+			return type;
+		}
+		virtual void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			for (IWidget* w : widgets) out->push_back(w);
+			if (nested) out->push_back(nested);
+		}
+
 		virtual void __stdcall SetParentNode(IContextNode* parent) override { ContextNodeImpl::SetParentNode(parent); }
 		virtual IContextNode* __stdcall GetParentNode() override { return ContextNodeImpl::GetParentNode(); }
 		virtual IContextNode* __stdcall GetContextNode() override { return ContextNodeImpl::GetContextNode(); }
 
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
-		virtual ICell* __stdcall SetProperty(const char* key, const char* value) {
-			m_properties[key] = (value) ? value : "";
-			InvalidateRect(m_hwnd, NULL, TRUE);
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override { return ContextNodeImpl::GetPropertyValue(key, out); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override { return ContextNodeImpl::GetStyleValue(prop, classid, subclass, stateMask, out); }
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override { return ContextNodeImpl::ResolveKey(key); }
+		virtual ICell* __stdcall SetProperty(PropertyHandle key, const char* value) override {
+			StoreProperty(key, value);
+
+			// Cells use the global impact defaults: skip, repaint (with erase) or relayout
+			PropertyImpact impact = PropertySchema::GetImpact(PropertyHandle{ 0 }, key);
+			if (impact == PropertyImpact::Layout) batchedLayout = true;
+			if (impact != PropertyImpact::None) batchedRepaint = true;
+			if (!IsUpdating()) OnEndUpdate();
 			return this;
 		}
+		virtual void __stdcall BeginUpdate() override { ContextNodeImpl::BeginUpdate(); }
+		virtual void __stdcall EndUpdate() override { ContextNodeImpl::EndUpdate(); }
+		virtual void OnEndUpdate() override {
+			if (batchedLayout) {
+				// The cell keeps its box; only its own pass runs again, in the next frame
+				batchedLayout = false;
+				measurementsDirty = true;
+				InvalidateLayout();
+			}
+			if (batchedRepaint) {
+				batchedRepaint = false;
+				InvalidateRect(m_hwnd, NULL, TRUE);
+			}
+		}
+		virtual ICell* __stdcall SetProperty(const char* key, const char* value) {
+			return SetProperty(PropertyAtoms::Intern(key), value);
+		}
 		virtual COLORREF GetColor(const char* key, COLORREF defaultColor = RGB(0, 0, 0)) override { return ContextNodeImpl::GetColor(key, defaultColor); }
 		virtual IContextNode* SetColor(const char* key, COLORREF color) override { return ContextNodeImpl::SetColor(key, color); };
 		virtual const char* GetStyle(const char* _prop, const char* _def, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active) override { return ContextNodeImpl::GetStyle(_prop, _def, _classid, _subclass, selected, enabled, hovered, active); }
@@ -216,12 +398,7 @@ namespace ChronoUI {
 			CellImpl* self = (CellImpl*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
 			switch (msg) {
 			case WM_SIZE:
-				if (self) {
-					if (self->m_mode == StackMode::CommandBar) {
-						self->measurementsDirty = true;
-					}
-					self->UpdateWidgets();
-				}
+				if (self) self->UpdateWidgets();
 				return 0;
 			case WM_ERASEBKGND: {
 				HDC hdc = (HDC)wp;
@@ -278,6 +455,17 @@ namespace ChronoUI {
 			case WM_CHRONO_SPLIT:
 				return SendMessage(GetParent(hwnd), msg, wp, lp);
 
+			case WM_CHRONO_LAYOUT_DIRTY: {
+				// Several widgets may have posted; one layout pass covers them all
+				MSG pending;
+				while (PeekMessage(&pending, hwnd, WM_CHRONO_LAYOUT_DIRTY, WM_CHRONO_LAYOUT_DIRTY, PM_REMOVE)) {}
+				if (self) {
+					self->measurementsDirty = true;
+					self->UpdateWidgets();
+				}
+				return 0;
+			}
+
 			case WM_USER + 200:
 				if (self)
 					self->ScrollWidgetIntoView((HWND)lp); return 0;
@@ -389,68 +577,6 @@ namespace ChronoUI {
 			this->UpdateWidgets();
 		}
 
-		void MeasureCommandBarWidgets(int availableWidth, std::vector<IWidget*>& visible, std::vector<IWidget*>& overflow, bool allowOverflow = true) {
-			visible.clear();
-			overflow.clear();
-
-			if (widgets.empty()) return;
-
-			int overflowBtnWidth = Scale(m_hwnd, 40);
-			int spacing = Scale(m_hwnd, 4);
-			int usedWidth = 0;
-
-			for (auto* w : widgets) {
-				if (w == overflowButton) continue;
-
-				int widgetWidth = 0;
-				const char* wProp = w->GetProperty("width");
-
-				// 1. Check for "auto"
-				if (wProp && strcmp(wProp, "auto") == 0) {
-					widgetWidth = Scale(m_hwnd, 40);
-				}
-				else {
-					// 2. Parse explicit dimension
-					widgetWidth = ParseCssDimension(wProp, availableWidth);
-					// 3. Default if missing
-					if (widgetWidth < 0) widgetWidth = Scale(m_hwnd, 80);
-				}
-
-				// Calculate maxWidth based on whether overflow logic is active
-				int maxWidth = availableWidth;
-
-				// Only check for overflow button reservation if overflow is actually allowed
-				if (allowOverflow) {
-					// Check if we need to reserve space for the overflow button.
-					// 1. If we already have items in overflow, we are in "overflow mode".
-					// 2. If adding this item + spacing + overflow button exceeds total, we restrict limit.
-					bool needsOverflowRoom = !overflow.empty() ||
-						(usedWidth + widgetWidth + spacing + overflowBtnWidth > availableWidth);
-
-					if (needsOverflowRoom) {
-						maxWidth = availableWidth - overflowBtnWidth - spacing;
-					}
-				}
-
-				// Check fit
-				// Note: If allowOverflow is false, 'overflow' vector is always empty, 
-				// so we effectively just check: (usedWidth + widgetWidth <= availableWidth)
-				if (overflow.empty() && (usedWidth + widgetWidth <= maxWidth)) {
-					visible.push_back(w);
-					usedWidth += widgetWidth + spacing;
-				}
-				else {
-					// It doesn't fit in the remaining visible space.
-					if (allowOverflow) {
-						overflow.push_back(w);
-					}
-					// If allowOverflow is false, we do nothing. 
-					// The widget is neither visible nor in overflow (effectively clipped/hidden).
-				}
-			}
-		}
-
-
 		IWidget* __stdcall AddWidget(IWidget* w) override;
 		void __stdcall RemoveWidget(IWidget* w) override;
 
@@ -458,51 +584,126 @@ namespace ChronoUI {
 		ILayout* __stdcall CreateLayout(int r, int c) override;
 		ILayout* __stdcall GetNestedLayout() override;
 
-		void __stdcall SetStackMode(StackMode mode) override { m_mode = mode; UpdateWidgets(); }
+		void __stdcall SetStackMode(StackMode mode) override { m_mode = mode; m_placed.clear(); ++m_flexGeneration; UpdateWidgets(); }
 		void __stdcall SetActiveTab(int index) override { m_activeTab = index; UpdateWidgets(); }
 		void __stdcall EnableScroll(bool e) override {
 			scrollEnabled = e; bool isHoriz = (m_mode == StackMode::Horizontal);
+			++m_flexGeneration;
 			LONG style = GetWindowLong(m_hwnd, GWL_STYLE);
 			SetWindowLong(m_hwnd, GWL_STYLE, e ? (style | (isHoriz ? WS_HSCROLL : WS_VSCROLL)) : (style & ~(WS_HSCROLL | WS_VSCROLL)));
 			UpdateWidgets();
 		}
+		void __stdcall GetLayoutCacheStats(uint64_t* hits, uint64_t* misses) override;
+
+	protected:
+		// Grid tracks size cells, so a cell is a dirty root unless it sits in an auto track
+		virtual bool SizesToContent() override { return m_autoSized; }
+
+		virtual void PerformLayout() override {
+			measurementsDirty = true;
+			if (m_hwnd) UpdateWidgets();
+			else ClearLayoutDirty();
+		}
 	};
 
-	struct DimPlan { 
-		WidgetSize size; 
-		WidgetSize min; 
-		int pos = 0; 
-		int actual = 0; 
-		bool splitter = false; 
-		SplitterData* sd = nullptr; 
-
-		// --- ADD THESE ---
-		WidgetSize savedSize = WidgetSize::Fixed(0);
-		bool isCollapsed = false;     // State flag
+	static_assert((int)SizeUnit::System == (int)Layout::Unit::System && (int)SizeUnit::Fill == (int)Layout::Unit::Fill && (int)SizeUnit::Auto == (int)Layout::Unit::Auto, "Layout::Unit mirrors SizeUnit");
+
+	// One CSS track size: <n>px (or a bare number), <n>%, <n>fr or auto
+	static bool ParseTrackSize(const char*& p, WidgetSize* out) {
+		while (*p == ' ') ++p;
+		if (strncmp(p, "auto", 4) == 0) {
+			p += 4;
+			*out = WidgetSize::Auto();
+			return true;
+		}
+		char* end = nullptr;
+		float v = strtof(p, &end);
+		if (end == p) return false;
+		p = end;
+		if (*p == '%') {
+			++p;
+			*out = WidgetSize::Percent(v);
+		}
+		else if (strncmp(p, "fr", 2) == 0) {
+			p += 2;
+			*out = WidgetSize::Fill(v);
+		}
+		else {
+			if (strncmp(p, "px", 2) == 0) p += 2;
+			*out = WidgetSize::Fixed(v);
+		}
+		return true;
+	}
+
+	// A track size or minmax(<min>, <max>). Without minmax the minimum is 0, so 1fr is
+	// minmax(0, 1fr) here; minmax(auto, 1fr) keeps a fill track no smaller than its cells.
+	static bool ParseTrack(const char*& p, WidgetSize* size, WidgetSize* min) {
+		while (*p == ' ') ++p;
+		*min = WidgetSize::Fixed(0);
+		if (strncmp(p, "minmax(", 7) != 0) return ParseTrackSize(p, size);
+
+		p += 7;
+		if (!ParseTrackSize(p, min)) return false;
+		while (*p == ' ') ++p;
+		if (*p++ != ',') return false;
+		if (!ParseTrackSize(p, size)) return false;
+		while (*p == ' ') ++p;
+		if (*p++ != ')') return false;
+		if (min->unit == SizeUnit::Fill) *min = WidgetSize::Fixed(0);
+		return true;
+	}
+
+	// What SetRow / SetCol asked for; Layout::Grid turns it into positions
+	struct DimPlan {
+		WidgetSize size;
+		WidgetSize min;
+		bool splitter = false;
+		SplitterData* sd = nullptr;
+		bool isCollapsed = false;     // Sized to 'min' until restored
 	};
 
-	class LayoutImpl : public ILayout, public ContextNodeImpl {
+	class LayoutImpl : public ILayout, public ContextNodeImpl, public IAnimated {
 		HWND m_parentNode;
 		int m_rCount,
 			m_cCount;
 		std::vector<DimPlan> m_rows, m_cols;
-		std::vector<CellImpl*> m_cells;
+		std::vector<CellImpl*> m_cells;			// Per slot, row-major: the cell covering it, null while empty
+		std::vector<CellImpl*> m_areaCells;		// Each cell once, in m_grid.areas order
+		bool m_autoTracks = false;				// Some row or column is sized by its cells
 		RECT m_lastRect = { 0,0,0,0 };
 		std::map<std::string, std::pair<int, int>> named_cells;
 
+		// The track math, and the last rectangles it produced
+		Layout::Grid m_grid;
+		int m_titleRowHeight = -1;
+		uint64_t m_syncedGeneration = UINT64_MAX;	// LayoutGeneration() the grid was last synced at
+
+		// CalculateMinimumSize result; only a track change or a new DPI moves it
+		int m_minW = 0, m_minH = 0;
+		UINT m_minDpi = 0;
+		bool m_minStale = true;
+
+		// Live resize: the splitter being dragged, and whether it moved since the last frame
+		SplitterData* m_dragSplitter = nullptr;
+		bool m_dragPending = false;
+
 	public:
 		LayoutImpl(IContainer* _parentContainer, HWND p, int r, int c) : parentContainer(_parentContainer), m_parentNode(p), m_rCount(r), m_cCount(c) {
 			m_rows.resize(r, { WidgetSize::Fill(), WidgetSize::Fixed(20) });
 			m_cols.resize(c, { WidgetSize::Fill(), WidgetSize::Fixed(20) });
-			for (int i = 0; i < r * c; ++i) {
-				CellImpl* cell = new CellImpl(GetParentContainer());
-				cell->Create(p);
-				m_cells.push_back(cell);
-			}
+			m_cells.resize((size_t)r * c, nullptr);
 		}
 		~LayoutImpl() {
+			// A drag in progress ends here, without the release pass
+			AnimationClock::Remove(this);
+			if (m_dragSplitter) {
+				m_dragSplitter->dragging = false;
+				m_dragSplitter = nullptr;
+				LiveResize::End();
+			}
+
 			// Destroy all cells created by this layout
-			for (CellImpl* cell : m_cells) {
+			for (CellImpl* cell : m_areaCells) {
 				if (cell) {
 					// Destroying the cell will trigger the recursive 
 					// destruction of widgets inside it (via ~CellImpl)
@@ -513,6 +714,7 @@ namespace ChronoUI {
 				}
 			}
 			m_cells.clear();
+			m_areaCells.clear();
 
 			// Clean up splitters
 			for (auto& r : m_rows) {
@@ -528,61 +730,89 @@ namespace ChronoUI {
 				}
 			}
 		}
-		// --- ADD THIS METHOD TO LayoutImpl ---
+		// Fixed, system and auto tracks, the minimums of the others and the splitters. Auto
+		// tracks follow their cells, so with any of them it is measured every time.
 		void CalculateMinimumSize(int& w, int& h) {
-			int sSize = Scale(m_parentNode, SPLITTER_SIZE);
-			w = 0; h = 0;
-
-			// Calculate Total Minimum Height (Rows)
-			for (auto& r : m_rows) {
-				if (r.splitter) h += sSize;
-
-				if (r.size.unit == SizeUnit::Pixels) {
-					h += Scale(m_parentNode, (int)r.size.value);
-				}
-				else if (r.size.unit == SizeUnit::System) {
-					h += GetSystemMetricsForDpi(SM_CYCAPTION, GetDpiForWindow(m_parentNode));
+			UINT dpi = GetDpiForWindow(m_parentNode);
+			if (m_minStale || dpi != m_minDpi || m_autoTracks) {
+				SyncGrid();
+				m_grid.MinimumSize(&m_minW, &m_minH);
+				m_minDpi = dpi;
+				m_minStale = false;
+			}
+			w = m_minW;
+			h = m_minH;
+		}
+
+		// Hands the rows and columns to the solver at the window's current DPI
+		void SyncGrid() {
+			UINT dpi = GetDpiForWindow(m_parentNode);
+			int caption = GetSystemMetricsForDpi(SM_CYCAPTION, dpi);
+			auto sync = [caption](const std::vector<DimPlan>& dims, std::vector<Layout::Track>& tracks) {
+				tracks.resize(dims.size());
+				for (size_t i = 0; i < dims.size(); ++i) {
+					Layout::Track& t = tracks[i];
+					t.size = { (Layout::Unit)dims[i].size.unit, dims[i].size.value };
+					t.min = { (Layout::Unit)dims[i].min.unit, dims[i].min.value };
+					t.system = caption;
+					t.splitter = dims[i].splitter;
+					t.collapsed = dims[i].isCollapsed;
 				}
-				else {
-					// For Fill/Percent, we rely on the defined Minimum size
-					// If Min is percent, we can't reliably calculate total height without context, 
-					// so we assume 0 or the pixel value.
-					int minPx = (r.min.unit == SizeUnit::Pixels) ? Scale(m_parentNode, (int)r.min.value) : 0;
-					h += minPx;
-				}
-			}
-
-			// Calculate Total Minimum Width (Cols)
-			for (auto& c : m_cols) {
-				if (c.splitter) w += sSize;
-
-				if (c.size.unit == SizeUnit::Pixels) {
-					w += Scale(m_parentNode, (int)c.size.value);
-				}
-				else if (c.size.unit == SizeUnit::System) {
-					// System width isn't standard, usually ignored, treat as 0 or valid metric
-					w += 0;
-				}
-				else {
-					int minPx = (c.min.unit == SizeUnit::Pixels) ? Scale(m_parentNode, (int)c.min.value) : 0;
-					w += minPx;
+			};
+			sync(m_rows, m_grid.rows);
+			sync(m_cols, m_grid.cols);
+			m_grid.dpi = (int)dpi;
+			m_grid.splitterSize = SPLITTER_SIZE;
+
+			// Cells in auto tracks report their content; the others are not measured
+			auto isAuto = [](const DimPlan& d) { return d.size.unit == SizeUnit::Auto || d.min.unit == SizeUnit::Auto; };
+			auto crossesAuto = [&isAuto](const std::vector<DimPlan>& dims, int first, int span) {
+				for (int i = (std::max)(first, 0); i < first + span && i < (int)dims.size(); ++i) {
+					if (isAuto(dims[i])) return true;
 				}
+				return false;
+			};
+			m_autoTracks = std::any_of(m_rows.begin(), m_rows.end(), isAuto) || std::any_of(m_cols.begin(), m_cols.end(), isAuto);
+			for (size_t i = 0; i < m_areaCells.size(); ++i) {
+				Layout::Area& a = m_grid.areas[i];
+				CellImpl* cell = m_areaCells[i];
+				cell->m_autoSized = m_autoTracks && (crossesAuto(m_rows, a.row, a.rowSpan) || crossesAuto(m_cols, a.col, a.colSpan));
+				if (cell->m_autoSized) cell->ContentSize(&a.contentW, &a.contentH);
+				else a.contentW = a.contentH = 0;
 			}
 		}
 		IContainer* parentContainer = nullptr;
 		IContainer* SetParentContainer(IContainer* _parentContainer) { parentContainer = _parentContainer; };
 		IContainer* GetParentContainer() { return parentContainer; };
 
+		virtual PropertyHandle StyleTypeKey() override {
+			static const PropertyHandle type = PropertyAtoms::Intern("Layout");
+			return type;
+		}
+		virtual void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			// Cells exist from their first GetCell
+			for (CellImpl* cell : m_areaCells) out->push_back(static_cast<ICell*>(cell));
+		}
+
 		virtual void __stdcall SetParentNode(IContextNode* parent) override {
 			ContextNodeImpl::SetParentNode(parent);
 		}
 		virtual IContextNode* __stdcall GetParentNode() override { return ContextNodeImpl::GetParentNode(); }
 		virtual IContextNode* __stdcall GetContextNode() override { return ContextNodeImpl::GetContextNode(); }
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override { return ContextNodeImpl::GetPropertyValue(key, out); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override { return ContextNodeImpl::GetStyleValue(prop, classid, subclass, stateMask, out); }
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override { return ContextNodeImpl::ResolveKey(key); }
+		virtual ILayout* __stdcall SetProperty(PropertyHandle key, const char* value) override {
+			StoreProperty(key, value);
+			return this;
+		}
 		virtual ILayout* __stdcall SetProperty(const char* key, const char* value) { 
-			m_properties[key] = (value) ? value : ""; 
-			return this; 
+			return SetProperty(PropertyAtoms::Intern(key), value);
 		}
+		virtual void __stdcall BeginUpdate() override { ContextNodeImpl::BeginUpdate(); }
+		virtual void __stdcall EndUpdate() override { ContextNodeImpl::EndUpdate(); }
 		virtual COLORREF GetColor(const char* key, COLORREF defaultColor = RGB(0, 0, 0)) override { return ContextNodeImpl::GetColor(key, defaultColor); }
 		virtual IContextNode* SetColor(const char* key, COLORREF color) override { return SetColor(key, color); };
 		virtual const char* GetStyle(const char* _prop, const char* _def, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active) override { return ContextNodeImpl::GetStyle(_prop, _def, _classid, _subclass, selected, enabled, hovered, active); }
@@ -591,6 +821,7 @@ namespace ChronoUI {
 			m_rows[i].size = s; 
 			m_rows[i].splitter = sp; 
 			m_rows[i].min = min;
+			TracksChanged();
 
 			if (sp && !m_rows[i].sd) {
 				m_rows[i].sd = new SplitterData{ nullptr, false, i, this };
@@ -603,6 +834,7 @@ namespace ChronoUI {
 
 		void __stdcall SetCol(int i, WidgetSize s, bool sp, WidgetSize min) override {
 			m_cols[i].size = s; m_cols[i].splitter = sp; m_cols[i].min = min;
+			TracksChanged();
 			if (sp && !m_cols[i].sd) {
 				m_cols[i].sd = new SplitterData{ nullptr, true, i, this };
 				WNDCLASSW wc = { 0 }; wc.lpfnWndProc = SplitterWndProc; wc.lpszClassName = L"ChronoSplit";
@@ -624,153 +856,153 @@ namespace ChronoUI {
 		}
 
 		ICell* __stdcall GetCell(int r, int c) override {
-			ICell* cell = m_cells[r * m_cCount + c];
+			if (r < 0 || r >= m_rCount || c < 0 || c >= m_cCount) return nullptr;
+			CellImpl* cell = m_cells[r * m_cCount + c];
+			if (!cell) cell = AddCell({ r, c, 1, 1, 0, 0 });
+			return cell;
+		}
 
-			if (cell && cell->GetParentNode() == nullptr) {
-				cell->SetParentNode((ContextNodeImpl*)this);
-			}
+		ICell* __stdcall SetCellSpan(int row, int col, int rowSpan, int colSpan) override {
+			if (row < 0 || col < 0 || rowSpan < 1 || colSpan < 1 || row + rowSpan > m_rCount || col + colSpan > m_cCount) return nullptr;
 
+			// 1. The area may take in empty slots and the cell's own, nothing else
+			CellImpl* cell = m_cells[row * m_cCount + col];
+			for (int r = row; r < row + rowSpan; ++r) {
+				for (int c = col; c < col + colSpan; ++c) {
+					CellImpl* other = m_cells[r * m_cCount + c];
+					if (other && other != cell) return nullptr;
+				}
+			}
+			if (!cell) return AddCell({ row, col, rowSpan, colSpan, 0, 0 });
+
+			// 2. A cell spanning here from another slot cannot be re-anchored
+			size_t index = std::find(m_areaCells.begin(), m_areaCells.end(), cell) - m_areaCells.begin();
+			Layout::Area& area = m_grid.areas[index];
+			if (area.row != row || area.col != col) return nullptr;
+			Cover(area, nullptr);
+			area.rowSpan = rowSpan;
+			area.colSpan = colSpan;
+			Cover(area, cell);
+			TracksChanged();
 			return cell;
 		}
 
+		void __stdcall SetRows(const char* tracks) override { SetTracks(tracks, true); }
+		void __stdcall SetCols(const char* tracks) override { SetTracks(tracks, false); }
+
+		// Mouse moves only note that the splitter moved; the next AnimationClock frame lays out
+		// once for all of them (live resize). The release applies the last position and
+		// repaints the layout at full quality.
 		void OnSplitter(SplitterData* sd, LPARAM lp) {
+			if (!sd->dragging) {
+				if (sd != m_dragSplitter) return;
+				AnimationClock::Remove(this);
+				if (m_dragPending) ApplySplitter();
+				m_dragSplitter = nullptr;
+				LiveResize::End();
+				RedrawWindow(m_parentNode, &m_lastRect, NULL, RDW_INVALIDATE | RDW_ALLCHILDREN | RDW_ERASE);
+				return;
+			}
+			if (!m_dragSplitter) {
+				m_dragSplitter = sd;
+				LiveResize::Begin();
+				AnimationClock::Add(this);
+			}
+			m_dragPending = true;
+		}
+
+		bool __stdcall OnAnimationFrame(double now) override {
+			if (m_dragPending) ApplySplitter();
+			return m_dragSplitter != nullptr;
+		}
+
+		void ApplySplitter() {
+			m_dragPending = false;
+			SplitterData* sd = m_dragSplitter;
 			POINT pt; GetCursorPos(&pt);
 			ScreenToClient(m_parentNode, &pt);
-			UINT dpiVal = GetDpiForWindow(m_parentNode);
-			float dpi = dpiVal / 96.0f;
-
-			DWORD pStyle = GetWindowLongW(m_parentNode, GWL_STYLE);
-			int sbWidth = (pStyle & WS_VSCROLL) ? GetSystemMetricsForDpi(SM_CXVSCROLL, dpiVal) : 0;
-			int sbHeight = (pStyle & WS_HSCROLL) ? GetSystemMetricsForDpi(SM_CYHSCROLL, dpiVal) : 0;
-
-			int sSize = Scale(m_parentNode, SPLITTER_SIZE);
-
-			if (sd->isVert) {
-				int layoutWidth = (m_lastRect.right - m_lastRect.left) - sbWidth;
-				int totalRightMinWidth = 0;
-				for (int i = sd->index + 1; i < m_cCount; ++i) {
-					int minPx = (m_cols[i].min.unit == SizeUnit::Percent) ? (int)(layoutWidth * m_cols[i].min.value / 100.0f) : Scale(m_parentNode, (int)m_cols[i].min.value);
-					totalRightMinWidth += minPx;
-					if (m_cols[i].splitter) totalRightMinWidth += sSize;
-				}
-
-				int minCurrentWidth = (m_cols[sd->index].min.unit == SizeUnit::Percent) ? (int)(layoutWidth * m_cols[sd->index].min.value / 100.0f) : Scale(m_parentNode, (int)m_cols[sd->index].min.value);
-				int newWidth = pt.x - m_cols[sd->index].pos;
-				newWidth = (std::max)(newWidth, minCurrentWidth);
-				newWidth = (std::min)(newWidth, (layoutWidth - totalRightMinWidth) - m_cols[sd->index].pos);
-				m_cols[sd->index].size = WidgetSize::Fixed(newWidth / dpi);
-			}
-			else {
-				int layoutHeight = (m_lastRect.bottom - m_lastRect.top) - sbHeight;
-				int totalBottomMinHeight = 0;
-				for (int i = sd->index + 1; i < m_rCount; ++i) {
-					int minPx = (m_rows[i].min.unit == SizeUnit::Percent) ? (int)(layoutHeight * m_rows[i].min.value / 100.0f) : Scale(m_parentNode, (int)m_rows[i].min.value);
-					totalBottomMinHeight += minPx;
-					if (m_rows[i].splitter) totalBottomMinHeight += sSize;
-				}
 
-				int minCurrentHeight = (m_rows[sd->index].min.unit == SizeUnit::Percent) ? (int)(layoutHeight * m_rows[sd->index].min.value / 100.0f) : Scale(m_parentNode, (int)m_rows[sd->index].min.value);
-				int newHeight = pt.y - m_rows[sd->index].pos;
-				newHeight = (std::max)(newHeight, minCurrentHeight);
-				newHeight = (std::min)(newHeight, (layoutHeight - totalBottomMinHeight) - m_rows[sd->index].pos);
-				m_rows[sd->index].size = WidgetSize::Fixed(newHeight / dpi);
-			}
+			// The solver keeps the track within its minimum and the room the tracks after it need.
+			// Dragging a collapsed column open restores it.
+			DimPlan& d = sd->isVert ? m_cols[sd->index] : m_rows[sd->index];
+			float size = sd->isVert ? m_grid.DragCol(sd->index, pt.x) : m_grid.DragRow(sd->index, pt.y);
+			d.size = WidgetSize::Fixed(size);
+			d.isCollapsed = false;
+			TracksChanged();
 			Arrange(m_lastRect.left, m_lastRect.top, m_lastRect.right - m_lastRect.left, m_lastRect.bottom - m_lastRect.top);
 		}
 
 		void __stdcall Arrange(int x, int y, int w, int h) override {
 			m_lastRect = { x, y, x + w, y + h };
-
-			auto solve = [&](std::vector<DimPlan>& dims, int total, int offset) {
-				int avail = total; float fillWeights = 0; int sSize = Scale(m_parentNode, SPLITTER_SIZE);
-				for (auto& d : dims) {
-					if (d.splitter) avail -= sSize;
-					int minPx = (d.min.unit == SizeUnit::Percent) ? (int)(total * d.min.value / 100.0f) : Scale(m_parentNode, (int)d.min.value);
-					if (d.size.unit == SizeUnit::Pixels) d.actual = (std::max)(Scale(m_parentNode, (int)d.size.value), minPx);
-					else if (d.size.unit == SizeUnit::System) d.actual = GetSystemMetricsForDpi(SM_CYCAPTION, GetDpiForWindow(m_parentNode));
-					else if (d.size.unit == SizeUnit::Percent) d.actual = (std::max)((int)(total * d.size.value / 100.0f), minPx);
-					else { d.actual = 0; fillWeights += d.size.value; continue; }
-					avail -= d.actual;
-				}
-				if (fillWeights > 0) {
-					for (auto& d : dims) if (d.size.unit == SizeUnit::Fill) {
-						int minPx = (d.min.unit == SizeUnit::Percent) ? (int)(total * d.min.value / 100.0f) : Scale(m_parentNode, (int)d.min.value);
-						d.actual = (std::max)((avail > 0) ? (int)(avail * d.size.value / fillWeights) : 0, minPx);
-					}
-				}
-				int cur = offset; for (auto& d : dims) { d.pos = cur; cur += d.actual + (d.splitter ? sSize : 0); }
-			};
-
-			solve(m_rows, h, y);
-			solve(m_cols, w, x);
-
-			if (m_rCount > 0) {
+			ClearLayoutDirty();
+
+			// 1. Solve, or replay a pass that had this box and the same tracks; either way the
+			// grid reports which rectangles moved since the last pass. The tracks are synced
+			// (and auto cells measured) only when the layout was marked dirty since.
+			uint64_t generation = LayoutGeneration();
+			if (generation != m_syncedGeneration || GetDpiForWindow(m_parentNode) != (UINT)m_grid.dpi) {
+				SyncGrid();
+				m_syncedGeneration = generation;
+			}
+			m_grid.Solve(x, y, w, h, m_grid.Signature());
+			const std::vector<uint32_t>& changed = m_grid.Changed();
+			if (changed.empty()) {
+				LayoutDirtyCells();
+				return;
+			}
+
+			// 2. The main window's caption hit-test follows the title row
+			if (m_rCount > 0 && m_grid.RowSpans()[0].size != m_titleRowHeight) {
+				m_titleRowHeight = m_grid.RowSpans()[0].size;
 				WCHAR cn[64];
 				GetClassNameW(m_parentNode, cn, 64);
 				if (wcscmp(cn, L"ChronoMain") == 0) {
-					SetPropW(m_parentNode, kPropTitleRowHeight, (HANDLE)(INT_PTR)m_rows[0].actual);
+					SetPropW(m_parentNode, kPropTitleRowHeight, (HANDLE)(INT_PTR)m_titleRowHeight);
 				}
 			}
 
-			HDWP hdwp = BeginDeferWindowPos(m_rCount * m_cCount + m_rCount + m_cCount);
-
-			for (int r = 0; r < m_rCount; ++r) {
-				for (int c = 0; c < m_cCount; ++c) {
-					CellImpl* cell = m_cells[r * m_cCount + c];
-					int cx = m_cols[c].pos, cy = m_rows[r].pos, cw = m_cols[c].actual, ch = m_rows[r].actual;
-					
-					hdwp = DeferWindowPos(hdwp, cell->m_hwnd, NULL, cx, cy, cw, ch, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
+			// 3. Move only the cells and splitter bars whose rectangle changed (before the first
+			// GetCell the grid still counts one empty slot per row and column)
+			const std::vector<Layout::Rect>& rects = m_grid.Rects();
+			size_t cellCount = m_grid.ItemCount();
+			HDWP hdwp = BeginDeferWindowPos((int)changed.size());
+			for (uint32_t index : changed) {
+				const Layout::Rect& r = rects[index];
+				if (index < cellCount) {
+					if (index < m_areaCells.size()) {
+						hdwp = DeferWindowPos(hdwp, m_areaCells[index]->m_hwnd, NULL, r.x, r.y, r.w, r.h, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
+					}
+					continue;
 				}
-			}
-
-			int sSize = Scale(m_parentNode, SPLITTER_SIZE);
-
-			for (int c = 0; c < m_cCount; ++c) {
-				if (m_cols[c].splitter && m_cols[c].sd && m_cols[c].sd->hwnd) {
-					int sx = m_cols[c].pos + m_cols[c].actual;
-					hdwp = DeferWindowPos(hdwp, m_cols[c].sd->hwnd, HWND_TOP,
-						sx, y, sSize, h,
-						SWP_NOACTIVATE | SWP_NOCOPYBITS);
+				const DimPlan& d = (index < cellCount + m_cCount) ? m_cols[index - cellCount] : m_rows[index - cellCount - m_cCount];
+				if (d.splitter && d.sd && d.sd->hwnd) {
+					hdwp = DeferWindowPos(hdwp, d.sd->hwnd, HWND_TOP, r.x, r.y, r.w, r.h, SWP_NOACTIVATE | SWP_NOCOPYBITS);
 				}
 			}
+			EndDeferWindowPos(hdwp);
 
-			for (int r = 0; r < m_rCount; ++r) {
-				if (m_rows[r].splitter && m_rows[r].sd && m_rows[r].sd->hwnd) {
-					int sy = m_rows[r].pos + m_rows[r].actual;
-					hdwp = DeferWindowPos(hdwp, m_rows[r].sd->hwnd, HWND_TOP,
-						x, sy, w, sSize,
-						SWP_NOACTIVATE | SWP_NOCOPYBITS);
-				}
-			}
+			// 4. Moved windows repaint themselves (SWP_NOCOPYBITS); the parent only redraws what
+			// they uncovered. Nothing is painted synchronously, so drag steps coalesce.
+			RECT box = { x, y, x + w, y + h };
+			RedrawWindow(m_parentNode, &box, NULL, RDW_INVALIDATE | RDW_ERASE);
 
-			EndDeferWindowPos(hdwp);
-			RedrawWindow(m_parentNode, NULL, NULL, RDW_INVALIDATE | RDW_UPDATENOW | RDW_ALLCHILDREN | RDW_ERASE);
+			// 5. Resized cells ran their pass on WM_SIZE; auto-sized ones whose content changed
+			// may not have moved
+			LayoutDirtyCells();
 		}
 
-		int GetRowHeight(int index) { return (index >= 0 && index < (int)m_rows.size()) ? m_rows[index].actual : 0; }
+		int GetRowHeight(int index) { return (index >= 0 && index < (int)m_grid.RowSpans().size()) ? m_grid.RowSpans()[index].size : 0; }
 
 		void __stdcall CollapseColumn(int index) override {
 			// Validation
 			if (index < 0 || index >= m_cCount) return;
 
 			DimPlan& col = m_cols[index];
-
-			// If already collapsed, do nothing to prevent overwriting savedSize with the min size
 			if (col.isCollapsed) return;
 
-			// 1. Save the current requested size
-			col.savedSize = col.size;
-
-			// 2. Set the current size to the minimum defined size
-			// The Arrange function uses 'col.size' to calculate 'col.actual', 
-			// effectively forcing the column to be exactly its minimum width.
-			col.size = col.min;
-
-			// 3. Update state
+			// The solver sizes a collapsed track to its minimum; the requested size is kept
 			col.isCollapsed = true;
-
-			// 4. Force a re-layout immediately
-			RefreshLayout();
+			TracksChanged();
 		}
 
 		void __stdcall RestoreColumn(int index) override {
@@ -778,18 +1010,10 @@ namespace ChronoUI {
 			if (index < 0 || index >= m_cCount) return;
 
 			DimPlan& col = m_cols[index];
-
-			// If not collapsed, nothing to restore
 			if (!col.isCollapsed) return;
 
-			// 1. Restore the original requested size
-			col.size = col.savedSize;
-
-			// 2. Update state
 			col.isCollapsed = false;
-
-			// 3. Force a re-layout immediately
-			RefreshLayout();
+			TracksChanged();
 		}
 
 		bool __stdcall IsColumnCollapsed(int index) override {
@@ -797,13 +1021,72 @@ namespace ChronoUI {
 			return m_cols[index].isCollapsed;
 		}
 
+		void __stdcall GetLayoutCacheStats(uint64_t* hits, uint64_t* misses) override {
+			*hits = m_grid.CacheHits();
+			*misses = m_grid.CacheMisses();
+			for (CellImpl* cell : m_areaCells) {
+				uint64_t h = 0, m = 0;
+				cell->GetLayoutCacheStats(&h, &m);
+				*hits += h;
+				*misses += m;
+			}
+		}
+
+		protected:
+			// The minimum follows the tracks, and a scrolling cell sizes its content to it
+			virtual bool SizesToContent() override { return true; }
+
+			// Only without a parent: otherwise the parent's pass arranges the layout
+			virtual void PerformLayout() override { RefreshLayout(); }
+
 		private:
+			// Empty slots have no cell and no window until something asks for one
+			CellImpl* AddCell(const Layout::Area& area) {
+				CellImpl* cell = new CellImpl(GetParentContainer());
+				cell->Create(m_parentNode);
+				cell->SetParentNode((ContextNodeImpl*)this);
+				StyleManager::Restyle((ICell*)cell);
+				m_areaCells.push_back(cell);
+				m_grid.areas.push_back(area);
+				Cover(area, cell);
+				TracksChanged();
+				return cell;
+			}
+
+			void Cover(const Layout::Area& area, CellImpl* cell) {
+				for (int r = area.row; r < area.row + area.rowSpan; ++r) {
+					for (int c = area.col; c < area.col + area.colSpan; ++c) m_cells[r * m_cCount + c] = cell;
+				}
+			}
+
+			void LayoutDirtyCells() {
+				if (!m_autoTracks) return;
+				for (CellImpl* cell : m_areaCells) cell->LayoutIfDirty();
+			}
+
+			void SetTracks(const char* tracks, bool rows) {
+				if (!tracks) return;
+				const char* p = tracks;
+				WidgetSize size, min;
+				for (int i = 0; i < (rows ? m_rCount : m_cCount) && ParseTrack(p, &size, &min); ++i) {
+					if (rows) SetRow(i, size, m_rows[i].splitter, min);
+					else SetCol(i, size, m_cols[i].splitter, min);
+				}
+			}
+
 			// Helper to trigger Arrange using the last known coordinates
 			void RefreshLayout() {
 				Arrange(m_lastRect.left, m_lastRect.top,
 					m_lastRect.right - m_lastRect.left,
 					m_lastRect.bottom - m_lastRect.top);
 			}
+
+			// Rows or columns changed: the minimum is stale and whoever places the layout runs
+			// again in the next pass
+			void TracksChanged() {
+				m_minStale = true;
+				InvalidateLayout(true);
+			}
 	};
 
 	// --- Container ---
@@ -827,13 +1110,64 @@ namespace ChronoUI {
 
 		IWidget* m_overlay = nullptr;
 
+		// What the @media rules of this window see: client size in logical pixels and DPI
+		MediaFeatures m_media = { 0.0f, 0.0f, 1.0f };
+
+		// Called on every WM_SIZE: cheap unless a media query flips (see StyleManager::UpdateMedia)
+		void RefreshMedia() {
+			RECT r;
+			GetClientRect(m_hwnd, &r);
+			MediaFeatures after;
+			after.dppx = (float)GetDpiForWindow(m_hwnd) / 96.0f;
+			if (after.dppx <= 0.0f) after.dppx = 1.0f;
+			after.width = (float)r.right / after.dppx;
+			after.height = (float)r.bottom / after.dppx;
+			if (after.width == m_media.width && after.height == m_media.height && after.dppx == m_media.dppx) return;
+
+			MediaFeatures before = m_media;
+			m_media = after;
+			StyleManager::UpdateMedia(static_cast<IContainer*>(this), before, after);
+		}
+
+	protected:
+		// Dirty layout roots below this window wait for one pass, run before the next paint
+		virtual bool SchedulesLayout() override { return true; }
+		virtual void OnLayoutQueued() override { PostMessage(m_hwnd, WM_CHRONO_LAYOUT_DIRTY, 0, 0); }
+
+		virtual void PerformLayout() override {
+			ClearLayoutDirty();
+			if (!m_root) return;
+			RECT r;
+			GetClientRect(m_hwnd, &r);
+			m_root->Arrange(0, 0, r.right, r.bottom);
+		}
+
 	public:
+		virtual PropertyHandle StyleTypeKey() override {
+			static const PropertyHandle type = PropertyAtoms::Intern("Container");
+			return type;
+		}
+		virtual const MediaFeatures* GetMediaFeatures() override {
+			return &m_media;
+		}
+		virtual void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			if (m_root) out->push_back(static_cast<ILayout*>(m_root));
+			if (m_overlay) out->push_back(m_overlay);
+		}
+
 		// Forward IContextNode methods explicitly
 		virtual void __stdcall SetParentNode(IContextNode* parent) override { ContextNodeImpl::SetParentNode(parent); }
 		virtual IContextNode* __stdcall GetParentNode() override { return ContextNodeImpl::GetParentNode(); }
 		virtual IContextNode* __stdcall GetContextNode() override { return ContextNodeImpl::GetContextNode(); }
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
 		virtual IContainer* __stdcall SetProperty(const char* key, const char* value) override { ContextNodeImpl::SetProperty(key, value); return this; }
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override { return ContextNodeImpl::GetProperty(key, def); }
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override { return ContextNodeImpl::GetPropertyValue(key, out); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override { return ContextNodeImpl::GetStyleValue(prop, classid, subclass, stateMask, out); }
+		virtual IContainer* __stdcall SetProperty(PropertyHandle key, const char* value) override { ContextNodeImpl::SetProperty(key, value); return this; }
+		virtual void __stdcall BeginUpdate() override { ContextNodeImpl::BeginUpdate(); }
+		virtual void __stdcall EndUpdate() override { ContextNodeImpl::EndUpdate(); }
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override { return ContextNodeImpl::ResolveKey(key); }
 		virtual COLORREF GetColor(const char* key, COLORREF defaultColor = RGB(0, 0, 0)) override { return ContextNodeImpl::GetColor(key, defaultColor); }
 		virtual IContextNode* SetColor(const char* key, COLORREF color) override { return SetColor(key, color); };
 		virtual const char* GetStyle(const char* _prop, const char* _def, const char* _classid, const char* _subclass, bool selected, bool enabled, bool hovered, bool active) override { return ContextNodeImpl::GetStyle(_prop, _def, _classid, _subclass, selected, enabled, hovered, active); }
@@ -906,6 +1240,10 @@ namespace ChronoUI {
 				SetPropW(m_hwnd, kPropCustomTitleBar, (HANDLE)1);
 				SetWindowPos(m_hwnd, nullptr, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER);
 			}
+
+			// Type selectors ("Container { ... }") match nodes without a class change too; cells
+			// and layouts are matched the same way as they join the tree
+			StyleManager::Restyle((IContainer*)this);
 		}
 
 		virtual IWidget* __stdcall SetOverlay(IWidget* w) override {
@@ -1108,7 +1446,17 @@ namespace ChronoUI {
 				return HTCLIENT;
 			}
 
+			case WM_DPICHANGED:
+				// Same device pixels, different logical size and resolution
+				self->RefreshMedia();
+				break;
+
+			case WM_CHRONO_LAYOUT_DIRTY:
+				self->RunLayoutPass();
+				return 0;
+
 			case WM_SIZE:
+				self->RefreshMedia();
 				if (self->m_root) 
 					self->m_root->Arrange(0, 0, LOWORD(lp), HIWORD(lp));
 				if (self->m_overlay) {
@@ -1177,6 +1525,7 @@ namespace ChronoUI {
 			if (m_root) delete m_root;
 			m_root = new LayoutImpl(this, GetHWND(), r, c);
 			m_root->SetParentNode((ContextNodeImpl*)this);
+			StyleManager::Restyle((ILayout*)m_root);
 			return m_root;
 		}
 
@@ -1341,6 +1690,7 @@ namespace ChronoUI {
 		if (it != widgets.end()) {
 			ShowWindow(w->GetHWND(), SW_HIDE);
 			widgets.erase(it);
+			m_placed.clear();
 
 			IContainer* container = GetParentContainer();
 			if (container) {
@@ -1462,12 +1812,27 @@ namespace ChronoUI {
 		return this->nested;
 	}
 
+	void __stdcall CellImpl::GetLayoutCacheStats(uint64_t* hits, uint64_t* misses) {
+		*hits = m_flexCache.Hits();
+		*misses = m_flexCache.Misses();
+		if (nested) {
+			uint64_t h = 0, m = 0;
+			nested->GetLayoutCacheStats(&h, &m);
+			*hits += h;
+			*misses += m;
+		}
+	}
+
 	IWidget* __stdcall CellImpl::AddWidget(IWidget* w) {
 		if (!w) return nullptr;
 
 		w->Create(m_hwnd);
 		w->SetParentNode((ContextNodeImpl*)this);
 		widgets.push_back(w);
+		m_placed.clear();
+
+		// Descendant and child selectors can only match once the widget has ancestors
+		StyleManager::Restyle(w);
 
 		// Resolve the correct container dynamically rather than using a global variable
 		IContainer* container = GetParentContainer();
@@ -1482,6 +1847,7 @@ namespace ChronoUI {
 		auto it = std::find(widgets.begin(), widgets.end(), w);
 		if (it != widgets.end()) {
 			widgets.erase(it);
+			m_placed.clear();
 			IContainer* container = GetParentContainer();
 			if (container) {
 				container->UnregisterWidget(w);
@@ -1519,6 +1885,7 @@ namespace ChronoUI {
 			);
 		}
 		widgets.push_back(w);
+		m_placed.clear();
 		w->SetParentNode((ContextNodeImpl*)this);
 
 		// 5. Register with the NEW Container
@@ -1549,6 +1916,7 @@ namespace ChronoUI {
 			// Create a local copy to iterate safely
 			std::vector<IWidget*> toDestroy = widgets;
 			widgets.clear();
+			m_placed.clear();
 
 			for (auto* w : toDestroy) {
 				if (container) {
@@ -1573,12 +1941,10 @@ namespace ChronoUI {
 
 		auto* subLayout = new LayoutImpl(GetParentContainer(), m_hwnd, r, c);
 		subLayout->SetParentNode((ContextNodeImpl*)this);
+		StyleManager::Restyle((ILayout*)subLayout);
 		this->nested = subLayout;
 
-		for (int x = 0; x < c; x++)
-			for (int y = 0; y < r; y++)
-				subLayout->GetCell(y, x); // Pre-create cells
-
+		// Cells (and their windows) are created on their first GetCell
 		return subLayout;
 	}
 
@@ -1610,6 +1976,10 @@ namespace ChronoUI {
 			}
 		}
 
+		virtual void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			if (m_root) out->push_back(static_cast<ILayout*>(m_root));
+		}
+
 		// -------------------------------------------------------------------------
 		// RESOLUTION OF AMBIGUITY
 		// We must implement the IPanel -> IWidget -> IContextNode chain
@@ -1628,10 +1998,23 @@ namespace ChronoUI {
 		virtual IContextNode* __stdcall GetContextNode() override { return ContextNodeImpl::GetContextNode(); }
 		virtual const char* __stdcall GetProperty(const char* key, const char* def = "") override { return WidgetImpl::GetProperty(key, def); }
 
+		virtual const char* __stdcall GetProperty(PropertyHandle key, const char* def = "") override { return WidgetImpl::GetProperty(key, def); }
+		virtual bool __stdcall GetPropertyValue(PropertyHandle key, PropertyValue* out) override { return WidgetImpl::GetPropertyValue(key, out); }
+		virtual bool __stdcall GetStyleValue(PropertyHandle prop, PropertyHandle classid, PropertyHandle subclass, uint32_t stateMask, PropertyValue* out) override { return WidgetImpl::GetStyleValue(prop, classid, subclass, stateMask, out); }
+
+		// A panel hosts a layout: its style keys are inherited by everything inside it
+		virtual void OnStyleKeyChanged() override { ContextNodeImpl::OnStyleKeyChanged(); }
+		virtual PropertyHandle __stdcall ResolveKey(const char* key) override { return WidgetImpl::ResolveKey(key); }
+
 		// Explicit forwarding for SetProperty to return 'this' (as the interface expected by the caller)
 		virtual IWidget* __stdcall SetProperty(const char* key, const char* value) override {
 			return WidgetImpl::SetProperty(key, value);			
 		}
+		virtual IWidget* __stdcall SetProperty(PropertyHandle key, const char* value) override {
+			return WidgetImpl::SetProperty(key, value);
+		}
+		virtual void __stdcall BeginUpdate() override { WidgetImpl::BeginUpdate(); }
+		virtual void __stdcall EndUpdate() override { WidgetImpl::EndUpdate(); }
 
 		virtual IWidget* SetColor(const char* key, COLORREF color) override {
 			return WidgetImpl::SetColor(key, color);
@@ -1675,6 +2058,16 @@ namespace ChronoUI {
 			return WidgetImpl::RemoveOverlay(overlay);
 		}
 
+		virtual IWidget* __stdcall SetFloat(PropertyHandle key, float value) override { return WidgetImpl::SetFloat(key, value); }
+		virtual IWidget* __stdcall SetInt(PropertyHandle key, int32_t value) override { return WidgetImpl::SetInt(key, value); }
+		virtual IWidget* __stdcall SetDouble(PropertyHandle key, double value) override { return WidgetImpl::SetDouble(key, value); }
+		virtual IWidget* __stdcall SetFloatArray(PropertyHandle key, const float* values, size_t count) override {
+			return WidgetImpl::SetFloatArray(key, values, count);
+		}
+		virtual bool __stdcall Measure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+			return WidgetImpl::Measure(availableW, availableH, mode, desired);
+		}
+
 		virtual void OnChanged(void (*callback)(IWidget* target, void* context), void* context, void (*cleanup)(void*) = nullptr) override {
 			// Forwarding to WidgetImpl
 			WidgetImpl::OnChanged(callback, context, cleanup);
@@ -1728,20 +2121,39 @@ namespace ChronoUI {
 			if (m_root) delete m_root;
 			m_root = new LayoutImpl(GetParentContainer(), GetHWND(), r, c); // Attach layout to this widget's HWND
 			m_root->SetParentNode((ContextNodeImpl*)this);
+			StyleManager::Restyle((ILayout*)m_root);
 			return m_root;
 		}
 
 		virtual ILayout* __stdcall GetLayout() override {
 			return m_root;
 		}
+
+	protected:
+		virtual void PerformLayout() override {
+			ClearLayoutDirty();
+			if (!m_root || !GetHWND()) return;
+			RECT r;
+			GetClientRect(GetHWND(), &r);
+			m_root->Arrange(0, 0, r.right, r.bottom);
+		}
 	};
 
 	void __stdcall CellImpl::UpdateWidgets() 
 	{
 		if (!m_hwnd) return;
 
+		// This pass places every widget: the cell and the widgets that asked for it are clean.
+		// A widget change that went past the cell (auto tracks) still re-reads the children.
+		if (IsLayoutDirty()) measurementsDirty = true;
+		ClearLayoutDirty();
+		for (IWidget* w : widgets) {
+			if (ContextNodeImpl* impl = dynamic_cast<ContextNodeImpl*>(w)) impl->ClearLayoutDirty();
+		}
+
 		RECT r;
 		GetClientRect(m_hwnd, &r);
+		PrepareLengths();
 
 		// --- NESTED LAYOUT FIX START ---
 		if (nested) {
@@ -1780,140 +2192,6 @@ namespace ChronoUI {
 			return;
 		}
 
-		// CommandBar mode implementation
-		if (m_mode == StackMode::CommandBar) {
-			const char* propOverflow = GetProperty("overflow");
-			std::string soverflow = propOverflow ? propOverflow : "true";
-			bool allowOverflow = (soverflow != "false");
-
-			const char* propAlign = GetProperty("align-items");
-			std::string align = propAlign ? propAlign : "normal";
-
-			const char* propJustify = GetProperty("justify-content");
-			std::string justify = propJustify ? propJustify : "start";
-
-			int parentHeight = r.bottom;
-			int parentWidth = r.right;
-
-			std::vector<IWidget*> visibleWidgets;
-			std::vector<IWidget*> overflowWidgets;
-
-			MeasureCommandBarWidgets(parentWidth, visibleWidgets, overflowWidgets, allowOverflow);
-
-			bool needsOverflow = !overflowWidgets.empty();
-
-			if (needsOverflow) {
-				if (!overflowButton) overflowButton = CreateOverflowButton();
-			}
-			else {
-				if (overflowButton) {
-					overflowButton->Destroy();
-					overflowButton = nullptr;
-				}
-			}
-
-			overflowItems = overflowWidgets;
-
-			int totalUsedWidth = 0;
-			int spacing = Scale(m_hwnd, 1);
-			int autoWidgetCount = 0;
-
-			std::vector<int> cachedWidths;
-			cachedWidths.reserve(visibleWidgets.size());
-			std::vector<bool> isAutoWidth;
-			isAutoWidth.reserve(visibleWidgets.size());
-
-			for (auto* w : visibleWidgets) {
-				const char* wWidthStr = w->GetProperty("width");
-				bool isAuto = (wWidthStr && strcmp(wWidthStr, "auto") == 0);
-				int finalW = 0;
-
-				if (isAuto) {
-					finalW = 0;
-					autoWidgetCount++;
-					isAutoWidth.push_back(true);
-				}
-				else {
-					int reqW = ParseCssDimension(wWidthStr, parentWidth);
-					finalW = (reqW >= 0) ? reqW : Scale(m_hwnd, 80);
-					totalUsedWidth += finalW;
-					isAutoWidth.push_back(false);
-				}
-				cachedWidths.push_back(finalW);
-			}
-
-			if (!visibleWidgets.empty()) {
-				totalUsedWidth += (int)(visibleWidgets.size() - 1) * spacing;
-			}
-
-			int btnWidth = 0;
-			if (overflowButton) {
-				btnWidth = Scale(m_hwnd, 40) / 2;
-				totalUsedWidth += spacing + btnWidth;
-			}
-
-			int remainingSpace = parentWidth - totalUsedWidth;
-
-			if (autoWidgetCount > 0 && remainingSpace > 0) {
-				int widthPerAuto = remainingSpace / autoWidgetCount;
-				int remainderPixels = remainingSpace % autoWidgetCount;
-				for (size_t i = 0; i < cachedWidths.size(); ++i) {
-					if (isAutoWidth[i]) {
-						int extra = (remainderPixels > 0) ? 1 : 0;
-						cachedWidths[i] = widthPerAuto + extra;
-						if (remainderPixels > 0) remainderPixels--;
-						totalUsedWidth += cachedWidths[i];
-					}
-				}
-			}
-
-			int x = 0;
-			if (justify == "center") x = (parentWidth - totalUsedWidth) / 2;
-			else if (justify == "end" || justify == "right") x = parentWidth - totalUsedWidth;
-			else x = Scale(m_hwnd, 1);
-			if (x < 0) x = 0;
-
-			HDWP hdwp = BeginDeferWindowPos((int)visibleWidgets.size() + (overflowButton ? 1 : 0));
-
-			for (size_t i = 0; i < visibleWidgets.size(); ++i) {
-				IWidget* w = visibleWidgets[i];
-				int wW = cachedWidths[i];
-				int reqH = ParseCssDimension(w->GetProperty("height"), parentHeight);
-				int wH = 0;
-				if (reqH >= 0) wH = reqH;
-				else if (align == "stretch" || align == "normal") wH = parentHeight;
-				else wH = Scale(m_hwnd, 32);
-
-				int wY = 0;
-				if (align == "center") wY = (parentHeight - wH) / 2;
-				else if (align == "end") wY = parentHeight - wH;
-				else wY = 0;
-
-				w->SetBounds(x, wY, wW, wH);
-				ShowWindow(w->GetHWND(), SW_SHOW);
-				hdwp = DeferWindowPos(hdwp, w->GetHWND(), NULL, x, wY, wW, wH - 2, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
-				x += wW + spacing;
-			}
-
-			if (overflowButton) {
-				int btnH = 0;
-				if (align == "stretch" || align == "normal") btnH = parentHeight;
-				else btnH = Scale(m_hwnd, 32);
-				int btnY = 0;
-				if (align == "center") btnY = (parentHeight - btnH) / 2;
-				else if (align == "end") btnY = parentHeight - btnH;
-				else btnY = 0;
-
-				overflowButton->SetBounds(x, btnY, btnWidth, btnH);
-				ShowWindow(overflowButton->GetHWND(), SW_SHOW);
-				hdwp = DeferWindowPos(hdwp, overflowButton->GetHWND(), NULL, x, btnY, btnWidth, btnH, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
-			}
-
-			for (auto* w : overflowWidgets) ShowWindow(w->GetHWND(), SW_HIDE);
-			EndDeferWindowPos(hdwp);
-			return;
-		}
-
 		if (m_mode == StackMode::Tabbed) {
 			for (int i = 0; i < (int)widgets.size(); ++i) {
 				if (i == m_activeTab) {
@@ -1925,97 +2203,360 @@ namespace ChronoUI {
 				}
 			}
 		}
-		else if (widgets.size() == 1 && !scrollEnabled) {
+		else if (widgets.size() == 1 && !scrollEnabled && m_mode != StackMode::CommandBar) {
 			int parentW = r.right;
 			int parentH = r.bottom;
 			int childW = parentW;
 			int childH = parentH;
 
-			const char* propWidth = widgets[0]->GetProperty("width");
-			const char* propHeight = widgets[0]->GetProperty("height");
 			const char* propAlign = widgets[0]->GetProperty("align-items");
 			std::string align = propAlign ? propAlign : "normal";
 
-			if (propWidth) {
-				int reqW = ParseCssDimension(propWidth, parentW);
-				if (reqW >= 0) childW = reqW;
-			}
-			if (propHeight) {
-				int reqH = ParseCssDimension(propHeight, parentH);
-				if (reqH >= 0) childH = reqH;
-			}
+			int reqW = ResolveDimension(widgets[0], kWidthKey, parentW);
+			if (reqW >= 0) childW = reqW;
+			int reqH = ResolveDimension(widgets[0], kHeightKey, parentH);
+			if (reqH >= 0) childH = reqH;
 
 			int x = 0, y = 0;
 			if (align == "center") x = (parentW - childW) / 2;
 			else if (align == "end") x = parentW - childW;
 			else if (align == "start") x = 0;
 			else if (align == "stretch" || align == "normal") {
-				if (!propWidth) { childW = parentW; x = 0; }
+				if (reqW < 0) { childW = parentW; x = 0; }
 				else x = 0;
 			}
 			ShowWindow(widgets[0]->GetHWND(), SW_SHOW);
-			widgets[0]->SetBounds(x, y, childW, childH);
+			if (Place(0, widgets[0], x, y, childW, childH)) widgets[0]->SetBounds(x, y, childW, childH);
 		}
 		else {
-			bool isHoriz = (m_mode == StackMode::Horizontal);
-			const char* propAlign = GetProperty("align-items");
-			std::string align = propAlign ? propAlign : "normal";
-			if (align == "") align = "normal";
-
-			HDWP hdwp = BeginDeferWindowPos((int)widgets.size());
-			int cur = -scrollPos, total = 0;
-
-			for (auto* w : widgets) {
-				int reqW = ParseCssDimension(w->GetProperty("width"), r.right);
-				int reqH = ParseCssDimension(w->GetProperty("height"), r.bottom);
-				int ww = 0, wh = 0;
+			LayoutFlex(r);
+		}
+	}
 
-				if (isHoriz) {
-					ww = (reqW >= 0) ? reqW : Scale(m_hwnd, 80);
-					if (reqH >= 0) wh = reqH;
-					else if (align == "stretch" || align == "normal") wh = r.bottom;
-					else wh = Scale(m_hwnd, 45);
-				}
-				else {
-					wh = (reqH >= 0) ? reqH : Scale(m_hwnd, 45);
-					if (reqW >= 0) ww = reqW;
-					else if (align == "stretch" || align == "normal") ww = r.right;
-					else ww = Scale(m_hwnd, 80);
+	void CellImpl::ReadFlex() {
+		static const PropertyHandle kFlex = PropertyAtoms::Intern("flex");
+		static const PropertyHandle kFlexGrow = PropertyAtoms::Intern("flex-grow");
+		static const PropertyHandle kFlexShrink = PropertyAtoms::Intern("flex-shrink");
+		static const PropertyHandle kFlexBasis = PropertyAtoms::Intern("flex-basis");
+		static const PropertyHandle kFlexWrap = PropertyAtoms::Intern("flex-wrap");
+		static const PropertyHandle kOrder = PropertyAtoms::Intern("order");
+		static const PropertyHandle kAlignSelf = PropertyAtoms::Intern("align-self");
+		static const PropertyHandle kAlignItems = PropertyAtoms::Intern("align-items");
+		static const PropertyHandle kAlignContent = PropertyAtoms::Intern("align-content");
+		static const PropertyHandle kJustify = PropertyAtoms::Intern("justify-content");
+		static const PropertyHandle kOverflow = PropertyAtoms::Intern("overflow");
+		static const PropertyHandle kGap = PropertyAtoms::Intern("gap");
+		static const PropertyHandle kRowGap = PropertyAtoms::Intern("row-gap");
+		static const PropertyHandle kColumnGap = PropertyAtoms::Intern("column-gap");
+		static const PropertyHandle kMinWidth = PropertyAtoms::Intern("min-width");
+		static const PropertyHandle kMaxWidth = PropertyAtoms::Intern("max-width");
+		static const PropertyHandle kMinHeight = PropertyAtoms::Intern("min-height");
+		static const PropertyHandle kMaxHeight = PropertyAtoms::Intern("max-height");
+
+		// A length property, Empty when unset, "auto" or not a length
+		auto readLength = [](IContextNode* node, PropertyHandle key, PropertyValue* out, bool* isAuto = nullptr) {
+			*out = {};
+			PropertyValue v;
+			if (!node->GetPropertyValue(key, &v)) return;
+			if (v.type == PropertyType::String) {
+				if (isAuto && v.text && strcmp(v.text, "auto") == 0) *isAuto = true;
+				return;
+			}
+			*out = v;
+		};
+
+		// Expressions are counted in, they may use vw / vh
+		auto UsesViewport = [](const PropertyValue& v) {
+			return v.type == PropertyType::Length && (v.unit == LengthUnit::Vw || v.unit == LengthUnit::Vh || v.unit == LengthUnit::Expression);
+		};
+		bool usesViewport = false;
+
+		// 1. Children
+		m_flexChildren.resize(widgets.size());
+		for (size_t i = 0; i < widgets.size(); ++i) {
+			IWidget* w = widgets[i];
+			FlexChild& c = m_flexChildren[i];
+			c = FlexChild();
+			readLength(w, kWidthKey, &c.width, &c.autoWidth);
+			readLength(w, kHeightKey, &c.height, &c.autoHeight);
+			readLength(w, kMinWidth, &c.minWidth);
+			readLength(w, kMaxWidth, &c.maxWidth);
+			readLength(w, kMinHeight, &c.minHeight);
+			readLength(w, kMaxHeight, &c.maxHeight);
+
+			// flex: none | auto | <grow> [<shrink>] [<basis>]; the longhands below win
+			PropertyValue v;
+			if (w->GetPropertyValue(kFlex, &v) && v.text) {
+				if (strcmp(v.text, "none") == 0) {
+					c.growSet = true;
+					c.shrink = 0.0f;
 				}
-
-				int wx = isHoriz ? cur : 0;
-				int wy = isHoriz ? 0 : cur;
-
-				if (isHoriz) {
-					if (align == "center") wy = (r.bottom - wh) / 2;
-					else if (align == "end") wy = r.bottom - wh;
-					else wy = 0;
+				else if (strcmp(v.text, "auto") == 0) {
+					c.growSet = true;
+					c.grow = 1.0f;
 				}
-				else {
-					if (align == "center") wx = (r.right - ww) / 2;
-					else if (align == "end") wx = r.right - ww;
-					else wx = 0;
+				else if (v.hasNumber) {
+					char* end = nullptr;
+					c.grow = (std::max)(0.0f, strtof(v.text, &end));
+					c.growSet = true;
+					c.basis = PropertyValue::Parse("0");
+					const char* next = end;
+					float shrink = strtof(next, &end);
+					if (end != next) {
+						c.shrink = (std::max)(0.0f, shrink);
+						next = end;
+					}
+					while (*next == ' ') ++next;
+					if (*next) {
+						// Parsed from the property text, which outlives the cached value
+						PropertyValue basis = PropertyValue::Parse(next);
+						if (basis.type == PropertyType::Length || basis.type == PropertyType::Int || basis.type == PropertyType::Float) c.basis = basis;
+						else if (strcmp(next, "auto") == 0) c.basis = {};
+					}
 				}
+			}
+			if (w->GetPropertyValue(kFlexGrow, &v) && v.hasNumber) {
+				c.grow = (std::max)(0.0f, v.number);
+				c.growSet = true;
+			}
+			if (w->GetPropertyValue(kFlexShrink, &v) && v.hasNumber) c.shrink = (std::max)(0.0f, v.number);
+			if (w->GetPropertyValue(kFlexBasis, &v)) readLength(w, kFlexBasis, &c.basis);
+			if (w->GetPropertyValue(kOrder, &v) && v.hasInteger) c.order = v.integer;
+			if (w->GetPropertyValue(kAlignSelf, &v)) c.alignSelf = ParseAlign(v.text, Layout::Align::Auto);
 
-				w->SetBounds(wx, wy, ww, wh);
-				hdwp = DeferWindowPos(hdwp, w->GetHWND(), NULL, wx, wy, ww, wh, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
-				if (!IsWindowVisible(w->GetHWND())) ShowWindow(w->GetHWND(), SW_SHOW);
+			const PropertyValue* lengths[] = { &c.width, &c.height, &c.basis, &c.minWidth, &c.maxWidth, &c.minHeight, &c.maxHeight };
+			for (const PropertyValue* length : lengths) {
+				if (Lengths::UsesFont(*length)) {
+					c.fontSize = FontSizeOf(w, kFontSizeKey);
+					break;
+				}
+			}
+			for (const PropertyValue* length : lengths) usesViewport = usesViewport || UsesViewport(*length);
+		}
+
+		// 2. The cell: gap is both gaps, row-gap / column-gap override it
+		IContextNode* self = (ContextNodeImpl*)this;
+		FlexBox& box = m_flexBox;
+		box = FlexBox();
+		readLength(self, kGap, &box.rowGap);
+		box.columnGap = box.rowGap;
+		PropertyValue v;
+		if (GetPropertyValue(kRowGap, &v)) readLength(self, kRowGap, &box.rowGap);
+		if (GetPropertyValue(kColumnGap, &v)) readLength(self, kColumnGap, &box.columnGap);
+		if (Lengths::UsesFont(box.rowGap) || Lengths::UsesFont(box.columnGap)) box.fontSize = FontSizeOf(self, kFontSizeKey);
+		box.wrap = GetPropertyValue(kFlexWrap, &v) && v.text && strcmp(v.text, "wrap") == 0;
+		box.allowOverflow = !(GetPropertyValue(kOverflow, &v) && v.text && strcmp(v.text, "false") == 0);
+		if (GetPropertyValue(kJustify, &v)) box.justify = ParseJustify(v.text);
+		if (GetPropertyValue(kAlignItems, &v)) box.alignItems = ParseAlign(v.text, Layout::Align::Stretch);
+		if (GetPropertyValue(kAlignContent, &v)) box.alignContent = ParseAlign(v.text, Layout::Align::Stretch);
+		if (box.alignItems == Layout::Align::Auto) box.alignItems = Layout::Align::Stretch;
+		if (box.alignContent == Layout::Align::Auto) box.alignContent = Layout::Align::Stretch;
+		box.usesViewport = usesViewport || UsesViewport(box.rowGap) || UsesViewport(box.columnGap);
+
+		m_flexEpoch = StyleCache::Epoch();
+		++m_flexGeneration;
+		measurementsDirty = false;
+	}
 
-				int step = isHoriz ? ww : wh;
-				cur += step;
-				total += step;
+	// Vertical, Horizontal and CommandBar: one Layout::Flex pass over the cached children,
+	// replayed when the cell had this box before
+	void CellImpl::LayoutFlex(const RECT& r) {
+		bool commandBar = (m_mode == StackMode::CommandBar);
+		bool isRow = (m_mode != StackMode::Vertical);
+		bool scrolls = scrollEnabled && !commandBar;
+
+		// 1. Re-read the children only when something they depend on may have changed
+		if (measurementsDirty || m_flexEpoch != StyleCache::Epoch() || m_flexChildren.size() != widgets.size()) ReadFlex();
+
+		// 2. A box the cell already had at this generation replays that pass; otherwise solve.
+		//    Viewport lengths follow the window rather than the cell, so those cells always solve.
+		//    A scrolling stack is solved at its scroll offset.
+		int offset = scrolls ? -scrollPos : 0;
+		int originX = isRow ? offset : 0;
+		int originY = isRow ? 0 : offset;
+		if (m_lengths.dpiScale != m_flexCacheDpi) {
+			m_flexCache.Clear();
+			m_flexCacheDpi = m_lengths.dpiScale;
+		}
+		const FlexPass* pass = m_flexBox.usesViewport ? nullptr : m_flexCache.Find(originX, originY, r.right, r.bottom, m_flexGeneration);
+		if (!pass) {
+			FlexPass& kept = m_flexBox.usesViewport ? m_flexUncached : m_flexCache.Store(originX, originY, r.right, r.bottom, m_flexGeneration);
+			SolveFlex(r, originX, originY, &kept);
+			pass = &kept;
+		}
+
+		// 3. Command bar overflow: the "..." button (the last rectangle) exists while items are hidden
+		size_t count = widgets.size();
+		if (commandBar) {
+			overflowItems.clear();
+			for (size_t i = 0; i < count; ++i) {
+				if (pass->hidden[i]) overflowItems.push_back(widgets[i]);
 			}
-			EndDeferWindowPos(hdwp);
+			if (!overflowItems.empty()) {
+				if (!overflowButton) overflowButton = CreateOverflowButton();
+			}
+			else if (overflowButton) {
+				overflowButton->Destroy();
+				overflowButton = nullptr;
+			}
+		}
 
-			if (scrollEnabled) {
-				SCROLLINFO si = { sizeof(si), SIF_RANGE | SIF_PAGE | SIF_POS | SIF_DISABLENOSCROLL };
-				si.nMin = 0;
-				si.nMax = total - 1;
-				si.nPage = isHoriz ? r.right : r.bottom;
-				si.nPos = scrollPos;
-				SetScrollInfo(m_hwnd, isHoriz ? SB_HORZ : SB_VERT, &si, TRUE);
+		// 4. Move only the widgets whose rectangle changed
+		const std::vector<Layout::Rect>& rects = pass->rects;
+		HDWP hdwp = BeginDeferWindowPos((int)rects.size());
+		for (size_t i = 0; i < count; ++i) {
+			IWidget* w = widgets[i];
+			if (pass->hidden[i]) {
+				if (IsWindowVisible(w->GetHWND())) ShowWindow(w->GetHWND(), SW_HIDE);
+				continue;
+			}
+			const Layout::Rect& rc = rects[i];
+			if (Place(i, w, rc.x, rc.y, rc.w, rc.h)) {
+				w->SetBounds(rc.x, rc.y, rc.w, rc.h);
+				// Command bar buttons leave two pixel rows below them
+				hdwp = DeferWindowPos(hdwp, w->GetHWND(), NULL, rc.x, rc.y, rc.w, commandBar ? rc.h - 2 : rc.h, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
 			}
+			if (!IsWindowVisible(w->GetHWND())) ShowWindow(w->GetHWND(), SW_SHOW);
+		}
+		if (commandBar && overflowButton) {
+			const Layout::Rect& rc = rects[count];
+			overflowButton->SetBounds(rc.x, rc.y, rc.w, rc.h);
+			hdwp = DeferWindowPos(hdwp, overflowButton->GetHWND(), NULL, rc.x, rc.y, rc.w, rc.h, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS);
+			if (!IsWindowVisible(overflowButton->GetHWND())) ShowWindow(overflowButton->GetHWND(), SW_SHOW);
+		}
+		EndDeferWindowPos(hdwp);
+
+		if (scrolls) {
+			SCROLLINFO si = { sizeof(si), SIF_RANGE | SIF_PAGE | SIF_POS | SIF_DISABLENOSCROLL };
+			si.nMin = 0;
+			si.nMax = pass->extent - 1;
+			si.nPage = isRow ? r.right : r.bottom;
+			si.nPos = scrollPos;
+			SetScrollInfo(m_hwnd, isRow ? SB_HORZ : SB_VERT, &si, TRUE);
+		}
+	}
+
+	void CellImpl::SolveFlex(const RECT& r, int x, int y, FlexPass* out) {
+		bool commandBar = (m_mode == StackMode::CommandBar);
+		bool isRow = (m_mode != StackMode::Vertical);
+		bool scrolls = scrollEnabled && !commandBar;
+
+		// 1. Items. A set width / height is the content size; otherwise what the widget
+		//    measures (rows on one line, columns wrapped at the cell width), and the defaults
+		//    for widgets that do not measure themselves.
+		int mainRef = isRow ? r.right : r.bottom;
+		int defMain, defCross, autoMin;
+		FlexDefaults(&defMain, &defCross, &autoMin);
+		size_t count = widgets.size();
+		m_flex.items.resize(count + (commandBar ? 1 : 0));
+		for (size_t i = 0; i < count; ++i) {
+			const FlexChild& c = m_flexChildren[i];
+			Layout::FlexItem& item = m_flex.items[i];
+			item = Layout::FlexItem();
+			int w = ResolveLength(c.width, c.fontSize, r.right);
+			int h = ResolveLength(c.height, c.fontSize, r.bottom);
+			int main = isRow ? w : h;
+			int cross = isRow ? h : w;
+			SIZE measured = { 0, 0 };
+			bool known = (main < 0 || cross < 0) && MeasureChild(i, isRow ? -1 : r.right, -1, isRow ? MeasureMode::Unbounded : MeasureMode::AtMost, &measured);
+			int measuredMain = isRow ? measured.cx : measured.cy;
+			item.content = (main >= 0) ? main : (known ? measuredMain : defMain);
+			item.cross = cross;
+			item.crossContent = known ? (isRow ? measured.cy : measured.cx) : defCross;
+			item.grow = c.grow;
+			item.shrink = c.shrink;
+			if (isRow ? c.autoWidth : c.autoHeight) {
+				// "auto": a share of what the other items leave, no smaller than the content
+				item.basis = 0;
+				item.minMain = known ? measuredMain : autoMin;
+				if (!c.growSet) item.grow = 1.0f;
+			}
+			int basis = ResolveLength(c.basis, c.fontSize, mainRef);
+			if (basis >= 0) item.basis = basis;
+
+			int minMain = ResolveLength(isRow ? c.minWidth : c.minHeight, c.fontSize, mainRef);
+			if (minMain >= 0) item.minMain = minMain;
+			item.maxMain = ResolveLength(isRow ? c.maxWidth : c.maxHeight, c.fontSize, mainRef);
+			item.minCross = (std::max)(0, ResolveLength(isRow ? c.minHeight : c.minWidth, c.fontSize, isRow ? r.bottom : r.right));
+			item.maxCross = ResolveLength(isRow ? c.maxHeight : c.maxWidth, c.fontSize, isRow ? r.bottom : r.right);
+			item.alignSelf = c.alignSelf;
+			item.order = c.order;
+		}
+
+		// 2. The box; a command bar keeps a pixel between its buttons unless a gap is set
+		const FlexBox& box = m_flexBox;
+		int rowGap = ResolveLength(box.rowGap, box.fontSize, r.bottom);
+		int columnGap = ResolveLength(box.columnGap, box.fontSize, r.right);
+		int mainGap = isRow ? columnGap : rowGap;
+		int crossGap = isRow ? rowGap : columnGap;
+		m_flex.row = isRow;
+		m_flex.wrap = box.wrap && !commandBar && !scrolls;
+		m_flex.gap = (mainGap >= 0) ? mainGap : (commandBar ? Scale(m_hwnd, 1) : 0);
+		m_flex.crossGap = (std::max)(0, crossGap);
+		m_flex.justify = box.justify;
+		m_flex.alignItems = box.alignItems;
+		m_flex.alignContent = box.alignContent;
+
+		// 3. Command bar overflow: the last slot is the "..." button, after every widget and
+		//    shown only when something did not fit
+		if (commandBar) {
+			Layout::FlexItem& button = m_flex.items[count];
+			button = Layout::FlexItem();
+			button.basis = button.content = Scale(m_hwnd, 40) / 2;
+			button.shrink = 0.0f;
+			button.crossContent = defCross;
+			button.order = INT_MAX;
+			button.hidden = true;
+			size_t hidden = box.allowOverflow ? m_flex.Overflow(r.right, button.basis + m_flex.gap) : 0;
+			button.hidden = (hidden == 0);
+		}
+
+		// 4. Solve; a scrolling stack keeps its natural sizes
+		m_flex.Solve(x, y, r.right, r.bottom, scrolls);
+		out->rects = m_flex.Rects();
+		out->hidden.resize(m_flex.items.size());
+		for (size_t i = 0; i < m_flex.items.size(); ++i) out->hidden[i] = m_flex.items[i].hidden;
+		out->extent = m_flex.Extent();
+	}
+
+	void CellImpl::ContentSize(int* w, int* h) {
+		*w = *h = 0;
+		if (!m_hwnd) return;
+		if (nested) {
+			((LayoutImpl*)nested)->CalculateMinimumSize(*w, *h);
+			return;
 		}
+		if (widgets.empty()) return;
+
+		// The same inputs LayoutFlex reads; percentages have no box to resolve against
+		PrepareLengths();
+		if (measurementsDirty || IsLayoutDirty() || m_flexEpoch != StyleCache::Epoch() || m_flexChildren.size() != widgets.size()) ReadFlex();
+		bool isRow = (m_mode != StackMode::Vertical);
+		bool stacked = (m_mode != StackMode::Tabbed) && (widgets.size() > 1 || scrollEnabled || m_mode == StackMode::CommandBar);
+		int defMain, defCross, autoMin;
+		FlexDefaults(&defMain, &defCross, &autoMin);
+
+		int main = 0, cross = 0;
+		for (size_t i = 0; i < m_flexChildren.size(); ++i) {
+			const FlexChild& c = m_flexChildren[i];
+			int cw = ResolveLength(c.width, c.fontSize, 0);
+			int ch = ResolveLength(c.height, c.fontSize, 0);
+			SIZE measured = { 0, 0 };
+			bool known = (cw < 0 || ch < 0) && MeasureChild(i, -1, -1, MeasureMode::Unbounded, &measured);
+			int itemMain = isRow ? cw : ch;
+			if (itemMain < 0) itemMain = known ? (isRow ? measured.cx : measured.cy) : ((isRow ? c.autoWidth : c.autoHeight) ? autoMin : defMain);
+			int itemCross = isRow ? ch : cw;
+			if (itemCross < 0) itemCross = known ? (isRow ? measured.cy : measured.cx) : defCross;
+			main = stacked ? main + itemMain : (std::max)(main, itemMain);
+			cross = (std::max)(cross, itemCross);
+		}
+		if (stacked) {
+			int gap = ResolveLength(isRow ? m_flexBox.columnGap : m_flexBox.rowGap, m_flexBox.fontSize, 0);
+			if (gap < 0) gap = (m_mode == StackMode::CommandBar) ? Scale(m_hwnd, 1) : 0;
+			main += gap * (int)(m_flexChildren.size() - 1);
+		}
+		*w = isRow ? main : cross;
+		*h = isRow ? cross : main;
 	}
 
 	extern "C" {
@@ -19,10 +19,15 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 {
 	// 1. INITIALIZATION
 	// Load default styles and resources (adjust paths as necessary)
-	StyleManager::LoadCSSFile("..\\assets\\bootstrap_lite.css");
-
 	myVirtualDrive.Open(L"..\\assets\\resources.pak", nullptr);
 
+	// Prefer the precompiled sheet (ChronoCSSC output packed with the resources): no parsing at startup
+	std::vector<unsigned char> compiledStyles;
+	if (!myVirtualDrive.ReadFile(L"bootstrap_lite.ccss", compiledStyles) ||
+		!StyleManager::LoadCompiled(compiledStyles.data(), compiledStyles.size())) {
+		StyleManager::LoadCSSFile("..\\assets\\bootstrap_lite.css");
+	}
+
 	// 2. CREATE WINDOW
 	// Create the main application container (Window)
 	// Args: Parent, Title, Width, Height, Custom Title Bar (true/false)
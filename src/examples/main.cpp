@@ -423,6 +423,8 @@ int exampleEqualizer(HWND parent)
 				// Previously 100ms
 				vu->AddTimer("AudioSim", 100);
 
+				// Resolved once; the timer pushes floats without formatting strings
+				PropertyHandle keyValue = vu->ResolveKey("value");
 				vu->addEventHandler("AudioSim", [=](IWidget* sender, const char* json) {
 					static float time = 0.0f;
 					time += 0.05f; // Adjusted for smoothness
@@ -433,7 +435,7 @@ int exampleEqualizer(HWND parent)
 
 					if (rand() % 40 == 0) val1 = 1.0f; // Adjusted rand probability for faster timer
 
-					sender->SetProperty("value", std::to_string(val2).c_str());
+					sender->SetFloat(keyValue, val2);
 				});
 			}
 		}
@@ -447,6 +449,7 @@ int exampleEqualizer(HWND parent)
 
 		// Update the horizontal bar to be smooth as well
 		vuRight->AddTimer("AudioSim", 100);
+		PropertyHandle keyValue = vuRight->ResolveKey("value");
 		vuRight->addEventHandler("AudioSim", [=](IWidget* sender, const char* json) {
 			static float time = 0.0f;
 			time += 0.05f; // Adjusted for smoothness
@@ -457,7 +460,7 @@ int exampleEqualizer(HWND parent)
 
 			if (rand() % 40 == 0) val1 = 1.0f; // Adjusted rand probability for faster timer
 
-			sender->SetProperty("value", std::to_string(val2).c_str());
+			sender->SetFloat(keyValue, val2);
 		});
 	}
 
@@ -507,7 +510,7 @@ int exampleGauges(HWND parent)
 			->AddWidget(WidgetFactory::Create("cw.GaugeSpeedOmeter.dll"))
 			->AddTimer("UptSpeed", 1000)
 			->addEventHandler("UptSpeed", [&](IWidget* sender, const char* json) {
-			sender->SetProperty("value", std::to_string(rand() % 220).c_str());
+			sender->SetFloat(sender->ResolveKey("value"), (float)(rand() % 220));
 		});
 
 		gaugesLayout->GetCell(0, 2)
@@ -1217,12 +1220,9 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 				// 1. Get real CPU data
 				double usage = g_cpuMonitor.GetUsage();
 
-				// 2. Format to string
-				std::string valStr = std::to_string(usage);
-
-				// 3. Push to plot
-				// This triggers the "add_value" logic in OnPropertyChanged
-				sender->SetProperty("add_value", valStr.c_str());
+				// 2. Push to plot
+				// This triggers the "add_value" logic in OnValueChanged, no string round trip
+				sender->SetDouble(sender->ResolveKey("add_value"), usage);
 			});
 
 			sidebar->AddWidget(WidgetFactory::Create("cw.SliderControl.dll"))
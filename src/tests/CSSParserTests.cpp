@@ -0,0 +1,297 @@
+// CSSParserTests: the CSS tokenizer and parser (ChronoCSSParser) checked headless, on the
+// rules, declarations and errors they produce. Registered with CTest; a failed check prints
+// its line and the run exits 1.
+//   - Tokenizer: token kinds and spans, url() (plain, quoted and bad), strings cut by a
+//     newline or the end of the input, comments
+//   - Declarations: values trimmed, !important with and without space after the '!',
+//     url() values holding ';'
+//   - Recovery: a missing ':', an empty value, a stray '}', a selector without a block, an
+//     unterminated block, and a string cut by a newline or a bad url() voiding only its
+//     declaration; the rules after each still parse
+//   - At-rules: nested @media, an @media with an empty prelude, statement at-rules, and
+//     SplitList / LineOf
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "ChronoCSSParser.hpp"
+
+using namespace ChronoUI;
+using namespace ChronoUI::CSS;
+
+#define CHECK(expr) Check((expr), #expr, __LINE__)
+
+namespace {
+	int g_checks = 0, g_failures = 0;
+
+	void Check(bool ok, const char* what, int line) {
+		++g_checks;
+		if (ok) return;
+		++g_failures;
+		printf("  FAILED line %d: %s\n", line, what);
+	}
+
+	std::vector<Token> Tokens(std::string_view source) {
+		std::vector<Token> out;
+		Tokenizer tok(source);
+		for (Token t = tok.Next(); t.type != TokenType::EndOfFile; t = tok.Next()) {
+			if (t.type != TokenType::Whitespace) out.push_back(t);
+		}
+		return out;
+	}
+
+	bool HasError(const StyleSheet& sheet, const char* message) {
+		for (const ParseError& e : sheet.errors) {
+			if (strcmp(e.message, message) == 0) return true;
+		}
+		return false;
+	}
+
+	const Declaration* Find(const StyleSheet& sheet, const Rule& rule, std::string_view name) {
+		for (uint32_t i = 0; i < rule.declarationCount; ++i) {
+			const Declaration& d = sheet.declarations[rule.firstDeclaration + i];
+			if (d.name == name) return &d;
+		}
+		return nullptr;
+	}
+
+	// The first qualified rule with this prelude, or null
+	const Rule* FindRule(const StyleSheet& sheet, std::string_view prelude) {
+		for (const Rule& r : sheet.rules) {
+			if (r.atKeyword.empty() && r.prelude == prelude) return &r;
+		}
+		return nullptr;
+	}
+
+	// --- Tokenizer ---
+
+	void TokenKinds() {
+		std::vector<Token> t = Tokens(".btn:hover > #ok { width: 10px; height: 50%; z: 3 } /* note */");
+		CHECK(t.size() == 19);
+		CHECK(t[0].IsDelim('.'));
+		CHECK(t[1].type == TokenType::Ident && t[1].text == "btn");
+		CHECK(t[2].type == TokenType::Colon);
+		CHECK(t[4].IsDelim('>'));
+		CHECK(t[5].type == TokenType::Hash && t[5].text == "#ok");
+		CHECK(t[6].type == TokenType::LeftCurly);
+		CHECK(t[9].type == TokenType::Dimension && t[9].text == "10px");
+		CHECK(t[13].type == TokenType::Percentage && t[13].text == "50%");
+		CHECK(t[17].type == TokenType::Number && t[17].text == "3");
+		CHECK(t[18].type == TokenType::RightCurly);
+
+		// Spans point into the source
+		CHECK(t[5].offset == 13);
+	}
+
+	void TokenUrls() {
+		std::vector<Token> t = Tokens("url(img/a.png) url( spaced.png ) url(\"quoted.png\") url(a b)");
+		CHECK(t.size() == 6);
+		CHECK(t[0].type == TokenType::Url && t[0].text == "url(img/a.png)");
+		CHECK(t[1].type == TokenType::Url);
+		// A quoted url() is a function holding a string
+		CHECK(t[2].type == TokenType::Function && t[2].text == "url(");
+		CHECK(t[3].type == TokenType::String && t[3].text == "\"quoted.png\"");
+		CHECK(t[4].type == TokenType::RightParen);
+		CHECK(t[5].type == TokenType::BadUrl);
+	}
+
+	void TokenStrings() {
+		std::vector<Token> t = Tokens("'one' \"two\\\"s\" 'cut\nnext");
+		CHECK(t.size() == 4);
+		CHECK(t[0].type == TokenType::String && t[0].text == "'one'");
+		CHECK(t[1].type == TokenType::String && t[1].text == "\"two\\\"s\"");
+		// A newline ends the string as bad; what follows is tokenized again
+		CHECK(t[2].type == TokenType::BadString);
+		CHECK(t[3].type == TokenType::Ident && t[3].text == "next");
+
+		// The end of the input closes a string
+		t = Tokens("'open");
+		CHECK(t.size() == 1);
+		CHECK(t[0].type == TokenType::String);
+
+		// An unterminated comment runs to the end
+		t = Tokens("a /* no end");
+		CHECK(t.size() == 1);
+	}
+
+	// --- Declarations ---
+
+	void DeclarationValues() {
+		StyleSheet sheet;
+		Parser::Parse("a { color :  red  ; margin: 1px 2px; font-family: 'Segoe UI', sans-serif }", &sheet);
+		CHECK(sheet.errors.empty());
+		CHECK(sheet.rules.size() == 1);
+		const Rule& a = sheet.rules[0];
+		CHECK(a.prelude == "a" && a.hasBlock && a.parent == -1);
+		CHECK(a.declarationCount == 3);
+		CHECK(Find(sheet, a, "color") && Find(sheet, a, "color")->value == "red");
+		CHECK(Find(sheet, a, "margin") && Find(sheet, a, "margin")->value == "1px 2px");
+		CHECK(Find(sheet, a, "font-family") && Find(sheet, a, "font-family")->value == "'Segoe UI', sans-serif");
+		CHECK(!Find(sheet, a, "color")->important);
+	}
+
+	void DeclarationImportant() {
+		StyleSheet sheet;
+		Parser::Parse("a { x: 1 !important; y: 2 ! important; z: 3 !IMPORTANT; w: 4 !important /* c */; v: 5 } ", &sheet);
+		CHECK(sheet.errors.empty());
+		const Rule& a = sheet.rules[0];
+		CHECK(a.declarationCount == 5);
+		const Declaration* x = Find(sheet, a, "x");
+		const Declaration* y = Find(sheet, a, "y");
+		const Declaration* z = Find(sheet, a, "z");
+		const Declaration* w = Find(sheet, a, "w");
+		const Declaration* v = Find(sheet, a, "v");
+		CHECK(x && x->important && x->value == "1");
+		CHECK(y && y->important && y->value == "2");
+		CHECK(z && z->important && z->value == "3");
+		CHECK(w && w->important && w->value == "4");
+		CHECK(v && !v->important && v->value == "5");
+	}
+
+	void DeclarationUrl() {
+		StyleSheet sheet;
+		Parser::Parse("a { background: url(data:image/png;base64,AAA=) no-repeat; color: red }", &sheet);
+		CHECK(sheet.errors.empty());
+		const Rule& a = sheet.rules[0];
+		CHECK(a.declarationCount == 2);
+		// The ';' inside url() does not end the declaration
+		CHECK(Find(sheet, a, "background") && Find(sheet, a, "background")->value == "url(data:image/png;base64,AAA=) no-repeat");
+		CHECK(Find(sheet, a, "color") != nullptr);
+	}
+
+	// --- Recovery ---
+
+	void RecoverDeclarations() {
+		StyleSheet sheet;
+		Parser::Parse("a { color red; margin: 1; width: ; 12: x; height: 2 } b { x: 1 }", &sheet);
+		CHECK(HasError(sheet, "expected ':' after property name"));
+		CHECK(HasError(sheet, "declaration without a value"));
+		CHECK(HasError(sheet, "expected a declaration"));
+		const Rule* a = FindRule(sheet, "a");
+		CHECK(a && a->declarationCount == 2);
+		CHECK(a && Find(sheet, *a, "margin") && Find(sheet, *a, "height"));
+		const Rule* b = FindRule(sheet, "b");
+		CHECK(b && b->declarationCount == 1);
+	}
+
+	void RecoverStrayBrace() {
+		StyleSheet sheet;
+		Parser::Parse("} a { x: 1 } } b { y: 2 }", &sheet);
+		CHECK(HasError(sheet, "unexpected '}'"));
+		CHECK(sheet.errors.size() == 2);
+		CHECK(FindRule(sheet, "a") && FindRule(sheet, "b"));
+	}
+
+	void RecoverSelectorWithoutBlock() {
+		StyleSheet sheet;
+		Parser::Parse("a b c", &sheet);
+		CHECK(HasError(sheet, "selector without a block"));
+		CHECK(sheet.rules.empty());
+	}
+
+	void RecoverUnterminatedBlock() {
+		StyleSheet sheet;
+		Parser::Parse("a { x: 1 } b { y: 2", &sheet);
+		CHECK(HasError(sheet, "unterminated block"));
+		CHECK(FindRule(sheet, "a") && FindRule(sheet, "a")->declarationCount == 1);
+	}
+
+	void RecoverUnterminatedString() {
+		StyleSheet sheet;
+		Parser::Parse("a { content: 'open\n; color: red }\nb { x: 1 }", &sheet);
+		CHECK(sheet.errors.size() == 1);
+		CHECK(HasError(sheet, "bad string or url in a value"));
+		// The bad string spoils its declaration only
+		const Rule* a = FindRule(sheet, "a");
+		CHECK(a && !Find(sheet, *a, "content"));
+		CHECK(a && Find(sheet, *a, "color") && Find(sheet, *a, "color")->value == "red");
+		CHECK(FindRule(sheet, "b") != nullptr);
+		CHECK(!sheet.errors.empty() && Parser::LineOf("a { content: 'open\n; color: red }\nb { x: 1 }", sheet.errors[0].offset) == 1);
+
+		// So does a broken url()
+		StyleSheet url;
+		Parser::Parse("a { background: url(a b.png); color: red }", &url);
+		CHECK(HasError(url, "bad string or url in a value"));
+		CHECK(url.rules.size() == 1 && url.rules[0].declarationCount == 1);
+	}
+
+	// --- At-rules ---
+
+	void NestedMedia() {
+		StyleSheet sheet;
+		Parser::Parse(
+			"@media (min-width: 100px) {\n"
+			"  @media (max-width: 200px) { a { x: 1 } }\n"
+			"  b { y: 2 }\n"
+			"}\n"
+			"c { z: 3 }", &sheet);
+		CHECK(sheet.errors.empty());
+		CHECK(sheet.rules.size() == 5);
+		CHECK(sheet.rules[0].atKeyword == "media" && sheet.rules[0].prelude == "(min-width: 100px)" && sheet.rules[0].parent == -1);
+		CHECK(sheet.rules[1].atKeyword == "media" && sheet.rules[1].prelude == "(max-width: 200px)" && sheet.rules[1].parent == 0);
+		CHECK(sheet.rules[2].prelude == "a" && sheet.rules[2].parent == 1);
+		CHECK(sheet.rules[3].prelude == "b" && sheet.rules[3].parent == 0);
+		CHECK(FindRule(sheet, "c") && FindRule(sheet, "c")->parent == -1);
+	}
+
+	void EmptyMediaPrelude() {
+		StyleSheet sheet;
+		Parser::Parse("@media { a { x: 1 } } @media{} b { y: 2 }", &sheet);
+		CHECK(sheet.errors.empty());
+		CHECK(sheet.rules.size() == 4);
+		CHECK(sheet.rules[0].atKeyword == "media" && sheet.rules[0].prelude.empty() && sheet.rules[0].hasBlock);
+		CHECK(sheet.rules[1].prelude == "a" && sheet.rules[1].parent == 0);
+		CHECK(sheet.rules[2].atKeyword == "media" && sheet.rules[2].prelude.empty() && sheet.rules[2].hasBlock);
+		CHECK(FindRule(sheet, "b") && FindRule(sheet, "b")->parent == -1);
+	}
+
+	void StatementAtRules() {
+		StyleSheet sheet;
+		Parser::Parse("@import url(theme.css) layer(base); @layer base, app; a { x: 1 }", &sheet);
+		CHECK(sheet.errors.empty());
+		CHECK(sheet.rules.size() == 3);
+		CHECK(sheet.rules[0].atKeyword == "import" && !sheet.rules[0].hasBlock);
+		CHECK(sheet.rules[0].prelude == "url(theme.css) layer(base)");
+		CHECK(sheet.rules[1].atKeyword == "layer" && sheet.rules[1].prelude == "base, app");
+
+		StyleSheet open;
+		Parser::Parse("@import 'x.css'", &open);
+		CHECK(HasError(open, "unterminated at-rule"));
+	}
+
+	void Lists() {
+		std::vector<std::string_view> parts;
+		Parser::SplitList(" a , b:is(c, d),'x,y' ,, [t=\",\"] ", &parts);
+		CHECK(parts.size() == 4);
+		CHECK(parts.size() == 4 && parts[0] == "a" && parts[1] == "b:is(c, d)" && parts[2] == "'x,y'" && parts[3] == "[t=\",\"]");
+
+		CHECK(Parser::LineOf("a\nb\nc", 0) == 1);
+		CHECK(Parser::LineOf("a\nb\nc", 4) == 3);
+	}
+}
+
+int main() {
+	TokenKinds();
+	TokenUrls();
+	TokenStrings();
+
+	DeclarationValues();
+	DeclarationImportant();
+	DeclarationUrl();
+
+	RecoverDeclarations();
+	RecoverStrayBrace();
+	RecoverSelectorWithoutBlock();
+	RecoverUnterminatedBlock();
+	RecoverUnterminatedString();
+
+	NestedMedia();
+	EmptyMediaPrelude();
+	StatementAtRules();
+	Lists();
+
+	printf("CSSParserTests: %d checks, %d failed\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
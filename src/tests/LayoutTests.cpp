@@ -0,0 +1,427 @@
+// LayoutTests: the portable layout solvers (ChronoLayout) checked headless, with exact
+// rectangles. Registered with CTest; a failed check prints its line and the run exits 1.
+//   - Grid: fill weights and the minimums they redistribute, percent and system tracks,
+//     collapse / restore, splitter drags kept within the minimums, MinimumSize, and
+//     Changed() reporting only the rectangles that moved
+//   - Grid areas: auto tracks sized by their cells, spanning cells spread over auto tracks
+//     (but not when they span a fill track), minmax(auto, 1fr), bars inside a span
+//   - SolveCache: hits, misses and oldest-first eviction; Grid::Solve with a generation
+//     replaying exactly what a solve gives, Signature() and DPI changes
+//   - Flex: grow by factor, shrink frozen at a minimum, justify-content with gaps, wrapping,
+//     order and hidden items, Changed() and Overflow()
+
+#include <cstdio>
+#include <vector>
+
+#include "ChronoLayout.hpp"
+
+using namespace ChronoUI;
+
+#define CHECK(expr) Check((expr), #expr, __LINE__)
+
+namespace {
+	int g_checks = 0, g_failures = 0;
+
+	void Check(bool ok, const char* what, int line) {
+		++g_checks;
+		if (ok) return;
+		++g_failures;
+		printf("  FAILED line %d: %s\n", line, what);
+	}
+
+	Layout::Track Track(Layout::Unit unit, float value, bool splitter = false) {
+		Layout::Track t;
+		t.size = { unit, value };
+		t.splitter = splitter;
+		return t;
+	}
+	Layout::Track WithMin(Layout::Track t, Layout::Unit unit, float value) {
+		t.min = { unit, value };
+		return t;
+	}
+
+	bool Is(const Layout::Rect& r, int x, int y, int w, int h) {
+		return r.x == x && r.y == y && r.w == w && r.h == h;
+	}
+	bool Changed(const std::vector<uint32_t>& changed, std::vector<uint32_t> expected) {
+		return changed == expected;
+	}
+
+	// --- Grid ---
+
+	void GridFillWeights() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { Track(Layout::Unit::Fill, 1), Track(Layout::Unit::Fill, 2), Track(Layout::Unit::Fill, 1) };
+		g.Solve(0, 0, 400, 100);
+		CHECK(Is(g.Rects()[g.CellIndex(0, 0)], 0, 0, 100, 100));
+		CHECK(Is(g.Rects()[g.CellIndex(0, 1)], 100, 0, 200, 100));
+		CHECK(Is(g.Rects()[g.CellIndex(0, 2)], 300, 0, 100, 100));
+
+		// A track held at its minimum takes that out of what the others share
+		g.cols = { WithMin(Track(Layout::Unit::Fill, 1), Layout::Unit::Pixels, 150), Track(Layout::Unit::Fill, 1), Track(Layout::Unit::Fill, 1) };
+		g.Solve(0, 0, 300, 100);
+		CHECK(g.ColSpans()[0].size == 150);
+		CHECK(g.ColSpans()[1].size == 75 && g.ColSpans()[1].pos == 150);
+		CHECK(g.ColSpans()[2].size == 75 && g.ColSpans()[2].pos == 225);
+	}
+
+	void GridPercentAndSystem() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { Track(Layout::Unit::Percent, 25), Track(Layout::Unit::System, 0), Track(Layout::Unit::Fill, 1) };
+		g.cols[1].system = 40;
+		g.Solve(10, 20, 400, 100);
+		CHECK(Is(g.Rects()[g.CellIndex(0, 0)], 10, 20, 100, 100));
+		CHECK(Is(g.Rects()[g.CellIndex(0, 1)], 110, 20, 40, 100));
+		CHECK(Is(g.Rects()[g.CellIndex(0, 2)], 150, 20, 260, 100));
+	}
+
+	void GridCollapse() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { WithMin(Track(Layout::Unit::Pixels, 120), Layout::Unit::Pixels, 20), Track(Layout::Unit::Fill, 1) };
+		g.Solve(0, 0, 300, 100);
+		CHECK(g.ColSpans()[0].size == 120 && g.ColSpans()[1].size == 180);
+
+		// Collapsed: sized to its minimum, the fill track takes the rest
+		g.cols[0].collapsed = true;
+		g.Solve(0, 0, 300, 100);
+		CHECK(g.ColSpans()[0].size == 20 && g.ColSpans()[1].size == 280);
+		CHECK(Changed(g.Changed(), { 0, 1 }));
+
+		g.cols[0].collapsed = false;
+		g.Solve(0, 0, 300, 100);
+		CHECK(Is(g.Rects()[0], 0, 0, 120, 100) && Is(g.Rects()[1], 120, 0, 180, 100));
+		CHECK(Changed(g.Changed(), { 0, 1 }));
+	}
+
+	void GridDrag() {
+		// Column 0 is 100 px wide with a splitter; column 1 needs 80 px
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { WithMin(Track(Layout::Unit::Pixels, 100, true), Layout::Unit::Pixels, 50), WithMin(Track(Layout::Unit::Fill, 1), Layout::Unit::Pixels, 80) };
+		g.Solve(0, 0, 400, 100);
+		CHECK(g.ColSpans()[1].pos == 106 && g.ColSpans()[1].size == 294);
+		CHECK(Is(g.Rects()[g.ColSplitterIndex(0)], 100, 0, 6, 100));
+		CHECK(g.DragCol(0, 200) == 200.0f);
+		CHECK(g.DragCol(0, 10) == 50.0f);			// Its own minimum
+		CHECK(g.DragCol(0, 390) == 320.0f);			// The next column's minimum
+		CHECK(g.DragCol(5, 200) == 0.0f);			// No such column
+
+		// At 192 DPI pointers are device pixels and the result layout pixels
+		g.dpi = 192;
+		g.Solve(0, 0, 400, 100);
+		CHECK(g.ColSpans()[0].size == 200);
+		CHECK(g.DragCol(0, 300) == 120.0f);
+
+		Layout::Grid r;
+		r.cols = { Track(Layout::Unit::Fill, 1) };
+		r.rows = { WithMin(Track(Layout::Unit::Pixels, 30, true), Layout::Unit::Pixels, 10), Track(Layout::Unit::Fill, 1) };
+		r.Solve(0, 0, 100, 100);
+		CHECK(r.DragRow(0, 5) == 10.0f);
+		CHECK(r.DragRow(0, 50) == 50.0f);
+		CHECK(r.DragRow(0, 200) == 100.0f);
+	}
+
+	void GridMinimumSize() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1), Track(Layout::Unit::Pixels, 40) };
+		g.cols = { Track(Layout::Unit::Pixels, 100, true), WithMin(Track(Layout::Unit::Fill, 1), Layout::Unit::Pixels, 80),
+			WithMin(Track(Layout::Unit::Percent, 10), Layout::Unit::Pixels, 20), Track(Layout::Unit::System, 0) };
+		g.cols[3].system = 30;
+		int w = 0, h = 0;
+		g.MinimumSize(&w, &h);
+		CHECK(w == 106 + 80 + 20 + 30);
+		CHECK(h == 40);
+	}
+
+	void GridChanged() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { Track(Layout::Unit::Pixels, 100), Track(Layout::Unit::Fill, 1) };
+		g.Solve(0, 0, 300, 100);
+		CHECK(g.Changed().size() == g.Rects().size());	// First solve: everything
+
+		g.Solve(0, 0, 300, 100);
+		CHECK(g.Changed().empty());
+
+		g.Solve(0, 0, 400, 100);
+		CHECK(Changed(g.Changed(), { 1 }));
+
+		g.Solve(0, 0, 400, 120);
+		CHECK(Changed(g.Changed(), { 0, 1 }));
+
+		// A track added: the count changed, so all of them
+		g.cols.push_back(Track(Layout::Unit::Pixels, 50));
+		g.Solve(0, 0, 400, 120);
+		CHECK(g.Changed().size() == g.Rects().size());
+	}
+
+	// --- Grid areas ---
+
+	Layout::Area At(int row, int col, int rowSpan = 1, int colSpan = 1, int contentW = 0, int contentH = 0) {
+		Layout::Area a;
+		a.row = row;
+		a.col = col;
+		a.rowSpan = rowSpan;
+		a.colSpan = colSpan;
+		a.contentW = contentW;
+		a.contentH = contentH;
+		return a;
+	}
+
+	void AreaAutoTracks() {
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1) };
+		g.cols = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1) };
+		g.areas = { At(0, 0, 1, 1, 80, 24), At(0, 1, 1, 1, 10, 30), At(1, 0, 1, 2) };
+		g.Solve(0, 0, 300, 200);
+		CHECK(g.ItemCount() == 3);
+		CHECK(Is(g.Rects()[0], 0, 0, 80, 30));			// The tallest cell of the row
+		CHECK(Is(g.Rects()[1], 80, 0, 220, 30));
+		CHECK(Is(g.Rects()[2], 0, 30, 300, 170));		// Spanning both columns
+	}
+
+	void AreaSpans() {
+		// 101 px over two auto columns: split evenly, the odd pixel to the first
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1) };
+		g.areas = { At(0, 0, 1, 2, 101), At(0, 2) };
+		g.Solve(0, 0, 300, 50);
+		CHECK(g.ColSpans()[0].size == 51 && g.ColSpans()[1].size == 50);
+		CHECK(Is(g.Rects()[0], 0, 0, 101, 50));
+		CHECK(Is(g.Rects()[1], 101, 0, 199, 50));
+
+		// Spanning a fill track too: the fill track makes the room, the auto one keeps its cells
+		Layout::Grid f;
+		f.rows = { Track(Layout::Unit::Fill, 1) };
+		f.cols = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1) };
+		f.areas = { At(0, 0, 1, 2, 500), At(0, 0, 1, 1, 40) };
+		f.Solve(0, 0, 300, 50);
+		CHECK(f.ColSpans()[0].size == 40);
+		CHECK(Is(f.Rects()[0], 0, 0, 300, 50));
+
+		// Splitter bars between the spanned tracks belong to the cell
+		Layout::Grid b;
+		b.rows = { Track(Layout::Unit::Fill, 1) };
+		b.cols = { Track(Layout::Unit::Pixels, 100, true), Track(Layout::Unit::Pixels, 100) };
+		b.areas = { At(0, 0, 1, 2) };
+		b.Solve(0, 0, 300, 50);
+		CHECK(Is(b.Rects()[0], 0, 0, 206, 50));
+	}
+
+	void AreaMinmaxAuto() {
+		// minmax(auto, 1fr) next to 1fr: held at its content, the other takes the rest
+		Layout::Grid g;
+		g.rows = { Track(Layout::Unit::Fill, 1) };
+		g.cols = { WithMin(Track(Layout::Unit::Fill, 1), Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1) };
+		g.areas = { At(0, 0, 1, 1, 200), At(0, 1) };
+		g.Solve(0, 0, 300, 50);
+		CHECK(g.ColSpans()[0].size == 200 && g.ColSpans()[1].size == 100);
+
+		// Wide enough: plain 1fr
+		g.Solve(0, 0, 600, 50);
+		CHECK(g.ColSpans()[0].size == 300 && g.ColSpans()[1].size == 300);
+
+		int w = 0, h = 0;
+		g.MinimumSize(&w, &h);
+		CHECK(w == 200);
+	}
+
+	// --- Solve cache ---
+
+	void CacheBasics() {
+		Layout::SolveCache<int, 2> cache;
+		CHECK(cache.Find(0, 0, 10, 10, 1) == nullptr);
+		cache.Store(0, 0, 10, 10, 1) = 5;
+		const int* found = cache.Find(0, 0, 10, 10, 1);
+		CHECK(found && *found == 5);
+		CHECK(cache.Find(0, 0, 10, 10, 2) == nullptr);	// Another generation
+		CHECK(cache.Find(1, 0, 10, 10, 1) == nullptr);	// Another box
+
+		// Full: the oldest entry makes room
+		cache.Store(0, 0, 20, 10, 1) = 6;
+		cache.Store(0, 0, 30, 10, 1) = 7;
+		CHECK(cache.Find(0, 0, 10, 10, 1) == nullptr);
+		found = cache.Find(0, 0, 20, 10, 1);
+		CHECK(found && *found == 6);
+		CHECK(cache.Hits() == 2 && cache.Misses() == 4);
+
+		cache.Clear();
+		CHECK(cache.Find(0, 0, 30, 10, 1) == nullptr);
+	}
+
+	void CacheGrid() {
+		Layout::Grid solved, cached;
+		for (Layout::Grid* g : { &solved, &cached }) {
+			g->rows = { Track(Layout::Unit::Auto, 0), Track(Layout::Unit::Fill, 1, true) };
+			g->cols = { Track(Layout::Unit::Pixels, 200, true), Track(Layout::Unit::Fill, 1) };
+			g->areas = { At(0, 0, 1, 2, 0, 30), At(1, 0), At(1, 1) };
+		}
+
+		// Two boxes back and forth: the second round replays, with the same rectangles and
+		// the same Changed() a solve reports
+		const int widths[4] = { 800, 600, 800, 600 };
+		bool same = true;
+		for (int w : widths) {
+			solved.Solve(0, 0, w, 400);
+			cached.Solve(0, 0, w, 400, cached.Signature());
+			same = same && solved.Rects() == cached.Rects() && solved.Changed() == cached.Changed();
+			same = same && solved.ColSpans()[1].size == cached.ColSpans()[1].size;
+		}
+		CHECK(same);
+		CHECK(cached.CacheHits() == 2 && cached.CacheMisses() == 2);
+		CHECK(cached.DragCol(0, 300) == solved.DragCol(0, 300));
+
+		// A splitter dragged away and back: a new signature, then the old one again
+		uint64_t before = cached.Signature();
+		cached.cols[0].size.value = 300;
+		CHECK(cached.Signature() != before);
+		cached.Solve(0, 0, 600, 400, cached.Signature());
+		CHECK(cached.CacheMisses() == 3);
+		cached.cols[0].size.value = 200;
+		CHECK(cached.Signature() == before);
+		cached.Solve(0, 0, 600, 400, cached.Signature());
+		CHECK(cached.CacheHits() == 3);
+		CHECK(Changed(cached.Changed(), { 1, 2, 3 }));		// Both bottom cells and the column bar
+
+		// A DPI change drops everything solved before it
+		cached.dpi = 144;
+		solved.dpi = 144;
+		cached.Solve(0, 0, 600, 400, cached.Signature());
+		solved.Solve(0, 0, 600, 400);
+		CHECK(cached.CacheMisses() == 4);
+		CHECK(cached.Rects() == solved.Rects());
+	}
+
+	// --- Flex ---
+
+	Layout::FlexItem Item(int content, float grow = 0.0f) {
+		Layout::FlexItem item;
+		item.content = content;
+		item.grow = grow;
+		return item;
+	}
+
+	void FlexGrow() {
+		Layout::Flex f;
+		f.items = { Item(50, 1), Item(50, 1), Item(50, 2) };
+		f.Solve(0, 0, 450, 40);
+		CHECK(Is(f.Rects()[0], 0, 0, 125, 40));
+		CHECK(Is(f.Rects()[1], 125, 0, 125, 40));
+		CHECK(Is(f.Rects()[2], 250, 0, 200, 40));
+
+		// Column: the same along y, items stretched across
+		f.row = false;
+		f.Solve(10, 0, 30, 450);
+		CHECK(Is(f.Rects()[2], 10, 250, 30, 200));
+	}
+
+	void FlexShrink() {
+		// 400 px in 300: shrunk in proportion to the basis; the first stops at its minimum
+		// and the second takes the rest of the deficit
+		Layout::Flex f;
+		f.items = { Item(200), Item(200) };
+		f.items[0].minMain = 180;
+		f.items[1].minMain = 0;
+		f.Solve(0, 0, 300, 20);
+		CHECK(f.Rects()[0].w == 180);
+		CHECK(f.Rects()[1].x == 180 && f.Rects()[1].w == 120);
+
+		// The automatic minimum is the content: nothing shrinks below it
+		f.items[1].minMain = -1;
+		f.Solve(0, 0, 300, 20);
+		CHECK(f.Rects()[1].w == 200);
+	}
+
+	void FlexJustify() {
+		Layout::Flex f;
+		f.items = { Item(100), Item(100) };
+		f.gap = 10;
+		f.justify = Layout::Justify::Center;
+		f.Solve(0, 0, 300, 20);
+		CHECK(f.Rects()[0].x == 45 && f.Rects()[1].x == 155);
+
+		f.justify = Layout::Justify::SpaceBetween;
+		f.Solve(0, 0, 300, 20);
+		CHECK(f.Rects()[0].x == 0 && f.Rects()[1].x == 200);
+		CHECK(Changed(f.Changed(), { 0, 1 }));
+
+		f.justify = Layout::Justify::End;
+		f.Solve(0, 0, 300, 20);
+		CHECK(f.Rects()[0].x == 90 && f.Rects()[1].x == 200);
+		CHECK(Changed(f.Changed(), { 0 }));
+	}
+
+	void FlexWrap() {
+		Layout::Flex f;
+		f.items = { Item(100), Item(100), Item(100) };
+		for (Layout::FlexItem& item : f.items) item.crossContent = 20;
+		f.wrap = true;
+		f.alignContent = Layout::Align::Start;
+		f.Solve(0, 0, 250, 100);
+		CHECK(Is(f.Rects()[0], 0, 0, 100, 20));
+		CHECK(Is(f.Rects()[1], 100, 0, 100, 20));
+		CHECK(Is(f.Rects()[2], 0, 20, 100, 20));		// Second line
+
+		// Stretched: the two lines share the free cross space
+		f.alignContent = Layout::Align::Stretch;
+		f.Solve(0, 0, 250, 100);
+		CHECK(Is(f.Rects()[2], 0, 50, 100, 50));
+	}
+
+	void FlexOrderAndHidden() {
+		Layout::Flex f;
+		f.items = { Item(50), Item(60), Item(70) };
+		f.items[0].order = 1;
+		f.items[2].hidden = true;
+		f.Solve(0, 0, 200, 20);
+		CHECK(f.Rects()[1].x == 0 && f.Rects()[1].w == 60);
+		CHECK(f.Rects()[0].x == 60 && f.Rects()[0].w == 50);
+		CHECK(Is(f.Rects()[2], 0, 0, 0, 0));
+		CHECK(f.Extent() == 110);
+
+		f.Solve(0, 0, 200, 20);
+		CHECK(f.Changed().empty());
+	}
+
+	void FlexOverflow() {
+		// 400 px in 300, 40 kept for the overflow button: two fit, the rest is hidden
+		Layout::Flex f;
+		f.items = { Item(100), Item(100), Item(100), Item(100) };
+		CHECK(f.Overflow(300, 40) == 2);
+		CHECK(!f.items[1].hidden && f.items[2].hidden && f.items[3].hidden);
+
+		Layout::Flex fits;
+		fits.items = { Item(100), Item(100) };
+		CHECK(fits.Overflow(300, 40) == 0);
+	}
+}
+
+int main() {
+	GridFillWeights();
+	GridPercentAndSystem();
+	GridCollapse();
+	GridDrag();
+	GridMinimumSize();
+	GridChanged();
+
+	AreaAutoTracks();
+	AreaSpans();
+	AreaMinmaxAuto();
+
+	CacheBasics();
+	CacheGrid();
+
+	FlexGrow();
+	FlexShrink();
+	FlexJustify();
+	FlexWrap();
+	FlexOrderAndHidden();
+	FlexOverflow();
+
+	printf("LayoutTests: %d checks, %d failed\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
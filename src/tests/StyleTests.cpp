@@ -0,0 +1,246 @@
+// StyleTests: the style engine (StyleManager and the compiled selectors) checked against
+// plain nodes and window-less widgets. Registered with CTest; a failed check prints its line
+// and the run exits 1.
+//   - Ids: a sheet naming the automatic id of a widget not constructed yet, and an id
+//     changed on a node in the tree re-matching it
+//   - Selectors: what Selector::Compile accepts, and state pseudo-classes resolving through
+//     the StyleState bits widgets pass
+//   - Cascade: layers over specificity, unlayered rules over layers, specificity, source
+//     order within and across sheets, !important reversing the layers, and LoadCSS /
+//     UnloadSheet restyling the tree under 'root'
+//   - Media: an @media with an empty prelude matching like "all"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ChronoUI.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoSelectors.hpp"
+#include "WidgetImpl.hpp"
+
+using namespace ChronoUI;
+
+#define CHECK(expr) Check((expr), #expr, __LINE__)
+
+namespace {
+	int g_checks = 0, g_failures = 0;
+
+	void Check(bool ok, const char* what, int line) {
+		++g_checks;
+		if (ok) return;
+		++g_failures;
+		printf("  FAILED line %d: %s\n", line, what);
+	}
+
+	class Node : public ContextNodeImpl {
+	public:
+		explicit Node(const char* type) : m_type(PropertyAtoms::Intern(type)) {}
+		PropertyHandle StyleTypeKey() override { return m_type; }
+		void GetStyleChildren(std::vector<IContextNode*>* out) override {
+			for (IContextNode* c : children) out->push_back(c);
+		}
+		const MediaFeatures* GetMediaFeatures() override { return media; }
+		std::vector<IContextNode*> children;
+		const MediaFeatures* media = nullptr;
+	private:
+		PropertyHandle m_type;
+	};
+
+	// A widget with no window, enough for the style engine
+	class Label : public WidgetImpl {
+	public:
+		const char* __stdcall GetControlName() override { return "Label"; }
+		const char* __stdcall GetControlManifest() override {
+			return R"json({ "properties": [ { "name": "title", "type": "string", "impact": "layout" } ] })json";
+		}
+		void OnDrawWidget(ID2D1RenderTarget* pRT) override {}
+	};
+
+	bool Is(IContextNode* node, const char* key, const char* expected) {
+		return strcmp(node->GetProperty(key, ""), expected) == 0;
+	}
+
+	// --- Ids ---
+
+	void IdBeforeConstruction() {
+		// The automatic ids count up, so the next widget gets the probe's number + 1
+		int next;
+		{
+			Label probe;
+			next = atoi(probe.GetProperty("id") + strlen("widget_")) + 1;
+		}
+		std::string id = "widget_" + std::to_string(next);
+		StyleSheetHandle sheet = StyleManager::LoadCSS("#" + id + " { color: #ff0000; } #renamed { color: #0000ff; }");
+
+		// Assigning the automatic id in the constructor must not match the half-built widget
+		Label w;
+		IWidget* node = &w;
+		CHECK(Is(node, "id", id.c_str()));
+		CHECK(Is(node, "color", ""));
+
+		// It is matched once added, as the container does
+		Node root("Container");
+		w.SetParentNode(&root);
+		root.children.push_back(node);
+		StyleManager::Restyle(node);
+		CHECK(Is(node, "color", "#ff0000"));
+
+		// In the tree a new id re-matches the node right away
+		w.SetProperty("id", "renamed");
+		CHECK(Is(node, "color", "#0000ff"));
+		w.SetProperty("id", id.c_str());
+		CHECK(Is(node, "color", "#ff0000"));
+
+		root.children.clear();
+		w.SetParentNode(nullptr);
+		StyleManager::UnloadSheet(sheet);
+	}
+
+	// --- Selectors ---
+
+	bool Compiles(const char* text) {
+		CSS::Selector sel;
+		return CSS::Selector::Compile(text, &sel);
+	}
+
+	void SelectorCompile() {
+		CSS::Selector sel;
+		CHECK(CSS::Selector::Compile("Container > .row Button#ok.primary:hover", &sel));
+		CHECK(sel.compounds.size() == 3);
+		CHECK(sel.state == "hover");
+		CHECK(sel.specificity == ((1u << 20) | (3u << 10) | 2u));
+
+		CHECK(Compiles("*"));
+		CHECK(Compiles(".btn:active"));
+		CHECK(Compiles(".btn:selected"));
+		CHECK(Compiles("Button:disabled"));
+
+		// No StyleState bit resolves these, so they must not compile into dead keys
+		CHECK(!Compiles(".btn:checked"));
+		CHECK(!Compiles(".btn:focus"));
+		// One state, on the subject only
+		CHECK(!Compiles(".btn:hover:active"));
+		CHECK(!Compiles(".row:hover Button"));
+		// Unsupported syntax
+		CHECK(!Compiles("Button + Button"));
+		CHECK(!Compiles("Button[title]"));
+		CHECK(!Compiles("Button::before"));
+		CHECK(!Compiles(""));
+	}
+
+	void SelectorStates() {
+		StyleSheetHandle sheet = StyleManager::LoadCSS(".on { color: #000000; } .on:active { color: #00ff00; } .on:selected { color: #0000ff; }");
+		Node root("Container");
+		Node button("Button");
+		Node* node = &button;
+		node->SetParentNode(&root);
+		root.children.push_back(node);
+		StyleManager::AddClass(node, "on");
+
+		PropertyHandle color = PropertyAtoms::Intern("color");
+		PropertyValue v;
+		CHECK(node->GetStyleValue(color, PropertyHandle{}, PropertyHandle{}, StyleState::Mask(false, true, false, false), &v));
+		CHECK(v.IsColor() && v.rgba == 0xFF000000);
+		// A checked widget passes Active, a focused one Selected
+		CHECK(node->GetStyleValue(color, PropertyHandle{}, PropertyHandle{}, StyleState::Mask(false, true, false, true), &v));
+		CHECK(v.IsColor() && v.rgba == 0xFF00FF00);
+		CHECK(node->GetStyleValue(color, PropertyHandle{}, PropertyHandle{}, StyleState::Mask(true, true, false, false), &v));
+		CHECK(v.IsColor() && v.rgba == 0xFF0000FF);
+
+		root.children.clear();
+		StyleManager::UnloadSheet(sheet);
+	}
+
+	// --- Cascade ---
+
+	void CascadeOrder() {
+		Node root("Container");
+		Node button("Button");
+		button.SetParentNode(&root);
+		root.children.push_back(&button);
+		button.SetProperty("id", "n");
+		StyleManager::AddClass(&button, "x");
+
+		// Loaded with a root, so the tree is restyled without being asked
+		StyleSheetHandle a = StyleManager::LoadCSS(
+			"@layer base, app;\n"
+			"@layer app { .x { tag-layer: app; } }\n"
+			"@layer base { #n.x { tag-layer: base; } }\n"
+			".x { tag-unlayered: unlayered; }\n"
+			"@layer app { #n { tag-unlayered: app; } }\n"
+			"#n { tag-specificity: id; }\n"
+			"Button.x { tag-specificity: class; }\n"
+			".x { tag-order: first; }\n"
+			".x { tag-order: second; }\n"
+			"@layer base { .x { tag-important: base !important; } }\n"
+			"@layer app { .x { tag-important: app !important; } }\n"
+			".x { tag-important: unlayered !important; }\n"
+			".x { tag-plugin: unlayered; }\n", "", &root);
+		CHECK(Is(&button, "tag-layer", "app"));				// A later layer beats a more specific selector
+		CHECK(Is(&button, "tag-unlayered", "unlayered"));	// Unlayered rules beat every layer
+		CHECK(Is(&button, "tag-specificity", "id"));
+		CHECK(Is(&button, "tag-order", "second"));
+		CHECK(Is(&button, "tag-important", "base"));		// !important takes the layers in reverse
+
+		// Later sheets win at equal specificity; a sheet put in a layer ranks under unlayered rules
+		StyleSheetHandle b = StyleManager::LoadCSS(".x { tag-order: later; }", "", &root);
+		StyleSheetHandle c = StyleManager::LoadCSS("#n.x { tag-plugin: plugin; }", "plugin", &root);
+		CHECK(Is(&button, "tag-order", "later"));
+		CHECK(Is(&button, "tag-plugin", "unlayered"));
+
+		// Unloading restyles the nodes that matched the sheet
+		StyleManager::UnloadSheet(b, &root);
+		CHECK(Is(&button, "tag-order", "second"));
+
+		StyleManager::UnloadSheet(c, &root);
+		StyleManager::UnloadSheet(a, &root);
+		CHECK(Is(&button, "tag-order", ""));
+		root.children.clear();
+	}
+
+	// --- Media ---
+
+	void EmptyMediaQuery() {
+		const MediaFeatures small = { 320.0f, 240.0f, 1.0f };
+		const MediaFeatures large = { 2560.0f, 1440.0f, 2.0f };
+		CSS::MediaQuery q;
+		CHECK(CSS::MediaQuery::Compile("", &q));
+		CHECK(q.Evaluate(small) && q.Evaluate(large));
+		CHECK(CSS::MediaQuery::Compile("  ", &q));
+		CHECK(q.Evaluate(small));
+		CHECK(CSS::MediaQuery::Compile("all", &q) && q.Evaluate(small));
+		CHECK(CSS::MediaQuery::Compile("print", &q) && !q.Evaluate(small));
+		CHECK(!CSS::MediaQuery::Compile("not screen", &q));
+
+		// The block of "@media {}" applies instead of being dropped
+		Node root("Container");
+		root.media = &small;
+		Node button("Button");
+		button.SetParentNode(&root);
+		root.children.push_back(&button);
+		StyleManager::AddClass(&button, "x");
+		StyleSheetHandle sheet = StyleManager::LoadCSS("@media { .x { tag-media: all; } } @media print { .x { tag-print: print; } }", "", &root);
+		CHECK(Is(&button, "tag-media", "all"));
+		CHECK(Is(&button, "tag-print", ""));
+
+		StyleManager::UnloadSheet(sheet, &root);
+		root.children.clear();
+	}
+}
+
+int main() {
+	IdBeforeConstruction();
+
+	SelectorCompile();
+	SelectorStates();
+
+	CascadeOrder();
+
+	EmptyMediaQuery();
+
+	printf("StyleTests: %d checks, %d failed\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
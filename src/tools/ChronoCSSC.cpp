@@ -0,0 +1,50 @@
+// ChronoCSSC: compiles a CSS file into the binary image StyleManager loads without parsing.
+//
+//   ChronoCSSC bootstrap_lite.css bootstrap_lite.ccss
+//
+// Put the output in the resource folder before packing it (VirtualDrive::PackDirectory) and
+// hand the bytes to StyleManager::LoadCompiled, or pass the file to LoadCSSFile directly.
+// Images carry a version; rebuild them whenever ChronoStyleImage.hpp changes.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "ChronoUI.hpp"
+#include "ChronoStyles.hpp"
+#include "ChronoStyleImage.hpp"
+
+using namespace ChronoUI;
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		printf("usage: ChronoCSSC <input.css> <output.ccss>\n");
+		return 2;
+	}
+
+	// 1. Read the source; parse errors and unsupported selectors are reported on stderr
+	std::ifstream in(argv[1], std::ios::binary);
+	if (!in.is_open()) {
+		printf("ChronoCSSC: could not open %s\n", argv[1]);
+		return 1;
+	}
+	std::stringstream buffer;
+	buffer << in.rdbuf();
+
+	// 2. Compile
+	std::string image;
+	StyleManager::CompileCSS(buffer.str(), &image);
+
+	// 3. Write
+	std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+	if (!out.is_open() || !out.write(image.data(), (std::streamsize)image.size())) {
+		printf("ChronoCSSC: could not write %s\n", argv[2]);
+		return 1;
+	}
+
+	const CSS::Image::Header* h = (const CSS::Image::Header*)image.data();
+	printf("ChronoCSSC: %s -> %s, %u rules, %u declarations, %u atoms, %zu bytes\n",
+		argv[1], argv[2], h->rules.count, h->decls.count, h->atoms.count, image.size());
+	return 0;
+}
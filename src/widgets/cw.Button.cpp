@@ -72,10 +72,10 @@ public:
             "version": 4,
             "description": "A stable, layout-consistent button (Direct2D)",
             "properties": [
-                { "name": "title", "type": "string", "description": "Button text" },
-                { "name": "image-align", "type": "string", "enum": ["left", "right", "top", "bottom", "center"], "description": "Image alignment" },
-                { "name": "image_path", "type": "string", "description": "File path to image" },
-                { "name": "image_base64", "type": "string", "description": "Base64 encoded image" },
+                { "name": "title", "type": "string", "description": "Button text", "impact": "layout" },
+                { "name": "image-align", "type": "string", "enum": ["left", "right", "top", "bottom", "center"], "description": "Image alignment", "impact": "layout" },
+                { "name": "image_path", "type": "string", "description": "File path to image", "impact": "layout" },
+                { "name": "image_base64", "type": "string", "description": "Base64 encoded image", "impact": "layout" },
                 { "name": "checked", "type": "boolean", "description": "Draw checked accent strip" },
                 { "name": "arrow", "type": "boolean", "description": "Draw chevron arrow" },
                 { "name": "is_pill", "type": "boolean", "description": "Enable fully rounded capsule shape" },
@@ -158,6 +158,43 @@ public:
 		}
 	}
 
+	// The content OnDrawWidget lays out: the title on one line and the image at the height
+	// it is capped at (square until the bitmap is loaded), inside the outer padding
+	bool OnMeasure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+		std::string title = GetStringProperty("title");
+		bool hasImage = m_pBitmap || !m_pendingImageBase64.empty() || !m_pendingImagePath.empty();
+		if (title.empty() && !hasImage) return false;
+
+		// 1. Parts
+		float fontSize = ScaleF((float)GetCSSIntStyle("font-size", 10));
+		D2D1_SIZE_F text = MeasureText(title, L"Segoe UI", DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, fontSize);
+		float imgH = hasImage ? ScaleF(24.0f) : 0.0f;
+		float imgW = imgH;
+		if (m_pBitmap) {
+			D2D1_SIZE_F bmpSize = m_pBitmap->GetSize();
+			if (bmpSize.height > 0.0f) imgW = bmpSize.width * imgH / bmpSize.height;
+		}
+		float spacing = (hasImage && !title.empty()) ? ScaleF(kBaseSpacing) : 0.0f;
+
+		// 2. Arrangement: top / bottom stack, center packs side by side, left / right keep the
+		//    title centered with the image at one edge, so the image's room is needed twice
+		std::string align = GetStringProperty("image-align");
+		float w, h;
+		if (align == "top" || align == "bottom") {
+			w = (std::max)(imgW, text.width);
+			h = imgH + spacing + text.height;
+		}
+		else {
+			w = text.width + (imgW + spacing) * ((align == "center") ? 1.0f : 2.0f);
+			h = (std::max)(imgH, text.height);
+		}
+
+		float pad = ScaleF(kOuterPadding) * 2.0f;
+		desired->cx = (LONG)std::ceil(w + pad);
+		desired->cy = (LONG)std::ceil(h + pad);
+		return true;
+	}
+
 	void OnDrawWidget(ID2D1RenderTarget* pRT) override {
 		if (m_imageDirty) ReloadImage(pRT);
 
@@ -29,6 +29,10 @@ private:
 	// Data State
 	std::vector<float> m_history;
 
+	// Hot keys, resolved once
+	PropertyHandle m_keySteps = PropertyAtoms::Intern("steps");
+	PropertyHandle m_keyAddValue = PropertyAtoms::Intern("add_value");
+
 public:
 	DataPlotControl() {
 		// Initialize Properties with defaults
@@ -64,7 +68,7 @@ public:
                 { "name": "steps", "type": "int", "description": "Max data points to keep" },
                 { "name": "min", "type": "float", "description": "Minimum Y value" },
                 { "name": "max", "type": "float", "description": "Maximum Y value" },
-                { "name": "add_value", "type": "float", "description": "Push a new value to the plot" },
+                { "name": "add_value", "type": "float", "description": "Push a new value (or a float array of values) to the plot", "impact": "none" },
                 { "name": "color", "type": "string", "description": "Plot line color (hex)" },
                 { "name": "background-color", "type": "string", "description": "Background color (hex)" },
                 { "name": "grid-color", "type": "string", "description": "Grid line color (hex)" },
@@ -73,11 +77,19 @@ public:
         })json";
 	}
 
+	// Every sample is a path segment; a splitter drag stretches the last plot
+	bool StretchesWhileResizing() override { return true; }
+
 	void AddValue(float val) {
-		size_t maxSteps = (size_t)GetIntProperty("steps");
+		AddValues(&val, 1);
+	}
+
+	void AddValues(const float* values, size_t count) {
+		PropertyValue steps;
+		size_t maxSteps = (GetPropertyValue(m_keySteps, &steps) && steps.hasInteger && steps.integer > 0) ? (size_t)steps.integer : 0;
 		if (maxSteps < 2) maxSteps = 2;
 
-		m_history.push_back(val);
+		m_history.insert(m_history.end(), values, values + count);
 
 		if (m_history.size() > maxSteps) {
 			m_history.erase(m_history.begin(), m_history.begin() + (m_history.size() - maxSteps));
@@ -89,6 +101,22 @@ public:
 		}
 	}
 
+	// SetFloat/SetDouble/SetFloatArray("add_value") land here without a string round trip
+	void OnValueChanged(PropertyHandle key, const PropertyValue& value) override {
+		if (key == m_keyAddValue) {
+			const float* values = nullptr;
+			size_t count = 0;
+			if (GetFloatArray(key, &values, &count)) {
+				if (count) AddValues(values, count);
+			}
+			else {
+				AddValue(value.number);
+			}
+			return;
+		}
+		WidgetImpl::OnValueChanged(key, value);
+	}
+
 	void OnPropertyChanged(const char* key, const char* value) override {
 		WidgetImpl::OnPropertyChanged(key, value);
 
@@ -30,6 +30,20 @@ private:
 
 	UINT_PTR m_timerId = 0;
 
+	// Level state, kept in members so the physics timer does not
+	// round-trip through the string property store every tick
+	float m_targetValue = 0.0f;
+	float m_visualValue = 0.0f;
+	float m_peakValue = 0.0f;
+	PropertyHandle m_keyValue = PropertyAtoms::Intern("value");
+
+	void SetTarget(float value) {
+		m_targetValue = (std::clamp)(value, 0.0f, 1.0f);
+		if (m_targetValue > m_peakValue) {
+			m_peakValue = m_targetValue;
+		}
+	}
+
 public:
 	EqualizerBar() {}
 
@@ -44,7 +58,7 @@ public:
             "version": 1,
             "description": "High-end segmented LED audio visualizer with smooth transitions",
             "properties": [
-                { "name": "value", "type": "float", "description": "Target level (0.0 - 1.0)" },
+                { "name": "value", "type": "float", "description": "Target level (0.0 - 1.0)", "impact": "none" },
                 { "name": "vertical", "type": "bool", "description": "True for vertical bar, false for horizontal" },
                 { "name": "segments", "type": "int", "description": "Number of LED segments" },
                 { "name": "background-color", "type": "color", "description": "Background color" },
@@ -58,8 +72,6 @@ public:
 
 		// Initialize Properties
 		SetProperty("value", "0.0");
-		SetProperty("visual-value", "0.0");
-		SetProperty("peak-value", "0.0");
 
 		SetProperty("vertical", "true");
 		SetProperty("segments", "24");
@@ -81,9 +93,9 @@ public:
 			bool needsRedraw = false;
 
 			// 1. Retrieve State
-			float targetVal = GetFloatProperty("value");
-			float currentVal = GetFloatProperty("visual-value");
-			float peakVal = GetFloatProperty("peak-value");
+			float targetVal = m_targetValue;
+			float currentVal = m_visualValue;
+			float peakVal = m_peakValue;
 
 			// 2. Smooth Transition Logic
 			float diff = targetVal - currentVal;
@@ -106,8 +118,8 @@ public:
 
 			// 4. Update Internal State
 			if (needsRedraw) {
-				SetProperty("visual-value", std::to_string(currentVal).c_str());
-				SetProperty("peak-value", std::to_string(peakVal).c_str());
+				m_visualValue = currentVal;
+				m_peakValue = peakVal;
 				InvalidateRect(m_hwnd, NULL, FALSE);
 			}
 
@@ -116,6 +128,15 @@ public:
 		return false;
 	}
 
+	// SetFloat/SetDouble("value") lands here without a string round trip
+	void OnValueChanged(PropertyHandle key, const PropertyValue& value) override {
+		if (key == m_keyValue) {
+			SetTarget(value.number);
+			return;
+		}
+		WidgetImpl::OnValueChanged(key, value);
+	}
+
 	void OnPropertyChanged(const char* key, const char* value) override {
 		WidgetImpl::OnPropertyChanged(key, value);
 		std::string t = key;
@@ -123,12 +144,7 @@ public:
 
 		if (t == "value") {
 			try {
-				float newVal = (std::clamp)(std::stof(v), 0.0f, 1.0f);
-				float currentPeak = GetFloatProperty("peak-value");
-
-				if (newVal > currentPeak) {
-					SetProperty("peak-value", std::to_string(newVal).c_str());
-				}
+				SetTarget(std::stof(v));
 			}
 			catch (...) {}
 		}
@@ -158,8 +174,8 @@ public:
 		int segments = GetIntProperty("segments");
 		if (segments < 5) segments = 5;
 
-		float visualValue = GetFloatProperty("visual-value");
-		float peakValue = GetFloatProperty("peak-value");
+		float visualValue = m_visualValue;
+		float peakValue = m_peakValue;
 
 		// 2. Background
 		pRT->Clear(colBg);
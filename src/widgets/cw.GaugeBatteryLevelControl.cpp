@@ -76,6 +76,9 @@ public:
         })json";
 	}
 
+	// Stretched while a splitter is dragged (see WidgetImpl::StretchesWhileResizing)
+	bool StretchesWhileResizing() override { return true; }
+
 	void __stdcall Create(HWND parent) override {
 		WidgetImpl::Create(parent);
 		if (m_hwnd) {
@@ -93,6 +93,9 @@ public:
         })json";
 	}
 
+	// Gradient arcs are too costly to redraw on every frame of a splitter drag
+	bool StretchesWhileResizing() override { return true; }
+
 	void OnPropertyChanged(const char* key, const char* value) override {
 		std::string t = key;
 		std::string val = value ? value : "";
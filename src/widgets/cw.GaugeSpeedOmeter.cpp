@@ -38,9 +38,8 @@ class GaugeSpeedOmeter : public WidgetImpl {
 	std::string m_accentColorHex = "#0096FF"; // Default Neon Blue
 	std::string m_needleColorHex = "#FF3232"; // Default Red
 
-	// Animation state
-	UINT_PTR m_timerId = 0;
-	static const UINT_PTR TIMER_ID = 101;
+	// Hot key, resolved once
+	PropertyHandle m_keyValue = PropertyAtoms::Intern("value");
 
 	// Geometry Constants
 	const float START_ANGLE = 135.0f; // Start at bottom-left
@@ -49,11 +48,7 @@ class GaugeSpeedOmeter : public WidgetImpl {
 public:
 	GaugeSpeedOmeter() {}
 
-	virtual ~GaugeSpeedOmeter() {
-		if (m_hwnd && m_timerId) {
-			KillTimer(m_hwnd, m_timerId);
-		}
-	}
+	virtual ~GaugeSpeedOmeter() = default;
 
 	const char* __stdcall GetControlName() override { return "GaugeSpeedOmeter"; }
 
@@ -62,7 +57,7 @@ public:
             "version": 2,
             "description": "Animated D2D Gauge Speedometer",
             "properties": [
-                { "name": "value", "type": "float", "description": "Target value to animate towards" },
+                { "name": "value", "type": "float", "description": "Target value; the needle follows along the 'value' transition", "impact": "none" },
                 { "name": "min", "type": "float", "description": "Minimum scale value" },
                 { "name": "max", "type": "float", "description": "Maximum scale value" },
                 { "name": "label", "type": "string", "description": "Label text (e.g. SPEED)" },
@@ -76,39 +71,8 @@ public:
         })json";
 	}
 
-	// --- Initialization ---
-
-	void __stdcall Create(HWND parent) override {
-		WidgetImpl::Create(parent);
-		// Start animation timer (~60fps)
-		if (m_hwnd) {
-			m_timerId = SetTimer(m_hwnd, TIMER_ID, 16, NULL);
-		}
-	}
-
-	// --- Message Handling ---
-
-	bool OnMessage(UINT msg, WPARAM wp, LPARAM lp) override {
-		if (msg == WM_TIMER && wp == TIMER_ID) {
-			// Smoothly interpolate current value toward target
-			float diff = m_targetValue - m_currentValue;
-
-			// If difference is significant, update physics
-			if (std::abs(diff) > 0.01f) {
-				// Damping factor: 0.15f provides a nice springy feel
-				m_currentValue += diff * 0.15f;
-
-				// Snap if very close
-				if (std::abs(m_targetValue - m_currentValue) < 0.05f) {
-					m_currentValue = m_targetValue;
-				}
-
-				InvalidateRect(m_hwnd, NULL, FALSE);
-			}
-			return true;
-		}
-		return false;
-	}
+	// Arcs, ticks and labels: a splitter drag stretches the last frame instead
+	bool StretchesWhileResizing() override { return true; }
 
 	// --- Rendering Helpers ---
 
@@ -166,6 +130,9 @@ public:
 
 		D2D1_POINT_2F center = D2D1::Point2F(centerX, centerY);
 
+		// The needle follows the value along its transition (shared animation clock, idle when settled)
+		m_currentValue = TransitionFloat(m_keyValue, m_targetValue, "value 600ms ease-out");
+
 		// 2. Resolve Styles
 		const char* cName = GetControlName();
 		std::string sub = GetProperty("subclass");
@@ -352,6 +319,16 @@ public:
 
 	// --- Property Logic ---
 
+	// SetFloat/SetDouble("value") lands here without a string round trip
+	void OnValueChanged(PropertyHandle key, const PropertyValue& value) override {
+		if (key == m_keyValue) {
+			m_targetValue = std::clamp(value.number, m_minValue, m_maxValue);
+			RequestRepaint();
+			return;
+		}
+		WidgetImpl::OnValueChanged(key, value);
+	}
+
 	void OnPropertyChanged(const char* key, const char* value) override {
 		std::string t = key;
 		std::string val = value ? value : "";
@@ -359,7 +336,8 @@ public:
 		if (t == "value") {
 			try { m_targetValue = std::clamp(std::stof(val), m_minValue, m_maxValue); }
 			catch (...) {}
-			// Animation handles the rest
+			// The next paint starts the transition
+			RequestRepaint();
 		}
 		else if (t == "min") {
 			try { m_minValue = std::stof(val); }
@@ -39,7 +39,7 @@ public:
 					"version": 1,
 					"description": "A control with CSS state support (:hover, :disabled)",
 					"properties": [
-						{ "name": "title", "type": "string", "description": "Label text" }
+						{ "name": "title", "type": "string", "description": "Label text", "impact": "layout" }
 					],
 					"events": [
 						{ "name": "onClick", "type": "action" }
@@ -67,6 +67,18 @@ public:
 		}
 	}
 
+	// The title in the font DrawTextStyled uses; wrapped at the offered width when there is one
+	bool OnMeasure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+		std::string label = GetProperty("title");
+		if (label.empty()) return false;
+
+		const ComputedStyle& cs = GetComputedStyle(StyleState::Mask(false, true, false, false));
+		D2D1_SIZE_F text = MeasureText(label, cs, (mode != MeasureMode::Unbounded && availableW >= 0) ? (float)availableW : -1.0f);
+		desired->cx = (LONG)text.width;
+		desired->cy = (LONG)text.height;
+		return true;
+	}
+
 	// 2. Message Logic: Remains mostly standard Win32, 
 	// though WM_PAINT is now handled by the engine calling OnDrawWidget
 	bool OnMessage(UINT msg, WPARAM wp, LPARAM lp) override {
@@ -21,22 +21,6 @@ using namespace ChronoUI;
 #include <windows.h>
 #include <commctrl.h>
 
-// Helper for Linear Interpolation
-template <typename T>
-T Lerp(T start, T end, float t) {
-	return start + static_cast<T>((end - start) * t);
-}
-
-// Helper to Interpolate D2D Colors
-D2D1_COLOR_F LerpColor(const D2D1_COLOR_F& c1, const D2D1_COLOR_F& c2, float t) {
-	return D2D1::ColorF(
-		Lerp(c1.r, c2.r, t),
-		Lerp(c1.g, c2.g, t),
-		Lerp(c1.b, c2.b, t),
-		Lerp(c1.a, c2.a, t)
-	);
-}
-
 class SwitchButton : public WidgetImpl {
 	// Internal State
 	HCURSOR m_handCursor = nullptr;
@@ -45,7 +29,7 @@ class SwitchButton : public WidgetImpl {
 
 	// Animation State
 	float m_animProgress = 0.0f; // 0.0f (Off) to 1.0f (On)
-	bool m_needsAnimation = false;
+	PropertyHandle m_keyChecked = PropertyAtoms::Intern("checked");
 
 public:
 	SwitchButton() {
@@ -191,17 +175,8 @@ public:
 		bool isRightAlign = (textAlign == "right");
 		bool isEnabled = IsWindowEnabled(m_hwnd);
 
-		// 2. Animation Logic (Smooth transition)
-		float target = checked ? 1.0f : 0.0f;
-		if (std::abs(m_animProgress - target) > 0.001f) {
-			// Lerp speed
-			m_animProgress += (target - m_animProgress) * 0.2f;
-			// Continue painting until settled
-			InvalidateRect(m_hwnd, NULL, FALSE);
-		}
-		else {
-			m_animProgress = target;
-		}
+		// 2. Animation Logic: "transition: checked ..." in the style, on the shared animation clock
+		m_animProgress = TransitionFloat(m_keyChecked, checked ? 1.0f : 0.0f, "checked 200ms ease-out");
 
 		// 3. Colors
 		D2D1_COLOR_F cTrackOff = CSSColorToD2D(GetStringProperty("track-off-color"));
@@ -215,7 +190,7 @@ public:
 			cThumb = D2D1::ColorF(0.6f, 0.6f, 0.6f);
 		}
 
-		D2D1_COLOR_F cCurrentTrack = LerpColor(cTrackOff, cTrackOn, m_animProgress);
+		D2D1_COLOR_F cCurrentTrack = RGBAToD2D(Transitions::MixColor(D2DToRGBA(cTrackOff), D2DToRGBA(cTrackOn), m_animProgress));
 
 		// 4. Draw Background
 		DrawWidgetBackground(pRT, rBounds, false); // Switch handles its own hover visual mostly
@@ -357,8 +332,8 @@ public:
 			UpdateTooltipState(true);
 		}
 
-		// For 'checked', we don't snap m_animProgress here to allow
-		// the OnDrawWidget to animate it from current position.
+		// For 'checked', we don't snap m_animProgress here: the next OnDrawWidget
+		// starts the transition from the current position.
 
 		WidgetImpl::OnPropertyChanged(key, value);
 	}
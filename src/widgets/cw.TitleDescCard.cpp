@@ -92,10 +92,10 @@ public:
             "version": 2,
             "description": "Modern card with pill-styled icon",
             "properties": [
-                { "name": "title", "type": "string" },
-                { "name": "description", "type": "string" },
-                { "name": "image_path", "type": "string" },
-                { "name": "image_base64", "type": "string" },
+                { "name": "title", "type": "string", "impact": "layout" },
+                { "name": "description", "type": "string", "impact": "layout" },
+                { "name": "image_path", "type": "string", "impact": "layout" },
+                { "name": "image_base64", "type": "string", "impact": "layout" },
                 { "name": "pill-color", "type": "color" }
             ],
             "events": [ { "name": "onClick", "type": "action" } ]
@@ -147,6 +147,27 @@ public:
 		}
 	}
 
+	// The text column next to the pill, as OnDrawWidget sets it: the title on one line, the
+	// description wrapped at the column width (on one line when no width is offered)
+	bool OnMeasure(int availableW, int availableH, MeasureMode mode, SIZE* desired) override {
+		std::string titleStr = GetStringProperty("title");
+		std::string descStr = GetStringProperty("description");
+		bool hasImage = !m_lastImagePath.empty() || !m_lastImageBase64.empty();
+		float pill = hasImage ? kImageSize + (kPillPadding * 2.0f) : 0.0f;
+		float pillRoom = hasImage ? pill + kPadding : 0.0f;
+
+		float column = -1.0f;
+		if (mode != MeasureMode::Unbounded && availableW >= 0) column = (std::max)(0.0f, availableW - kPadding * 2.0f - pillRoom);
+
+		D2D1_SIZE_F title = MeasureText(titleStr, L"Segoe UI", DWRITE_FONT_WEIGHT_BOLD, DWRITE_FONT_STYLE_NORMAL, 15.0f);
+		D2D1_SIZE_F desc = MeasureText(descStr, L"Segoe UI", DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, 13.0f, column);
+
+		float textH = title.height + ((title.height > 0.0f) ? kTitleGap : 0.0f) + desc.height;
+		desired->cx = (LONG)std::ceil(kPadding * 2.0f + pillRoom + (std::max)(title.width, desc.width));
+		desired->cy = (LONG)std::ceil(kPadding * 2.0f + (std::max)(pill, textH));
+		return true;
+	}
+
 	// -------------------------------------------------------------------------
 	// Modern Painting Entry Point
 	// -------------------------------------------------------------------------
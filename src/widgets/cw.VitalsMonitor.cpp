@@ -38,6 +38,10 @@ private:
 	// ECG Simulation vars
 	float m_simTime = 0.0f;
 
+	// Data mode input, mirrored from "value" so the timer does not parse it
+	float m_inputValue = 0.5f;
+	PropertyHandle m_keyValue = PropertyAtoms::Intern("value");
+
 public:
 	VitalsMonitor() {
 		// --- Initialize Properties ---
@@ -75,7 +79,7 @@ public:
             "properties": [
                 { "name": "label", "type": "string", "description": "Monitor Label" },
                 { "name": "mode", "type": "string", "description": "'sim' for heartbeat, 'data' for manual input" },
-                { "name": "value", "type": "float", "description": "Input value (0.0 - 1.0) for data mode" },
+                { "name": "value", "type": "float", "description": "Input value (0.0 - 1.0) for data mode", "impact": "none" },
                 { "name": "trace_color", "type": "color", "description": "Signal line color" },
                 { "name": "grid_color", "type": "color", "description": "Background grid color" },
                 { "name": "background-color", "type": "color", "description": "Monitor background" },
@@ -88,6 +92,9 @@ public:
         })json";
 	}
 
+	// The traces are redrawn in full, so a splitter drag stretches a snapshot
+	bool StretchesWhileResizing() override { return true; }
+
 	// --- 3. Initialization ---
 	void __stdcall Create(HWND parent) override {
 		WidgetImpl::Create(parent);
@@ -139,6 +146,23 @@ public:
 		return false;
 	}
 
+	// SetFloat/SetDouble("value") lands here without a string round trip
+	void OnValueChanged(PropertyHandle key, const PropertyValue& value) override {
+		if (key == m_keyValue) {
+			m_inputValue = value.number;
+			return;
+		}
+		WidgetImpl::OnValueChanged(key, value);
+	}
+
+	void OnPropertyChanged(const char* key, const char* value) override {
+		WidgetImpl::OnPropertyChanged(key, value);
+		if (strcmp(key, "value") == 0) {
+			try { m_inputValue = std::stof(value ? value : ""); }
+			catch (...) {}
+		}
+	}
+
 	// --- Internal Logic: Simulation & Buffer Update ---
 	void UpdateSimulation() {
 		if (m_dataBuffer.empty()) return;
@@ -169,7 +193,7 @@ public:
 			}
 			else {
 				// Real data mode
-				float val = GetFloatProperty("value");
+				float val = m_inputValue;
 				val = (std::max)(0.0f, (std::min)(1.0f, val));
 				newValue = 1.0f - val; // Invert for Y-axis (0 at top)
 			}